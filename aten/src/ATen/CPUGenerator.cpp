@@ -61,6 +61,7 @@ void CPUGenerator::set_current_seed(uint64_t seed) {
   next_float_normal_sample_.reset();
   next_double_normal_sample_.reset();
   engine_ = mt19937(seed);
+  philox_offset_ = 0;
 }
 
 /**
@@ -159,6 +160,62 @@ void CPUGenerator::set_engine(at::mt19937 engine) {
   engine_ = engine;
 }
 
+/**
+ * Note [Philox mode of CPUGenerator]
+ * ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * By default, a CPUGenerator produces one sequential stream of randoms from
+ * its mt19937 engine, so tensors are filled one element at a time while
+ * holding the generator's lock.
+ *
+ * In Philox mode, contiguous fills (uniform_, normal_ and bernoulli_ with a
+ * scalar probability, and thus dropout) instead use the counter-based
+ * philox_engine, keyed by current_seed(). A fill reserves a range of the
+ * Philox stream by advancing the offset with philox_engine_inputs(), and
+ * element i of the tensor always gets the randoms at the same position of
+ * that range. Each parallel_for chunk then starts its own engine at the
+ * offset of its first element, so the chunks run in parallel without
+ * locking and the result only depends on the seed and the offset, not on
+ * the number of threads. See ATen/native/PhiloxFill.h.
+ *
+ * Ops that do not support Philox mode keep using the mt19937 engine, which
+ * is not affected by Philox fills.
+ */
+void CPUGenerator::set_philox_mode(bool enabled) {
+  philox_mode_ = enabled;
+}
+
+bool CPUGenerator::philox_mode() const {
+  return philox_mode_;
+}
+
+/**
+ * Sets the offset (in 128 bit numbers) of the next Philox fill
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+void CPUGenerator::set_philox_offset(uint64_t offset) {
+  philox_offset_ = offset;
+}
+
+/**
+ * Gets the offset (in 128 bit numbers) of the next Philox fill
+ */
+uint64_t CPUGenerator::philox_offset() const {
+  return philox_offset_;
+}
+
+/**
+ * Reserves `increment` 128 bit numbers of the Philox stream and returns the
+ * seed and the offset of the first one.
+ *
+ * See Note [Acquire lock when using random generators]
+ */
+std::pair<uint64_t, uint64_t> CPUGenerator::philox_engine_inputs(uint64_t increment) {
+  uint64_t offset = philox_offset_;
+  philox_offset_ += increment;
+  return std::make_pair(current_seed(), offset);
+}
+
 /**
  * Public clone method implementation
  * 
@@ -178,6 +235,8 @@ CPUGenerator* CPUGenerator::clone_impl() const {
   gen->set_engine(engine_);
   gen->set_next_float_normal_sample(next_float_normal_sample_);
   gen->set_next_double_normal_sample(next_double_normal_sample_);
+  gen->set_philox_mode(philox_mode_);
+  gen->set_philox_offset(philox_offset_);
   return gen;
 }
 
@@ -4,6 +4,7 @@
 #include <ATen/core/MT19937RNGEngine.h>
 #include <ATen/core/PhiloxRNGEngine.h>
 #include <c10/util/Optional.h>
+#include <atomic>
 
 namespace at {
 
@@ -26,12 +27,20 @@ struct CAFFE2_API CPUGenerator : public Generator {
   void set_next_double_normal_sample(c10::optional<double> randn);
   at::mt19937 engine();
   void set_engine(at::mt19937 engine);
+  // See Note [Philox mode of CPUGenerator]
+  void set_philox_mode(bool enabled);
+  bool philox_mode() const;
+  void set_philox_offset(uint64_t offset);
+  uint64_t philox_offset() const;
+  std::pair<uint64_t, uint64_t> philox_engine_inputs(uint64_t increment);
 
 private:
   CPUGenerator* clone_impl() const override;
   at::mt19937 engine_;
   c10::optional<float> next_float_normal_sample_;
   c10::optional<double> next_double_normal_sample_;
+  std::atomic<bool> philox_mode_{false};
+  uint64_t philox_offset_ = 0;
 };
 
 namespace detail {
@@ -81,6 +81,11 @@ std::string get_parallel_info() {
   #endif
   ss << std::endl;
 
+  #if AT_PARALLEL_NATIVE
+  ss << "\tat::get_intraop_numa_pinning() : "
+     << at::get_intraop_numa_pinning() << std::endl;
+  #endif
+
   #if AT_EXPERIMENTAL_SINGLE_THREAD_POOL
   ss << "Experimental: single thread pool" << std::endl;
   #endif
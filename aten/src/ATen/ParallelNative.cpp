@@ -2,6 +2,8 @@
 #include <ATen/Parallel.h>
 #include <ATen/PTThreadPool.h>
 
+#include <c10/util/numa.h>
+
 #include <atomic>
 
 #ifdef _OPENMP
@@ -27,6 +29,13 @@ const int CONSUMED = -2;
 //  - CONSUMED - pool is initialized
 std::atomic<int> num_intraop_threads{NOT_SET};
 
+// Whether to create one intra-op pool per NUMA node, see
+// set_intraop_numa_pinning
+std::atomic<bool> intraop_numa_pinning{false};
+
+// round-robin counter for intraop_launch over the per-node pools
+std::atomic<size_t> next_launch_pool{0};
+
 // used with _set_in_parallel_region to mark master thread
 // as in parallel region while executing parallel primitives
 thread_local bool in_parallel_region_ = false;
@@ -43,18 +52,88 @@ int _num_pool_threads(int nthreads) {
   // minus one because of the master thread
   return nthreads - 1;
 }
+
+// Marks the current thread as running chunk `task_id` of a parallel
+// primitive; restores the previous state on exit, since with nested
+// parallelism and helping a thread can run chunks of several regions on top
+// of each other
+struct ParallelRegionGuard {
+  explicit ParallelRegionGuard(size_t task_id)
+      : prev_in_region_(in_parallel_region_), prev_thread_num_(thread_num_) {
+    in_parallel_region_ = true;
+    thread_num_ = task_id;
+  }
+
+  ~ParallelRegionGuard() {
+    in_parallel_region_ = prev_in_region_;
+    thread_num_ = prev_thread_num_;
+  }
+
+ private:
+  bool prev_in_region_;
+  size_t prev_thread_num_;
+};
+
+// Intra-op work runs on work-stealing pools: chunks of a parallel region
+// are stolen by idle workers, and threads waiting for a region to finish
+// run chunks instead of blocking
+using intraop_pools_t = std::vector<std::shared_ptr<c10::WorkStealingThreadPool>>;
+
+intraop_pools_t _create_intraop_pools(int pool_size) {
+  intraop_pools_t pools;
+  int num_nodes = intraop_numa_pinning.load() ? c10::GetNumNUMANodes() : -1;
+  if (num_nodes <= 1 || pool_size < num_nodes) {
+    pools.push_back(std::make_shared<PTWorkStealingThreadPool>(pool_size));
+    return pools;
+  }
+  // split the workers evenly over the nodes, each pool binds its threads to
+  // its node
+  for (int node = 0; node < num_nodes; ++node) {
+    int node_pool_size = pool_size * (node + 1) / num_nodes -
+        pool_size * node / num_nodes;
+    pools.push_back(
+        std::make_shared<PTWorkStealingThreadPool>(node_pool_size, node));
+  }
+  return pools;
+}
+
+intraop_pools_t& _get_intraop_pools() {
+  static intraop_pools_t pools = _create_intraop_pools(
+      _num_pool_threads(num_intraop_threads.exchange(CONSUMED)));
+  return pools;
+}
+
+// With NUMA pinning the tasks of a region are spread over the per-node pools
+// in contiguous blocks, so that a given chunk always lands on the same node
+c10::WorkStealingThreadPool& _get_task_pool(size_t task_id, size_t num_tasks) {
+  auto& pools = _get_intraop_pools();
+  if (pools.size() == 1) {
+    return *pools[0];
+  }
+  return *pools[task_id * pools.size() / num_tasks];
+}
+
+// The pool the current thread is a worker of, or the first one for threads
+// outside of the intra-op pools
+c10::WorkStealingThreadPool& _get_current_intraop_pool() {
+  auto& pools = _get_intraop_pools();
+  for (auto& pool : pools) {
+    if (pool->inThreadPool()) {
+      return *pool;
+    }
+  }
+  return *pools[0];
+}
 } // namespace
 
 namespace internal {
 
 TaskThreadPoolBase& _get_intraop_pool() {
-  static std::shared_ptr<TaskThreadPoolBase> pool =
-      ThreadPoolRegistry()->Create(
-          "C10",
-          /* device_id */ 0,
-          /* pool_size */ _num_pool_threads(num_intraop_threads.exchange(CONSUMED)),
-          /* create_new */ true); // create a separate thread pool for intra-op
-  return *pool;
+  return *_get_intraop_pools()[0];
+}
+
+TaskThreadPoolBase& _get_intraop_pool(size_t task_id, size_t num_tasks) {
+  return _get_task_pool(task_id, num_tasks);
 }
 
 void _set_in_parallel_region(bool in_region) {
@@ -69,6 +148,59 @@ void _unset_thread_num() {
   thread_num_ = 0;
 }
 
+void _parallel_run(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t, size_t)>& f) {
+  size_t num_tasks, chunk_size;
+  std::tie(num_tasks, chunk_size) =
+      calc_num_tasks_and_chunk_size(begin, end, grain_size);
+
+  std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
+  std::exception_ptr eptr;
+  std::atomic<size_t> remaining{num_tasks};
+  auto task = [&](size_t task_id) {
+    int64_t local_start = begin + task_id * chunk_size;
+    if (local_start < end) {
+      int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
+      ParallelRegionGuard guard(task_id);
+      try {
+        f(local_start, local_end, task_id);
+      } catch (...) {
+        if (!err_flag.test_and_set()) {
+          eptr = std::current_exception();
+        }
+      }
+    }
+    // last access to the state of this call, the caller may return as soon
+    // as the count drops to zero
+    --remaining;
+  };
+
+  for (size_t task_id = 1; task_id < num_tasks; ++task_id) {
+    _get_task_pool(task_id, num_tasks).fork(
+        // copy task_id
+        [&task, task_id]() { task(task_id); });
+  }
+  task(0);
+  if (num_tasks > 1) {
+    // run outstanding chunks (ours, or anyone's) rather than block
+    _get_current_intraop_pool().waitUntil(
+        [&remaining]() { return remaining.load() == 0; });
+  }
+  if (eptr) {
+    std::rethrow_exception(eptr);
+  }
+}
+
+bool _can_fork_nested() {
+  if (num_intraop_threads.load() != CONSUMED) {
+    return false;
+  }
+  return _get_current_intraop_pool().numAvailable() > 0;
+}
+
 } // namespace internal
 
 void init_num_threads() {
@@ -89,6 +221,20 @@ void set_num_threads(int nthreads) {
       "after parallel work has started or after set_num_threads call");
 }
 
+void set_intraop_numa_pinning(bool enabled) {
+  TORCH_CHECK(num_intraop_threads.load() != CONSUMED,
+      "Error: cannot set intra-op NUMA pinning "
+      "after parallel work has started");
+  intraop_numa_pinning = enabled;
+  if (enabled) {
+    FLAGS_caffe2_cpu_numa_enabled = true;
+  }
+}
+
+bool get_intraop_numa_pinning() {
+  return intraop_numa_pinning.load();
+}
+
 int get_num_threads() {
   // not initializing pool unnecessarily,
   // because pool cannot be resized after initialization
@@ -99,7 +245,11 @@ int get_num_threads() {
     return intraop_default_num_threads();
   } else {
     TORCH_INTERNAL_ASSERT(nthreads == CONSUMED);
-    return internal::_get_intraop_pool().size() + 1;
+    size_t pool_threads = 0;
+    for (auto& pool : _get_intraop_pools()) {
+      pool_threads += pool->size();
+    }
+    return pool_threads + 1;
   }
 }
 
@@ -108,15 +258,33 @@ int get_thread_num() {
 }
 
 bool in_parallel_region() {
-  return in_parallel_region_ || (
-    num_intraop_threads.load() == CONSUMED &&
-    internal::_get_intraop_pool().inThreadPool()
-  );
+  if (in_parallel_region_) {
+    return true;
+  }
+  if (num_intraop_threads.load() != CONSUMED) {
+    return false;
+  }
+  for (auto& pool : _get_intraop_pools()) {
+    if (pool->inThreadPool()) {
+      return true;
+    }
+  }
+  return false;
 }
 
+namespace {
+TaskThreadPoolBase& _get_launch_pool() {
+  auto& pools = _get_intraop_pools();
+  if (pools.size() == 1) {
+    return *pools[0];
+  }
+  return *pools[next_launch_pool++ % pools.size()];
+}
+} // namespace
+
 void intraop_launch(std::function<void()> func) {
   if (!in_parallel_region() && get_num_threads() > 1) {
-    internal::_get_intraop_pool().run(func);
+    _get_launch_pool().run(func);
   } else {
     // execute inline if we're in parallel region
     func();
@@ -127,7 +295,7 @@ std::shared_ptr<c10::ivalue::Future> intraop_launch_future(
     std::function<void()> func) {
   auto future = std::make_shared<c10::ivalue::Future>();
   if (!in_parallel_region() && get_num_threads() > 1) {
-    internal::_get_intraop_pool().run(
+    _get_launch_pool().run(
       [func, future]() {
         func();
         future->markCompleted();
@@ -6,6 +6,8 @@
 #include <algorithm>
 #include <cstddef>
 #include <exception>
+#include <functional>
+#include <tuple>
 
 #define INTRA_OP_PARALLEL
 
@@ -15,6 +17,14 @@ namespace internal {
 // template parallel primitives (parallel_for, parallel_reduce)
 CAFFE2_API TaskThreadPoolBase& _get_intraop_pool();
 
+// internal function to get the intra-op thread pool that runs task
+// `task_id` out of `num_tasks`; with NUMA pinning the tasks are spread over
+// the per-node pools in contiguous blocks, so that a given chunk of a range
+// always lands on the same node
+CAFFE2_API TaskThreadPoolBase& _get_intraop_pool(
+    size_t task_id,
+    size_t num_tasks);
+
 // internal utility function to mark master thread as in parallel
 // region when executing parallel primitives
 CAFFE2_API void _set_in_parallel_region(bool);
@@ -23,8 +33,47 @@ CAFFE2_API void _set_in_parallel_region(bool);
 // task id as thread number when executing parallel primitives
 CAFFE2_API void _set_thread_num(size_t thread_num);
 CAFFE2_API void _unset_thread_num();
+
+// Splits [begin, end) into one chunk per thread, but no chunk smaller than
+// grain_size; returns the number of chunks and the chunk size
+inline std::tuple<size_t, size_t> calc_num_tasks_and_chunk_size(
+    int64_t begin, int64_t end, int64_t grain_size) {
+  size_t chunk_size = divup((end - begin), get_num_threads());
+  chunk_size = std::max((size_t)grain_size, chunk_size);
+  size_t num_tasks = divup((end - begin), chunk_size);
+  return std::make_tuple(num_tasks, chunk_size);
 }
 
+// Runs f(local_start, local_end, task_id) for every chunk of [begin, end) as
+// split by calc_num_tasks_and_chunk_size.  The calling thread runs the first
+// chunk and then, instead of blocking, helps the intra-op pool with the
+// remaining ones.  Inside each chunk in_parallel_region() is true and
+// get_thread_num() returns the task id.  Rethrows the first exception thrown
+// by f.
+CAFFE2_API void _parallel_run(
+    const int64_t begin,
+    const int64_t end,
+    const int64_t grain_size,
+    const std::function<void(int64_t, int64_t, size_t)>& f);
+
+// Whether a parallel primitive called from inside a parallel region should
+// fork again rather than run serially: true when some intra-op workers are
+// idle and can steal the nested chunks
+CAFFE2_API bool _can_fork_nested();
+}
+
+// Splits the intra-op thread pool into one pool per NUMA node, with workers
+// bound to the CPUs and memory of their node.  parallel_for and
+// parallel_reduce then always run a given chunk of their range on the same
+// node, so memory first touched by one parallel op stays local to the
+// workers of later ops over the same range.  Enables NUMA support in c10
+// (caffe2_cpu_numa_enabled).  Must be called before any parallel work is
+// started; has no effect on machines with a single NUMA node.
+CAFFE2_API void set_intraop_numa_pinning(bool enabled);
+
+// Returns whether intra-op workers are pinned to NUMA nodes
+CAFFE2_API bool get_intraop_numa_pinning();
+
 template <class F>
 inline void parallel_for(
     const int64_t begin,
@@ -36,56 +85,15 @@ inline void parallel_for(
     return;
   }
 
-  if (((end - begin) >= grain_size) && !in_parallel_region()) {
-    // choose number of tasks based on grain size and number of threads
-    size_t chunk_size = divup((end - begin), get_num_threads());
-    // make sure each task is at least grain_size size
-    chunk_size = std::max((size_t)grain_size, chunk_size);
-    size_t num_tasks = divup((end - begin), chunk_size);
-
-    std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
-    std::exception_ptr eptr;
-    auto task = [f, &eptr, &err_flag]
-        (int64_t task_id, int64_t local_start, int64_t local_end) {
-      internal::_set_thread_num(task_id);
-      internal::_set_in_parallel_region(true);
-      try {
-        f(local_start, local_end);
-      } catch (...) {
-        if (!err_flag.test_and_set()) {
-          eptr = std::current_exception();
-        }
-      }
-      internal::_set_in_parallel_region(false);
-      internal::_unset_thread_num();
-    };
-
-    std::vector<c10::ivalue::Future> futures(num_tasks);
-    for (size_t task_id = 1; task_id < num_tasks; ++task_id) {
-      int64_t local_start = begin + task_id * chunk_size;
-      if (local_start < end) {
-        int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
-        internal::_get_intraop_pool().run(
-          // copy task_id, local_start, local_end
-          [&task, &futures, task_id, local_start, local_end]() {
-            task(task_id, local_start, local_end);
-            futures[task_id].markCompleted();
-          }
-        );
-      } else {
-        futures[task_id].markCompleted();
-      }
-    }
-
-    int64_t first_task_end = std::min(end, (int64_t)(chunk_size + begin));
-    task(0, begin, first_task_end);
-    // wait for all tasks to finish
-    for (size_t task_id = 1; task_id < num_tasks; ++task_id) {
-      futures[task_id].wait();
-    }
-    if (eptr) {
-      std::rethrow_exception(eptr);
-    }
+  if (((end - begin) >= grain_size) &&
+      (!in_parallel_region() || internal::_can_fork_nested())) {
+    internal::_parallel_run(
+        begin,
+        end,
+        grain_size,
+        [&f](int64_t local_start, int64_t local_end, size_t /* task_id */) {
+          f(local_start, local_end);
+        });
   } else {
     f(begin, end);
   }
@@ -104,55 +112,22 @@ inline scalar_t parallel_reduce(
     return ident;
   }
 
-  if (((end - begin) >= grain_size) && !in_parallel_region()) {
-    size_t chunk_size = divup((end - begin), get_num_threads());
-    chunk_size = std::max((size_t)grain_size, chunk_size);
-    size_t num_tasks = divup((end - begin), chunk_size);
-    std::vector<scalar_t> results(num_tasks);
+  if (((end - begin) >= grain_size) &&
+      (!in_parallel_region() || internal::_can_fork_nested())) {
+    size_t num_tasks, chunk_size;
+    std::tie(num_tasks, chunk_size) =
+        internal::calc_num_tasks_and_chunk_size(begin, end, grain_size);
+    std::vector<scalar_t> results(num_tasks, ident);
     scalar_t* results_data = results.data();
 
-    std::atomic_flag err_flag = ATOMIC_FLAG_INIT;
-    std::exception_ptr eptr;
-    auto task = [f, ident, results_data, &eptr, &err_flag]
-        (int64_t task_id, int64_t local_start, int64_t local_end) {
-      internal::_set_thread_num(task_id);
-      internal::_set_in_parallel_region(true);
-      try {
-        results_data[task_id] = f(local_start, local_end, ident);
-      } catch (...) {
-        if (!err_flag.test_and_set()) {
-          eptr = std::current_exception();
-        }
-      }
-      internal::_set_in_parallel_region(false);
-      internal::_unset_thread_num();
-    };
-
-    std::vector<c10::ivalue::Future> futures(num_tasks);
-    for (size_t task_id = 1; task_id < num_tasks; ++task_id) {
-      int64_t local_start = begin + task_id * chunk_size;
-      if (local_start < end) {
-        int64_t local_end = std::min(end, (int64_t)(chunk_size + local_start));
-        internal::_get_intraop_pool().run(
-          // copy task_id, local_start, local_end
-          [&task, &futures, task_id, local_start, local_end]() {
-            task(task_id, local_start, local_end);
-            futures[task_id].markCompleted();
-          }
-        );
-      } else {
-        futures[task_id].markCompleted();
-      }
-    }
-
-    int64_t first_task_end = std::min(end, (int64_t)(chunk_size + begin));
-    task(0, begin, first_task_end);
-    for (size_t task_id = 1; task_id < num_tasks; ++task_id) {
-      futures[task_id].wait();
-    }
-    if (eptr) {
-      std::rethrow_exception(eptr);
-    }
+    internal::_parallel_run(
+        begin,
+        end,
+        grain_size,
+        [&f, ident, results_data]
+            (int64_t local_start, int64_t local_end, size_t task_id) {
+          results_data[task_id] = f(local_start, local_end, ident);
+        });
 
     scalar_t result = ident;
     for (auto partial_result : results) {
@@ -0,0 +1,105 @@
+#include <ATen/ATen.h>
+#include <ATen/SparseCsrTensorImpl.h>
+#include <ATen/InitialTensorOptions.h>
+
+namespace at {
+
+namespace {
+  DeviceType sparseCsrTensorSetToDeviceType(TensorTypeSet type_set) {
+    if (type_set.has(TensorTypeId::SparseCsrCPUTensorId)) {
+      return kCPU;
+    } else {
+      AT_ERROR("Cannot construct SparseCsrTensor with non-sparse CSR tensor type ID ", type_set);
+    }
+  }
+}
+
+
+// An empty CSR tensor is a 0 x 0 matrix: it has a single row pointer (the
+// trailing one, which is 0) and no columns or values.
+SparseCsrTensorImpl::SparseCsrTensorImpl(at::TensorTypeSet type_set, const caffe2::TypeMeta& data_type)
+  :   SparseCsrTensorImpl(type_set, data_type
+      , at::zeros({1}, at::initialTensorOptions().device(sparseCsrTensorSetToDeviceType(type_set)).dtype(ScalarType::Long))
+      , at::empty({0}, at::initialTensorOptions().device(sparseCsrTensorSetToDeviceType(type_set)).dtype(ScalarType::Long))
+      , at::empty({0}, at::initialTensorOptions().device(sparseCsrTensorSetToDeviceType(type_set)).dtype(data_type))) {}
+
+SparseCsrTensorImpl::SparseCsrTensorImpl(at::TensorTypeSet type_set, const caffe2::TypeMeta& data_type, at::Tensor crow_indices, at::Tensor col_indices, at::Tensor values)
+    : TensorImpl(type_set, data_type, values.device())
+    , crow_indices_(std::move(crow_indices))
+    , col_indices_(std::move(col_indices))
+    , values_(std::move(values)) {
+  sizes_ = {0, 0};
+  refresh_numel();
+}
+
+IntArrayRef SparseCsrTensorImpl::strides() const {
+  AT_ERROR("sparse CSR tensors do not have strides");
+}
+bool SparseCsrTensorImpl::is_contiguous(at::MemoryFormat memory_format) const {
+  AT_ERROR("sparse CSR tensors do not have is_contiguous");
+}
+int64_t SparseCsrTensorImpl::stride(int64_t d) const {
+  AT_ERROR("sparse CSR tensors do not have strides");
+}
+void SparseCsrTensorImpl::resize_dim(int64_t ndim) {
+  AT_ERROR("sparse CSR tensors do not have resize_dim");
+}
+void SparseCsrTensorImpl::set_size(int64_t dim, int64_t new_size) {
+  AT_ERROR("sparse CSR tensors do not have set_size");
+}
+void SparseCsrTensorImpl::set_stride(int64_t dim, int64_t new_stride) {
+  AT_ERROR("sparse CSR tensors do not have set_stride");
+}
+void SparseCsrTensorImpl::set_storage_offset(int64_t storage_offset) {
+  AT_ERROR("sparse CSR tensors do not have set_storage_offset");
+}
+
+TensorImpl* SparseCsrTensorImpl::maybe_zero_dim(bool condition_when_zero_dim) {
+  TORCH_CHECK(!condition_when_zero_dim,
+           "Attempted to maybe_zero_dim on a SparseCsrTensorImpl to ", condition_when_zero_dim,
+           " but sparse CSR tensors are always 2-dimensional");
+  return this;
+}
+bool SparseCsrTensorImpl::has_storage() const {
+  return false;
+}
+const Storage& SparseCsrTensorImpl::storage() const {
+  AT_ERROR("sparse CSR tensors do not have storage");
+}
+int64_t SparseCsrTensorImpl::storage_offset() const {
+  AT_ERROR("sparse CSR tensors do not have storage");
+}
+void SparseCsrTensorImpl::set_member_tensors_unsafe(const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, IntArrayRef size) {
+  TORCH_CHECK(allow_tensor_metadata_change(), "set_member_tensors_unsafe ", err_msg_tensor_metadata_change_not_allowed);
+  AT_ASSERT(!crow_indices.is_variable() && !col_indices.is_variable() && !values.is_variable());  // They should be plain tensors!  // TODO: change this to check `.requires_grad()` and `GradMode::is_enabled()` when Variable and Tensor are merged
+
+  TORCH_CHECK(crow_indices.layout() == kStrided, "expected crow_indices to be a strided tensor, but got crow_indices of layout ", crow_indices.layout());
+  TORCH_CHECK(col_indices.layout() == kStrided, "expected col_indices to be a strided tensor, but got col_indices of layout ", col_indices.layout());
+  TORCH_CHECK(values.layout() == kStrided, "expected values to be a strided tensor, but got values of layout ", values.layout());
+
+  TORCH_CHECK(values.device().type() == device().type(), "device type of values (", values.device().type(), ") must match device type of device().type()", device().type(), ")");
+  TORCH_CHECK(values.scalar_type() == typeMetaToScalarType(dtype()), "dtype of values (", values.scalar_type(), ") must match dtype of sparse CSR tensor (", typeMetaToScalarType(dtype()), ")");
+  TORCH_CHECK(crow_indices.scalar_type() == kLong, "crow_indices must be an int64 tensor");
+  TORCH_CHECK(col_indices.scalar_type() == kLong, "col_indices must be an int64 tensor");
+  TORCH_CHECK(crow_indices.device() == values.device() && col_indices.device() == values.device(),
+      "crow_indices, col_indices and values must be on the same device");
+
+  TORCH_CHECK(size.size() == 2, "sparse CSR tensors must be 2-dimensional, but got size ", size);
+  TORCH_CHECK(crow_indices.dim() == 1, "crow_indices must have dim=1, but got crow_indices.dim()=", crow_indices.dim());
+  TORCH_CHECK(col_indices.dim() == 1, "col_indices must have dim=1, but got col_indices.dim()=", col_indices.dim());
+  TORCH_CHECK(values.dim() == 1, "values must have dim=1, but got values.dim()=", values.dim());
+  TORCH_CHECK(crow_indices.size(0) == size[0] + 1,
+      "crow_indices must have size(0) == size[0] + 1 (", size[0] + 1, "), but got ", crow_indices.size(0));
+  TORCH_CHECK(col_indices.size(0) == values.size(0),
+      "col_indices and values must have same nnz, but got nnz from col_indices: ", col_indices.size(0), ", nnz from values: ", values.size(0));
+
+  crow_indices_ = crow_indices.contiguous();
+  col_indices_ = col_indices.contiguous();
+  values_ = values;
+  sizes_ = size.vec();
+  refresh_numel();
+  AT_ASSERT(device() == values_.device());
+}
+
+
+} // namespace at
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <ATen/Tensor.h>
+#include <c10/core/TensorImpl.h>
+#include <c10/util/Exception.h>
+
+namespace at {
+struct CAFFE2_API SparseCsrTensorImpl : public TensorImpl {
+  // Stored in compressed sparse row (CSR) format, crow_indices + col_indices + values.
+
+  // INVARIANTS:
+  // len(shape) == 2; only matrices are supported
+  // _crow_indices.shape: dimensionality: 1, shape: (shape[0] + 1)
+  // _col_indices.shape:  dimensionality: 1, shape: (nnz)
+  // _values.shape:       dimensionality: 1, shape: (nnz)
+  //
+  // crow_indices[0] == 0, crow_indices[shape[0]] == nnz and crow_indices is
+  // non-decreasing; the entries of row i are col_indices[crow_indices[i]:crow_indices[i+1]]
+  // and values[crow_indices[i]:crow_indices[i+1]].
+
+  Tensor crow_indices_; // always a contiguous LongTensor
+  Tensor col_indices_; // always a contiguous LongTensor
+  Tensor values_;
+
+public:
+  // Public for now...
+  explicit SparseCsrTensorImpl(at::TensorTypeSet, const caffe2::TypeMeta&);
+
+  int64_t nnz() const { return values_.size(0); }
+  Tensor crow_indices() const { return crow_indices_; }
+  Tensor col_indices() const { return col_indices_; }
+  Tensor values() const { return values_; }
+
+  IntArrayRef strides() const override;
+  bool is_contiguous(at::MemoryFormat memory_format=at::MemoryFormat::Contiguous) const override;
+  int64_t stride(int64_t d) const override;
+  void resize_dim(int64_t ndim) override;
+  void set_size(int64_t dim, int64_t new_size) override;
+  void set_stride(int64_t dim, int64_t new_stride) override;
+  void set_storage_offset(int64_t storage_offset) override;
+
+  TensorImpl* maybe_zero_dim(bool condition_when_zero_dim) override;
+  bool has_storage() const override;
+  const Storage& storage() const override;
+  int64_t storage_offset() const override;
+
+  // Takes crow_indices, col_indices and values and directly puts them into the
+  // CSR tensor, no copy.
+  // NOTE: this function is unsafe because it only checks the shapes, not that
+  // crow_indices is non-decreasing or that col_indices are within `size`, so
+  // it should ONLY be used where those invariants are already known to hold.
+  void set_member_tensors_unsafe(const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, IntArrayRef size);
+
+  /**
+   * Return a TensorImpl that is a shallow-copy of this TensorImpl.
+   *
+   * For usage of `version_counter` and `allow_tensor_metadata_change`,
+   * see NOTE [ TensorImpl Shallow-Copying ].
+   */
+  c10::intrusive_ptr<TensorImpl> shallow_copy_and_detach(
+      const c10::VariableVersion& version_counter,
+      bool allow_tensor_metadata_change) const override {
+    auto impl = c10::make_intrusive<SparseCsrTensorImpl>(type_set(), dtype());
+    copy_tensor_metadata(
+      /*src_impl=*/this,
+      /*dest_impl=*/impl.get(),
+      /*version_counter=*/version_counter,
+      /*allow_tensor_metadata_change=*/allow_tensor_metadata_change);
+    impl->refresh_numel();
+    return impl;
+  }
+
+  /**
+   * Shallow-copies data from another TensorImpl into this TensorImpl.
+   *
+   * For why this function doesn't check this TensorImpl's `allow_tensor_metadata_change_`,
+   * see NOTE [ TensorImpl Shallow-Copying ].
+   */
+  void shallow_copy_from(const c10::intrusive_ptr<TensorImpl>& impl) override {
+    AT_ASSERT(has_compatible_shallow_copy_type(impl->type_set()));
+    auto sparse_csr_impl = static_cast<const SparseCsrTensorImpl*>(impl.get());
+    copy_tensor_metadata(
+      /*src_impl=*/sparse_csr_impl,
+      /*dest_impl=*/this,
+      /*version_counter=*/version_counter(),
+      /*allow_tensor_metadata_change=*/allow_tensor_metadata_change());
+    refresh_numel();
+  }
+private:
+  explicit SparseCsrTensorImpl(at::TensorTypeSet, const caffe2::TypeMeta&, at::Tensor crow_indices, at::Tensor col_indices, at::Tensor values);
+
+  /**
+   * Copy the tensor metadata fields (e.g. sizes / strides / storage pointer / storage_offset)
+   * from one TensorImpl to another TensorImpl.
+   *
+   * For usage of `version_counter` and `allow_tensor_metadata_change`, see NOTE [ TensorImpl Shallow-Copying ].
+   */
+  static void copy_tensor_metadata(
+      const SparseCsrTensorImpl* src_sparse_csr_impl,
+      SparseCsrTensorImpl* dest_sparse_csr_impl,
+      const c10::VariableVersion& version_counter,
+      bool allow_tensor_metadata_change) {
+    TensorImpl::copy_tensor_metadata(src_sparse_csr_impl, dest_sparse_csr_impl, version_counter, allow_tensor_metadata_change);
+
+    // SparseCsr-specific fields
+    dest_sparse_csr_impl->crow_indices_ = src_sparse_csr_impl->crow_indices();
+    dest_sparse_csr_impl->col_indices_ = src_sparse_csr_impl->col_indices();
+    dest_sparse_csr_impl->values_ = src_sparse_csr_impl->values();
+  }
+};
+
+} // namespace at
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/SparseCsrTensorImpl.h>
 #include <ATen/SparseTensorImpl.h>
 
 namespace at { namespace sparse {
@@ -24,6 +26,14 @@ inline SparseTensorImpl* get_sparse_impl(const SparseTensor& self) {
   return static_cast<SparseTensorImpl*>(self.unsafeGetTensorImpl());
 }
 
+// Same as get_sparse_impl, for the SparseCsrTensorImpl of a tensor with
+// sparse CSR layout.
+inline SparseCsrTensorImpl* get_sparse_csr_impl(const Tensor& self) {
+  AT_ASSERTM(!self.is_variable(), "_internal_get_SparseCsrTensorImpl: should not be a variable");  // TODO: remove this when Variable and Tensor are merged
+  AT_ASSERTM(self.is_sparse_csr(), "_internal_get_SparseCsrTensorImpl: not a sparse CSR tensor");
+  return static_cast<SparseCsrTensorImpl*>(self.unsafeGetTensorImpl());
+}
+
 // Takes indices and values and directly puts them into the sparse tensor, no
 // copy.  This used to be called THSTensor_(_move)
 inline void alias_into_sparse(const SparseTensor& self, const LongTensor& indices, const Tensor& values) {
@@ -39,6 +49,30 @@ inline void copy_into_sparse(const SparseTensor& self, const LongTensor& indices
       values.to(self._values().options(), non_blocking, /*copy=*/true));
 }
 
+// Compresses the sorted row indices of a coalesced 2-D sparse tensor into
+// CSR row pointers: rows [csr[i], csr[i+1]) of the nnz entries belong to
+// row i, for i in [0, dim).
+inline LongTensor coo_to_csr(const int64_t* indices, int64_t dim, int64_t nnz) {
+  LongTensor csr = at::zeros({dim + 1}, kLong);
+
+  // TODO: eliminate this conditional when zero-size dims supported correctly
+  if (nnz > 0) {
+    auto csr_accessor = csr.accessor<int64_t, 1>();
+    // Convert the sparse matrix to CSR format
+    at::parallel_for(0, nnz, 10000, [&](int64_t start, int64_t end) {
+      int64_t h, hp0, hp1;
+      for (auto i = start; i < end; i++) {
+        hp0 = indices[i];
+        hp1 = (i+1 == nnz) ?  dim : indices[i+1];
+        if (hp0 != hp1) for (h = hp0; h < hp1; h++) {
+          csr_accessor[h+1] = i+1;
+        }
+      }
+    });
+  }
+  return csr;
+}
+
 // TODO: put this into the public API
 inline bool is_same_tensor(const Tensor& lhs, const Tensor& rhs) {
   return lhs.unsafeGetTensorImpl() == rhs.unsafeGetTensorImpl();
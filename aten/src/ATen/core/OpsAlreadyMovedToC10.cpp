@@ -362,6 +362,7 @@ bool aten_op_is_already_moved_to_c10(const c10::OperatorName& opName) {
         {"aten::threshold_backward", ""},
         {"aten::transpose", "int"},
         {"aten::_mkldnn_transpose", ""},
+        {"aten::_sparse_csr_transpose", ""},
         {"aten::transpose_", ""},
         {"aten::_mkldnn_transpose_", ""},
         {"aten::one_hot", ""},
@@ -440,12 +441,15 @@ bool aten_op_is_already_moved_to_c10(const c10::OperatorName& opName) {
         {"aten::_coalesced_", ""},
         {"aten::indices", ""},
         {"aten::values", ""},
+        {"aten::crow_indices", ""},
+        {"aten::col_indices", ""},
         {"aten::hspmm", ""},
         {"aten::copy_sparse_to_sparse_", ""},
         {"aten::numel", ""},
         {"aten::unbind", "int"},
         {"aten::to_sparse", "sparse_dim"},
         {"aten::to_sparse", ""},
+        {"aten::to_sparse_csr", ""},
         {"aten::to_mkldnn", ""},
         {"aten::mkldnn_reorder_conv2d_weight", ""},
         {"aten::to_mkldnn_backward", ""},
@@ -830,6 +834,9 @@ bool aten_op_is_not_moved_to_c10_yet(const c10::OperatorName& opName) {
         {"aten::convolution_backward_overrideable", ""},
         {"aten::_convolution", ""},
         {"aten::_convolution_nogroup", ""},
+        {"aten::_conv2d_direct", ""},
+        {"aten::_conv2d_winograd", ""},
+        {"aten::_conv2d_channels_last", ""},
         {"aten::_convolution_double_backward", ""},
         {"aten::conv1d", ""},
         {"aten::conv2d", ""},
@@ -1147,6 +1154,8 @@ bool aten_op_is_not_moved_to_c10_yet(const c10::OperatorName& opName) {
         {"aten::_sparse_coo_tensor_unsafe", ""},
         {"aten::_sparse_coo_tensor_with_dims", ""},
         {"aten::_sparse_coo_tensor_with_dims_and_tensors", ""},
+        {"aten::sparse_csr_tensor", ""},
+        {"aten::_sparse_csr_tensor_unsafe", ""},
         {"aten::hspmm", "out"},
     #ifdef BUILD_NAMEDTENSOR
         {"aten::unbind", "Dimname"},
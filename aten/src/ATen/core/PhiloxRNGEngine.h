@@ -37,9 +37,10 @@ typedef at::detail::Array<float, 2> FLOAT2;
  * Refer to: http://www.thesalmons.org/john/random123/papers/random123sc11.pdf
  * for details regarding the engine.
  *
- * Note that currently this implementation of the philox engine is not used
- * anywhere except for tests in cpu_generator_test.cpp. However, this engine
- * will replace curandStatePhilox4_32_10_t in the future.
+ * Note that currently this implementation of the philox engine is only used
+ * by the Philox mode of CPUGenerator (see Note [Philox mode of CPUGenerator])
+ * and in tests. However, this engine will replace
+ * curandStatePhilox4_32_10_t in the future.
  * 
  * The philox engine takes a seed value, a subsequeunce
  * for starting the generation and an offset for the subsequence.
@@ -1712,6 +1712,9 @@ inline Tensor Tensor::mv(const Tensor & vec) const {
         case Backend::CPU:
             return CPUType::mv(const_cast<Tensor&>(*this), vec);
             break;
+        case Backend::SparseCPU:
+            return SparseCPUType::mv(const_cast<Tensor&>(*this), vec);
+            break;
         default:
             AT_ERROR("mv not implemented for ", at::toString(type_set()));
     }
@@ -3101,6 +3104,32 @@ inline Tensor Tensor::values() const {
         op, impl::dispatchTypeId(at::detail::multi_dispatch_tensor_type_set(*this)), const_cast<Tensor&>(*this));
 #endif
 }
+inline Tensor Tensor::crow_indices() const {
+#ifdef USE_STATIC_DISPATCH
+    switch(tensorTypeIdToBackend(impl::dispatchTypeId(type_set()))) {
+    
+        default:
+            AT_ERROR("crow_indices not implemented for ", at::toString(type_set()));
+    }
+#else
+    static c10::OperatorHandle op = c10::Dispatcher::singleton().findSchema({"aten::crow_indices", ""}).value();
+    return c10::Dispatcher::singleton().callUnboxedOnly<Tensor, const Tensor &>(
+        op, impl::dispatchTypeId(at::detail::multi_dispatch_tensor_type_set(*this)), const_cast<Tensor&>(*this));
+#endif
+}
+inline Tensor Tensor::col_indices() const {
+#ifdef USE_STATIC_DISPATCH
+    switch(tensorTypeIdToBackend(impl::dispatchTypeId(type_set()))) {
+    
+        default:
+            AT_ERROR("col_indices not implemented for ", at::toString(type_set()));
+    }
+#else
+    static c10::OperatorHandle op = c10::Dispatcher::singleton().findSchema({"aten::col_indices", ""}).value();
+    return c10::Dispatcher::singleton().callUnboxedOnly<Tensor, const Tensor &>(
+        op, impl::dispatchTypeId(at::detail::multi_dispatch_tensor_type_set(*this)), const_cast<Tensor&>(*this));
+#endif
+}
 inline int64_t Tensor::numel() const {
 #ifdef USE_STATIC_DISPATCH
     return TypeDefault::numel(const_cast<Tensor&>(*this));
@@ -3159,6 +3188,24 @@ inline Tensor Tensor::to_sparse() const {
         op, impl::dispatchTypeId(at::detail::multi_dispatch_tensor_type_set(*this)), const_cast<Tensor&>(*this));
 #endif
 }
+inline Tensor Tensor::to_sparse_csr() const {
+#ifdef USE_STATIC_DISPATCH
+    switch(tensorTypeIdToBackend(impl::dispatchTypeId(type_set()))) {
+        case Backend::CPU:
+            return CPUType::to_sparse_csr(const_cast<Tensor&>(*this));
+            break;
+        case Backend::SparseCPU:
+            return SparseCPUType::to_sparse_csr(const_cast<Tensor&>(*this));
+            break;
+        default:
+            AT_ERROR("to_sparse_csr not implemented for ", at::toString(type_set()));
+    }
+#else
+    static c10::OperatorHandle op = c10::Dispatcher::singleton().findSchema({"aten::to_sparse_csr", ""}).value();
+    return c10::Dispatcher::singleton().callUnboxed<Tensor, const Tensor &>(
+        op, impl::dispatchTypeId(at::detail::multi_dispatch_tensor_type_set(*this)), const_cast<Tensor&>(*this));
+#endif
+}
 inline Tensor Tensor::to_mkldnn() const {
 #ifdef USE_STATIC_DISPATCH
     switch(tensorTypeIdToBackend(impl::dispatchTypeId(type_set()))) {
@@ -5565,6 +5612,15 @@ inline bool is_mkldnn(Tensor self) {
   return self.is_mkldnn();
 }
 
+inline bool Tensor::is_sparse_csr() const {
+  // NB: this is not a native function to avoid dispatching overhead.
+  return impl_->is_sparse_csr();
+}
+
+inline bool is_sparse_csr(Tensor self) {
+  return self.is_sparse_csr();
+}
+
 inline bool Tensor::is_quantized() const {
   // NB: this is not a native function to avoid dispatching overhead.
   return impl_->is_quantized();
@@ -84,6 +84,7 @@ namespace c10 {
   _(prim, ConstantChunk)             \
   _(prim, MMTreeReduce)              \
   _(prim, MMBatchSide)               \
+  _(prim, BatchLinear)               \
   _(prim, min)                       \
   _(prim, max)                       \
   _(prim, abs)                       \
@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/Pool.h>
+#include <ATen/native/Resize.h>
 #include <tuple>
 
 
@@ -136,6 +137,19 @@ void avg_pool2d_out_cpu_template(
     inputHeight, inputWidth,
     outputHeight, outputWidth);
 
+  if (input_.ndimension() == 4 &&
+      input_.suggest_memory_format() == at::MemoryFormat::ChannelsLast) {
+    /* compute channels last input as it is, and keep its format in the output */
+    Tensor input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+    resize_channels_last_(output, {nbatch, nInputPlane, outputHeight, outputWidth});
+    avg_pool2d_nhwc_stub(
+      kCPU, output, input,
+      kW, kH, dW, dH, padW, padH,
+      count_include_pad,
+      divisor_override);
+    return;
+  }
+
   if (input_.ndimension() == 3) {
     output.resize_({nInputPlane, outputHeight, outputWidth});
   }
@@ -296,6 +310,19 @@ Tensor& avg_pool2d_backward_out_cpu_template(
     inputHeight, inputWidth,
     outputHeight, outputWidth);
 
+  if (ndim == 4 && input.suggest_memory_format() == at::MemoryFormat::ChannelsLast) {
+    /* channels last input keeps its format in gradInput */
+    const Tensor gradOutput = gradOutput_.contiguous(at::MemoryFormat::ChannelsLast);
+    resize_channels_last_(gradInput, input.sizes());
+    gradInput.zero_();
+    avg_pool2d_backward_nhwc_stub(
+      kCPU, gradInput, gradOutput,
+      kW, kH, dW, dH, padW, padH,
+      count_include_pad,
+      divisor_override);
+    return gradInput;
+  }
+
   /* get contiguous gradOutput */
   const Tensor gradOutput = gradOutput_.contiguous();
 
@@ -330,6 +357,9 @@ Tensor& avg_pool2d_backward_out_cpu_template(
 
 } // namespace
 
+DEFINE_DISPATCH(avg_pool2d_nhwc_stub);
+DEFINE_DISPATCH(avg_pool2d_backward_nhwc_stub);
+
 Tensor& avg_pool2d_out_cpu(
   Tensor& output,
   const Tensor& input,
@@ -1,6 +1,7 @@
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/utils/ParamUtils.h>
+#include <ATen/core/grad_mode.h>
 
 #include <ATen/Config.h>
 #if AT_NNPACK_ENABLED()
@@ -36,6 +37,9 @@ struct ConvParams {
   bool use_mkldnn(const at::Tensor& input) const;
   bool use_nnpack(const at::Tensor& input) const;
   bool is_depthwise(const at::Tensor& input, const at::Tensor& weight) const;
+  bool use_cpu_direct(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  bool use_cpu_winograd(const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const;
+  bool use_channels_last_gemm(const at::Tensor& input, const at::Tensor& weight) const;
 };
 
 std::ostream& operator<<(std::ostream & out, const ConvParams& params) {
@@ -190,6 +194,72 @@ auto ConvParams::is_depthwise(
          weight.size(0) % input.size(1) == 0; // output channels must be a multiple of input channels
 }
 
+// The native CPU convolutions in DirectConvolution.cpp have no derivative, so
+// they are only used on dense 2D float/double inputs that need no gradient.
+static bool can_use_cpu_native_conv(
+        const ConvParams& params, const at::Tensor& input,
+        const at::Tensor& weight, const at::Tensor& bias) {
+  if (input.type().backend() != at::Backend::CPU ||
+      weight.type().backend() != at::Backend::CPU ||
+      input.ndimension() != 4 ||
+      params.transposed ||
+      params.is_dilated() ||
+      params.is_padding_neg()) {
+    return false;
+  }
+  if ((input.scalar_type() != kFloat && input.scalar_type() != kDouble) ||
+      weight.scalar_type() != input.scalar_type() ||
+      (bias.defined() && bias.scalar_type() != input.scalar_type())) {
+    return false;
+  }
+  return !at::GradMode::is_enabled() ||
+         !(input.requires_grad() || weight.requires_grad() ||
+           (bias.defined() && bias.requires_grad()));
+}
+
+// Direct convolution covers depthwise convolutions (any kernel size, stride
+// and padding), and 1x1 convolutions with stride 1 and no padding, which
+// otherwise pay for an im2col copy of the whole input.
+auto ConvParams::use_cpu_direct(
+        const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const -> bool {
+  if (!can_use_cpu_native_conv(*this, input, weight, bias)) {
+    return false;
+  }
+  if (groups > 1) {
+    return input.size(1) == groups && weight.size(0) % groups == 0;
+  }
+  return weight.size(2) == 1 && weight.size(3) == 1 &&
+         !is_strided() && !is_padded() &&
+         !use_nnpack(input);
+}
+
+// Winograd F(4x4, 3x3) covers 3x3 convolutions with stride 1. It needs
+// enough channels to amortize the tile transforms over the batched GEMM.
+auto ConvParams::use_cpu_winograd(
+        const at::Tensor& input, const at::Tensor& weight, const at::Tensor& bias) const -> bool {
+  if (!can_use_cpu_native_conv(*this, input, weight, bias)) {
+    return false;
+  }
+  return groups == 1 &&
+         weight.size(2) == 3 && weight.size(3) == 3 &&
+         !is_strided() &&
+         input.size(1) >= 16 && weight.size(0) >= 16 &&
+         input.size(2) + 2 * padding[0] >= 6 &&
+         input.size(3) + 2 * padding[1] >= 6 &&
+         !use_nnpack(input);
+}
+
+// Convolutions of channels last inputs run on the NHWC data, see
+// _conv2d_channels_last. Unlike the kernels above, this path is
+// differentiable.
+auto ConvParams::use_channels_last_gemm(
+        const at::Tensor& input, const at::Tensor& weight) const -> bool {
+  return input.type().backend() == at::Backend::CPU &&
+         input.ndimension() == 4 &&
+         weight.layout() == at::kStrided &&
+         !transposed;
+}
+
 // Check workload to activate fast depthwise FP16 cudnn conv kernels
 bool check_cudnn_depthwise_workload(const at::Tensor& input, int stride) {
   int w = input.size(3);  // same as h
@@ -511,8 +581,14 @@ at::Tensor _convolution(
     bool benchmark, bool deterministic, bool cudnn_enabled) {
 
   const bool input_is_mkldnn = input_r.is_mkldnn();
+  // Channels last CPU inputs keep their format in the output. Only the NHWC
+  // paths below read them as they are; the others take an NCHW copy.
+  const bool channels_last = !input_is_mkldnn &&
+      input_r.device().type() == c10::DeviceType::CPU &&
+      input_r.dim() == 4 &&
+      input_r.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
   auto input = input_r;
-  if (!input_is_mkldnn) {
+  if (!input_is_mkldnn && !channels_last) {
     input = input.contiguous();
   }
   auto weight = weight_r;
@@ -547,6 +623,15 @@ at::Tensor _convolution(
   }
 
   Tensor output;
+  if (channels_last && k == 4 && params.groups > 1 && params.use_cpu_direct(input, weight, bias)) {
+    return at::_conv2d_direct(input, weight, bias, params.stride, params.padding, params.groups);
+  } else if (channels_last && k == 4 && params.use_channels_last_gemm(input, weight)) {
+    return at::_conv2d_channels_last(
+        input, weight, bias, params.stride, params.padding, params.dilation, params.groups);
+  } else if (channels_last) {
+    input = input.contiguous();
+  }
+
   if (params.is_depthwise(input, weight)) {
       /* output.resize_(output_size(input, weight)); */
 
@@ -617,6 +702,10 @@ at::Tensor _convolution(
                                       params.padding, params.stride, params.dilation, params.groups);
     }
 #endif
+  } else if (params.use_cpu_direct(input, weight, bias)) {
+    output = at::_conv2d_direct(input, weight, bias, params.stride, params.padding, params.groups);
+  } else if (params.use_cpu_winograd(input, weight, bias)) {
+    output = at::_conv2d_winograd(input, weight, bias, params.padding);
   } else if (input.device().type() == c10::DeviceType::CPU || input.device().type() == c10::DeviceType::CUDA) {
     // TH/native only covers CPU/CUDA implementation.
     if (params.groups == 1) {
@@ -640,11 +729,94 @@ at::Tensor _convolution(
 
   if (k == 3) {
     output = view3d(output);
+  } else if (channels_last) {
+    output = output.contiguous(at::MemoryFormat::ChannelsLast);
   }
 
   return output;
 }
 
+// Convolution of a channels last input computed on its NHWC data, without
+// converting it to NCHW. Unfolding H and W of the [N, H, W, C] view gives the
+// receptive fields as [N, OH, OW, C, KH, KW], in the order of the [O, C, KH,
+// KW] weight, so the convolution is one GEMM (one per group) of the
+// [N * OH * OW, C * KH * KW] columns with the weight. Its [N * OH * OW, O]
+// result is the NHWC data of the output. The op is made of differentiable
+// ops, so autograd goes through it too.
+Tensor _conv2d_channels_last(
+    const Tensor& self, const Tensor& weight, const Tensor& bias,
+    IntArrayRef stride, IntArrayRef padding, IntArrayRef dilation, int64_t groups) {
+  TORCH_CHECK(self.dim() == 4 && weight.dim() == 4,
+      "_conv2d_channels_last: expected 4-D input and weight");
+  TORCH_CHECK(groups > 0 && self.size(1) == weight.size(1) * groups &&
+      weight.size(0) % groups == 0,
+      "_conv2d_channels_last: channels of the input and weight do not match groups");
+  const int64_t batch = self.size(0);
+  const int64_t out_channels = weight.size(0);
+  const int64_t kernel_h = weight.size(2);
+  const int64_t kernel_w = weight.size(3);
+  const int64_t extent_h = dilation[0] * (kernel_h - 1) + 1;
+  const int64_t extent_w = dilation[1] * (kernel_w - 1) + 1;
+
+  // A no-op for the dense channels last inputs this is called with.
+  auto input = self.is_contiguous(at::MemoryFormat::ChannelsLast)
+      ? self : self.contiguous(at::MemoryFormat::ChannelsLast);
+  auto input_nhwc = input.permute({0, 2, 3, 1});
+  if (padding[0] != 0 || padding[1] != 0) {
+    input_nhwc = at::constant_pad_nd(
+        input_nhwc, {0, 0, padding[1], padding[1], padding[0], padding[0]});
+  }
+  const int64_t out_h = (input_nhwc.size(1) - extent_h) / stride[0] + 1;
+  const int64_t out_w = (input_nhwc.size(2) - extent_w) / stride[1] + 1;
+  const int64_t rows_per_image = out_h * out_w;
+  const int64_t group_depth = weight.size(1) * kernel_h * kernel_w;
+
+  // [G, C/G * KH * KW, O/G]
+  auto weight_t = weight.reshape({groups, out_channels / groups, group_depth}).transpose(1, 2);
+
+  // Computes the NHWC output of `images` images of the padded input. The
+  // columns are the only copy of the input, like the columns of the NCHW
+  // im2col kernels.
+  auto convolve = [&](const Tensor& images) {
+    const int64_t rows = images.size(0) * rows_per_image;
+    auto columns = images.unfold(1, extent_h, stride[0]).unfold(2, extent_w, stride[1]);
+    if (dilation[0] != 1 || dilation[1] != 1) {
+      columns = columns.slice(4, 0, extent_h, dilation[0]).slice(5, 0, extent_w, dilation[1]);
+    }
+    Tensor output;
+    if (groups == 1) {
+      auto columns_2d = columns.reshape({rows, group_depth});
+      output = bias.defined()
+          ? at::addmm(bias, columns_2d, weight_t[0])
+          : at::mm(columns_2d, weight_t[0]);
+    } else {
+      auto columns_3d = columns.reshape({rows, groups, group_depth}).transpose(0, 1);
+      output = at::bmm(columns_3d, weight_t).transpose(0, 1).reshape({rows, out_channels});
+      if (bias.defined()) {
+        output = output + bias;
+      }
+    }
+    return output.view({images.size(0), out_h, out_w, out_channels});
+  };
+
+  // Bounds the size of the columns by convolving a few images at a time.
+  constexpr int64_t kMaxColumnsSize = 1 << 24;
+  const int64_t images_per_step = std::max<int64_t>(
+      1, kMaxColumnsSize / std::max<int64_t>(1, rows_per_image * group_depth * groups));
+  Tensor output_nhwc;
+  if (images_per_step >= batch) {
+    output_nhwc = convolve(input_nhwc);
+  } else {
+    std::vector<Tensor> outputs;
+    for (int64_t image = 0; image < batch; image += images_per_step) {
+      outputs.push_back(convolve(
+          input_nhwc.narrow(0, image, std::min(images_per_step, batch - image))));
+    }
+    output_nhwc = at::cat(outputs, 0);
+  }
+  return output_nhwc.permute({0, 3, 1, 2});
+}
+
 // A generic function for convolution implementations which don't
 // natively implement groups (e.g., not CuDNN).
 at::Tensor _convolution_nogroup(
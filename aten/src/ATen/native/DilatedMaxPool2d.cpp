@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/native/Pool.h>
+#include <ATen/native/Resize.h>
 #include <tuple>
 
 
@@ -170,6 +171,20 @@ void max_pool2d_with_indices_out_cpu_template(
     inputHeight, inputWidth,
     outputHeight, outputWidth);
 
+  if (input_.ndimension() == 4 &&
+      input_.suggest_memory_format() == at::MemoryFormat::ChannelsLast) {
+    /* compute channels last input as it is, and keep its format in the output */
+    Tensor input = input_.contiguous(at::MemoryFormat::ChannelsLast);
+    resize_channels_last_(output, {nbatch, nInputPlane, outputHeight, outputWidth});
+    resize_channels_last_(indices, {nbatch, nInputPlane, outputHeight, outputWidth});
+    max_pool2d_nhwc_stub(
+      kCPU, output, indices, input,
+      kW, kH, dW, dH,
+      padW, padH,
+      dilationW, dilationH);
+    return;
+  }
+
   /* get contiguous input */
   Tensor input = input_.contiguous();
 
@@ -332,11 +347,21 @@ Tensor& max_pool2d_with_indices_backward_out_cpu_template(
   TORCH_CHECK((input.ndimension() == 3 || input.ndimension() == 4),
     "non-empty 3D or 4D (batch mode) tensor expected for input");
 
+  /* channels last input keeps its format in gradInput */
+  const bool channels_last = input.ndimension() == 4 &&
+    input.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
+
   /* get contiguous gradOutput */
-  const Tensor gradOutput = gradOutput_.contiguous();
+  const Tensor gradOutput = channels_last
+    ? gradOutput_.contiguous(at::MemoryFormat::ChannelsLast)
+    : gradOutput_.contiguous();
 
   /* resize */
-  gradInput.resize_as_(input);
+  if (channels_last) {
+    resize_channels_last_(gradInput, input.sizes());
+  } else {
+    gradInput.resize_as_(input);
+  }
   gradInput.zero_();
 
   /* sizes */
@@ -362,6 +387,14 @@ Tensor& max_pool2d_with_indices_backward_out_cpu_template(
     outputHeight_for_shape_check, outputWidth_for_shape_check);
 
   /* backprop */
+  if (channels_last)
+  {
+    max_pool2d_backward_nhwc_stub(
+      kCPU, gradInput, gradOutput,
+      indices.contiguous(at::MemoryFormat::ChannelsLast));
+    return gradInput;
+  }
+
   if (input.ndimension() == 3)
   {
     AT_DISPATCH_FLOATING_TYPES(input.scalar_type(),
@@ -409,6 +442,9 @@ Tensor& max_pool2d_with_indices_backward_out_cpu_template(
 
 } // namespace
 
+DEFINE_DISPATCH(max_pool2d_nhwc_stub);
+DEFINE_DISPATCH(max_pool2d_backward_nhwc_stub);
+
 std::tuple<Tensor&, Tensor&> max_pool2d_with_indices_out_cpu(
   Tensor& output,
   Tensor& indices,
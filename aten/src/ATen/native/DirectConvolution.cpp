@@ -0,0 +1,150 @@
+#include <ATen/ATen.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/native/cpu/ConvolutionKernel.h>
+
+// Native CPU convolutions for small-batch inference. They compute the output
+// directly from the input, without the im2col buffers of thnn_conv2d:
+//
+//  - _conv2d_direct handles 1x1 convolutions with unit stride and no padding,
+//    and depthwise convolutions, with register-blocked Vec256 kernels.
+//    Channels last depthwise convolutions are computed in NHWC and return a
+//    channels last output.
+//  - _conv2d_winograd handles 3x3 convolutions with unit stride using
+//    Winograd F(4x4, 3x3): the input and output tile transforms are done by
+//    the kernels in cpu/ConvolutionKernel.cpp and the 36 elementwise products
+//    become one batched GEMM over channels.
+//
+// Neither has a derivative. _convolution only picks them when no gradient is
+// needed.
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(conv2d_pointwise_stub);
+DEFINE_DISPATCH(conv2d_depthwise_stub);
+DEFINE_DISPATCH(conv2d_depthwise_nhwc_stub);
+DEFINE_DISPATCH(winograd_input_transform_stub);
+DEFINE_DISPATCH(winograd_output_transform_stub);
+
+// The 6x3 matrix G of the Winograd F(4x4, 3x3) weight transform.
+static const double kWinogradG[] = {
+    1.0 / 4,  0.0,       0.0,
+    -1.0 / 6, -1.0 / 6,  -1.0 / 6,
+    -1.0 / 6, 1.0 / 6,   -1.0 / 6,
+    1.0 / 24, 1.0 / 12,  1.0 / 6,
+    1.0 / 24, -1.0 / 12, 1.0 / 6,
+    0.0,      0.0,       1.0};
+
+static void check_conv2d_direct_args(
+    const char* c,
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& bias) {
+  TORCH_CHECK(self.dim() == 4, c, ": expected 4D input, but got ", self.dim(), "D");
+  TORCH_CHECK(weight.dim() == 4, c, ": expected 4D weight, but got ", weight.dim(), "D");
+  TORCH_CHECK(self.scalar_type() == weight.scalar_type(),
+              c, ": input type (", self.scalar_type(), ") and weight type (",
+              weight.scalar_type(), ") should be the same");
+  TORCH_CHECK(!bias.defined() || self.scalar_type() == bias.scalar_type(),
+              c, ": input type (", self.scalar_type(), ") and bias type (",
+              bias.scalar_type(), ") should be the same");
+}
+
+Tensor conv2d_direct_cpu(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding,
+    int64_t groups) {
+  check_conv2d_direct_args("_conv2d_direct", self, weight, bias);
+  // Channels last depthwise convolutions are computed in NHWC.
+  const bool channels_last = groups > 1 &&
+      self.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
+  const auto input = channels_last
+      ? self.contiguous(at::MemoryFormat::ChannelsLast)
+      : self.contiguous();
+  const auto weight_c = weight.contiguous();
+  const auto bias_c = bias.defined() ? bias.contiguous() : bias;
+
+  const int64_t channels_in = input.size(1);
+  const int64_t channels_out = weight.size(0);
+  const int64_t kernel_h = weight.size(2);
+  const int64_t kernel_w = weight.size(3);
+  const int64_t out_h = (input.size(2) + 2 * padding[0] - kernel_h) / stride[0] + 1;
+  const int64_t out_w = (input.size(3) + 2 * padding[1] - kernel_w) / stride[1] + 1;
+  TORCH_CHECK(out_h > 0 && out_w > 0,
+              "_conv2d_direct: input is smaller than the kernel");
+  auto output = at::empty(
+      {input.size(0), channels_out, out_h, out_w},
+      input.options(),
+      channels_last ? at::MemoryFormat::ChannelsLast : at::MemoryFormat::Contiguous);
+  if (output.numel() == 0) {
+    return output;
+  }
+
+  if (groups == 1) {
+    TORCH_CHECK(kernel_h == 1 && kernel_w == 1 &&
+                stride[0] == 1 && stride[1] == 1 &&
+                padding[0] == 0 && padding[1] == 0,
+                "_conv2d_direct: with groups=1, only 1x1 convolutions with stride 1 and no padding are supported");
+    TORCH_CHECK(weight.size(1) == channels_in,
+                "_conv2d_direct: expected weight with ", channels_in, " input channels, but got ",
+                weight.size(1));
+    conv2d_pointwise_stub(kCPU, output, input, weight_c, bias_c);
+  } else {
+    TORCH_CHECK(groups == channels_in && weight.size(1) == 1 && channels_out % channels_in == 0,
+                "_conv2d_direct: grouped convolutions must be depthwise");
+    if (channels_last) {
+      conv2d_depthwise_nhwc_stub(
+          kCPU, output, input, weight.permute({2, 3, 0, 1}).contiguous(), bias_c, stride, padding);
+    } else {
+      conv2d_depthwise_stub(kCPU, output, input, weight_c, bias_c, stride, padding);
+    }
+  }
+  return output;
+}
+
+Tensor conv2d_winograd_cpu(
+    const Tensor& self,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef padding) {
+  check_conv2d_direct_args("_conv2d_winograd", self, weight, bias);
+  TORCH_CHECK(weight.size(2) == 3 && weight.size(3) == 3,
+              "_conv2d_winograd: only 3x3 kernels are supported");
+  TORCH_CHECK(weight.size(1) == self.size(1),
+              "_conv2d_winograd: expected weight with ", self.size(1), " input channels, but got ",
+              weight.size(1));
+  const auto input = self.contiguous();
+  const auto bias_c = bias.defined() ? bias.contiguous() : bias;
+
+  const int64_t batch = input.size(0);
+  const int64_t channels_in = input.size(1);
+  const int64_t channels_out = weight.size(0);
+  const int64_t out_h = input.size(2) + 2 * padding[0] - 2;
+  const int64_t out_w = input.size(3) + 2 * padding[1] - 2;
+  TORCH_CHECK(out_h > 0 && out_w > 0,
+              "_conv2d_winograd: input is smaller than the kernel");
+  auto output = at::empty({batch, channels_out, out_h, out_w}, input.options());
+  if (output.numel() == 0) {
+    return output;
+  }
+  const int64_t tiles = batch * ((out_h + 3) / 4) * ((out_w + 3) / 4);
+
+  // U = G g G^T, laid out as [36, channels_out, channels_in].
+  auto G = at::tensor(ArrayRef<double>(kWinogradG), input.options()).view({6, 3});
+  auto U = at::matmul(at::matmul(G, weight), G.t())
+      .permute({2, 3, 0, 1})
+      .reshape({36, channels_out, channels_in});
+
+  // V = B^T d B for every input tile, laid out as [36, channels_in, tiles].
+  auto V = at::empty({36, channels_in, tiles}, input.options());
+  winograd_input_transform_stub(kCPU, V, input, padding);
+
+  // M = U * V elementwise in the tile domain, summed over input channels.
+  auto M = at::bmm(U, V);
+  winograd_output_transform_stub(kCPU, output, M, bias_c);
+  return output;
+}
+
+}} // namespace at::native
@@ -50,7 +50,7 @@ enum class CPUCapability {
   NUM_OPTIONS
 };
 
-CPUCapability get_cpu_capability();
+CAFFE2_API CPUCapability get_cpu_capability();
 
 template <typename FnPtr, typename T>
 struct CAFFE2_API DispatchStub;
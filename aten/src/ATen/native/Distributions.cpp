@@ -11,6 +11,7 @@
 #include <ATen/CPUGenerator.h>
 #include <ATen/core/DistributionsHelper.h>
 #include <ATen/native/Distributions.h>
+#include <ATen/native/PhiloxFill.h>
 #include <ATen/native/DispatchStub.h>
 #include <ATen/native/UnaryOps.h>
 #include <ATen/NamedTensorUtils.h>
@@ -163,6 +164,18 @@ DEFINE_DISPATCH(bernoulli_mkl_stub);
 
 Tensor& bernoulli_scalar_cpu_(Tensor& self, double p, Generator* gen) {
   TORCH_CHECK(0 <= p && p <= 1, "bernoulli_ expects p to be in [0, 1], but got p=", p);
+  CPUGenerator* philox_generator = get_generator_or_default<CPUGenerator>(gen, detail::getDefaultCPUGenerator());
+  if (philox_generator->philox_mode()) {
+    // See Note [Philox mode of CPUGenerator]
+    Tensor contig = self.contiguous();
+    AT_DISPATCH_ALL_TYPES_AND(at::ScalarType::Bool, self.scalar_type(), "bernoulli_scalar_cpu_", [&] {
+      philox_bernoulli_fill(contig.data_ptr<scalar_t>(), contig.numel(), philox_generator, p);
+    });
+    if (!contig.is_same(self)) {
+      self.copy_(contig);
+    }
+    return self;
+  }
 #if AT_MKL_ENABLED()
   if (cpuinfo_initialize() && cpuinfo_vendor_intel == cpuinfo_get_processor(0)->core->vendor) {
     bernoulli_mkl_stub(kCPU, self, p, gen);
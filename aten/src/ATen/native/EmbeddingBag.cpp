@@ -13,6 +13,7 @@
 #include <sstream>
 #include <vector>
 #include <algorithm>
+#include <numeric>
 
 
 namespace {
@@ -33,166 +34,167 @@ static void make_offset2bag(const Tensor &offsets, const Tensor &indices, Tensor
 
 namespace {
 
-bool isFastPathIndexSelect(const Tensor& src, Tensor& output) {
-  return src.scalar_type() == kFloat && src.stride(1) == 1 && output.stride(1) == 1;
+// Bags are independent of each other, so the forward kernels below split
+// them among threads, sizing chunks to about GRAIN_SIZE rows of ddim
+// elements read from the table.
+int64_t bag_grain_size(int64_t num_bags, int64_t num_indices, int64_t ddim) {
+  const int64_t rows_per_bag = std::max<int64_t>(1, num_indices / std::max<int64_t>(1, num_bags));
+  return std::max<int64_t>(1, internal::GRAIN_SIZE / (rows_per_bag * std::max<int64_t>(1, ddim)));
 }
 
-bool isFastPathIndexSelectScale(const Tensor& src, const Tensor& scale, Tensor& output) {
-  return src.scalar_type() == kFloat && src.stride(1) == 1 && output.stride(1) == 1 && scale.stride(0) == 1;
+inline int64_t bag_end(const int64_t* offsets_data, int64_t bag, int64_t num_bags, int64_t num_indices) {
+  return bag + 1 < num_bags ? offsets_data[bag + 1] : num_indices;
 }
 
-// This function combines index_select (using select_indices as the index) and
-// index_add (using add_indices as the index), without creating an intermediary
-// tensor to hold the selected embeddings
-template<typename T>
-void index_select_add(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& /*offsets*/) {
-  AT_ASSERT(select_indices.numel() == add_indices.numel());
-  auto add_indices_data = add_indices.data_ptr<int64_t>();
-  auto select_indices_data = select_indices.data_ptr<int64_t>();
-  auto src_data = src.data_ptr<T>();
-  auto output_data = output.data_ptr<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-
-  for (int64_t i = 0; i < numel; i++) {
-    THBlas_axpy<T>(ddim, 1,
-            src_data + src_stride0 * select_indices_data[i], src_stride1,
-            output_data + output_stride0 * add_indices_data[i], output_stride1);
-  }
+// The caffe2 perfkernels (AVX2 where available) take rows of `ddim`
+// contiguous elements and accumulate in float.
+bool is_fast_path(const Tensor& weight, const Tensor& per_sample_weights) {
+  return (weight.scalar_type() == kFloat || weight.scalar_type() == kHalf) &&
+      weight.stride(1) == 1 && weight.stride(0) == weight.size(1) &&
+      (!per_sample_weights.defined() || per_sample_weights.stride(0) == 1);
 }
 
-template<>
-void index_select_add<float>(const Tensor &select_indices,
-                             const Tensor &add_indices,
-                             const Tensor &src,
-                             Tensor &output,
-                             const Tensor& offsets) {
-  int64_t ddim = src.size(1);
-  auto src_data = src.data_ptr<float>();
-  auto select_indices_data = select_indices.data_ptr<int64_t>();
-  auto output_data = output.data_ptr<float>();
-
-  if (isFastPathIndexSelect(src, output)) {
+// Sum or mean of every bag with caffe2::EmbeddingLookupIdx, one call per
+// chunk of bags. The kernel expects the offsets of its bags to start at 0,
+// so every chunk passes its own indices and rebased offsets.
+template <typename data_t>
+void embedding_bag_cpu_sum_mean_fast(
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    int64_t mode,
+    Tensor& output) {
+  const int64_t num_bags = offsets.numel();
+  const int64_t num_indices = indices.numel();
+  const int64_t ddim = weight.size(1);
+  const data_t* weight_data = weight.data_ptr<data_t>();
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  const float* per_sample_weights_data =
+      per_sample_weights.defined() ? per_sample_weights.data_ptr<float>() : nullptr;
+  float* output_data = output.data_ptr<float>();
+
+  const int64_t grain_size = bag_grain_size(num_bags, num_indices, ddim);
+  at::parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    const int64_t first = offsets_data[begin];
+    const int64_t last = bag_end(offsets_data, end - 1, num_bags, num_indices);
+    std::vector<int64_t> chunk_offsets(end - begin);
+    for (int64_t bag = begin; bag < end; bag++) {
+      chunk_offsets[bag - begin] = offsets_data[bag] - first;
+    }
     caffe2::EmbeddingLookupIdx(
       /*block_size=*/ddim,
-      /*output_size=*/offsets.numel(),
-      /*index_size=*/select_indices.numel(),
-      /*data_size=*/src.size(0),
-      /*input=*/src_data,
-      /*indices=*/select_indices_data,
-      /*offsets=*/offsets.data_ptr<int64_t>(),
-      /*weights=*/nullptr,
+      /*output_size=*/end - begin,
+      /*index_size=*/last - first,
+      /*data_size=*/weight.size(0),
+      /*input=*/weight_data,
+      /*indices=*/indices_data + first,
+      /*offsets=*/chunk_offsets.data(),
+      /*weights=*/per_sample_weights_data ? per_sample_weights_data + first : nullptr,
       /*scale_bias=*/nullptr,
-      /*normalize_by_lengths=*/false,
-      /*out=*/output_data
+      /*normalize_by_lengths=*/mode == MODE_MEAN,
+      /*out=*/output_data + begin * ddim
     );
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto add_indices_data = add_indices.data_ptr<int64_t>();
-    auto src_stride0 = src.stride(0);
-    auto src_stride1 = src.stride(1);
-    auto output_stride0 = output.stride(0);
-    auto output_stride1 = output.stride(1);
-    auto numel = add_indices.numel();
-    for (int64_t i = 0; i < numel; i++) {
-      THBlas_axpy<float>(ddim, 1,
-              src_data + src_stride0 * select_indices_data[i], src_stride1,
-              output_data + output_stride0 * add_indices_data[i], output_stride1);
-    }
-  }
+  });
 }
 
-// This function fuses the following three fns:
-// index_select (using select_indices as the index)
-// mul (scaling by per_sample_weights)
-// index_add (using add_indices as the index)
-template<typename T>
-static void index_select_scale_add(const Tensor &select_indices,
-                                   const Tensor &add_indices,
-                                   const Tensor &scale,
-                                   const Tensor &src,
-                                   Tensor &output,
-                                   const Tensor& /*offsets*/) {
-  AT_ASSERT(select_indices.numel() == add_indices.numel());
-  auto add_indices_data = add_indices.data_ptr<int64_t>();
-  auto select_indices_data = select_indices.data_ptr<int64_t>();
-  auto src_data = src.data_ptr<T>();
-  auto output_data = output.data_ptr<T>();
-  auto numel = add_indices.numel();
-  int64_t ddim = src.size(1);
-  auto src_stride0 = src.stride(0);
-  auto src_stride1 = src.stride(1);
-  auto output_stride0 = output.stride(0);
-  auto output_stride1 = output.stride(1);
-
-  auto* scale_data = scale.data_ptr<T>();
-  auto scale_stride = scale.stride(0);
-
-  for (int64_t i = 0; i < numel; i++) {
-    auto* src_base = src_data + src_stride0 * select_indices_data[i];
-    auto* output_base = output_data + output_stride0 * add_indices_data[i];
-    auto scale = scale_data[i * scale_stride];
-    for (int64_t j = 0; j < ddim; j++) {
-      output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
+// Sum or mean of every bag for strided tables and types the perfkernels
+// do not cover; every bag accumulates its rows with axpy.
+template <typename scalar_t>
+void embedding_bag_cpu_sum_mean(
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    int64_t mode,
+    Tensor& output) {
+  const int64_t num_bags = offsets.numel();
+  const int64_t num_indices = indices.numel();
+  const int64_t num_weights = weight.size(0);
+  const int64_t ddim = weight.size(1);
+  scalar_t* weight_data = weight.data_ptr<scalar_t>();
+  const int64_t weight_stride0 = weight.stride(0);
+  const int64_t weight_stride1 = weight.stride(1);
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  const scalar_t* per_sample_weights_data =
+      per_sample_weights.defined() ? per_sample_weights.data_ptr<scalar_t>() : nullptr;
+  const int64_t per_sample_weights_stride =
+      per_sample_weights.defined() ? per_sample_weights.stride(0) : 0;
+  // output is freshly allocated and contiguous
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  const int64_t grain_size = bag_grain_size(num_bags, num_indices, ddim);
+  at::parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      const int64_t start = offsets_data[bag];
+      const int64_t stop = bag_end(offsets_data, bag, num_bags, num_indices);
+      scalar_t* out = output_data + bag * ddim;
+      for (int64_t i = start; i < stop; i++) {
+        const int64_t index = indices_data[i];
+        TORCH_CHECK(index >= 0 && index < num_weights,
+            "embedding_bag: index ", index, " is out of bounds for ", num_weights, " embeddings");
+        const scalar_t scale = per_sample_weights_data
+            ? per_sample_weights_data[i * per_sample_weights_stride] : scalar_t(1);
+        THBlas_axpy<scalar_t>(ddim, scale,
+            weight_data + weight_stride0 * index, weight_stride1, out, 1);
+      }
+      // Empty bags stay all 0s.
+      if (mode == MODE_MEAN && stop > start) {
+        const scalar_t scale = scalar_t(1) / (stop - start);
+        for (int64_t d = 0; d < ddim; d++) {
+          out[d] *= scale;
+        }
+      }
     }
-  }
+  });
 }
 
-template<>
-void index_select_scale_add<float>(const Tensor &select_indices,
-                                          const Tensor &add_indices,
-                                          const Tensor &scale,
-                                          const Tensor &src,
-                                          Tensor &output,
-                                          const Tensor& offsets) {
-  int64_t ddim = src.size(1);
-  auto* scale_data = scale.data_ptr<float>();
-  auto select_indices_data = select_indices.data_ptr<int64_t>();
-  auto src_data = src.data_ptr<float>();
-  auto output_data = output.data_ptr<float>();
-
-  if (isFastPathIndexSelectScale(src, scale, output)) {
-    caffe2::EmbeddingLookupIdx(
-      /*block_size=*/ddim,
-      /*output_size=*/offsets.numel(),
-      /*index_size=*/select_indices.numel(),
-      /*data_size=*/src.size(0),
-      /*input=*/src_data,
-      /*indices=*/select_indices_data,
-      /*offsets=*/offsets.data_ptr<int64_t>(),
-      /*weights=*/scale_data,
-      /*scale_bias=*/nullptr,
-      /*normalize_by_lengths=*/false,
-      /*out=*/output_data
-    );
-  } else {
-    AT_ASSERT(select_indices.numel() == add_indices.numel());
-    auto add_indices_data = add_indices.data_ptr<int64_t>();
-    auto src_stride0 = src.stride(0);
-    auto src_stride1 = src.stride(1);
-    auto output_stride0 = output.stride(0);
-    auto output_stride1 = output.stride(1);
-    auto scale_stride = scale.stride(0);
-    auto numel = add_indices.numel();
-
-
-    for (int64_t i = 0; i < numel; i++) {
-      auto* src_base = src_data + src_stride0 * select_indices_data[i];
-      auto* output_base = output_data + output_stride0 * add_indices_data[i];
-      auto scale = scale_data[i * scale_stride];
-      for (int64_t j = 0; j < ddim; j++) {
-        output_base[j * output_stride1] += src_base[j * src_stride1] * scale;
+// Every element of a bag's output is the maximum over the bag's rows, and
+// max_indices records the row it came from; empty bags keep 0s in both.
+template <typename scalar_t>
+void embedding_bag_cpu_max(
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    Tensor& output,
+    Tensor& max_indices) {
+  const int64_t num_bags = offsets.numel();
+  const int64_t num_indices = indices.numel();
+  const int64_t num_weights = weight.size(0);
+  const int64_t ddim = weight.size(1);
+  const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+  const int64_t weight_stride0 = weight.stride(0);
+  const int64_t weight_stride1 = weight.stride(1);
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  // output and max_indices are freshly allocated and contiguous
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* max_indices_data = max_indices.data_ptr<int64_t>();
+
+  const int64_t grain_size = bag_grain_size(num_bags, num_indices, ddim);
+  at::parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t bag = begin; bag < end; bag++) {
+      const int64_t start = offsets_data[bag];
+      const int64_t stop = bag_end(offsets_data, bag, num_bags, num_indices);
+      scalar_t* out = output_data + bag * ddim;
+      int64_t* out_indices = max_indices_data + bag * ddim;
+      for (int64_t i = start; i < stop; i++) {
+        const int64_t index = indices_data[i];
+        TORCH_CHECK(index >= 0 && index < num_weights,
+            "embedding_bag: index ", index, " is out of bounds for ", num_weights, " embeddings");
+        const scalar_t* row = weight_data + weight_stride0 * index;
+        for (int64_t d = 0; d < ddim; d++) {
+          const scalar_t item = row[d * weight_stride1];
+          if (i == start || item > out[d]) {
+            out[d] = item;
+            out_indices[d] = index;
+          }
+        }
       }
     }
-  }
+  });
 }
 
 }  // namespace
@@ -210,26 +212,6 @@ static void make_bag_size(const Tensor &offsets, const Tensor &indices,
   }
 }
 
-static Tensor apply_bag_size(const Tensor &offsets, const Tensor &indices,
-                             const int64_t mode, Tensor &output,
-                             const Tensor &bag_size) {
-  if (mode == MODE_MEAN) {
-    // Avoid dividing by 0 for empty bags.
-    // Instead we want empty bags to return all 0s
-    if (offsets.size(0) == 1) {
-      auto bag_size_ = std::max(indices.size(0), static_cast<int64_t>(1));
-      output /= bag_size_;
-    } else {
-      auto bag_size_ = at::max(bag_size, at::ones_like(bag_size))
-                           .to(output.options())
-                           .unsqueeze(1)
-                           .expand_as(output);
-      output /= bag_size_;
-    }
-  }
-  return output;
-}
-
 static Tensor apply_bag_size_backward(const Tensor &offsets,
                                       const Tensor &indices, const int64_t mode,
                                       Tensor &output, const Tensor &offset2bag,
@@ -248,51 +230,6 @@ static Tensor apply_bag_size_backward(const Tensor &offsets,
   return output;
 }
 
-
-template <typename scalar_t>
-std::tuple<Tensor, Tensor, Tensor, Tensor> embedding_bag_cpu_max(
-    const Tensor& weight,
-    const Tensor& indices,
-    const Tensor& offset2bag,
-    const Tensor& output,
-    const Tensor& bag_size,
-    const Tensor& offsets) {
-
-    auto max_indices = at::zeros({offsets.size(0), weight.size(1)}, indices.options());
-
-    int64_t numel = indices.numel();
-    int64_t dims = weight.size(1);
-    auto indices_data = indices.data_ptr<int64_t>();
-    auto offset2bag_data = offset2bag.data_ptr<int64_t>();
-
-    auto max_indices_data = max_indices.data_ptr<int64_t>();
-    auto max_indices_stride = max_indices.stride(0);
-
-    auto weight_data = weight.data_ptr<scalar_t>();
-    auto output_data = output.data_ptr<scalar_t>();
-    auto weight_stride0 = weight.stride(0);
-    auto weight_stride1 = weight.stride(1);
-    auto output_stride = output.stride(0);
-
-    for (int i = 0; i < numel; i++) {
-      auto bag = offset2bag_data[i];
-      auto word_idx = indices_data[i];
-
-      for (int dim = 0; dim < dims; dim++) {
-        auto& current_item = output_data[output_stride * bag + dim];
-        auto weight_item = weight_data[weight_stride0 * word_idx + dim * weight_stride1];
-        bool is_first_for_bag = (i == 0) || offset2bag_data[i - 1] != bag;
-
-        if (is_first_for_bag || weight_item > current_item) {
-          current_item = weight_item;
-          max_indices_data[max_indices_stride * bag + dim] = word_idx;
-        }
-      }
-    }
-
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
-}
-
 // embedding_bag wrapper to enforce contiguity in tensors other than `weight`.
 // This is created to save extra `.contiguous()` call in backward.
 // See NOTE [ embedding_bag Native Functions ] in native_functions.yaml for details
@@ -317,7 +254,7 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
   auto offsets_arg = TensorArg(offsets, "offsets", 1);
   checkScalarType("embedding_bag", offsets_arg, kLong);
   auto weight_arg = TensorArg(weight, "weight", 1);
-  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble});
+  checkScalarTypes("embedding_bag", weight_arg, {kFloat, kDouble, kHalf});
 
   if (per_sample_weights.defined()) {
     TORCH_CHECK(mode == MODE_SUM,
@@ -334,56 +271,43 @@ _embedding_bag_cpu(const Tensor &weight, const Tensor &indices,
 
   auto output = at::zeros({offsets.size(0), weight.size(1)}, weight.options());
 
-  // To save compute, if we are going to go down the fast path case for the 'sum'
-  // mode, we skip calculating offset2bag, since it is not going to be used.
-  auto fast_path_sum = [&weight, &per_sample_weights, &output]() {
-    if (per_sample_weights.defined()) {
-      return isFastPathIndexSelectScale(weight, per_sample_weights, output);
-    } else {
-      return isFastPathIndexSelect(weight, output);
-    }
-  };
-
-  // Use an empty 0-element tensor as a sentinel that we have skipped the
-  // creation of offset2bag because autograd chokes when trying to use an
-  // undefined tensor as an input to a backward op.
+  // The forward kernels walk bags through offsets and never need offset2bag,
+  // so we return an empty 0-element tensor as a sentinel that its creation
+  // was skipped (autograd chokes when trying to use an undefined tensor as an
+  // input to a backward op). The backward builds it when it needs it.
   Tensor offset2bag = at::empty({0}, offsets.options());
-  if (mode == MODE_MEAN || mode == MODE_MAX || !fast_path_sum()) {
-    // If the last entries are empty, that the last offsets are irrelevant as they
-    // won't change anything in the assignment of ID -> bag, but index_add would
-    // throw out of bounds error. So to keep it simple we just add one more
-    // entry to the end then get rid of it after make_offset2bag.
-    offset2bag = at::zeros(
-       {indices.sizes()[0] + 1}, indices.options()); // offset2bag = [0 0 0 0 0]
-
-    make_offset2bag(offsets, indices, offset2bag);
-
-    offset2bag.resize_({indices.sizes()[0]});
-  }
 
   if (mode == MODE_MEAN || mode == MODE_SUM) {
-    AT_DISPATCH_FLOATING_TYPES(weight.scalar_type(), "embedding_bag_cpu", [&]() {
-      if (per_sample_weights.defined()) {
-        AT_ASSERT(mode == MODE_SUM);
-        index_select_scale_add<scalar_t>(
-            indices, offset2bag, per_sample_weights, weight, output, offsets);
+    if (is_fast_path(weight, per_sample_weights)) {
+      Tensor per_sample_weights_float = per_sample_weights.defined()
+          ? per_sample_weights.to(kFloat) : per_sample_weights;
+      Tensor output_float = weight.scalar_type() == kFloat
+          ? output : at::empty(output.sizes(), output.options().dtype(kFloat));
+      if (weight.scalar_type() == kFloat) {
+        embedding_bag_cpu_sum_mean_fast<float>(
+            weight, indices, offsets, per_sample_weights_float, mode, output_float);
       } else {
-        index_select_add<scalar_t>(indices, offset2bag, weight, output, offsets);
+        embedding_bag_cpu_sum_mean_fast<at::Half>(
+            weight, indices, offsets, per_sample_weights_float, mode, output_float);
+        output.copy_(output_float);
       }
-    });
-    auto ret = apply_bag_size(offsets, indices, mode, output, bag_size);
-    return std::tuple<Tensor, Tensor, Tensor, Tensor>(ret, offset2bag, bag_size, bag_size);
-  } else { // MODE_MAX
-    at::optional<Tensor> maybe_per_sample_weights;
-    if (per_sample_weights.defined()) {
-      maybe_per_sample_weights = per_sample_weights;
+    } else {
+      TORCH_CHECK(weight.scalar_type() != kHalf,
+          "embedding_bag: Half weights must be contiguous");
+      AT_DISPATCH_FLOATING_TYPES(weight.scalar_type(), "embedding_bag_cpu", [&]() {
+        embedding_bag_cpu_sum_mean<scalar_t>(
+            weight, indices, offsets, per_sample_weights, mode, output);
+      });
     }
-    return AT_DISPATCH_FLOATING_TYPES_AND_HALF(
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, bag_size);
+  } else { // MODE_MAX
+    auto max_indices = at::zeros({offsets.size(0), weight.size(1)}, indices.options());
+    AT_DISPATCH_FLOATING_TYPES_AND_HALF(
       weight.scalar_type(), "embedding_bag_cpu_max", [&]() {
-        return embedding_bag_cpu_max<scalar_t>(
-            weight, indices, offset2bag, output, bag_size, offsets);
+        embedding_bag_cpu_max<scalar_t>(weight, indices, offsets, output, max_indices);
       }
     );
+    return std::tuple<Tensor, Tensor, Tensor, Tensor>(output, offset2bag, bag_size, max_indices);
   }
 }
 
@@ -431,62 +355,83 @@ Tensor _embedding_bag_backward(const Tensor &grad, const Tensor &indices,
   }
 }
 
-static Tensor _embedding_bag_dense_backward_cpu_max(
+// Bags may have taken their maxima from the same rows, so threads split the
+// columns instead, and every column is owned by one thread.
+template <typename scalar_t>
+void _embedding_bag_dense_backward_cpu_max(
     const Tensor& grad,
     const Tensor& bag_size,
     const Tensor& max_indices,
-    int64_t num_weights) {
-  AT_ASSERT(max_indices.defined());
-  auto index_grad_weight =
-      at::zeros({num_weights, grad.size(1)}, grad.options());
-  auto nonempty_max_indices = max_indices.index_select(0, bag_size.nonzero().view(-1));
-  auto nonempty_grad = grad.index_select(0, bag_size.nonzero().view(-1));
-
-  for (int64_t dim = 0; dim < grad.size(1); dim++) {
-    index_grad_weight.select(1, dim).index_add_(
-      0, nonempty_max_indices.select(1, dim), nonempty_grad.select(1, dim));
-  }
-  return index_grad_weight;
-}
-
-static std::vector<int64_t> compute_counts(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length) {
-  std::vector<int64_t> counts(num_weights, 0);
-  for (int i = 0; i < indices_length; i++) {
-    counts[indices_data[i]]++;
-  }
-  return counts;
+    Tensor& index_grad_weight) {
+  const int64_t num_bags = grad.size(0);
+  const int64_t ddim = grad.size(1);
+  const scalar_t* grad_data = grad.data_ptr<scalar_t>();
+  const int64_t* bag_size_data = bag_size.data_ptr<int64_t>();
+  const int64_t* max_indices_data = max_indices.data_ptr<int64_t>();
+  scalar_t* igwd = index_grad_weight.data_ptr<scalar_t>();
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, num_bags));
+  at::parallel_for(0, ddim, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t bag = 0; bag < num_bags; bag++) {
+      // Empty bags did not take their output from any row.
+      if (bag_size_data[bag] == 0) {
+        continue;
+      }
+      for (int64_t d = begin; d < end; d++) {
+        igwd[max_indices_data[bag * ddim + d] * ddim + d] += grad_data[bag * ddim + d];
+      }
+    }
+  });
 }
 
-// counts_uniq stores the index of the NEXT unique element
-// of the (sorted) indices vector.
-//
-// For example:
+// Returns the positions in the sorted `indices` where a new index starts,
+// i.e. the segments of equal indices. For example:
 // indices: [0, 0, 0, 1, 3, 3, 4]
-// counts: [3, 1, 0, 2, 1, 0]
-// counts_uniq: [3, 4, 6, 7]
-//
-// The unique indices can be found at index 0, 3, 4, 6.
-static std::vector<int64_t> compute_counts_uniq(
-    int64_t num_weights,
-    int64_t* indices_data,
-    int64_t indices_length,
-    const std::vector<int64_t>& counts) {
-  std::vector<int64_t> counts_uniq;
-  counts_uniq.reserve(num_weights);
-  int64_t o = 0;
-  for (int64_t i = 0; i < indices_length; i += counts[indices_data[i]]) {
-    counts_uniq.push_back(counts[indices_data[i]]);
-    if (o > 0) {
-      counts_uniq[o] += counts_uniq[o - 1];
+// segment starts: [0, 3, 4, 6]
+// Chunks count their starts in parallel, and after a prefix sum over the
+// counts write them to their own ranges of the result.
+static std::vector<int64_t> compute_segment_starts(
+    const int64_t* indices_data,
+    int64_t numel) {
+  const int64_t chunk_size = std::max<int64_t>(
+      internal::GRAIN_SIZE, divup(numel, static_cast<int64_t>(at::get_num_threads())));
+  const int64_t num_chunks = divup(numel, chunk_size);
+  auto is_start = [&](int64_t i) {
+    return i == 0 || indices_data[i] != indices_data[i - 1];
+  };
+
+  std::vector<int64_t> chunk_starts(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      const int64_t stop = std::min(numel, (chunk + 1) * chunk_size);
+      int64_t count = 0;
+      for (int64_t i = chunk * chunk_size; i < stop; i++) {
+        count += is_start(i);
+      }
+      chunk_starts[chunk + 1] = count;
     }
-    o++;
-  }
-  return counts_uniq;
+  });
+  std::partial_sum(chunk_starts.begin(), chunk_starts.end(), chunk_starts.begin());
+
+  std::vector<int64_t> segment_starts(chunk_starts[num_chunks]);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      const int64_t stop = std::min(numel, (chunk + 1) * chunk_size);
+      int64_t pos = chunk_starts[chunk];
+      for (int64_t i = chunk * chunk_size; i < stop; i++) {
+        if (is_start(i)) {
+          segment_starts[pos++] = i;
+        }
+      }
+    }
+  });
+  return segment_starts;
 }
 
+// Sorting the indices groups the samples of every row of the gradient into
+// one segment. Segments write different rows, so they are accumulated in
+// parallel without atomics, and the length of a segment is the frequency
+// used by scale_grad_by_freq.
 template <typename scalar_t>
 void _embedding_bag_dense_backward_cpu_sum_mean(
     const Tensor& grad,
@@ -519,16 +464,26 @@ void _embedding_bag_dense_backward_cpu_sum_mean(
   auto offsets_data = offsets_.data_ptr<int64_t>();
   auto offset2bag_data = offset2bag.data_ptr<int64_t>();
   int64_t numel = indices.numel();
-
-  auto counts = compute_counts(num_weights, indices_data, numel);
-  auto next_unique_index_idx =
-      compute_counts_uniq(num_weights, indices_data, numel, counts);
-
-  auto loop = [&](int64_t start, int64_t end) {
-    for (int64_t i = start; i < end; i++) {
-      int64_t start = i == 0 ? 0 : next_unique_index_idx[i - 1];
+  int64_t num_bags = offsets_.size(0);
+  int64_t ddim = grad.size(1);
+  auto igwd = index_grad_weight.data_ptr<scalar_t>();
+  auto gd = grad.data_ptr<scalar_t>();
+
+  if (numel > 0) {
+    TORCH_CHECK(indices_data[0] >= 0 && indices_data[numel - 1] < num_weights,
+        "embedding_bag: indices are out of bounds for ", num_weights, " embeddings");
+  }
+  auto segment_starts = compute_segment_starts(indices_data, numel);
+  int64_t num_segments = segment_starts.size();
+
+  const int64_t grain_size = std::max<int64_t>(
+      1, internal::GRAIN_SIZE / std::max<int64_t>(1, ddim * numel / std::max<int64_t>(1, num_segments)));
+  at::parallel_for(0, num_segments, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t s = begin; s < end; s++) {
+      int64_t start = segment_starts[s];
+      int64_t stop = s + 1 < num_segments ? segment_starts[s + 1] : numel;
       int64_t index = indices_data[start];
-      for (int64_t j = start; j < next_unique_index_idx[i]; j++) {
+      for (int64_t j = start; j < stop; j++) {
         int64_t source = offset2bag_data[j];
         double scale = 1.0;
         if (per_sample_weights) {
@@ -536,33 +491,16 @@ void _embedding_bag_dense_backward_cpu_sum_mean(
           scale = per_sample_weights_data[*per_sample_weights_stride * j];
         }
         if (scale_grad_by_freq) {
-          scale /= counts[indices_data[i]];
+          scale /= stop - start;
         }
-        if (mode == 1) { // MODE_MEAN
-          if (offsets_.size(0) == 1) {
-            auto bag_size = indices.size(0);
-            scale /= bag_size;
-          } else {
-            if (source == offsets_.size(0) - 1) {
-              scale /= indices.size(0) - offsets_data[offsets_.size(0) - 1];
-            } else {
-              scale /= offsets_data[source + 1] - offsets_data[source];
-            }
-          }
+        if (mode == MODE_MEAN) {
+          scale /= bag_end(offsets_data, source, num_bags, numel) - offsets_data[source];
         }
-        int64_t ddim = grad.size(1);
-        auto igwd = index_grad_weight.data_ptr<scalar_t>();
-        auto gd = grad.data_ptr<scalar_t>();
         THBlas_axpy<scalar_t>(ddim, (scalar_t)scale, gd + ddim * source, 1,
                     igwd + ddim * index, 1);
       }
     }
-  };
-  if (numel > 1000) {
-    at::parallel_for(0, (int64_t)next_unique_index_idx.size(), 0, loop);
-  } else {
-    loop(0, (int64_t)next_unique_index_idx.size());
-  }
+  });
 }
 
 Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indices_,
@@ -578,17 +516,30 @@ Tensor _embedding_bag_dense_backward_cpu(const Tensor &grad_, const Tensor &indi
   // for more details.
   auto grad = grad_.contiguous();
   auto grad_arg = TensorArg(grad, "grad_", 1);
-  checkScalarTypes("embedding_bag", grad_arg, {kFloat, kDouble});
-
-  if (mode == MODE_MAX) {
-    return _embedding_bag_dense_backward_cpu_max(
-        grad_, bag_size_, max_indices_, num_weights);
+  checkScalarTypes("embedding_bag", grad_arg, {kFloat, kDouble, kHalf});
+
+  // Half gradients are accumulated in float.
+  if (grad.scalar_type() == kHalf) {
+    return _embedding_bag_dense_backward_cpu(
+        grad.to(kFloat), indices_, offsets_, offset2bag__, bag_size_, max_indices_,
+        num_weights, scale_grad_by_freq, mode,
+        per_sample_weights_.defined() ? per_sample_weights_.to(kFloat) : per_sample_weights_)
+        .to(kHalf);
   }
-  AT_ASSERT(mode == MODE_MEAN || mode == MODE_SUM);
 
   auto index_grad_weight =
       at::zeros({num_weights, grad.size(1)}, grad.options());
 
+  if (mode == MODE_MAX) {
+    AT_ASSERT(max_indices_.defined());
+    AT_DISPATCH_FLOATING_TYPES(grad.scalar_type(), "embedding_bag_backward_max", [&] {
+        _embedding_bag_dense_backward_cpu_max<scalar_t>(
+            grad, bag_size_.contiguous(), max_indices_.contiguous(), index_grad_weight);
+    });
+    return index_grad_weight;
+  }
+  AT_ASSERT(mode == MODE_MEAN || mode == MODE_SUM);
+
   AT_DISPATCH_FLOATING_TYPES(grad.scalar_type(), "embedding_bag_backward", [&] {
       _embedding_bag_dense_backward_cpu_sum_mean<scalar_t>(
           grad, indices_, offsets_, offset2bag__, num_weights,
@@ -0,0 +1,126 @@
+#include <ATen/native/FusedOptimizers.h>
+
+namespace at { namespace native {
+
+DEFINE_DISPATCH(fused_sgd_stub);
+DEFINE_DISPATCH(fused_adam_stub);
+DEFINE_DISPATCH(fused_adagrad_stub);
+DEFINE_DISPATCH(fused_rmsprop_stub);
+
+namespace {
+
+void check_fused_tensor(const char* fn, const Tensor& tensor, const Tensor& param) {
+  TORCH_CHECK(tensor.device().type() == kCPU && tensor.layout() == kStrided,
+      fn, ": expected dense CPU tensors");
+  TORCH_CHECK(tensor.scalar_type() == param.scalar_type(),
+      fn, ": expected all tensors to be of type ", param.scalar_type(),
+      " but got ", tensor.scalar_type());
+  TORCH_CHECK(tensor.is_contiguous(), fn, ": expected contiguous tensors");
+  TORCH_CHECK(tensor.numel() == param.numel(),
+      fn, ": expected ", param.numel(), " elements but got ", tensor.numel());
+}
+
+// Every list holds one tensor per parameter, or is empty if it is optional.
+void check_fused_lists(
+    const char* fn,
+    TensorList params,
+    std::initializer_list<TensorList> lists,
+    std::initializer_list<TensorList> optional_lists = {}) {
+  TORCH_CHECK(at::isFloatingType(params[0].scalar_type()),
+      fn, ": expected floating point parameters but got ", params[0].scalar_type());
+  for (const auto& param : params) {
+    check_fused_tensor(fn, param, params[0]);
+  }
+  auto check_list = [&](TensorList list) {
+    TORCH_CHECK(list.size() == params.size(),
+        fn, ": expected ", params.size(), " tensors per list but got ", list.size());
+    for (size_t i = 0; i < list.size(); i++) {
+      check_fused_tensor(fn, list[i], params[i]);
+    }
+  };
+  for (auto list : lists) {
+    check_list(list);
+  }
+  for (auto list : optional_lists) {
+    if (!list.empty()) {
+      check_list(list);
+    }
+  }
+}
+
+} // anonymous namespace
+
+void fused_sgd_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov) {
+  if (params.empty()) {
+    return;
+  }
+  check_fused_lists("fused_sgd_step_", params, {grads}, {momentum_buffers});
+  fused_sgd_stub(kCPU, params, grads, momentum_buffers,
+                 lr, momentum, dampening, weight_decay, nesterov);
+}
+
+void fused_adam_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    ArrayRef<double> step_sizes,
+    ArrayRef<double> bias_corrections2,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps) {
+  if (params.empty()) {
+    return;
+  }
+  check_fused_lists("fused_adam_step_", params, {grads, exp_avgs, exp_avg_sqs}, {max_exp_avg_sqs});
+  TORCH_CHECK(step_sizes.size() == params.size() && bias_corrections2.size() == params.size(),
+      "fused_adam_step_: expected one step size and bias correction per parameter");
+  fused_adam_stub(kCPU, params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs,
+                  step_sizes, bias_corrections2, beta1, beta2, weight_decay, eps);
+}
+
+void fused_adagrad_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList sums,
+    ArrayRef<double> lrs,
+    double weight_decay) {
+  if (params.empty()) {
+    return;
+  }
+  check_fused_lists("fused_adagrad_step_", params, {grads, sums});
+  TORCH_CHECK(lrs.size() == params.size(),
+      "fused_adagrad_step_: expected one learning rate per parameter");
+  fused_adagrad_stub(kCPU, params, grads, sums, lrs, weight_decay);
+}
+
+void fused_rmsprop_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList square_avgs,
+    TensorList grad_avgs,
+    TensorList momentum_buffers,
+    double lr,
+    double alpha,
+    double eps,
+    double weight_decay,
+    double momentum) {
+  if (params.empty()) {
+    return;
+  }
+  check_fused_lists("fused_rmsprop_step_", params, {grads, square_avgs}, {grad_avgs, momentum_buffers});
+  fused_rmsprop_stub(kCPU, params, grads, square_avgs, grad_avgs, momentum_buffers,
+                     lr, alpha, eps, weight_decay, momentum);
+}
+
+}} // namespace at::native
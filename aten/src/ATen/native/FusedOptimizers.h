@@ -0,0 +1,82 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Optimizer steps that update whole lists of parameters on CPU in a single
+// pass. Entry i of every list belongs to parameter i, and all tensors are
+// dense, contiguous and of one floating point type. A list of optional state
+// is empty when the option that needs it is off. Passing one flat tensor per
+// list, when parameters and state live in contiguous buffers, is the same as
+// passing the individual tensors.
+
+// p -= lr * update, with g = grad + weight_decay * p and, if
+// momentum_buffers is not empty,
+//   buf = momentum * buf + (1 - dampening) * g
+//   update = nesterov ? g + momentum * buf : buf
+CAFFE2_API void fused_sgd_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov);
+
+// p -= step_size(i) * m / (sqrt(v / bias_correction2(i)) + eps), where v is
+// the running maximum of exp_avg_sq if max_exp_avg_sqs is not empty.
+CAFFE2_API void fused_adam_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    ArrayRef<double> step_sizes,
+    ArrayRef<double> bias_corrections2,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps);
+
+// sum += g * g; p -= lr(i) * g / (sqrt(sum) + 1e-10)
+CAFFE2_API void fused_adagrad_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList sums,
+    ArrayRef<double> lrs,
+    double weight_decay);
+
+// Centered if grad_avgs is not empty, with momentum if momentum_buffers is
+// not empty.
+CAFFE2_API void fused_rmsprop_step_(
+    TensorList params,
+    TensorList grads,
+    TensorList square_avgs,
+    TensorList grad_avgs,
+    TensorList momentum_buffers,
+    double lr,
+    double alpha,
+    double eps,
+    double weight_decay,
+    double momentum);
+
+using fused_sgd_fn = void(*)(
+    TensorList, TensorList, TensorList, double, double, double, double, bool);
+using fused_adam_fn = void(*)(
+    TensorList, TensorList, TensorList, TensorList, TensorList,
+    ArrayRef<double>, ArrayRef<double>, double, double, double, double);
+using fused_adagrad_fn = void(*)(
+    TensorList, TensorList, TensorList, ArrayRef<double>, double);
+using fused_rmsprop_fn = void(*)(
+    TensorList, TensorList, TensorList, TensorList, TensorList,
+    double, double, double, double, double);
+
+DECLARE_DISPATCH(fused_sgd_fn, fused_sgd_stub);
+DECLARE_DISPATCH(fused_adam_fn, fused_adam_stub);
+DECLARE_DISPATCH(fused_adagrad_fn, fused_adagrad_stub);
+DECLARE_DISPATCH(fused_rmsprop_fn, fused_rmsprop_stub);
+
+}} // namespace at::native
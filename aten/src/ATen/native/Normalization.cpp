@@ -6,6 +6,7 @@
 #include <ATen/Config.h>
 
 #include <ATen/detail/CUDAHooksInterface.h>
+#include <ATen/native/cpu/BatchNormKernel.h>
 
 #include <vector>
 
@@ -25,8 +26,20 @@ namespace {
     }
     return t;
   }
+
+  // Channels last inputs are computed in NHWC by the kernels in
+  // cpu/BatchNormKernel.cpp, and their outputs stay channels last.
+  static inline bool batch_norm_use_channels_last(const Tensor& input) {
+    return input.dim() == 4 &&
+        input.suggest_memory_format() == at::MemoryFormat::ChannelsLast;
+  }
 }
 
+DEFINE_DISPATCH(batch_norm_nhwc_collect_stats_stub);
+DEFINE_DISPATCH(batch_norm_nhwc_transform_stub);
+DEFINE_DISPATCH(batch_norm_nhwc_backward_reduce_stub);
+DEFINE_DISPATCH(batch_norm_nhwc_backward_elemt_stub);
+
 // TensorAccessor when it is defined to work around undefined...
 template <typename scalar_t>
 static TensorAccessor<scalar_t, 1> conditional_accessor_1d(const Tensor& t) {
@@ -132,6 +145,41 @@ std::tuple<Tensor,Tensor,Tensor> batch_norm_cpu_transform_input_template(
     const Tensor& running_mean /* optional */, const Tensor& running_var /* optional */,
     bool train, double eps) {
 
+  int64_t n_input = input.size(1);
+
+  auto save_mean_a = conditional_accessor_1d<scalar_t>(save_mean);
+  auto save_invstd_a = conditional_accessor_1d<scalar_t>(save_invstd);
+
+  auto running_mean_a = conditional_accessor_1d<scalar_t>(running_mean);
+  auto running_var_a = conditional_accessor_1d<scalar_t>(running_var);
+
+  if (batch_norm_use_channels_last(input)) {
+    // output(n, h, w, c) = input(n, h, w, c) * alpha(c) + beta(c), as in
+    // batch_norm_cpu_inference_contiguous.
+    Tensor output = at::empty(input.sizes(), input.options(), at::MemoryFormat::ChannelsLast);
+    Tensor alpha = at::empty({n_input}, input.options());
+    Tensor beta = at::empty({n_input}, input.options());
+    scalar_t* alpha_data = alpha.data_ptr<scalar_t>();
+    scalar_t* beta_data = beta.data_ptr<scalar_t>();
+    for (int64_t f = 0; f < n_input; ++f) {
+      scalar_t mean, invstd;
+      if (train) {
+        mean = save_mean_a[f];
+        invstd = save_invstd_a[f];
+      } else {
+        mean = running_mean_a[f];
+        invstd = 1 / std::sqrt(running_var_a[f] + eps);
+      }
+      scalar_t w = weight.defined() ? weight.data_ptr<scalar_t>()[f * weight.stride(0)] : 1;
+      scalar_t b = bias.defined() ? bias.data_ptr<scalar_t>()[f * bias.stride(0)] : 0;
+      alpha_data[f] = invstd * w;
+      beta_data[f] = b - mean * invstd * w;
+    }
+    batch_norm_nhwc_transform_stub(
+        kCPU, output, input.contiguous(at::MemoryFormat::ChannelsLast), alpha, beta);
+    return std::make_tuple(output, save_mean, save_invstd);
+  }
+
   Tensor output = at::empty_like(input);
 
   // Check if we should use the fast path.
@@ -144,13 +192,6 @@ std::tuple<Tensor,Tensor,Tensor> batch_norm_cpu_transform_input_template(
       running_mean, running_var, eps);
     return std::make_tuple(output, save_mean, save_invstd);
   }
-  int64_t n_input = input.size(1);
-
-  auto save_mean_a = conditional_accessor_1d<scalar_t>(save_mean);
-  auto save_invstd_a = conditional_accessor_1d<scalar_t>(save_invstd);
-
-  auto running_mean_a = conditional_accessor_1d<scalar_t>(running_mean);
-  auto running_var_a = conditional_accessor_1d<scalar_t>(running_var);
 
   parallel_for(0, n_input, 1, [&](int64_t b_begin, int64_t b_end) {
     for (int64_t f = b_begin; f < b_end; ++f) {
@@ -196,6 +237,26 @@ std::tuple<Tensor,Tensor> batch_norm_cpu_update_stats_template(
   auto running_mean_a = conditional_accessor_1d<scalar_t>(running_mean);
   auto running_var_a = conditional_accessor_1d<scalar_t>(running_var);
 
+  if (batch_norm_use_channels_last(input)) {
+    Tensor var_sum = at::empty({n_input}, input.options());
+    batch_norm_nhwc_collect_stats_stub(
+        kCPU, save_mean, var_sum, input.contiguous(at::MemoryFormat::ChannelsLast));
+    auto var_sum_a = var_sum.accessor<scalar_t, 1>();
+    for (int64_t f = 0; f < n_input; ++f) {
+      scalar_t mean = save_mean_a[f];
+      accscalar_t var_sum_f = var_sum_a[f];
+      save_var_transform_a[f] = VarTransform<accscalar_t>{}(var_sum_f / n, eps);
+      if (running_mean.defined()) {
+        running_mean_a[f] = momentum * mean + (1 - momentum) * running_mean_a[f];
+      }
+      if (running_var.defined()) {
+        accscalar_t unbiased_var = var_sum_f / (n - 1);
+        running_var_a[f] = momentum * unbiased_var + (1 - momentum) * running_var_a[f];
+      }
+    }
+    return std::make_tuple(save_mean, save_var_transform);
+  }
+
   parallel_for(0, n_input, 1, [&](int64_t b_begin, int64_t b_end) {
     for (int64_t f = b_begin; f < b_end; ++f) {
       Tensor in = input.select(1, f);
@@ -239,8 +300,11 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cpu_template(const Tensor
   Tensor grad_input;
   Tensor grad_weight;
   Tensor grad_bias;
+  const bool channels_last = batch_norm_use_channels_last(input);
   if (grad_input_mask[0]) {
-    grad_input = at::empty_like(input);
+    grad_input = channels_last
+        ? at::empty(input.sizes(), input.options(), at::MemoryFormat::ChannelsLast)
+        : at::empty_like(input);
   }
   if (grad_input_mask[1]) {
     grad_weight = at::empty_like(weight);
@@ -262,6 +326,64 @@ std::tuple<Tensor, Tensor, Tensor> batch_norm_backward_cpu_template(const Tensor
   auto running_mean_a = conditional_accessor_1d<scalar_t>(running_mean);
   auto running_var_a = conditional_accessor_1d<scalar_t>(running_var);
 
+  if (channels_last) {
+    const Tensor in = input.contiguous(at::MemoryFormat::ChannelsLast);
+    const Tensor grad_out = grad_out_.contiguous(at::MemoryFormat::ChannelsLast);
+    Tensor mean = at::empty({n_input}, input.options());
+    Tensor invstd = at::empty({n_input}, input.options());
+    auto mean_a = mean.accessor<scalar_t, 1>();
+    auto invstd_a = invstd.accessor<scalar_t, 1>();
+    for (int64_t f = 0; f < n_input; ++f) {
+      if (train) {
+        mean_a[f] = save_mean_a[f];
+        invstd_a[f] = save_invstd_a[f];
+      } else {
+        mean_a[f] = running_mean_a[f];
+        invstd_a[f] = 1 / std::sqrt(running_var_a[f] + eps);
+      }
+    }
+
+    Tensor sum_dy = at::empty({n_input}, input.options());
+    Tensor dot_p = at::empty({n_input}, input.options());
+    batch_norm_nhwc_backward_reduce_stub(kCPU, sum_dy, dot_p, grad_out, in, mean);
+    auto sum_dy_a = sum_dy.accessor<scalar_t, 1>();
+    auto dot_p_a = dot_p.accessor<scalar_t, 1>();
+
+    if (grad_input_mask[0]) {
+      // The formulas below, written as
+      // grad_in = grad_out * a(c) + input * b(c) + d(c).
+      Tensor a = at::empty({n_input}, input.options());
+      Tensor b = at::empty({n_input}, input.options());
+      Tensor d = at::empty({n_input}, input.options());
+      auto a_a = a.accessor<scalar_t, 1>();
+      auto b_a = b.accessor<scalar_t, 1>();
+      auto d_a = d.accessor<scalar_t, 1>();
+      for (int64_t f = 0; f < n_input; ++f) {
+        scalar_t w = weight.defined() ? weight_a[f] : 1;
+        scalar_t scale = invstd_a[f] * w;
+        a_a[f] = scale;
+        if (train) {
+          scalar_t k = dot_p_a[f] * invstd_a[f] * invstd_a[f] / n;
+          scalar_t grad_mean = sum_dy_a[f] / n;
+          b_a[f] = -k * scale;
+          d_a[f] = (mean_a[f] * k - grad_mean) * scale;
+        } else {
+          b_a[f] = 0;
+          d_a[f] = 0;
+        }
+      }
+      batch_norm_nhwc_backward_elemt_stub(kCPU, grad_input, grad_out, in, a, b, d);
+    }
+    for (int64_t f = 0; f < n_input; ++f) {
+      if (grad_input_mask[1]) {
+        grad_weight_a[f] = dot_p_a[f] * invstd_a[f];
+      }
+      if (grad_input_mask[2]) {
+        grad_bias_a[f] = sum_dy_a[f];
+      }
+    }
+    return std::make_tuple(grad_input, grad_weight, grad_bias);
+  }
 
   parallel_for(0, n_input, 1, [&](int64_t b_begin, int64_t b_end) {
       for (int64_t f = b_begin; f < b_end; ++f) {
@@ -0,0 +1,291 @@
+#pragma once
+
+// Parallel sorting primitives for CPU kernels.
+//
+// radix_sort_pairs is a stable least significant digit radix sort of unsigned
+// integer keys. RadixSortKey maps the scalar types to keys with the same
+// order, so sorting numbers of any dtype only needs a few linear passes.
+// merge_sort is a stable merge sort for everything that can only be compared,
+// such as rows of a tensor.
+//
+// Both split their input into get_num_threads() chunks of at least
+// grain_size elements. They run on one thread when called from inside a
+// parallel region, so kernels that sort many slices can parallelize over the
+// slices instead.
+
+#include <ATen/Parallel.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace at { namespace native {
+
+inline int64_t parallel_sort_num_chunks(int64_t n, int64_t grain_size) {
+  if (at::in_parallel_region()) {
+    return 1;
+  }
+  return std::max<int64_t>(1, std::min<int64_t>(at::get_num_threads(), n / grain_size));
+}
+
+// Maps a scalar to an unsigned integer key, such that comparing keys compares
+// the scalars. NaNs map to the largest key, so they sort after all other
+// values, and -0.0 maps to the key of 0.0 so that sorting is stable for them.
+template <typename scalar_t, typename = void>
+struct RadixSortKey;
+
+template <typename scalar_t>
+struct RadixSortKey<scalar_t, typename std::enable_if<std::is_integral<scalar_t>::value && !std::is_same<scalar_t, bool>::value>::type> {
+  using type = typename std::make_unsigned<scalar_t>::type;
+  static type encode(scalar_t x) {
+    // Flipping the sign bit orders two's complement integers as unsigned ones.
+    constexpr type sign = std::is_signed<scalar_t>::value ? type(1) << (sizeof(type) * 8 - 1) : 0;
+    return static_cast<type>(static_cast<type>(x) ^ sign);
+  }
+};
+
+template <typename scalar_t>
+struct RadixSortKey<scalar_t, typename std::enable_if<std::is_floating_point<scalar_t>::value>::type> {
+  using type = typename std::conditional<sizeof(scalar_t) == 4, uint32_t, uint64_t>::type;
+  static type encode(scalar_t x) {
+    if (std::isnan(x)) {
+      return std::numeric_limits<type>::max();
+    }
+    if (x == 0) {
+      x = 0;
+    }
+    type bits;
+    std::memcpy(&bits, &x, sizeof(bits));
+    // Negative values are in sign-magnitude order, so they are inverted.
+    constexpr type sign = type(1) << (sizeof(type) * 8 - 1);
+    return (bits & sign) ? static_cast<type>(~bits) : static_cast<type>(bits | sign);
+  }
+};
+
+// Sorts `keys` and applies the same permutation to `values`. Elements with
+// equal keys keep their order.
+//
+// Every pass sorts by one 8-bit digit: each chunk counts its digits, a scan of
+// the counts tells each chunk where its elements of every digit go, and the
+// chunks scatter their elements in parallel. Digits that are the same for
+// all keys are skipped, so keys that only span a small range take few passes.
+template <typename key_t, typename value_t>
+void radix_sort_pairs(key_t* keys, value_t* values, int64_t n, int64_t grain_size = at::internal::GRAIN_SIZE) {
+  static_assert(std::is_unsigned<key_t>::value, "radix_sort_pairs expects unsigned keys");
+  constexpr int kRadixBits = 8;
+  constexpr int64_t kBuckets = 1 << kRadixBits;
+  constexpr int kKeyBits = sizeof(key_t) * 8;
+  if (n <= 1) {
+    return;
+  }
+  const int64_t num_chunks = parallel_sort_num_chunks(n, grain_size);
+  const int64_t chunk_size = divup(n, num_chunks);
+
+  std::vector<key_t> chunk_and(num_chunks);
+  std::vector<key_t> chunk_or(num_chunks);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t c = chunk_begin; c < chunk_end; c++) {
+      key_t all = std::numeric_limits<key_t>::max(), any = 0;
+      for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+        all &= keys[i];
+        any |= keys[i];
+      }
+      chunk_and[c] = all;
+      chunk_or[c] = any;
+    }
+  });
+  key_t all = std::numeric_limits<key_t>::max(), any = 0;
+  for (int64_t c = 0; c < num_chunks; c++) {
+    all &= chunk_and[c];
+    any |= chunk_or[c];
+  }
+  const key_t varying = all ^ any;
+  if (varying == 0) {
+    return;
+  }
+
+  std::vector<key_t> keys_buffer(n);
+  std::vector<value_t> values_buffer(n);
+  std::vector<int64_t> offsets(num_chunks * kBuckets);
+  key_t* src_keys = keys;
+  value_t* src_values = values;
+  key_t* dst_keys = keys_buffer.data();
+  value_t* dst_values = values_buffer.data();
+
+  for (int shift = 0; shift < kKeyBits; shift += kRadixBits) {
+    if (((varying >> shift) & (kBuckets - 1)) == 0) {
+      continue;
+    }
+    auto digit = [shift](key_t key) {
+      return static_cast<int64_t>((key >> shift) & (kBuckets - 1));
+    };
+    at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+      for (int64_t c = chunk_begin; c < chunk_end; c++) {
+        int64_t* histogram = offsets.data() + c * kBuckets;
+        std::fill(histogram, histogram + kBuckets, 0);
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          histogram[digit(src_keys[i])]++;
+        }
+      }
+    });
+    // Chunk c writes its elements of digit d after all elements with smaller
+    // digits and after the elements of digit d of the chunks before it.
+    int64_t total = 0;
+    for (int64_t d = 0; d < kBuckets; d++) {
+      for (int64_t c = 0; c < num_chunks; c++) {
+        int64_t count = offsets[c * kBuckets + d];
+        offsets[c * kBuckets + d] = total;
+        total += count;
+      }
+    }
+    at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+      for (int64_t c = chunk_begin; c < chunk_end; c++) {
+        int64_t* offset = offsets.data() + c * kBuckets;
+        for (int64_t i = c * chunk_size; i < std::min(n, (c + 1) * chunk_size); i++) {
+          int64_t pos = offset[digit(src_keys[i])]++;
+          dst_keys[pos] = src_keys[i];
+          dst_values[pos] = src_values[i];
+        }
+      }
+    });
+    std::swap(src_keys, dst_keys);
+    std::swap(src_values, dst_values);
+  }
+
+  if (src_keys != keys) {
+    at::parallel_for(0, n, grain_size, [&](int64_t begin, int64_t end) {
+      std::copy(src_keys + begin, src_keys + end, keys + begin);
+      std::copy(src_values + begin, src_values + end, values + begin);
+    });
+  }
+}
+
+// Returns how many of the first `diagonal` elements of the stable merge of the
+// sorted ranges `a` and `b` come from `a`.
+template <typename T, typename Comp>
+int64_t merge_path(const T* a, int64_t a_n, const T* b, int64_t b_n, int64_t diagonal, const Comp& comp) {
+  int64_t lo = std::max<int64_t>(0, diagonal - b_n);
+  int64_t hi = std::min(diagonal, a_n);
+  while (lo < hi) {
+    int64_t mid = lo + (hi - lo) / 2;
+    if (comp(b[diagonal - mid - 1], a[mid])) {
+      hi = mid;
+    } else {
+      lo = mid + 1;
+    }
+  }
+  return lo;
+}
+
+// Stable sort of `data` by `comp`. The chunks are sorted in parallel, and then
+// merged pairwise in rounds. The output of every round is cut into pieces of
+// one chunk that are merged in parallel, using merge_path to find the inputs
+// of every piece, so the last rounds use all threads as well.
+template <typename T, typename Comp>
+void merge_sort(T* data, int64_t n, const Comp& comp, int64_t grain_size = at::internal::GRAIN_SIZE) {
+  const int64_t num_chunks = parallel_sort_num_chunks(n, grain_size);
+  if (num_chunks == 1) {
+    std::stable_sort(data, data + n, comp);
+    return;
+  }
+  const int64_t chunk_size = divup(n, num_chunks);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t c = chunk_begin; c < chunk_end; c++) {
+      std::stable_sort(data + c * chunk_size, data + std::min(n, (c + 1) * chunk_size), comp);
+    }
+  });
+
+  std::vector<T> buffer(n);
+  T* src = data;
+  T* dst = buffer.data();
+  for (int64_t width = chunk_size; width < n; width *= 2) {
+    at::parallel_for(0, num_chunks, 1, [&](int64_t piece_begin, int64_t piece_end) {
+      for (int64_t pos = piece_begin * chunk_size; pos < std::min(n, piece_end * chunk_size);) {
+        // A piece may span the end of one pair of runs and the start of the next.
+        const int64_t pair_begin = pos / (2 * width) * (2 * width);
+        const int64_t mid = std::min(n, pair_begin + width);
+        const int64_t pair_end = std::min(n, pair_begin + 2 * width);
+        const int64_t stop = std::min(std::min(n, piece_end * chunk_size), pair_end);
+        const T* a = src + pair_begin;
+        const T* b = src + mid;
+        const int64_t a_n = mid - pair_begin, b_n = pair_end - mid;
+        const int64_t a_begin = merge_path(a, a_n, b, b_n, pos - pair_begin, comp);
+        const int64_t a_end = merge_path(a, a_n, b, b_n, stop - pair_begin, comp);
+        std::merge(
+            a + a_begin, a + a_end,
+            b + (pos - pair_begin - a_begin), b + (stop - pair_begin - a_end),
+            dst + pos, comp);
+        pos = stop;
+      }
+    });
+    std::swap(src, dst);
+  }
+
+  if (src != data) {
+    at::parallel_for(0, n, grain_size, [&](int64_t begin, int64_t end) {
+      std::copy(src + begin, src + end, data + begin);
+    });
+  }
+}
+
+// Sorts `keys` with merge_sort and applies the same permutation to `values`.
+template <typename key_t, typename value_t, typename Comp>
+void merge_sort_pairs(key_t* keys, value_t* values, int64_t n, const Comp& comp, int64_t grain_size = at::internal::GRAIN_SIZE) {
+  using pair_t = std::pair<key_t, value_t>;
+  std::vector<pair_t> pairs(n);
+  at::parallel_for(0, n, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      pairs[i] = pair_t(keys[i], values[i]);
+    }
+  });
+  merge_sort(pairs.data(), n, [&](const pair_t& x, const pair_t& y) { return comp(x.first, y.first); }, grain_size);
+  at::parallel_for(0, n, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      keys[i] = pairs[i].first;
+      values[i] = pairs[i].second;
+    }
+  });
+}
+
+// Stable sort of the contiguous `data`, which writes the sorted elements to
+// `values` and their positions in `data` to `indices`. NaNs are the largest
+// elements, as in sort. `values` must not overlap `data`.
+template <typename scalar_t>
+void sort_with_indices(
+    const scalar_t* data,
+    int64_t n,
+    bool descending,
+    scalar_t* values,
+    int64_t* indices,
+    int64_t grain_size = at::internal::GRAIN_SIZE) {
+  using key_t = typename RadixSortKey<scalar_t>::type;
+  // Below this, the histograms of a radix sort cost more than sorting.
+  constexpr int64_t kMinRadixSortSize = 256;
+  std::vector<key_t> keys(n);
+  at::parallel_for(0, n, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      key_t key = RadixSortKey<scalar_t>::encode(data[i]);
+      keys[i] = descending ? static_cast<key_t>(~key) : key;
+      indices[i] = i;
+    }
+  });
+  if (n < kMinRadixSortSize) {
+    std::stable_sort(indices, indices + n, [&](int64_t i, int64_t j) {
+      return keys[i] < keys[j];
+    });
+  } else {
+    radix_sort_pairs(keys.data(), indices, n, grain_size);
+  }
+  at::parallel_for(0, n, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t i = begin; i < end; i++) {
+      values[i] = data[indices[i]];
+    }
+  });
+}
+
+}} // namespace at::native
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <ATen/CPUGenerator.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/DistributionsHelper.h>
+#include <ATen/core/PhiloxRNGEngine.h>
+
+#include <algorithm>
+#include <cmath>
+#include <type_traits>
+
+// Parallel random fills for the Philox mode of CPUGenerator.
+// See Note [Philox mode of CPUGenerator]
+
+namespace at { namespace native {
+
+namespace philox {
+
+constexpr int64_t kGrainSize = 32768;
+// Number of elements whose randoms are generated at once, so that
+// transforming them into samples is a separate loop that can be vectorized.
+constexpr int64_t kBlockSize = 256;
+
+inline float uniform_float(uint32_t random) {
+  return (random & FLOAT_MASK) * FLOAT_DIVISOR;
+}
+
+inline double uniform_double(const uint32_t* randoms) {
+  uint64_t random = (static_cast<uint64_t>(randoms[0]) << 32) | randoms[1];
+  return (random & DOUBLE_MASK) * DOUBLE_DIVISOR;
+}
+
+} // namespace philox
+
+// Fills data[0, numel) with transform(randoms), where element i gets the
+// kRandoms 32 bit randoms at position i * kRandoms of the Philox stream
+// reserved for this fill.
+template <int kRandoms, typename scalar_t, typename transform_t>
+void philox_fill(
+    scalar_t* data,
+    int64_t numel,
+    CPUGenerator* generator,
+    const transform_t& transform) {
+  if (numel == 0) {
+    return;
+  }
+  std::pair<uint64_t, uint64_t> seed_and_offset;
+  {
+    // See Note [Acquire lock when using random generators]
+    std::lock_guard<std::mutex> lock(generator->mutex_);
+    // each 128 bit Philox number holds 4 randoms
+    seed_and_offset =
+        generator->philox_engine_inputs((numel * kRandoms + 3) / 4);
+  }
+  const uint64_t seed = seed_and_offset.first;
+  const uint64_t offset = seed_and_offset.second;
+
+  parallel_for(0, numel, philox::kGrainSize, [&](int64_t begin, int64_t end) {
+    const uint64_t first_random = static_cast<uint64_t>(begin) * kRandoms;
+    at::Philox4_32_10 engine(seed, /* subsequence */ 0, offset + first_random / 4);
+    for (uint64_t i = 0; i < first_random % 4; i++) {
+      engine();
+    }
+    uint32_t randoms[philox::kBlockSize * kRandoms];
+    for (int64_t i = begin; i < end; i += philox::kBlockSize) {
+      const int64_t n = std::min(philox::kBlockSize, end - i);
+      for (int64_t j = 0; j < n * kRandoms; j++) {
+        randoms[j] = engine();
+      }
+      scalar_t* out = data + i;
+      for (int64_t j = 0; j < n; j++) {
+        out[j] = transform(randoms + j * kRandoms);
+      }
+    }
+  });
+}
+
+// Uniform samples in [from, to) for float and double
+template <typename scalar_t>
+void philox_uniform_fill(
+    scalar_t* data,
+    int64_t numel,
+    CPUGenerator* generator,
+    double from,
+    double to) {
+  using accscalar_t = dist_acctype<scalar_t>;
+  const accscalar_t a = from;
+  const accscalar_t range = to - from;
+  if (std::is_same<scalar_t, double>::value) {
+    philox_fill<2>(data, numel, generator, [=](const uint32_t* randoms) {
+      return static_cast<scalar_t>(philox::uniform_double(randoms) * range + a);
+    });
+  } else {
+    philox_fill<1>(data, numel, generator, [=](const uint32_t* randoms) {
+      return static_cast<scalar_t>(philox::uniform_float(randoms[0]) * range + a);
+    });
+  }
+}
+
+// Normal samples for float and double, by the Box-Muller transform of two
+// uniform samples per element
+template <typename scalar_t>
+void philox_normal_fill(
+    scalar_t* data,
+    int64_t numel,
+    CPUGenerator* generator,
+    double mean,
+    double stddev) {
+  using accscalar_t = dist_acctype<scalar_t>;
+  const accscalar_t m = mean;
+  const accscalar_t s = stddev;
+  if (std::is_same<scalar_t, double>::value) {
+    philox_fill<4>(data, numel, generator, [=](const uint32_t* randoms) {
+      const double u1 = philox::uniform_double(randoms);
+      const double u2 = philox::uniform_double(randoms + 2);
+      const double r = ::sqrt(-2.0 * ::log(1.0 - u2));
+      return static_cast<scalar_t>(r * ::cos(2.0 * M_PI * u1) * s + m);
+    });
+  } else {
+    philox_fill<2>(data, numel, generator, [=](const uint32_t* randoms) {
+      const float u1 = philox::uniform_float(randoms[0]);
+      const float u2 = philox::uniform_float(randoms[1]);
+      const float r = ::sqrtf(-2.0f * ::logf(1.0f - u2));
+      return static_cast<scalar_t>(r * ::cosf(2.0f * static_cast<float>(M_PI) * u1) * s + m);
+    });
+  }
+}
+
+// Bernoulli samples with probability p, for any type
+template <typename scalar_t>
+void philox_bernoulli_fill(
+    scalar_t* data,
+    int64_t numel,
+    CPUGenerator* generator,
+    double p) {
+  philox_fill<2>(data, numel, generator, [=](const uint32_t* randoms) {
+    return static_cast<scalar_t>(philox::uniform_double(randoms) < p);
+  });
+}
+
+}} // namespace at::native
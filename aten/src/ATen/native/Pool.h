@@ -2,6 +2,7 @@
 #include <ATen/Parallel.h>
 #include <ATen/NativeFunctions.h>
 #include <ATen/div_rtn.h>
+#include <ATen/native/DispatchStub.h>
 #include <tuple>
 
 #pragma once
@@ -258,5 +259,25 @@ avg_pool3d_backward_shape_check(
 
 } // namespace
 
+// Kernels of the 2D pooling ops for 4D channels-last (NHWC) tensors. All
+// tensors passed to them are channels-last contiguous, and the indices of
+// max pooling are offsets into an input plane, as in the NCHW kernels.
+using max_pool2d_nhwc_fn = void(*)(Tensor& output, Tensor& indices, const Tensor& input,
+                                   int kW, int kH, int dW, int dH, int padW, int padH,
+                                   int dilationW, int dilationH);
+using max_pool2d_backward_nhwc_fn = void(*)(Tensor& gradInput, const Tensor& gradOutput,
+                                            const Tensor& indices);
+using avg_pool2d_nhwc_fn = void(*)(Tensor& output, const Tensor& input,
+                                   int kW, int kH, int dW, int dH, int padW, int padH,
+                                   bool count_include_pad, c10::optional<int64_t> divisor_override);
+using avg_pool2d_backward_nhwc_fn = void(*)(Tensor& gradInput, const Tensor& gradOutput,
+                                            int kW, int kH, int dW, int dH, int padW, int padH,
+                                            bool count_include_pad, c10::optional<int64_t> divisor_override);
+
+DECLARE_DISPATCH(max_pool2d_nhwc_fn, max_pool2d_nhwc_stub);
+DECLARE_DISPATCH(max_pool2d_backward_nhwc_fn, max_pool2d_backward_nhwc_stub);
+DECLARE_DISPATCH(avg_pool2d_nhwc_fn, avg_pool2d_nhwc_stub);
+DECLARE_DISPATCH(avg_pool2d_backward_nhwc_fn, avg_pool2d_backward_nhwc_stub);
+
 } // at::native
 } // at
@@ -57,6 +57,15 @@ inline TensorImpl* resize_impl_cpu_(
   return self;
 }
 
+// Resizes a 4D `self` to `size` with channels-last strides. Like resize_,
+// it keeps the storage of `self` when it is large enough.
+static inline void resize_channels_last_(Tensor& self, IntArrayRef size) {
+  self.resize_(size);
+  if (!self.is_contiguous(at::MemoryFormat::ChannelsLast)) {
+    self.unsafeGetTensorImpl()->empty_tensor_restride(at::MemoryFormat::ChannelsLast);
+  }
+}
+
 static inline void checkInBoundsForStorage(
     IntArrayRef size,
     IntArrayRef stride,
@@ -88,6 +88,9 @@ Tensor to_dense_backward(const Tensor& grad, const Tensor& input_) {
     return grad.sparse_mask(input);
   } else if (input_.layout() == c10::kMkldnn) {
     return grad.to_mkldnn();
+  } else if (input_.layout() == c10::kSparseCsr) {
+    auto input = input_.to_sparse().coalesce();
+    return grad.sparse_mask(input).to_sparse_csr();
   } else {
     AT_ERROR("Unsupported input layout: ", input_.layout());
   }
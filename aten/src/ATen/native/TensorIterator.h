@@ -244,6 +244,11 @@ struct CAFFE2_API TensorIterator {
 
   void parallel_reduce(const loop2d_t& loop);
 
+  /// Reorders the dimensions of a reduction so that its inner loop reads the
+  /// input in memory order. Afterwards reduced and non-reduced dimensions may
+  /// be interleaved, so this is only meant for serial iteration.
+  void reorder_reduction_loops();
+
   void serial_for_each(const loop_t& loop, Range range) const;
   void serial_for_each(const loop2d_t& loop, Range range) const;
 
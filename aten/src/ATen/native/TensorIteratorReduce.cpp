@@ -1,7 +1,9 @@
 #include <ATen/native/TensorIterator.h>
 #include <ATen/Parallel.h>
 #include <algorithm>
+#include <cstdlib>
 #include <memory>
+#include <numeric>
 
 /// Contains the implementation of parallel reductions in TensorIterator.
 
@@ -18,7 +20,9 @@ void TensorIterator::parallel_reduce(const loop2d_t& loop) {
   int64_t numel = this->numel();
   if (numel < at::internal::GRAIN_SIZE || at::get_num_threads() == 1 ||
       at::in_parallel_region()) {
-    serial_for_each(loop, {0, numel});
+    auto sub_iter = *this;
+    sub_iter.reorder_reduction_loops();
+    sub_iter.serial_for_each(loop, {0, numel});
   } else if (use_two_pass_reduction(*this)) {
     two_pass_reduction(*this, loop);
   } else {
@@ -26,8 +30,11 @@ void TensorIterator::parallel_reduce(const loop2d_t& loop) {
   }
 }
 
+/// Splitting the outputs among threads leaves some of them idle when there are
+/// fewer outputs than threads. Such reductions split the input instead, and
+/// combine the partial results of the threads afterwards.
 static bool use_two_pass_reduction(TensorIterator& iter) {
-  return iter.output(0).numel() == 1;
+  return iter.output(0).numel() < at::get_num_threads();
 }
 
 static void two_pass_reduction(TensorIterator& iter, const loop2d_t& loop) {
@@ -47,7 +54,10 @@ static void two_pass_reduction(TensorIterator& iter, const loop2d_t& loop) {
     auto slice = buffer[thread_num];
     slice.copy_(dst);
 
+    // Every thread reorders its iterator the same way, so the ranges still
+    // partition the input.
     auto sub_iter = TensorIterator::reduce_op(slice, iter.input(0));
+    sub_iter.reorder_reduction_loops();
     sub_iter.serial_for_each(loop, {begin, end});
   });
 
@@ -58,8 +68,29 @@ static void two_pass_reduction(TensorIterator& iter, const loop2d_t& loop) {
     }
   }
 
+  // Combine the partial results pairwise, as a tree: every level halves the
+  // number of partial results. This keeps the rounding error of sums growing
+  // with the log of the number of threads, and combines large outputs in
+  // parallel.
+  const int64_t output_numel = dst.numel();
+  for (int64_t step = 1; step < max_threads; step *= 2) {
+    const int64_t pairs = (max_threads + 2 * step - 1) / (2 * step);
+    const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, output_numel));
+    at::parallel_for(0, pairs, grain_size, [&](int64_t begin, int64_t end) {
+      for (int64_t pair = begin; pair < end; pair++) {
+        const int64_t left = pair * 2 * step;
+        const int64_t right = left + step;
+        if (right < max_threads) {
+          auto slice = buffer[left];
+          auto combine = TensorIterator::reduce_op(slice, buffer[right]);
+          combine.serial_for_each(loop, {0, combine.numel()});
+        }
+      }
+    });
+  }
+
   auto unsqueezed = dst.unsqueeze(0);
-  auto final_reduce = TensorIterator::reduce_op(unsqueezed, buffer);
+  auto final_reduce = TensorIterator::reduce_op(unsqueezed, buffer.narrow(0, 0, 1));
   final_reduce.for_each(loop);
 }
 
@@ -112,10 +143,42 @@ static void parallel_dim_reduction(TensorIterator& iter, const loop2d_t& loop) {
     }
     auto sub_iter = TensorIterator(iter);
     sub_iter.narrow(dim, begin, end - begin);
-    sub_iter.for_each(loop);
+    sub_iter.reorder_reduction_loops();
+    sub_iter.serial_for_each(loop, {0, sub_iter.numel()});
   });
 }
 
+void TensorIterator::reorder_reduction_loops() {
+  // Reduced dimensions come first, ordered by their input strides, so dim 0
+  // is the reduced dimension that is closest together in memory. If it is
+  // not contiguous, the inner loop walks the input with a large stride for
+  // every output. Pairing it with the dimension of smallest input stride
+  // instead, usually a non-reduced one, lets the loop read the input row by
+  // row (and vectorize it as an outer reduction).
+  if (ndim() < 3 || !is_dim_reduced(0)) {
+    return;
+  }
+  const auto& input_strides = operands_[num_outputs_].stride_bytes;
+  if (input_strides[0] == element_size(num_outputs_)) {
+    return;
+  }
+  int best_dim = 1;
+  for (int dim = 2; dim < ndim(); dim++) {
+    if (shape_[dim] > 1 &&
+        std::abs(input_strides[dim]) < std::abs(input_strides[best_dim])) {
+      best_dim = dim;
+    }
+  }
+  if (best_dim == 1 || std::abs(input_strides[best_dim]) >= std::abs(input_strides[0])) {
+    return;
+  }
+  // Move best_dim to position 1, keeping the order of the others.
+  DimVector perm(ndim());
+  std::iota(perm.begin(), perm.end(), 0);
+  std::rotate(perm.begin() + 1, perm.begin() + best_dim, perm.begin() + best_dim + 1);
+  permute_dimensions(perm);
+}
+
 void TensorIterator::foreach_reduced_elt(const loop_subiter_t &loop, bool parallelize) {
   AT_ASSERT(ninputs() == 1);
   AT_ASSERT(noutputs() >= 1);
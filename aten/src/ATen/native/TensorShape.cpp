@@ -850,6 +850,11 @@ Tensor transpose(const Tensor & self, int64_t dim0, int64_t dim1) {
     return at::_mkldnn_transpose(self, dim0, dim1);
   }
 
+  if (self.is_sparse_csr()) {
+    // sparse CSR tensors are always 2-D, so this swaps rows and columns
+    return at::_sparse_csr_transpose(self);
+  }
+
   auto strides = self.strides().vec();
   auto sizes = self.sizes().vec();
   std::swap(strides[dim0], strides[dim1]);
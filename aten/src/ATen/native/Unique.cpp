@@ -2,122 +2,119 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/ParallelSort.h>
 
-#include <set>
+#include <numeric>
 #include <tuple>
-#include <unordered_map>
-#include <unordered_set>
+#include <vector>
 
 namespace at {
 namespace native{
 
 namespace {
 
+// Finds the runs of equal elements of `data`, which holds the elements of
+// `input` in the order given by `order`, or in their own order if `order` is
+// null. Returns the first element of every run, the index of the run of every
+// input element, and the length of every run. Each chunk counts the runs that
+// start in it, so that a scan of the counts numbers the runs of every chunk
+// and the chunks can be processed in parallel.
 template <typename scalar_t>
-std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
-    const Tensor& self,
-    const bool sorted,
+std::tuple<Tensor, Tensor, Tensor> unique_runs(
+    const Tensor& input,
+    const scalar_t* data,
+    const int64_t* order,
     const bool return_inverse,
     const bool return_counts) {
-  const Tensor& input = self.contiguous();
-  const scalar_t* input_data = input.data_ptr<scalar_t>();
-  int64_t numel = input.numel();
-  Tensor output;
-  Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
-  Tensor counts = at::empty({0}, self.options().dtype(kLong));
-
-  std::unordered_set<scalar_t> set(input_data, input_data + numel);
-  output = at::empty({static_cast<int64_t>(set.size())}, input.options());
-  scalar_t *output_data = output.data_ptr<scalar_t>();
-
-  if (sorted) {
-    std::vector<scalar_t> vec(set.begin(), set.end());
-    std::sort(vec.begin(), vec.end());
-    std::copy(vec.begin(), vec.end(), output_data);
-  } else {
-    std::copy(set.begin(), set.end(), output_data);
-  }
-
-  if (return_inverse || return_counts) {
-    inverse_indices.resize_(input.sizes());
-    int64_t* inverse_indices_data = inverse_indices.data_ptr<int64_t>();
-    std::unordered_map<scalar_t, int64_t> inverse_map;
-    inverse_map.reserve(output.numel());
-    for (int64_t i = 0; i < output.numel(); ++i) {
-      inverse_map[output_data[i]] = i;
-    }
-    for(int64_t i = 0; i < numel; ++i) {
-      inverse_indices_data[i] = inverse_map[input_data[i]];
-    }
-    if (return_counts) {
-      std::unordered_map<scalar_t, int64_t> counts_map;
-      counts_map.reserve(output.numel());
-      for (int64_t i = 0; i < output.numel(); ++i) {
-        counts_map[output_data[i]] = 0;
-      }
-      for(int64_t i = 0; i < numel; i++) {
-        counts_map[input_data[i]] += 1;
+  const int64_t numel = input.numel();
+  const int64_t num_chunks = std::max<int64_t>(
+      1, std::min<int64_t>(at::get_num_threads(), numel / at::internal::GRAIN_SIZE));
+  const int64_t chunk_size = std::max<int64_t>(1, divup(numel, num_chunks));
+  auto is_run_start = [&](int64_t i) {
+    return i == 0 || data[i] != data[i - 1];
+  };
+
+  std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t c = chunk_begin; c < chunk_end; c++) {
+      int64_t runs = 0;
+      for (int64_t i = c * chunk_size; i < std::min(numel, (c + 1) * chunk_size); i++) {
+        runs += is_run_start(i);
       }
-      counts.resize_(output.sizes());
-      counts.fill_(0);
-      int64_t *counts_data = counts.data_ptr<int64_t>();
-      for(int64_t i = 0; i < output.numel(); i++) {
-        counts_data[i] = counts_map[output_data[i]];
+      chunk_offsets[c + 1] = runs;
+    }
+  });
+  std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+  const int64_t num_runs = chunk_offsets[num_chunks];
+
+  Tensor output = at::empty({num_runs}, input.options());
+  Tensor inverse_indices = at::empty({0}, input.options().dtype(kLong));
+  Tensor counts = at::empty({0}, input.options().dtype(kLong));
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* inverse_data = nullptr;
+  if (return_inverse) {
+    inverse_indices.resize_(input.sizes());
+    inverse_data = inverse_indices.data_ptr<int64_t>();
+  }
+  std::vector<int64_t> run_starts(return_counts ? num_runs + 1 : 0);
+
+  at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t c = chunk_begin; c < chunk_end; c++) {
+      int64_t run = chunk_offsets[c] - 1;
+      for (int64_t i = c * chunk_size; i < std::min(numel, (c + 1) * chunk_size); i++) {
+        if (is_run_start(i)) {
+          output_data[++run] = data[i];
+          if (return_counts) {
+            run_starts[run] = i;
+          }
+        }
+        if (return_inverse) {
+          inverse_data[order ? order[i] : i] = run;
+        }
       }
     }
+  });
+
+  if (return_counts) {
+    run_starts[num_runs] = numel;
+    counts.resize_({num_runs});
+    int64_t* counts_data = counts.data_ptr<int64_t>();
+    at::parallel_for(0, num_runs, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+      for (int64_t run = begin; run < end; run++) {
+        counts_data[run] = run_starts[run + 1] - run_starts[run];
+      }
+    });
   }
   return std::make_tuple(output, inverse_indices, counts);
 }
 
+// The output is sorted whether or not `sorted` is set: equal elements are
+// found by sorting the input in parallel, which is faster than hashing it on
+// one thread.
 template <typename scalar_t>
-std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_template(
+std::tuple<Tensor, Tensor, Tensor> unique_cpu_template(
     const Tensor& self,
+    const bool sorted,
     const bool return_inverse,
     const bool return_counts) {
   const Tensor& input = self.contiguous();
   const scalar_t* input_data = input.data_ptr<scalar_t>();
   int64_t numel = input.numel();
-  Tensor output = at::empty({numel}, input.options());
-  Tensor inverse_indices = at::empty({0}, self.options().dtype(kLong));
-  Tensor counts = at::empty({0}, self.options().dtype(kLong));
-
-  scalar_t *output_data = output.data_ptr<scalar_t>();
-  int64_t *inverse_data = nullptr;
-  int64_t *counts_data = nullptr;
-  if (numel > 0) {
-    *output_data = *input_data;
-  }
-  if (return_inverse) {
-    inverse_indices.resize_(input.sizes());
-    inverse_data = inverse_indices.data_ptr<int64_t>();
-  }
-  if (return_counts) {
-    counts.resize_(input.sizes());
-    counts_data = counts.data_ptr<int64_t>();
-  }
-  scalar_t *p = output_data;
-  int64_t *q = counts_data;
-  int64_t last = 0;
-  for (int64_t i = 0; i < numel; i++) {
-    if (input_data[i] != *p) {
-      *(++p) = input_data[i];
-      if (return_counts) {
-        *(q++) = i - last;
-        last = i;
-      }
-    }
-    if (return_inverse) {
-      inverse_data[i] = p - output_data;
-    }
-  }
-  int64_t output_size = p - output_data + 1;
-  if (return_counts && numel > 0) {
-    *q = numel - last;
-    counts.resize_({output_size});
-  }
-  output.resize_({output_size});
 
-  return std::make_tuple(output, inverse_indices, counts);
+  std::vector<scalar_t> sorted_data(numel);
+  std::vector<int64_t> order(numel);
+  sort_with_indices(input_data, numel, /*descending=*/false, sorted_data.data(), order.data());
+  return unique_runs<scalar_t>(input, sorted_data.data(), order.data(), return_inverse, return_counts);
+}
+
+template <typename scalar_t>
+std::tuple<Tensor, Tensor, Tensor> unique_consecutive_cpu_template(
+    const Tensor& self,
+    const bool return_inverse,
+    const bool return_counts) {
+  const Tensor& input = self.contiguous();
+  return unique_runs<scalar_t>(input, input.data_ptr<scalar_t>(), nullptr, return_inverse, return_counts);
 }
 
 template<class ForwardIt>
@@ -187,7 +184,7 @@ std::tuple<Tensor, Tensor, Tensor> _unique_dim_cpu_template(
 
   // sort indices using data
   if (!consecutive) {
-    std::sort(indices.begin(), indices.end(),
+    merge_sort(indices.data(), indices.size(),
       [&](int64_t a, int64_t b) -> bool {
         for (int64_t i = 0; i < numel; ++i) {
           scalar_t lhs = input_flat_ptr[i + a * numel];
@@ -199,15 +196,15 @@ std::tuple<Tensor, Tensor, Tensor> _unique_dim_cpu_template(
           }
         }
         return false;
-      });
+      },
+      // a comparison may read whole rows
+      std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, numel)));
   }
 
   Tensor input_sorted;
   if (!consecutive) {
-    input_sorted = at::empty(input_flat.sizes(), input_flat.options());
-    for (size_t i = 0; i < indices.size(); ++i) {
-      input_sorted[i] = input_flat[indices[i]];
-    }
+    input_sorted = input_flat.index_select(
+        0, at::from_blob(indices.data(), {static_cast<int64_t>(indices.size())}, kLong));
   } else {
     input_sorted = input_flat;
   }
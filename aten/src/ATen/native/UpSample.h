@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/TensorUtils.h>
+#include <ATen/native/DispatchStub.h>
 
 namespace at {
 namespace native {
@@ -237,5 +238,10 @@ static inline scalar_t cubic_interp1d(
   return x0 * coeffs[0] + x1 * coeffs[1] + x2 * coeffs[2] + x3 * coeffs[3];
 }
 
+// (output, input, align_corners): bilinear upsampling of a channels-last
+// contiguous input into a channels-last contiguous output.
+using upsample_bilinear2d_nhwc_fn = void(*)(Tensor&, const Tensor&, bool);
+DECLARE_DISPATCH(upsample_bilinear2d_nhwc_fn, upsample_bilinear2d_nhwc_stub);
+
 } // namespace native
 } // namespace at
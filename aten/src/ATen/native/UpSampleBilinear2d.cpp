@@ -3,6 +3,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/NativeFunctions.h>
+#include <ATen/native/Resize.h>
 #include <ATen/native/UpSample.h>
 
 namespace at {
@@ -182,6 +183,15 @@ static void upsample_bilinear2d_out_cpu_template(
       output_height,
       output_width);
 
+  if (input_.suggest_memory_format() == at::MemoryFormat::ChannelsLast &&
+      input_.scalar_type() != at::ScalarType::Half) {
+    // channels last input keeps its format in the output
+    resize_channels_last_(output, {nbatch, channels, output_height, output_width});
+    upsample_bilinear2d_nhwc_stub(
+        kCPU, output, input_.contiguous(at::MemoryFormat::ChannelsLast), align_corners);
+    return;
+  }
+
   auto input = input_.contiguous();
 
   output.resize_({nbatch, channels, output_height, output_width});
@@ -266,6 +276,8 @@ static void upsample_bilinear2d_backward_out_cpu_template(
 }
 } // namespace
 
+DEFINE_DISPATCH(upsample_bilinear2d_nhwc_stub);
+
 Tensor& upsample_bilinear2d_out_cpu(
     Tensor& output,
     const Tensor& input,
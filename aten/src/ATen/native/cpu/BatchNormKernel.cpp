@@ -0,0 +1,225 @@
+#include <ATen/native/cpu/BatchNormKernel.h>
+
+#include <algorithm>
+#include <vector>
+
+#include <ATen/AccumulateType.h>
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// A channels-last input is a [rows, channels] matrix with rows = N * H * W.
+// Per-channel reductions sum chunks of rows in parallel into partial rows of
+// accumulators, which are then added up in order.
+template <typename acc_t, typename F>
+void reduce_rows(int64_t rows, int64_t channels, acc_t* result, const F& f) {
+  const int64_t max_chunks = 4 * at::get_num_threads();
+  const int64_t chunk_rows = std::max(
+      divup(rows, max_chunks),
+      std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, channels)));
+  const int64_t chunks = divup(rows, chunk_rows);
+  std::vector<acc_t> partial(chunks * channels, acc_t(0));
+  at::parallel_for(0, chunks, 1, [&](int64_t begin, int64_t end) {
+    for (int64_t chunk = begin; chunk < end; chunk++) {
+      f(chunk * chunk_rows,
+        std::min(rows, (chunk + 1) * chunk_rows),
+        partial.data() + chunk * channels);
+    }
+  });
+  std::fill(result, result + channels, acc_t(0));
+  for (int64_t chunk = 0; chunk < chunks; chunk++) {
+    for (int64_t c = 0; c < channels; c++) {
+      result[c] += partial[chunk * channels + c];
+    }
+  }
+}
+
+template <typename scalar_t>
+void batch_norm_nhwc_collect_stats(Tensor& mean, Tensor& var_sum, const Tensor& input) {
+  using accscalar_t = at::acc_type<scalar_t, false>;
+  const int64_t channels = input.size(1);
+  const int64_t rows = input.numel() / channels;
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* mean_data = mean.data_ptr<scalar_t>();
+  scalar_t* var_sum_data = var_sum.data_ptr<scalar_t>();
+
+  std::vector<accscalar_t> sum(channels);
+  reduce_rows(rows, channels, sum.data(), [&](int64_t begin, int64_t end, accscalar_t* acc) {
+    for (int64_t r = begin; r < end; r++) {
+      const scalar_t* row = input_data + r * channels;
+      for (int64_t c = 0; c < channels; c++) {
+        acc[c] += row[c];
+      }
+    }
+  });
+  for (int64_t c = 0; c < channels; c++) {
+    mean_data[c] = sum[c] / rows;
+  }
+
+  reduce_rows(rows, channels, sum.data(), [&](int64_t begin, int64_t end, accscalar_t* acc) {
+    for (int64_t r = begin; r < end; r++) {
+      const scalar_t* row = input_data + r * channels;
+      for (int64_t c = 0; c < channels; c++) {
+        const accscalar_t d = row[c] - mean_data[c];
+        acc[c] += d * d;
+      }
+    }
+  });
+  for (int64_t c = 0; c < channels; c++) {
+    var_sum_data[c] = sum[c];
+  }
+}
+
+static void batch_norm_nhwc_collect_stats_kernel(Tensor& mean, Tensor& var_sum, const Tensor& input) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_nhwc_collect_stats", [&] {
+    batch_norm_nhwc_collect_stats<scalar_t>(mean, var_sum, input);
+  });
+}
+
+template <typename scalar_t>
+void batch_norm_nhwc_transform(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& alpha,
+    const Tensor& beta) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t channels = input.size(1);
+  const int64_t rows = input.numel() / channels;
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* alpha_data = alpha.data_ptr<scalar_t>();
+  const scalar_t* beta_data = beta.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / channels);
+  at::parallel_for(0, rows, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const scalar_t* in = input_data + r * channels;
+      scalar_t* out = output_data + r * channels;
+      int64_t c = 0;
+      for (; c + Vec::size() <= channels; c += Vec::size()) {
+        vec256::fmadd(Vec::loadu(in + c), Vec::loadu(alpha_data + c), Vec::loadu(beta_data + c))
+            .store(out + c);
+      }
+      for (; c < channels; c++) {
+        out[c] = in[c] * alpha_data[c] + beta_data[c];
+      }
+    }
+  });
+}
+
+static void batch_norm_nhwc_transform_kernel(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& alpha,
+    const Tensor& beta) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_nhwc_transform", [&] {
+    batch_norm_nhwc_transform<scalar_t>(output, input, alpha, beta);
+  });
+}
+
+template <typename scalar_t>
+void batch_norm_nhwc_backward_reduce(
+    Tensor& sum_dy,
+    Tensor& dot_p,
+    const Tensor& grad_out,
+    const Tensor& input,
+    const Tensor& mean) {
+  using accscalar_t = at::acc_type<scalar_t, false>;
+  const int64_t channels = input.size(1);
+  const int64_t rows = input.numel() / channels;
+  const scalar_t* grad_out_data = grad_out.data_ptr<scalar_t>();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* mean_data = mean.data_ptr<scalar_t>();
+
+  // Both sums are taken in one pass, as two halves of one accumulator row.
+  std::vector<accscalar_t> sums(2 * channels);
+  reduce_rows(rows, 2 * channels, sums.data(), [&](int64_t begin, int64_t end, accscalar_t* acc) {
+    for (int64_t r = begin; r < end; r++) {
+      const scalar_t* go = grad_out_data + r * channels;
+      const scalar_t* in = input_data + r * channels;
+      for (int64_t c = 0; c < channels; c++) {
+        acc[c] += go[c];
+        acc[channels + c] += (in[c] - mean_data[c]) * go[c];
+      }
+    }
+  });
+  scalar_t* sum_dy_data = sum_dy.data_ptr<scalar_t>();
+  scalar_t* dot_p_data = dot_p.data_ptr<scalar_t>();
+  for (int64_t c = 0; c < channels; c++) {
+    sum_dy_data[c] = sums[c];
+    dot_p_data[c] = sums[channels + c];
+  }
+}
+
+static void batch_norm_nhwc_backward_reduce_kernel(
+    Tensor& sum_dy,
+    Tensor& dot_p,
+    const Tensor& grad_out,
+    const Tensor& input,
+    const Tensor& mean) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_nhwc_backward_reduce", [&] {
+    batch_norm_nhwc_backward_reduce<scalar_t>(sum_dy, dot_p, grad_out, input, mean);
+  });
+}
+
+template <typename scalar_t>
+void batch_norm_nhwc_backward_elemt(
+    Tensor& grad_input,
+    const Tensor& grad_out,
+    const Tensor& input,
+    const Tensor& a,
+    const Tensor& b,
+    const Tensor& d) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t channels = input.size(1);
+  const int64_t rows = input.numel() / channels;
+  const scalar_t* grad_out_data = grad_out.data_ptr<scalar_t>();
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* a_data = a.data_ptr<scalar_t>();
+  const scalar_t* b_data = b.data_ptr<scalar_t>();
+  const scalar_t* d_data = d.data_ptr<scalar_t>();
+  scalar_t* grad_input_data = grad_input.data_ptr<scalar_t>();
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / channels);
+  at::parallel_for(0, rows, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const scalar_t* go = grad_out_data + r * channels;
+      const scalar_t* in = input_data + r * channels;
+      scalar_t* gi = grad_input_data + r * channels;
+      int64_t c = 0;
+      for (; c + Vec::size() <= channels; c += Vec::size()) {
+        Vec result = vec256::fmadd(Vec::loadu(in + c), Vec::loadu(b_data + c), Vec::loadu(d_data + c));
+        vec256::fmadd(Vec::loadu(go + c), Vec::loadu(a_data + c), result).store(gi + c);
+      }
+      for (; c < channels; c++) {
+        gi[c] = go[c] * a_data[c] + in[c] * b_data[c] + d_data[c];
+      }
+    }
+  });
+}
+
+static void batch_norm_nhwc_backward_elemt_kernel(
+    Tensor& grad_input,
+    const Tensor& grad_out,
+    const Tensor& input,
+    const Tensor& a,
+    const Tensor& b,
+    const Tensor& d) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "batch_norm_nhwc_backward_elemt", [&] {
+    batch_norm_nhwc_backward_elemt<scalar_t>(grad_input, grad_out, input, a, b, d);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(batch_norm_nhwc_collect_stats_stub, &batch_norm_nhwc_collect_stats_kernel);
+REGISTER_DISPATCH(batch_norm_nhwc_transform_stub, &batch_norm_nhwc_transform_kernel);
+REGISTER_DISPATCH(batch_norm_nhwc_backward_reduce_stub, &batch_norm_nhwc_backward_reduce_kernel);
+REGISTER_DISPATCH(batch_norm_nhwc_backward_elemt_stub, &batch_norm_nhwc_backward_elemt_kernel);
+
+}} // namespace at::native
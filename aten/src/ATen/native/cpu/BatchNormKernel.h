@@ -0,0 +1,29 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Kernels of batch_norm on CPU for channels-last (NHWC) inputs. Every input
+// and output is a channels-last contiguous 4D tensor, or a contiguous [C]
+// tensor of per-channel values.
+
+// (mean, var_sum, input): mean(c) and sum of (input - mean(c))^2.
+using batch_norm_nhwc_collect_stats_fn = void(*)(Tensor&, Tensor&, const Tensor&);
+// (output, input, alpha, beta): output = input * alpha(c) + beta(c).
+using batch_norm_nhwc_transform_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const Tensor&);
+// (sum_dy, dot_p, grad_out, input, mean): sum of grad_out and of
+// (input - mean(c)) * grad_out.
+using batch_norm_nhwc_backward_reduce_fn = void(*)(Tensor&, Tensor&, const Tensor&, const Tensor&, const Tensor&);
+// (grad_input, grad_out, input, a, b, d):
+// grad_input = grad_out * a(c) + input * b(c) + d(c).
+using batch_norm_nhwc_backward_elemt_fn = void(*)(
+    Tensor&, const Tensor&, const Tensor&, const Tensor&, const Tensor&, const Tensor&);
+
+DECLARE_DISPATCH(batch_norm_nhwc_collect_stats_fn, batch_norm_nhwc_collect_stats_stub);
+DECLARE_DISPATCH(batch_norm_nhwc_transform_fn, batch_norm_nhwc_transform_stub);
+DECLARE_DISPATCH(batch_norm_nhwc_backward_reduce_fn, batch_norm_nhwc_backward_reduce_stub);
+DECLARE_DISPATCH(batch_norm_nhwc_backward_elemt_fn, batch_norm_nhwc_backward_elemt_stub);
+
+}} // namespace at::native
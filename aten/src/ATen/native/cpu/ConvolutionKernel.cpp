@@ -0,0 +1,494 @@
+#include <ATen/native/cpu/ConvolutionKernel.h>
+
+#include <algorithm>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Number of output channels and of vectors of output pixels that the
+// pointwise kernel keeps in registers: 4 x 2 accumulators, plus the 2 input
+// vectors and the broadcast weight, fit in the 16 AVX registers.
+constexpr int64_t kPointwiseChannelBlock = 4;
+constexpr int64_t kPointwiseVectorBlock = 2;
+
+// Accumulates a kPointwiseChannelBlock x (kPointwiseVectorBlock * Vec::size())
+// block of output[co:co+4, p:p+2V] over all input channels.
+template <typename scalar_t>
+inline void pointwise_block(
+    scalar_t* out,
+    const scalar_t* in,
+    const scalar_t* w,
+    const scalar_t* b,
+    int64_t co,
+    int64_t p,
+    int64_t channels_in,
+    int64_t plane) {
+  using Vec = Vec256<scalar_t>;
+  Vec acc[kPointwiseChannelBlock][kPointwiseVectorBlock];
+  for (int64_t r = 0; r < kPointwiseChannelBlock; r++) {
+    Vec init(b ? b[co + r] : scalar_t(0));
+    for (int64_t j = 0; j < kPointwiseVectorBlock; j++) {
+      acc[r][j] = init;
+    }
+  }
+  for (int64_t ci = 0; ci < channels_in; ci++) {
+    const scalar_t* in_row = in + ci * plane + p;
+    Vec x0 = Vec::loadu(in_row);
+    Vec x1 = Vec::loadu(in_row + Vec::size());
+    for (int64_t r = 0; r < kPointwiseChannelBlock; r++) {
+      Vec wv(w[(co + r) * channels_in + ci]);
+      acc[r][0] = vec256::fmadd(wv, x0, acc[r][0]);
+      acc[r][1] = vec256::fmadd(wv, x1, acc[r][1]);
+    }
+  }
+  for (int64_t r = 0; r < kPointwiseChannelBlock; r++) {
+    scalar_t* out_row = out + (co + r) * plane + p;
+    acc[r][0].store(out_row);
+    acc[r][1].store(out_row + Vec::size());
+  }
+}
+
+// Scalar fallback for the output channels and pixels left over by the blocks.
+template <typename scalar_t>
+inline void pointwise_scalar(
+    scalar_t* out,
+    const scalar_t* in,
+    const scalar_t* w,
+    const scalar_t* b,
+    int64_t co,
+    int64_t p_begin,
+    int64_t p_end,
+    int64_t channels_in,
+    int64_t plane) {
+  scalar_t* out_row = out + co * plane;
+  const scalar_t* w_row = w + co * channels_in;
+  for (int64_t p = p_begin; p < p_end; p++) {
+    out_row[p] = b ? b[co] : scalar_t(0);
+  }
+  for (int64_t ci = 0; ci < channels_in; ci++) {
+    const scalar_t* in_row = in + ci * plane;
+    const scalar_t wv = w_row[ci];
+    for (int64_t p = p_begin; p < p_end; p++) {
+      out_row[p] += wv * in_row[p];
+    }
+  }
+}
+
+template <typename scalar_t>
+void conv2d_pointwise(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t batch = input.size(0);
+  const int64_t channels_in = input.size(1);
+  const int64_t channels_out = output.size(1);
+  const int64_t plane = input.size(2) * input.size(3);
+  const int64_t pixel_block = kPointwiseVectorBlock * Vec::size();
+  const int64_t co_blocked = channels_out - channels_out % kPointwiseChannelBlock;
+  const int64_t p_blocked = plane - plane % pixel_block;
+  const int64_t co_tasks = divup(channels_out, kPointwiseChannelBlock);
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+  const scalar_t* bias_data = bias.defined() ? bias.data_ptr<scalar_t>() : nullptr;
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  // One task computes kPointwiseChannelBlock output planes of one image, so
+  // that a batch of one still spreads over the output channels.
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / (kPointwiseChannelBlock * plane * channels_in));
+  parallel_for(0, batch * co_tasks, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t task = begin; task < end; task++) {
+      const int64_t n = task / co_tasks;
+      const int64_t co = (task % co_tasks) * kPointwiseChannelBlock;
+      const scalar_t* in = input_data + n * channels_in * plane;
+      scalar_t* out = output_data + n * channels_out * plane;
+      if (co < co_blocked) {
+        for (int64_t p = 0; p < p_blocked; p += pixel_block) {
+          pointwise_block(out, in, weight_data, bias_data, co, p, channels_in, plane);
+        }
+        for (int64_t r = 0; r < kPointwiseChannelBlock; r++) {
+          pointwise_scalar(out, in, weight_data, bias_data, co + r, p_blocked, plane, channels_in, plane);
+        }
+      } else {
+        for (int64_t c = co; c < channels_out; c++) {
+          pointwise_scalar(out, in, weight_data, bias_data, c, 0, plane, channels_in, plane);
+        }
+      }
+    }
+  });
+}
+
+static void conv2d_pointwise_kernel(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "conv2d_pointwise_cpu", [&] {
+    conv2d_pointwise<scalar_t>(output, input, weight, bias);
+  });
+}
+
+// Computes one output plane of a depthwise convolution. With unit stride,
+// the columns whose taps are all inside the input row are computed a vector
+// at a time; the borders and strided convolutions fall back to scalar code.
+template <typename scalar_t>
+inline void depthwise_plane(
+    scalar_t* out,
+    const scalar_t* in,
+    const scalar_t* w,
+    scalar_t b,
+    int64_t in_h,
+    int64_t in_w,
+    int64_t out_h,
+    int64_t out_w,
+    int64_t kernel_h,
+    int64_t kernel_w,
+    int64_t stride_h,
+    int64_t stride_w,
+    int64_t pad_h,
+    int64_t pad_w) {
+  using Vec = Vec256<scalar_t>;
+  // Output columns [ow_begin, ow_end) read only in-bounds input columns.
+  int64_t ow_begin = 0;
+  int64_t ow_end = 0;
+  if (stride_w == 1) {
+    ow_begin = std::min(pad_w, out_w);
+    ow_end = std::max(ow_begin, std::min(out_w, in_w + pad_w - kernel_w + 1));
+  }
+  for (int64_t oh = 0; oh < out_h; oh++) {
+    scalar_t* out_row = out + oh * out_w;
+    const int64_t ih0 = oh * stride_h - pad_h;
+    const int64_t kh_begin = std::max<int64_t>(0, -ih0);
+    const int64_t kh_end = std::min(kernel_h, in_h - ih0);
+
+    int64_t ow = ow_begin;
+    for (; ow + Vec::size() <= ow_end; ow += Vec::size()) {
+      Vec acc(b);
+      for (int64_t kh = kh_begin; kh < kh_end; kh++) {
+        const scalar_t* in_row = in + (ih0 + kh) * in_w + ow - pad_w;
+        const scalar_t* w_row = w + kh * kernel_w;
+        for (int64_t kw = 0; kw < kernel_w; kw++) {
+          acc = vec256::fmadd(Vec(w_row[kw]), Vec::loadu(in_row + kw), acc);
+        }
+      }
+      acc.store(out_row + ow);
+    }
+
+    auto scalar_column = [&](int64_t col) {
+      const int64_t iw0 = col * stride_w - pad_w;
+      const int64_t kw_begin = std::max<int64_t>(0, -iw0);
+      const int64_t kw_end = std::min(kernel_w, in_w - iw0);
+      scalar_t acc = b;
+      for (int64_t kh = kh_begin; kh < kh_end; kh++) {
+        const scalar_t* in_row = in + (ih0 + kh) * in_w;
+        const scalar_t* w_row = w + kh * kernel_w;
+        for (int64_t kw = kw_begin; kw < kw_end; kw++) {
+          acc += w_row[kw] * in_row[iw0 + kw];
+        }
+      }
+      out_row[col] = acc;
+    };
+    for (int64_t col = 0; col < ow_begin; col++) {
+      scalar_column(col);
+    }
+    for (int64_t col = ow; col < out_w; col++) {
+      scalar_column(col);
+    }
+  }
+}
+
+template <typename scalar_t>
+void conv2d_depthwise(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding) {
+  const int64_t batch = input.size(0);
+  const int64_t channels_in = input.size(1);
+  const int64_t in_h = input.size(2);
+  const int64_t in_w = input.size(3);
+  const int64_t channels_out = output.size(1);
+  const int64_t out_h = output.size(2);
+  const int64_t out_w = output.size(3);
+  const int64_t kernel_h = weight.size(2);
+  const int64_t kernel_w = weight.size(3);
+  // Each input channel feeds `multiplier` consecutive output channels.
+  const int64_t multiplier = channels_out / channels_in;
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+  const scalar_t* bias_data = bias.defined() ? bias.data_ptr<scalar_t>() : nullptr;
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / (out_h * out_w * kernel_h * kernel_w));
+  parallel_for(0, batch * channels_out, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t plane = begin; plane < end; plane++) {
+      const int64_t n = plane / channels_out;
+      const int64_t co = plane % channels_out;
+      const int64_t ci = co / multiplier;
+      depthwise_plane(
+          output_data + plane * out_h * out_w,
+          input_data + (n * channels_in + ci) * in_h * in_w,
+          weight_data + co * kernel_h * kernel_w,
+          bias_data ? bias_data[co] : scalar_t(0),
+          in_h, in_w, out_h, out_w, kernel_h, kernel_w,
+          stride[0], stride[1], padding[0], padding[1]);
+    }
+  });
+}
+
+static void conv2d_depthwise_kernel(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "conv2d_depthwise_cpu", [&] {
+    conv2d_depthwise<scalar_t>(output, input, weight, bias, stride, padding);
+  });
+}
+
+// In NHWC, an output pixel of a depthwise convolution is a weighted sum of
+// input pixels, so it is computed a vector of channels at a time when every
+// output channel reads its own input channel.
+template <typename scalar_t>
+void conv2d_depthwise_nhwc(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t batch = input.size(0);
+  const int64_t channels_in = input.size(1);
+  const int64_t in_h = input.size(2);
+  const int64_t in_w = input.size(3);
+  const int64_t channels_out = output.size(1);
+  const int64_t out_h = output.size(2);
+  const int64_t out_w = output.size(3);
+  const int64_t kernel_h = weight.size(0);
+  const int64_t kernel_w = weight.size(1);
+  const int64_t multiplier = channels_out / channels_in;
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  const scalar_t* weight_data = weight.data_ptr<scalar_t>();
+  const scalar_t* bias_data = bias.defined() ? bias.data_ptr<scalar_t>() : nullptr;
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  const int64_t grain_size =
+      std::max<int64_t>(1, internal::GRAIN_SIZE / (channels_out * kernel_h * kernel_w));
+  parallel_for(0, batch * out_h * out_w, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t pixel = begin; pixel < end; pixel++) {
+      const int64_t n = pixel / (out_h * out_w);
+      const int64_t oh = (pixel / out_w) % out_h;
+      const int64_t ow = pixel % out_w;
+      const int64_t ih0 = oh * stride[0] - padding[0];
+      const int64_t iw0 = ow * stride[1] - padding[1];
+      const int64_t kh_begin = std::max<int64_t>(0, -ih0);
+      const int64_t kh_end = std::min(kernel_h, in_h - ih0);
+      const int64_t kw_begin = std::max<int64_t>(0, -iw0);
+      const int64_t kw_end = std::min(kernel_w, in_w - iw0);
+
+      scalar_t* out = output_data + pixel * channels_out;
+      for (int64_t c = 0; c < channels_out; c++) {
+        out[c] = bias_data ? bias_data[c] : scalar_t(0);
+      }
+      for (int64_t kh = kh_begin; kh < kh_end; kh++) {
+        for (int64_t kw = kw_begin; kw < kw_end; kw++) {
+          const scalar_t* in = input_data +
+              ((n * in_h + ih0 + kh) * in_w + iw0 + kw) * channels_in;
+          const scalar_t* w = weight_data + (kh * kernel_w + kw) * channels_out;
+          if (multiplier == 1) {
+            int64_t c = 0;
+            for (; c + Vec::size() <= channels_out; c += Vec::size()) {
+              vec256::fmadd(Vec::loadu(w + c), Vec::loadu(in + c), Vec::loadu(out + c))
+                  .store(out + c);
+            }
+            for (; c < channels_out; c++) {
+              out[c] += w[c] * in[c];
+            }
+          } else {
+            for (int64_t c = 0; c < channels_out; c++) {
+              out[c] += w[c] * in[c / multiplier];
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+static void conv2d_depthwise_nhwc_kernel(
+    Tensor& output,
+    const Tensor& input,
+    const Tensor& weight,
+    const Tensor& bias,
+    IntArrayRef stride,
+    IntArrayRef padding) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "conv2d_depthwise_nhwc_cpu", [&] {
+    conv2d_depthwise_nhwc<scalar_t>(output, input, weight, bias, stride, padding);
+  });
+}
+
+// Winograd F(4x4, 3x3) computes a 4x4 output tile from a 6x6 input tile as
+// A^T [(G g G^T) * (B^T d B)] A. The weight transform G g G^T is done with
+// matmuls in DirectConvolution.cpp; the kernels below apply B^T . B to the
+// input tiles and A^T . A to the products.
+constexpr int64_t kWinogradTile = 6;
+constexpr int64_t kWinogradOutputTile = 4;
+
+template <typename scalar_t>
+void winograd_input_transform(Tensor& V, const Tensor& input, IntArrayRef padding) {
+  const int64_t batch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t in_h = input.size(2);
+  const int64_t in_w = input.size(3);
+  const int64_t tiles_h = divup(in_h + 2 * padding[0] - 2, kWinogradOutputTile);
+  const int64_t tiles_w = divup(in_w + 2 * padding[1] - 2, kWinogradOutputTile);
+  const int64_t tiles = batch * tiles_h * tiles_w;
+  // V is [36, channels, tiles]; element k of a tile is at k * element_stride.
+  const int64_t element_stride = channels * tiles;
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* v_data = V.data_ptr<scalar_t>();
+
+  parallel_for(0, channels * tiles, internal::GRAIN_SIZE / 64, [&](int64_t begin, int64_t end) {
+    scalar_t d[kWinogradTile][kWinogradTile];
+    scalar_t t[kWinogradTile][kWinogradTile];
+    for (int64_t index = begin; index < end; index++) {
+      const int64_t c = index / tiles;
+      const int64_t tile = index % tiles;
+      const int64_t n = tile / (tiles_h * tiles_w);
+      const int64_t th = (tile / tiles_w) % tiles_h;
+      const int64_t tw = tile % tiles_w;
+      const scalar_t* plane = input_data + (n * channels + c) * in_h * in_w;
+      const int64_t ih0 = th * kWinogradOutputTile - padding[0];
+      const int64_t iw0 = tw * kWinogradOutputTile - padding[1];
+      for (int64_t i = 0; i < kWinogradTile; i++) {
+        const int64_t ih = ih0 + i;
+        for (int64_t j = 0; j < kWinogradTile; j++) {
+          const int64_t iw = iw0 + j;
+          d[i][j] = (ih >= 0 && ih < in_h && iw >= 0 && iw < in_w)
+              ? plane[ih * in_w + iw]
+              : scalar_t(0);
+        }
+      }
+      // t = B^T d
+      for (int64_t j = 0; j < kWinogradTile; j++) {
+        t[0][j] = 4 * d[0][j] - 5 * d[2][j] + d[4][j];
+        t[1][j] = -4 * d[1][j] - 4 * d[2][j] + d[3][j] + d[4][j];
+        t[2][j] = 4 * d[1][j] - 4 * d[2][j] - d[3][j] + d[4][j];
+        t[3][j] = -2 * d[1][j] - d[2][j] + 2 * d[3][j] + d[4][j];
+        t[4][j] = 2 * d[1][j] - d[2][j] - 2 * d[3][j] + d[4][j];
+        t[5][j] = 4 * d[1][j] - 5 * d[3][j] + d[5][j];
+      }
+      // V = t B
+      scalar_t* v = v_data + c * tiles + tile;
+      for (int64_t i = 0; i < kWinogradTile; i++) {
+        scalar_t* row = v + i * kWinogradTile * element_stride;
+        row[0 * element_stride] = 4 * t[i][0] - 5 * t[i][2] + t[i][4];
+        row[1 * element_stride] = -4 * t[i][1] - 4 * t[i][2] + t[i][3] + t[i][4];
+        row[2 * element_stride] = 4 * t[i][1] - 4 * t[i][2] - t[i][3] + t[i][4];
+        row[3 * element_stride] = -2 * t[i][1] - t[i][2] + 2 * t[i][3] + t[i][4];
+        row[4 * element_stride] = 2 * t[i][1] - t[i][2] - 2 * t[i][3] + t[i][4];
+        row[5 * element_stride] = 4 * t[i][1] - 5 * t[i][3] + t[i][5];
+      }
+    }
+  });
+}
+
+static void winograd_input_transform_kernel(Tensor& V, const Tensor& input, IntArrayRef padding) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "winograd_input_transform_cpu", [&] {
+    winograd_input_transform<scalar_t>(V, input, padding);
+  });
+}
+
+template <typename scalar_t>
+void winograd_output_transform(Tensor& output, const Tensor& M, const Tensor& bias) {
+  const int64_t batch = output.size(0);
+  const int64_t channels = output.size(1);
+  const int64_t out_h = output.size(2);
+  const int64_t out_w = output.size(3);
+  const int64_t tiles_h = divup(out_h, kWinogradOutputTile);
+  const int64_t tiles_w = divup(out_w, kWinogradOutputTile);
+  const int64_t tiles = batch * tiles_h * tiles_w;
+  // M is [36, channels, tiles], laid out like V.
+  const int64_t element_stride = channels * tiles;
+
+  const scalar_t* m_data = M.data_ptr<scalar_t>();
+  const scalar_t* bias_data = bias.defined() ? bias.data_ptr<scalar_t>() : nullptr;
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  parallel_for(0, channels * tiles, internal::GRAIN_SIZE / 64, [&](int64_t begin, int64_t end) {
+    scalar_t m[kWinogradTile][kWinogradTile];
+    scalar_t t[kWinogradOutputTile][kWinogradTile];
+    for (int64_t index = begin; index < end; index++) {
+      const int64_t c = index / tiles;
+      const int64_t tile = index % tiles;
+      const int64_t n = tile / (tiles_h * tiles_w);
+      const int64_t th = (tile / tiles_w) % tiles_h;
+      const int64_t tw = tile % tiles_w;
+      const scalar_t* src = m_data + c * tiles + tile;
+      for (int64_t i = 0; i < kWinogradTile; i++) {
+        for (int64_t j = 0; j < kWinogradTile; j++) {
+          m[i][j] = src[(i * kWinogradTile + j) * element_stride];
+        }
+      }
+      // t = A^T m
+      for (int64_t j = 0; j < kWinogradTile; j++) {
+        t[0][j] = m[0][j] + m[1][j] + m[2][j] + m[3][j] + m[4][j];
+        t[1][j] = m[1][j] - m[2][j] + 2 * m[3][j] - 2 * m[4][j];
+        t[2][j] = m[1][j] + m[2][j] + 4 * m[3][j] + 4 * m[4][j];
+        t[3][j] = m[1][j] - m[2][j] + 8 * m[3][j] - 8 * m[4][j] + m[5][j];
+      }
+      // y = t A, clipped to the output plane.
+      const scalar_t b = bias_data ? bias_data[c] : scalar_t(0);
+      scalar_t* plane = output_data + (n * channels + c) * out_h * out_w;
+      const int64_t oh0 = th * kWinogradOutputTile;
+      const int64_t ow0 = tw * kWinogradOutputTile;
+      const int64_t rows = std::min(kWinogradOutputTile, out_h - oh0);
+      const int64_t cols = std::min(kWinogradOutputTile, out_w - ow0);
+      for (int64_t i = 0; i < rows; i++) {
+        scalar_t y[kWinogradOutputTile];
+        y[0] = t[i][0] + t[i][1] + t[i][2] + t[i][3] + t[i][4];
+        y[1] = t[i][1] - t[i][2] + 2 * t[i][3] - 2 * t[i][4];
+        y[2] = t[i][1] + t[i][2] + 4 * t[i][3] + 4 * t[i][4];
+        y[3] = t[i][1] - t[i][2] + 8 * t[i][3] - 8 * t[i][4] + t[i][5];
+        scalar_t* out_row = plane + (oh0 + i) * out_w + ow0;
+        for (int64_t j = 0; j < cols; j++) {
+          out_row[j] = y[j] + b;
+        }
+      }
+    }
+  });
+}
+
+static void winograd_output_transform_kernel(Tensor& output, const Tensor& M, const Tensor& bias) {
+  AT_DISPATCH_FLOATING_TYPES(output.scalar_type(), "winograd_output_transform_cpu", [&] {
+    winograd_output_transform<scalar_t>(output, M, bias);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(conv2d_pointwise_stub, &conv2d_pointwise_kernel);
+REGISTER_DISPATCH(conv2d_depthwise_stub, &conv2d_depthwise_kernel);
+REGISTER_DISPATCH(conv2d_depthwise_nhwc_stub, &conv2d_depthwise_nhwc_kernel);
+REGISTER_DISPATCH(winograd_input_transform_stub, &winograd_input_transform_kernel);
+REGISTER_DISPATCH(winograd_output_transform_stub, &winograd_output_transform_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <ATen/ATen.h>
+#include <ATen/native/DispatchStub.h>
+
+namespace at { namespace native {
+
+// Kernels of the CPU convolutions in DirectConvolution.cpp. All tensors are
+// contiguous, and bias may be undefined.
+
+// (output, input, weight, bias): 1x1 convolution with stride 1.
+using conv2d_pointwise_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const Tensor&);
+// (output, input, weight, bias, stride, padding): depthwise convolution. The
+// nhwc kernel takes channels-last input and output, and a weight permuted to
+// [kernel_h, kernel_w, out_channels].
+using conv2d_depthwise_fn = void(*)(Tensor&, const Tensor&, const Tensor&, const Tensor&, IntArrayRef, IntArrayRef);
+// (V, input, padding): Winograd F(4x4, 3x3) transform of the input tiles.
+using winograd_input_transform_fn = void(*)(Tensor&, const Tensor&, IntArrayRef);
+// (output, M, bias): Winograd F(4x4, 3x3) transform of the output tiles.
+using winograd_output_transform_fn = void(*)(Tensor&, const Tensor&, const Tensor&);
+
+DECLARE_DISPATCH(conv2d_pointwise_fn, conv2d_pointwise_stub);
+DECLARE_DISPATCH(conv2d_depthwise_fn, conv2d_depthwise_stub);
+DECLARE_DISPATCH(conv2d_depthwise_fn, conv2d_depthwise_nhwc_stub);
+DECLARE_DISPATCH(winograd_input_transform_fn, winograd_input_transform_stub);
+DECLARE_DISPATCH(winograd_output_transform_fn, winograd_output_transform_stub);
+
+}}  // namespace at::native
@@ -0,0 +1,297 @@
+#include <ATen/native/FusedOptimizers.h>
+
+#include <algorithm>
+#include <unordered_set>
+#include <vector>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Splits every tensor of the list into chunks and runs f(tensor, begin, end)
+// on the chunks in parallel, so that many small parameters share a thread and
+// a single large (or flattened) parameter spreads over all of them. A tensor
+// that is listed more than once (a tied parameter) is only visited at its
+// first position, so it is neither updated twice nor from two threads.
+template <typename F>
+void multi_tensor_apply(TensorList tensors, const F& f) {
+  constexpr int64_t kChunkSize = 4096;
+  struct Chunk {
+    size_t tensor;
+    int64_t begin;
+    int64_t end;
+  };
+  std::vector<Chunk> chunks;
+  std::unordered_set<const TensorImpl*> seen;
+  int64_t numel = 0;
+  for (size_t t = 0; t < tensors.size(); t++) {
+    if (!seen.insert(tensors[t].unsafeGetTensorImpl()).second) {
+      continue;
+    }
+    const int64_t size = tensors[t].numel();
+    for (int64_t begin = 0; begin < size; begin += kChunkSize) {
+      chunks.push_back({t, begin, std::min(size, begin + kChunkSize)});
+    }
+    numel += size;
+  }
+  if (chunks.empty()) {
+    return;
+  }
+  const int64_t chunk_numel = divup(numel, static_cast<int64_t>(chunks.size()));
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / chunk_numel);
+  at::parallel_for(0, chunks.size(), grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t c = begin; c < end; c++) {
+      f(chunks[c].tensor, chunks[c].begin, chunks[c].end);
+    }
+  });
+}
+
+// The loops below step through a chunk one vector at a time, with a partial
+// vector at the end; lanes past the end are loaded but never stored.
+
+template <typename scalar_t>
+void fused_sgd(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov) {
+  using Vec = Vec256<scalar_t>;
+  const bool use_momentum = !momentum_buffers.empty();
+  const Vec lr_vec(lr);
+  const Vec momentum_vec(momentum);
+  const Vec grad_scale(1 - dampening);
+  const Vec weight_decay_vec(weight_decay);
+  multi_tensor_apply(params, [&](size_t t, int64_t begin, int64_t end) {
+    scalar_t* param_data = params[t].data_ptr<scalar_t>();
+    const scalar_t* grad_data = grads[t].data_ptr<scalar_t>();
+    scalar_t* buf_data = use_momentum ? momentum_buffers[t].data_ptr<scalar_t>() : nullptr;
+    for (int64_t i = begin; i < end; i += Vec::size()) {
+      const int64_t n = std::min<int64_t>(Vec::size(), end - i);
+      const Vec param = Vec::loadu(param_data + i, n);
+      Vec update = Vec::loadu(grad_data + i, n);
+      if (weight_decay > 0) {
+        update = vec256::fmadd(param, weight_decay_vec, update);
+      }
+      if (use_momentum) {
+        const Vec buf = vec256::fmadd(Vec::loadu(buf_data + i, n), momentum_vec, update * grad_scale);
+        buf.store(buf_data + i, n);
+        update = nesterov ? vec256::fmadd(buf, momentum_vec, update) : buf;
+      }
+      (param - update * lr_vec).store(param_data + i, n);
+    }
+  });
+}
+
+static void fused_sgd_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList momentum_buffers,
+    double lr,
+    double momentum,
+    double dampening,
+    double weight_decay,
+    bool nesterov) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_sgd", [&] {
+    fused_sgd<scalar_t>(params, grads, momentum_buffers,
+                        lr, momentum, dampening, weight_decay, nesterov);
+  });
+}
+
+template <typename scalar_t>
+void fused_adam(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    ArrayRef<double> step_sizes,
+    ArrayRef<double> bias_corrections2,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps) {
+  using Vec = Vec256<scalar_t>;
+  const bool amsgrad = !max_exp_avg_sqs.empty();
+  const Vec beta1_vec(beta1);
+  const Vec beta2_vec(beta2);
+  const Vec grad_scale1(1 - beta1);
+  const Vec grad_scale2(1 - beta2);
+  const Vec weight_decay_vec(weight_decay);
+  const Vec eps_vec(eps);
+  multi_tensor_apply(params, [&](size_t t, int64_t begin, int64_t end) {
+    scalar_t* param_data = params[t].data_ptr<scalar_t>();
+    const scalar_t* grad_data = grads[t].data_ptr<scalar_t>();
+    scalar_t* exp_avg_data = exp_avgs[t].data_ptr<scalar_t>();
+    scalar_t* exp_avg_sq_data = exp_avg_sqs[t].data_ptr<scalar_t>();
+    scalar_t* max_exp_avg_sq_data = amsgrad ? max_exp_avg_sqs[t].data_ptr<scalar_t>() : nullptr;
+    const Vec step_size(step_sizes[t]);
+    const Vec bias_correction2(bias_corrections2[t]);
+    for (int64_t i = begin; i < end; i += Vec::size()) {
+      const int64_t n = std::min<int64_t>(Vec::size(), end - i);
+      const Vec param = Vec::loadu(param_data + i, n);
+      Vec grad = Vec::loadu(grad_data + i, n);
+      if (weight_decay > 0) {
+        grad = vec256::fmadd(param, weight_decay_vec, grad);
+      }
+      const Vec exp_avg = vec256::fmadd(Vec::loadu(exp_avg_data + i, n), beta1_vec, grad * grad_scale1);
+      Vec exp_avg_sq = vec256::fmadd(Vec::loadu(exp_avg_sq_data + i, n), beta2_vec, grad * grad * grad_scale2);
+      exp_avg.store(exp_avg_data + i, n);
+      exp_avg_sq.store(exp_avg_sq_data + i, n);
+      if (amsgrad) {
+        exp_avg_sq = vec256::maximum(Vec::loadu(max_exp_avg_sq_data + i, n), exp_avg_sq);
+        exp_avg_sq.store(max_exp_avg_sq_data + i, n);
+      }
+      const Vec denom = (exp_avg_sq / bias_correction2).sqrt() + eps_vec;
+      (param - step_size * exp_avg / denom).store(param_data + i, n);
+    }
+  });
+}
+
+static void fused_adam_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList exp_avgs,
+    TensorList exp_avg_sqs,
+    TensorList max_exp_avg_sqs,
+    ArrayRef<double> step_sizes,
+    ArrayRef<double> bias_corrections2,
+    double beta1,
+    double beta2,
+    double weight_decay,
+    double eps) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_adam", [&] {
+    fused_adam<scalar_t>(params, grads, exp_avgs, exp_avg_sqs, max_exp_avg_sqs,
+                         step_sizes, bias_corrections2, beta1, beta2, weight_decay, eps);
+  });
+}
+
+template <typename scalar_t>
+void fused_adagrad(
+    TensorList params,
+    TensorList grads,
+    TensorList sums,
+    ArrayRef<double> lrs,
+    double weight_decay) {
+  using Vec = Vec256<scalar_t>;
+  const Vec weight_decay_vec(weight_decay);
+  const Vec eps_vec(1e-10);
+  multi_tensor_apply(params, [&](size_t t, int64_t begin, int64_t end) {
+    scalar_t* param_data = params[t].data_ptr<scalar_t>();
+    const scalar_t* grad_data = grads[t].data_ptr<scalar_t>();
+    scalar_t* sum_data = sums[t].data_ptr<scalar_t>();
+    const Vec lr(lrs[t]);
+    for (int64_t i = begin; i < end; i += Vec::size()) {
+      const int64_t n = std::min<int64_t>(Vec::size(), end - i);
+      const Vec param = Vec::loadu(param_data + i, n);
+      Vec grad = Vec::loadu(grad_data + i, n);
+      if (weight_decay > 0) {
+        grad = vec256::fmadd(param, weight_decay_vec, grad);
+      }
+      const Vec sum = vec256::fmadd(grad, grad, Vec::loadu(sum_data + i, n));
+      sum.store(sum_data + i, n);
+      (param - lr * grad / (sum.sqrt() + eps_vec)).store(param_data + i, n);
+    }
+  });
+}
+
+static void fused_adagrad_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList sums,
+    ArrayRef<double> lrs,
+    double weight_decay) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_adagrad", [&] {
+    fused_adagrad<scalar_t>(params, grads, sums, lrs, weight_decay);
+  });
+}
+
+template <typename scalar_t>
+void fused_rmsprop(
+    TensorList params,
+    TensorList grads,
+    TensorList square_avgs,
+    TensorList grad_avgs,
+    TensorList momentum_buffers,
+    double lr,
+    double alpha,
+    double eps,
+    double weight_decay,
+    double momentum) {
+  using Vec = Vec256<scalar_t>;
+  const bool centered = !grad_avgs.empty();
+  const bool use_momentum = !momentum_buffers.empty();
+  const Vec lr_vec(lr);
+  const Vec alpha_vec(alpha);
+  const Vec grad_scale(1 - alpha);
+  const Vec eps_vec(eps);
+  const Vec weight_decay_vec(weight_decay);
+  const Vec momentum_vec(momentum);
+  multi_tensor_apply(params, [&](size_t t, int64_t begin, int64_t end) {
+    scalar_t* param_data = params[t].data_ptr<scalar_t>();
+    const scalar_t* grad_data = grads[t].data_ptr<scalar_t>();
+    scalar_t* square_avg_data = square_avgs[t].data_ptr<scalar_t>();
+    scalar_t* grad_avg_data = centered ? grad_avgs[t].data_ptr<scalar_t>() : nullptr;
+    scalar_t* buf_data = use_momentum ? momentum_buffers[t].data_ptr<scalar_t>() : nullptr;
+    for (int64_t i = begin; i < end; i += Vec::size()) {
+      const int64_t n = std::min<int64_t>(Vec::size(), end - i);
+      const Vec param = Vec::loadu(param_data + i, n);
+      Vec grad = Vec::loadu(grad_data + i, n);
+      if (weight_decay > 0) {
+        grad = vec256::fmadd(param, weight_decay_vec, grad);
+      }
+      const Vec square_avg = vec256::fmadd(
+          Vec::loadu(square_avg_data + i, n), alpha_vec, grad * grad * grad_scale);
+      square_avg.store(square_avg_data + i, n);
+      Vec avg;
+      if (centered) {
+        const Vec grad_avg = vec256::fmadd(
+            Vec::loadu(grad_avg_data + i, n), alpha_vec, grad * grad_scale);
+        grad_avg.store(grad_avg_data + i, n);
+        avg = (square_avg - grad_avg * grad_avg).sqrt() + eps_vec;
+      } else {
+        avg = square_avg.sqrt() + eps_vec;
+      }
+      Vec update = grad / avg;
+      if (use_momentum) {
+        update = vec256::fmadd(Vec::loadu(buf_data + i, n), momentum_vec, update);
+        update.store(buf_data + i, n);
+      }
+      (param - update * lr_vec).store(param_data + i, n);
+    }
+  });
+}
+
+static void fused_rmsprop_kernel(
+    TensorList params,
+    TensorList grads,
+    TensorList square_avgs,
+    TensorList grad_avgs,
+    TensorList momentum_buffers,
+    double lr,
+    double alpha,
+    double eps,
+    double weight_decay,
+    double momentum) {
+  AT_DISPATCH_FLOATING_TYPES(params[0].scalar_type(), "fused_rmsprop", [&] {
+    fused_rmsprop<scalar_t>(params, grads, square_avgs, grad_avgs, momentum_buffers,
+                            lr, alpha, eps, weight_decay, momentum);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(fused_sgd_stub, &fused_sgd_kernel);
+REGISTER_DISPATCH(fused_adam_stub, &fused_adam_kernel);
+REGISTER_DISPATCH(fused_adagrad_stub, &fused_adagrad_kernel);
+REGISTER_DISPATCH(fused_rmsprop_stub, &fused_rmsprop_kernel);
+
+}} // namespace at::native
@@ -0,0 +1,288 @@
+#include <ATen/native/Pool.h>
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// In NHWC, the C values of a pixel are contiguous, so every kernel below
+// works on whole pixels: an output pixel is computed from (or scattered to)
+// the input pixels of its window, a vector of channels at a time.
+
+template <typename scalar_t>
+inline void add_pixel(scalar_t* out, const scalar_t* in, int64_t channels) {
+  using Vec = Vec256<scalar_t>;
+  int64_t c = 0;
+  for (; c + Vec::size() <= channels; c += Vec::size()) {
+    (Vec::loadu(out + c) + Vec::loadu(in + c)).store(out + c);
+  }
+  for (; c < channels; c++) {
+    out[c] += in[c];
+  }
+}
+
+template <typename scalar_t>
+void max_pool2d_nhwc(
+    Tensor& output,
+    Tensor& indices,
+    const Tensor& input,
+    int kW, int kH, int dW, int dH, int padW, int padH,
+    int dilationW, int dilationH) {
+  const int64_t nbatch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t inputHeight = input.size(2);
+  const int64_t inputWidth = input.size(3);
+  const int64_t outputHeight = output.size(2);
+  const int64_t outputWidth = output.size(3);
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+  int64_t* indices_data = indices.data_ptr<int64_t>();
+
+  // The max and its index are tracked per channel; the index is an int64
+  // and does not fit the lanes of a float vector, so this loop stays scalar
+  // and relies on the channels being contiguous.
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (channels * kH * kW));
+  at::parallel_for(0, nbatch * outputHeight * outputWidth, grain_size, [&](int64_t start, int64_t end) {
+    for (auto pixel = start; pixel < end; pixel++) {
+      const int64_t n = pixel / (outputHeight * outputWidth);
+      const int64_t oh = (pixel / outputWidth) % outputHeight;
+      const int64_t ow = pixel % outputWidth;
+
+      int64_t hstart = oh * dH - padH;
+      int64_t wstart = ow * dW - padW;
+      const int64_t hend = std::min(hstart + (kH - 1) * dilationH + 1, inputHeight);
+      const int64_t wend = std::min(wstart + (kW - 1) * dilationW + 1, inputWidth);
+      while (hstart < 0)
+        hstart += dilationH;
+      while (wstart < 0)
+        wstart += dilationW;
+
+      scalar_t* op = output_data + pixel * channels;
+      int64_t* indp = indices_data + pixel * channels;
+      const scalar_t* ip = input_data + n * inputHeight * inputWidth * channels;
+      std::fill(op, op + channels, -std::numeric_limits<scalar_t>::infinity());
+      std::fill(indp, indp + channels, hstart * inputWidth + wstart);
+
+      for (int64_t y = hstart; y < hend; y += dilationH) {
+        for (int64_t x = wstart; x < wend; x += dilationW) {
+          const int64_t tcntr = y * inputWidth + x;
+          const scalar_t* in_pixel = ip + tcntr * channels;
+          for (int64_t c = 0; c < channels; c++) {
+            const scalar_t val = in_pixel[c];
+            if ((val > op[c]) || std::isnan(val)) {
+              op[c] = val;
+              indp[c] = tcntr;
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+static void max_pool2d_nhwc_kernel(
+    Tensor& output,
+    Tensor& indices,
+    const Tensor& input,
+    int kW, int kH, int dW, int dH, int padW, int padH,
+    int dilationW, int dilationH) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "max_pool2d_with_indices_nhwc", [&] {
+    max_pool2d_nhwc<scalar_t>(
+        output, indices, input, kW, kH, dW, dH, padW, padH, dilationW, dilationH);
+  });
+}
+
+template <typename scalar_t>
+void max_pool2d_backward_nhwc(
+    Tensor& gradInput,
+    const Tensor& gradOutput,
+    const Tensor& indices) {
+  const int64_t nbatch = gradInput.size(0);
+  const int64_t channels = gradInput.size(1);
+  const int64_t input_plane = gradInput.size(2) * gradInput.size(3);
+  const int64_t output_plane = gradOutput.size(2) * gradOutput.size(3);
+
+  scalar_t* gradInput_data = gradInput.data_ptr<scalar_t>();
+  const scalar_t* gradOutput_data = gradOutput.data_ptr<scalar_t>();
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+
+  // Output pixels of one image scatter into the same input pixels, so the
+  // work is split over images.
+  at::parallel_for(0, nbatch, 0, [&](int64_t start, int64_t end) {
+    for (auto n = start; n < end; n++) {
+      scalar_t* gi = gradInput_data + n * input_plane * channels;
+      const scalar_t* go = gradOutput_data + n * output_plane * channels;
+      const int64_t* ind = indices_data + n * output_plane * channels;
+      for (int64_t p = 0; p < output_plane; p++) {
+        for (int64_t c = 0; c < channels; c++) {
+          const int64_t maxp = ind[p * channels + c];
+          if (maxp != -1) {
+            gi[maxp * channels + c] += go[p * channels + c];
+          }
+        }
+      }
+    }
+  });
+}
+
+static void max_pool2d_backward_nhwc_kernel(
+    Tensor& gradInput,
+    const Tensor& gradOutput,
+    const Tensor& indices) {
+  AT_DISPATCH_FLOATING_TYPES(gradOutput.scalar_type(), "max_pool2d_with_indices_backward_nhwc", [&] {
+    max_pool2d_backward_nhwc<scalar_t>(gradInput, gradOutput, indices);
+  });
+}
+
+// Returns the clipped window [hstart, hend) x [wstart, wend) of an average
+// pooling output pixel and the divisor of its sum.
+inline int64_t avg_pool2d_window(
+    int64_t oh, int64_t ow,
+    int64_t inputHeight, int64_t inputWidth,
+    int kW, int kH, int dW, int dH, int padW, int padH,
+    bool count_include_pad, c10::optional<int64_t> divisor_override,
+    int64_t& hstart, int64_t& hend, int64_t& wstart, int64_t& wend) {
+  hstart = oh * dH - padH;
+  wstart = ow * dW - padW;
+  hend = std::min(hstart + kH, inputHeight + padH);
+  wend = std::min(wstart + kW, inputWidth + padW);
+  const int64_t pool_size = (hend - hstart) * (wend - wstart);
+  hstart = std::max(hstart, (int64_t) 0);
+  wstart = std::max(wstart, (int64_t) 0);
+  hend = std::min(hend, inputHeight);
+  wend = std::min(wend, inputWidth);
+
+  if (divisor_override.has_value()) {
+    return divisor_override.value();
+  }
+  return count_include_pad ? pool_size : (hend - hstart) * (wend - wstart);
+}
+
+template <typename scalar_t>
+void avg_pool2d_nhwc(
+    Tensor& output,
+    const Tensor& input,
+    int kW, int kH, int dW, int dH, int padW, int padH,
+    bool count_include_pad,
+    c10::optional<int64_t> divisor_override) {
+  const int64_t nbatch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t inputHeight = input.size(2);
+  const int64_t inputWidth = input.size(3);
+  const int64_t outputHeight = output.size(2);
+  const int64_t outputWidth = output.size(3);
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* output_data = output.data_ptr<scalar_t>();
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (channels * kH * kW));
+  at::parallel_for(0, nbatch * outputHeight * outputWidth, grain_size, [&](int64_t start, int64_t end) {
+    for (auto pixel = start; pixel < end; pixel++) {
+      const int64_t n = pixel / (outputHeight * outputWidth);
+      const int64_t oh = (pixel / outputWidth) % outputHeight;
+      const int64_t ow = pixel % outputWidth;
+      int64_t hstart, hend, wstart, wend;
+      const int64_t divide_factor = avg_pool2d_window(
+          oh, ow, inputHeight, inputWidth, kW, kH, dW, dH, padW, padH,
+          count_include_pad, divisor_override, hstart, hend, wstart, wend);
+
+      scalar_t* op = output_data + pixel * channels;
+      const scalar_t* ip = input_data + n * inputHeight * inputWidth * channels;
+      std::fill(op, op + channels, scalar_t(0));
+      for (int64_t y = hstart; y < hend; y++) {
+        for (int64_t x = wstart; x < wend; x++) {
+          add_pixel(op, ip + (y * inputWidth + x) * channels, channels);
+        }
+      }
+      for (int64_t c = 0; c < channels; c++) {
+        op[c] /= divide_factor;
+      }
+    }
+  });
+}
+
+static void avg_pool2d_nhwc_kernel(
+    Tensor& output,
+    const Tensor& input,
+    int kW, int kH, int dW, int dH, int padW, int padH,
+    bool count_include_pad,
+    c10::optional<int64_t> divisor_override) {
+  AT_DISPATCH_FLOATING_TYPES_AND(at::ScalarType::Long, input.scalar_type(), "avg_pool2d_nhwc", [&] {
+    avg_pool2d_nhwc<scalar_t>(
+        output, input, kW, kH, dW, dH, padW, padH, count_include_pad, divisor_override);
+  });
+}
+
+template <typename scalar_t>
+void avg_pool2d_backward_nhwc(
+    Tensor& gradInput,
+    const Tensor& gradOutput,
+    int kW, int kH, int dW, int dH, int padW, int padH,
+    bool count_include_pad,
+    c10::optional<int64_t> divisor_override) {
+  const int64_t nbatch = gradInput.size(0);
+  const int64_t channels = gradInput.size(1);
+  const int64_t inputHeight = gradInput.size(2);
+  const int64_t inputWidth = gradInput.size(3);
+  const int64_t outputHeight = gradOutput.size(2);
+  const int64_t outputWidth = gradOutput.size(3);
+
+  scalar_t* gradInput_data = gradInput.data_ptr<scalar_t>();
+  const scalar_t* gradOutput_data = gradOutput.data_ptr<scalar_t>();
+
+  at::parallel_for(0, nbatch, 0, [&](int64_t start, int64_t end) {
+    std::vector<scalar_t> scaled(channels);
+    for (auto n = start; n < end; n++) {
+      scalar_t* gi = gradInput_data + n * inputHeight * inputWidth * channels;
+      const scalar_t* go = gradOutput_data + n * outputHeight * outputWidth * channels;
+      for (int64_t oh = 0; oh < outputHeight; oh++) {
+        for (int64_t ow = 0; ow < outputWidth; ow++) {
+          int64_t hstart, hend, wstart, wend;
+          const int64_t divide_factor = avg_pool2d_window(
+              oh, ow, inputHeight, inputWidth, kW, kH, dW, dH, padW, padH,
+              count_include_pad, divisor_override, hstart, hend, wstart, wend);
+          const scalar_t* go_pixel = go + (oh * outputWidth + ow) * channels;
+          for (int64_t c = 0; c < channels; c++) {
+            scaled[c] = go_pixel[c] / divide_factor;
+          }
+          for (int64_t y = hstart; y < hend; y++) {
+            for (int64_t x = wstart; x < wend; x++) {
+              add_pixel(gi + (y * inputWidth + x) * channels, scaled.data(), channels);
+            }
+          }
+        }
+      }
+    }
+  });
+}
+
+static void avg_pool2d_backward_nhwc_kernel(
+    Tensor& gradInput,
+    const Tensor& gradOutput,
+    int kW, int kH, int dW, int dH, int padW, int padH,
+    bool count_include_pad,
+    c10::optional<int64_t> divisor_override) {
+  AT_DISPATCH_FLOATING_TYPES_AND(at::ScalarType::Long, gradOutput.scalar_type(), "avg_pool2d_backward_nhwc", [&] {
+    avg_pool2d_backward_nhwc<scalar_t>(
+        gradInput, gradOutput, kW, kH, dW, dH, padW, padH, count_include_pad, divisor_override);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(max_pool2d_nhwc_stub, &max_pool2d_nhwc_kernel);
+REGISTER_DISPATCH(max_pool2d_backward_nhwc_stub, &max_pool2d_backward_nhwc_kernel);
+REGISTER_DISPATCH(avg_pool2d_nhwc_stub, &avg_pool2d_nhwc_kernel);
+REGISTER_DISPATCH(avg_pool2d_backward_nhwc_stub, &avg_pool2d_backward_nhwc_kernel);
+
+}} // namespace at::native
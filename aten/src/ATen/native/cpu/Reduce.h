@@ -4,6 +4,8 @@
 #include <ATen/Parallel.h>
 #include <c10/util/TypeList.h>
 
+#include <algorithm>
+#include <cstdlib>
 #include <sstream>
 
 namespace at { namespace native { namespace {
@@ -87,6 +89,28 @@ static inline void vectorized_inner_reduction(char** data, int64_t n, func_t op,
   basic_loop(ptrs, strides, count * 4 * Vec::size(), n, op);
 }
 
+// computes the reduction out = op(out, in) over a [size0, size1] block with
+// arbitrary strides, row by row: each row updates a tile of outputs that stays
+// in cache, so the input is read in memory order when its columns are closer
+// together than its rows.
+template <typename func_t>
+static inline void blocked_reduction(char** data, const int64_t* strides, int64_t size0, int64_t size1, func_t op) {
+  using scalar_t = typename function_traits<func_t>::result_type;
+  constexpr int64_t kTileSize = 256;
+  for (int64_t j0 = 0; j0 < size1; j0 += kTileSize) {
+    int64_t j1 = std::min(size1, j0 + kTileSize);
+    for (int64_t i = 0; i < size0; i++) {
+      char* out = data[0] + i * strides[0] + j0 * strides[2];
+      const char* in = data[1] + i * strides[1] + j0 * strides[3];
+      for (int64_t j = j0; j < j1; j++) {
+        *(scalar_t*)out = op(*(scalar_t*)out, *(const scalar_t*)in);
+        out += strides[2];
+        in += strides[3];
+      }
+    }
+  }
+}
+
 // computes the reduction out = op(out, in)
 template <typename func_t, typename vec_func_t>
 static inline void vectorized_outer_reduction(char** data, int64_t inner_stride, int64_t size0, int64_t size1, func_t op, vec_func_t vop) {
@@ -98,14 +122,10 @@ static inline void vectorized_outer_reduction(char** data, int64_t inner_stride,
     reduction128(data, size0, inner_stride, op, vop, /*reduce=*/false);
   });
 
-  // reduce down the remaining columns
-  int64_t step[] = { sizeof(scalar_t), sizeof(scalar_t) };
+  // reduce down the remaining columns, all of them in one pass over the rows
   int64_t remaining = size1 % (4 * Vec::size());
-  UNARY_OUTER_LOOP(data, step, remaining, [&] {
-    char* ptrs[3] = { data[0], data[0], data[1] };
-    int64_t strides[] = { 0, 0, inner_stride };
-    basic_loop(ptrs, strides, 0, size0, op);
-  });
+  int64_t strides[] = { 0, inner_stride, sizeof(scalar_t), sizeof(scalar_t) };
+  blocked_reduction(data, strides, size0, remaining, op);
 }
 
 template<typename traits, typename res_t>
@@ -264,6 +284,9 @@ void binary_kernel_reduce_vec(TensorIterator& iter, func_t op, vec_func_t vop, d
       // input and output are contiguous in dim 1
       int64_t inner_stride = strides[1]; // stride of input in dim 0
       vectorized_outer_reduction(data, inner_stride, size0, size1, op, vop);
+    } else if (std::abs(strides[3]) < std::abs(strides[1])) {
+      // the input is closer together along dim 1, so read it row by row
+      blocked_reduction(data, strides, size0, size1, op);
     } else {
       UNARY_OUTER_LOOP(data, outer_strides, size1, [&] {
         char* ptrs[3] = { data[0], data[0], data[1] };
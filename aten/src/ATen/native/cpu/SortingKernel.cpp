@@ -2,6 +2,7 @@
 #include <ATen/Dispatch.h>
 #include <ATen/Parallel.h>
 #include <ATen/NumericUtils.h>
+#include <ATen/native/ParallelSort.h>
 #include <ATen/native/Sorting.h>
 #include <ATen/native/SortingUtils.h>
 
@@ -9,6 +10,71 @@ namespace at { namespace native {
 
 namespace {
 
+// Sorts every slice of `self` along `dim` with sort_with_indices, which
+// expects contiguous slices. Many slices are sorted in parallel with each other,
+// a few long ones are each sorted in parallel.
+template <typename scalar_t>
+void sort_slices(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool descending) {
+  const int64_t n = self.size(dim);
+  const Tensor input = self.transpose(dim, -1).contiguous();
+  Tensor values_t = values.transpose(dim, -1);
+  Tensor indices_t = indices.transpose(dim, -1);
+  Tensor values_out = values_t.is_contiguous() ? values_t : at::empty_like(input);
+  Tensor indices_out = indices_t.is_contiguous()
+      ? indices_t
+      : at::empty(input.sizes(), indices.options());
+
+  const scalar_t* input_data = input.data_ptr<scalar_t>();
+  scalar_t* values_data = values_out.data_ptr<scalar_t>();
+  int64_t* indices_data = indices_out.data_ptr<int64_t>();
+  const int64_t slices = input.numel() / n;
+  auto sort_slice = [&](int64_t s) {
+    sort_with_indices(
+        input_data + s * n,
+        n,
+        descending,
+        values_data + s * n,
+        indices_data + s * n);
+  };
+  if (slices < at::get_num_threads() && n >= at::internal::GRAIN_SIZE) {
+    for (int64_t s = 0; s < slices; s++) {
+      sort_slice(s);
+    }
+  } else {
+    at::parallel_for(0, slices, divup(at::internal::GRAIN_SIZE, n), [&](int64_t begin, int64_t end) {
+      for (int64_t s = begin; s < end; s++) {
+        sort_slice(s);
+      }
+    });
+  }
+
+  if (!values_out.is_same(values_t)) {
+    values_t.copy_(values_out);
+  }
+  if (!indices_out.is_same(indices_t)) {
+    indices_t.copy_(indices_out);
+  }
+}
+
+static void sort_kernel(
+    Tensor& values,
+    Tensor& indices,
+    const Tensor& self,
+    int64_t dim,
+    bool descending) {
+  if (self.numel() == 0) {
+    return;
+  }
+  AT_DISPATCH_ALL_TYPES(self.scalar_type(), "sort_cpu", [&] {
+    sort_slices<scalar_t>(values, indices, self, dim, descending);
+  });
+}
+
 static void topk_kernel(
     Tensor& values,
     Tensor& indices,
@@ -17,6 +83,21 @@ static void topk_kernel(
     int64_t dim,
     bool largest,
     bool sorted) {
+  const int64_t n = self.dim() > 0 ? self.size(dim) : 1;
+  const int64_t slices = n > 0 ? self.numel() / n : 0;
+  // When k is large, nth_element and sort are serial passes over most of a
+  // slice, so a few long slices are better served by a full parallel sort.
+  if (k * 64 > n && n >= at::internal::GRAIN_SIZE && slices < at::get_num_threads()) {
+    Tensor sorted_values = at::empty(self.sizes(), self.options());
+    Tensor sorted_indices = at::empty(self.sizes(), self.options().dtype(kLong));
+    AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
+      sort_slices<scalar_t>(sorted_values, sorted_indices, self, dim, largest);
+    });
+    values.copy_(sorted_values.narrow(dim, 0, k));
+    indices.copy_(sorted_indices.narrow(dim, 0, k));
+    return;
+  }
+
   AT_DISPATCH_ALL_TYPES(self.scalar_type(), "topk_cpu", [&] {
     dim_apply(
         {self, values, indices},
@@ -85,6 +166,7 @@ static void topk_kernel(
 
 } // anonymous namespace
 
+REGISTER_DISPATCH(sort_stub, &sort_kernel);
 REGISTER_DISPATCH(topk_stub, &topk_kernel);
 
 }} //at::native
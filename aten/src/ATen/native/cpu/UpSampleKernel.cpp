@@ -0,0 +1,90 @@
+#include <ATen/native/UpSample.h>
+
+#include <algorithm>
+
+#include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
+#include <ATen/cpu/vec256/vec256.h>
+
+namespace at { namespace native {
+namespace {
+
+using namespace vec256;
+
+// Every output pixel of a channels-last output interpolates four input
+// pixels, whose channels are contiguous, with the same four weights.
+template <typename scalar_t>
+void upsample_bilinear2d_nhwc(Tensor& output, const Tensor& input, bool align_corners) {
+  using Vec = Vec256<scalar_t>;
+  const int64_t nbatch = input.size(0);
+  const int64_t channels = input.size(1);
+  const int64_t input_height = input.size(2);
+  const int64_t input_width = input.size(3);
+  const int64_t output_height = output.size(2);
+  const int64_t output_width = output.size(3);
+
+  const scalar_t* idata = input.data_ptr<scalar_t>();
+  scalar_t* odata = output.data_ptr<scalar_t>();
+
+  const scalar_t rheight = area_pixel_compute_scale<scalar_t>(
+      input_height, output_height, align_corners);
+  const scalar_t rwidth = area_pixel_compute_scale<scalar_t>(
+      input_width, output_width, align_corners);
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / (4 * channels));
+  at::parallel_for(0, nbatch * output_height * output_width, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t pixel = begin; pixel < end; pixel++) {
+      const int64_t n = pixel / (output_height * output_width);
+      const int64_t h2 = (pixel / output_width) % output_height;
+      const int64_t w2 = pixel % output_width;
+
+      const scalar_t h1r = area_pixel_compute_source_index<scalar_t>(
+          rheight, h2, align_corners, /*cubic=*/false);
+      const int64_t h1 = h1r;
+      const int64_t h1p = (h1 < input_height - 1) ? 1 : 0;
+      const scalar_t h1lambda = h1r - h1;
+      const scalar_t h0lambda = static_cast<scalar_t>(1.) - h1lambda;
+
+      const scalar_t w1r = area_pixel_compute_source_index<scalar_t>(
+          rwidth, w2, align_corners, /*cubic=*/false);
+      const int64_t w1 = w1r;
+      const int64_t w1p = (w1 < input_width - 1) ? 1 : 0;
+      const scalar_t w1lambda = w1r - w1;
+      const scalar_t w0lambda = static_cast<scalar_t>(1.) - w1lambda;
+
+      const scalar_t* i00 = idata + ((n * input_height + h1) * input_width + w1) * channels;
+      const scalar_t* i01 = i00 + w1p * channels;
+      const scalar_t* i10 = i00 + h1p * input_width * channels;
+      const scalar_t* i11 = i10 + w1p * channels;
+      scalar_t* out = odata + pixel * channels;
+
+      const scalar_t l00 = h0lambda * w0lambda;
+      const scalar_t l01 = h0lambda * w1lambda;
+      const scalar_t l10 = h1lambda * w0lambda;
+      const scalar_t l11 = h1lambda * w1lambda;
+      int64_t c = 0;
+      for (; c + Vec::size() <= channels; c += Vec::size()) {
+        Vec result = Vec::loadu(i00 + c) * Vec(l00);
+        result = vec256::fmadd(Vec::loadu(i01 + c), Vec(l01), result);
+        result = vec256::fmadd(Vec::loadu(i10 + c), Vec(l10), result);
+        result = vec256::fmadd(Vec::loadu(i11 + c), Vec(l11), result);
+        result.store(out + c);
+      }
+      for (; c < channels; c++) {
+        out[c] = l00 * i00[c] + l01 * i01[c] + l10 * i10[c] + l11 * i11[c];
+      }
+    }
+  });
+}
+
+static void upsample_bilinear2d_nhwc_kernel(Tensor& output, const Tensor& input, bool align_corners) {
+  AT_DISPATCH_FLOATING_TYPES(input.scalar_type(), "upsample_bilinear2d_nhwc", [&] {
+    upsample_bilinear2d_nhwc<scalar_t>(output, input, align_corners);
+  });
+}
+
+} // anonymous namespace
+
+REGISTER_DISPATCH(upsample_bilinear2d_nhwc_stub, &upsample_bilinear2d_nhwc_kernel);
+
+}} // namespace at::native
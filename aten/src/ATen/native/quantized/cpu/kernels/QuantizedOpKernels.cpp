@@ -1,9 +1,12 @@
 #include <ATen/ATen.h>
 #include <ATen/Dispatch.h>
+#include <ATen/Parallel.h>
 #include <ATen/native/TensorIterator.h>
 #include <ATen/native/cpu/Loops.h>
 #include <ATen/native/quantized/cpu/quantized_ops.h>
 
+#include <cstring>
+
 namespace at {
 namespace native {
 namespace {
@@ -576,6 +579,105 @@ void qavg_pool2d_nhwc_kernel(
   });
 }
 
+// Scale and bias of a row of a row-wise quantized embedding table; see
+// quantized_ops.h for the layout of the rows.
+template <int BIT_RATE>
+struct RowwiseScaleBias {
+  using type = float;
+};
+
+template <>
+struct RowwiseScaleBias<4> {
+  using type = at::Half;
+};
+
+// Bags are split among threads, and every row of a bag is dequantized one
+// vector at a time and accumulated into the bag's output, so the table is
+// never expanded to float.
+template <int BIT_RATE>
+void qembedding_bag_rowwise_kernel(
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    const Tensor& per_sample_weights,
+    bool mean,
+    Tensor& output) {
+  using Vec = Vec256<float>;
+  using scale_bias_t = typename RowwiseScaleBias<BIT_RATE>::type;
+  constexpr int64_t kValuesPerByte = 8 / BIT_RATE;
+  constexpr int kMask = (1 << BIT_RATE) - 1;
+
+  const int64_t num_bags = offsets.numel();
+  const int64_t num_indices = indices.numel();
+  const int64_t num_rows = weight.size(0);
+  const int64_t row_bytes = weight.size(1);
+  const int64_t ddim = output.size(1);
+  const uint8_t* weight_data = weight.data_ptr<uint8_t>();
+  const int64_t* indices_data = indices.data_ptr<int64_t>();
+  const int64_t* offsets_data = offsets.data_ptr<int64_t>();
+  const float* per_sample_weights_data =
+      per_sample_weights.defined() ? per_sample_weights.data_ptr<float>() : nullptr;
+  float* output_data = output.data_ptr<float>();
+
+  auto value = [&](const uint8_t* row, int64_t d) -> float {
+    return (row[d / kValuesPerByte] >> ((d % kValuesPerByte) * BIT_RATE)) & kMask;
+  };
+
+  // Checked once up front, so that the bags below only read indices in
+  // [0, num_indices).
+  for (int64_t bag = 0; bag < num_bags; bag++) {
+    const int64_t start = offsets_data[bag];
+    const int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : num_indices;
+    TORCH_CHECK(0 <= start && start <= stop && stop <= num_indices,
+        "embedding_bag: offsets must be non-negative, non-decreasing and at most the number of indices");
+  }
+
+  const int64_t rows_per_bag = std::max<int64_t>(1, num_indices / std::max<int64_t>(1, num_bags));
+  const int64_t grain_size = std::max<int64_t>(
+      1, internal::GRAIN_SIZE / (rows_per_bag * std::max<int64_t>(1, ddim)));
+  at::parallel_for(0, num_bags, grain_size, [&](int64_t begin, int64_t end) {
+    float values[Vec::size()];
+    for (int64_t bag = begin; bag < end; bag++) {
+      const int64_t start = offsets_data[bag];
+      const int64_t stop = bag + 1 < num_bags ? offsets_data[bag + 1] : num_indices;
+      float* out = output_data + bag * ddim;
+      std::fill(out, out + ddim, 0.f);
+      for (int64_t i = start; i < stop; i++) {
+        const int64_t index = indices_data[i];
+        TORCH_CHECK(index >= 0 && index < num_rows,
+            "embedding_bag: index ", index, " is out of bounds for ", num_rows, " embeddings");
+        const uint8_t* row = weight_data + index * row_bytes;
+        // Rows are not aligned for the scale and bias.
+        scale_bias_t scale_bias[2];
+        std::memcpy(scale_bias, row + ddim / kValuesPerByte, sizeof(scale_bias));
+        const float weight = per_sample_weights_data ? per_sample_weights_data[i] : 1.f;
+        const float scale = weight * static_cast<float>(scale_bias[0]);
+        const float bias = weight * static_cast<float>(scale_bias[1]);
+        const Vec scale_vec(scale);
+        const Vec bias_vec(bias);
+        int64_t d = 0;
+        for (; d + Vec::size() <= ddim; d += Vec::size()) {
+          for (int k = 0; k < Vec::size(); k++) {
+            values[k] = value(row, d + k);
+          }
+          vec256::fmadd(Vec::loadu(values), scale_vec, Vec::loadu(out + d) + bias_vec)
+              .store(out + d);
+        }
+        for (; d < ddim; d++) {
+          out[d] += scale * value(row, d) + bias;
+        }
+      }
+      // Empty bags stay all 0s.
+      if (mean && stop > start) {
+        const float inv_length = 1.f / (stop - start);
+        for (int64_t d = 0; d < ddim; d++) {
+          out[d] *= inv_length;
+        }
+      }
+    }
+  });
+}
+
 } // namespace
 
 REGISTER_DISPATCH(qrelu_stub, &qrelu_kernel);
@@ -589,6 +691,8 @@ REGISTER_DISPATCH(
 REGISTER_DISPATCH(qavg_pool2d_nhwc_stub, &qavg_pool2d_nhwc_kernel);
 REGISTER_DISPATCH(qcat_nhwc_stub, &qcat_nhwc_kernel<false>);
 REGISTER_DISPATCH(qcat_relu_nhwc_stub, &qcat_nhwc_kernel<true>);
+REGISTER_DISPATCH(qembedding_bag_byte_stub, &qembedding_bag_rowwise_kernel<8>);
+REGISTER_DISPATCH(qembedding_bag_4bit_stub, &qembedding_bag_rowwise_kernel<4>);
 
 } // namespace native
 } // namespace at
@@ -0,0 +1,107 @@
+#include <ATen/ATen.h>
+#include <ATen/core/op_registration/op_registration.h>
+#include <ATen/native/quantized/cpu/quantized_ops.h>
+
+namespace at {
+namespace native {
+
+DEFINE_DISPATCH(qembedding_bag_byte_stub);
+DEFINE_DISPATCH(qembedding_bag_4bit_stub);
+
+namespace {
+
+const int64_t MODE_SUM = 0;
+const int64_t MODE_MEAN = 1;
+
+// Looks up bags of a table packed by quantized::embedding_bag_*_prepack, with
+// the same indices, offsets, modes and per_sample_weights as embedding_bag.
+template <int BIT_RATE>
+Tensor qembedding_bag_rowwise(
+    const Tensor& weight,
+    const Tensor& indices,
+    const Tensor& offsets,
+    int64_t mode,
+    const c10::optional<Tensor>& per_sample_weights,
+    const char* op) {
+  TORCH_CHECK(weight.dim() == 2 && weight.scalar_type() == kByte, op,
+      ": expected a 2-D uint8 packed weight");
+  TORCH_CHECK(indices.dim() == 1 && indices.scalar_type() == kLong, op,
+      ": expected 1-D int64 indices");
+  TORCH_CHECK(offsets.dim() == 1 && offsets.scalar_type() == kLong, op,
+      ": expected 1-D int64 offsets");
+  TORCH_CHECK(offsets.numel() > 0, op, ": expected at least one offset");
+  TORCH_CHECK(mode == MODE_SUM || mode == MODE_MEAN, op,
+      ": only mode='sum' (0) and mode='mean' (1) are supported");
+
+  const int64_t scale_bias_bytes = BIT_RATE == 8 ? 2 * sizeof(float) : 2 * sizeof(at::Half);
+  const int64_t value_bytes = weight.size(1) - scale_bias_bytes;
+  TORCH_CHECK(value_bytes >= 0, op, ": packed rows of ", weight.size(1),
+      " bytes are too short for a scale and bias");
+  const int64_t ddim = value_bytes * (8 / BIT_RATE);
+
+  auto indices_contig = indices.contiguous();
+  auto offsets_contig = offsets.contiguous();
+  TORCH_CHECK(offsets_contig.data_ptr<int64_t>()[0] == 0, op,
+      ": expected offsets to start at 0");
+  Tensor per_sample_weights_contig;
+  if (per_sample_weights.has_value()) {
+    TORCH_CHECK(mode == MODE_SUM, op,
+        ": per_sample_weights only supported with mode='sum'");
+    TORCH_CHECK(per_sample_weights->numel() == indices.numel(), op,
+        ": expected one per_sample_weight per index");
+    per_sample_weights_contig = per_sample_weights->to(kFloat).contiguous();
+  }
+
+  auto output = at::empty({offsets.numel(), ddim}, weight.options().dtype(kFloat));
+  if (BIT_RATE == 8) {
+    qembedding_bag_byte_stub(kCPU, weight.contiguous(), indices_contig, offsets_contig,
+                             per_sample_weights_contig, mode == MODE_MEAN, output);
+  } else {
+    qembedding_bag_4bit_stub(kCPU, weight.contiguous(), indices_contig, offsets_contig,
+                             per_sample_weights_contig, mode == MODE_MEAN, output);
+  }
+  return output;
+}
+
+class QEmbeddingBagByte final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor weight,
+      Tensor indices,
+      Tensor offsets,
+      int64_t mode,
+      c10::optional<Tensor> per_sample_weights) {
+    return qembedding_bag_rowwise<8>(
+        weight, indices, offsets, mode, per_sample_weights,
+        "quantized::embedding_bag_byte");
+  }
+};
+
+class QEmbeddingBag4Bit final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(
+      Tensor weight,
+      Tensor indices,
+      Tensor offsets,
+      int64_t mode,
+      c10::optional<Tensor> per_sample_weights) {
+    return qembedding_bag_rowwise<4>(
+        weight, indices, offsets, mode, per_sample_weights,
+        "quantized::embedding_bag_4bit");
+  }
+};
+
+static auto registry =
+    torch::RegisterOperators()
+        .op("quantized::embedding_bag_byte(Tensor weight, Tensor indices, Tensor offsets, "
+            "int mode=0, Tensor? per_sample_weights=None) -> Tensor",
+            torch::RegisterOperators::options()
+                .kernel<QEmbeddingBagByte>(TensorTypeId::CPUTensorId))
+        .op("quantized::embedding_bag_4bit(Tensor weight, Tensor indices, Tensor offsets, "
+            "int mode=0, Tensor? per_sample_weights=None) -> Tensor",
+            torch::RegisterOperators::options()
+                .kernel<QEmbeddingBag4Bit>(TensorTypeId::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -0,0 +1,152 @@
+#include <ATen/ATen.h>
+#include <ATen/Parallel.h>
+#include <ATen/core/op_registration/op_registration.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace at {
+namespace native {
+namespace {
+
+// Row-wise quantization of embedding tables into the fused layouts described
+// in quantized_ops.h: every row gets its own scale and bias from its minimum
+// and maximum, and stores them after its quantized values.
+template <int BIT_RATE, typename scale_bias_t>
+Tensor qembedding_bag_rowwise_prepack(const Tensor& weight, const char* op) {
+  TORCH_CHECK(weight.dim() == 2, op, ": expected a 2-D weight but got ",
+      weight.dim(), " dimensions");
+  TORCH_CHECK(weight.scalar_type() == kFloat, op,
+      ": expected a float weight but got ", weight.scalar_type());
+  constexpr int64_t kValuesPerByte = 8 / BIT_RATE;
+  constexpr int kLevels = (1 << BIT_RATE) - 1;
+  const int64_t num_rows = weight.size(0);
+  const int64_t ddim = weight.size(1);
+  TORCH_CHECK(ddim % kValuesPerByte == 0, op,
+      ": expected the embedding dimension to be a multiple of ", kValuesPerByte,
+      " but got ", ddim);
+  const int64_t value_bytes = ddim / kValuesPerByte;
+  const int64_t row_bytes = value_bytes + 2 * sizeof(scale_bias_t);
+
+  auto weight_contig = weight.contiguous();
+  auto output = at::empty({num_rows, row_bytes}, weight.options().dtype(kByte));
+  const float* weight_data = weight_contig.data_ptr<float>();
+  uint8_t* output_data = output.data_ptr<uint8_t>();
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, ddim));
+  at::parallel_for(0, num_rows, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const float* in = weight_data + r * ddim;
+      uint8_t* out = output_data + r * row_bytes;
+      float minimum = 0.f;
+      float maximum = 0.f;
+      if (ddim > 0) {
+        minimum = *std::min_element(in, in + ddim);
+        maximum = *std::max_element(in, in + ddim);
+      }
+      // Quantize with the stored (possibly rounded) scale and bias, so that
+      // dequantization reproduces the values as closely as possible.
+      scale_bias_t scale_bias[2] = {
+          scale_bias_t((maximum - minimum) / kLevels), scale_bias_t(minimum)};
+      const float scale = static_cast<float>(scale_bias[0]);
+      const float bias = static_cast<float>(scale_bias[1]);
+      const float inverse_scale = scale > 0.f ? 1.f / scale : 0.f;
+      std::memset(out, 0, value_bytes);
+      for (int64_t d = 0; d < ddim; d++) {
+        const float q = std::nearbyint((in[d] - bias) * inverse_scale);
+        const int value = static_cast<int>(std::min<float>(std::max(q, 0.f), kLevels));
+        out[d / kValuesPerByte] |= value << ((d % kValuesPerByte) * BIT_RATE);
+      }
+      std::memcpy(out + value_bytes, scale_bias, sizeof(scale_bias));
+    }
+  });
+  return output;
+}
+
+template <int BIT_RATE, typename scale_bias_t>
+Tensor qembedding_bag_rowwise_unpack(const Tensor& packed_weight, const char* op) {
+  TORCH_CHECK(packed_weight.dim() == 2 && packed_weight.scalar_type() == kByte, op,
+      ": expected a 2-D uint8 packed weight");
+  constexpr int64_t kValuesPerByte = 8 / BIT_RATE;
+  constexpr int kMask = (1 << BIT_RATE) - 1;
+  const int64_t num_rows = packed_weight.size(0);
+  const int64_t row_bytes = packed_weight.size(1);
+  const int64_t value_bytes = row_bytes - 2 * static_cast<int64_t>(sizeof(scale_bias_t));
+  TORCH_CHECK(value_bytes >= 0, op, ": packed rows of ", row_bytes,
+      " bytes are too short for a scale and bias");
+  const int64_t ddim = value_bytes * kValuesPerByte;
+
+  auto packed_contig = packed_weight.contiguous();
+  auto output = at::empty({num_rows, ddim}, packed_weight.options().dtype(kFloat));
+  const uint8_t* packed_data = packed_contig.data_ptr<uint8_t>();
+  float* output_data = output.data_ptr<float>();
+
+  const int64_t grain_size = std::max<int64_t>(1, internal::GRAIN_SIZE / std::max<int64_t>(1, ddim));
+  at::parallel_for(0, num_rows, grain_size, [&](int64_t begin, int64_t end) {
+    for (int64_t r = begin; r < end; r++) {
+      const uint8_t* in = packed_data + r * row_bytes;
+      float* out = output_data + r * ddim;
+      scale_bias_t scale_bias[2];
+      std::memcpy(scale_bias, in + value_bytes, sizeof(scale_bias));
+      const float scale = static_cast<float>(scale_bias[0]);
+      const float bias = static_cast<float>(scale_bias[1]);
+      for (int64_t d = 0; d < ddim; d++) {
+        const int value = (in[d / kValuesPerByte] >> ((d % kValuesPerByte) * BIT_RATE)) & kMask;
+        out[d] = scale * value + bias;
+      }
+    }
+  });
+  return output;
+}
+
+class QEmbeddingBagBytePrepack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    return qembedding_bag_rowwise_prepack<8, float>(
+        weight, "quantized::embedding_bag_byte_prepack");
+  }
+};
+
+class QEmbeddingBagByteUnpack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    return qembedding_bag_rowwise_unpack<8, float>(
+        packed_weight, "quantized::embedding_bag_byte_unpack");
+  }
+};
+
+class QEmbeddingBag4BitPrepack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor weight) {
+    return qembedding_bag_rowwise_prepack<4, at::Half>(
+        weight, "quantized::embedding_bag_4bit_prepack");
+  }
+};
+
+class QEmbeddingBag4BitUnpack final : public c10::OperatorKernel {
+ public:
+  Tensor operator()(Tensor packed_weight) {
+    return qembedding_bag_rowwise_unpack<4, at::Half>(
+        packed_weight, "quantized::embedding_bag_4bit_unpack");
+  }
+};
+
+static auto registry =
+    torch::RegisterOperators()
+        .op("quantized::embedding_bag_byte_prepack(Tensor weight) -> Tensor",
+            torch::RegisterOperators::options()
+                .kernel<QEmbeddingBagBytePrepack>(TensorTypeId::CPUTensorId))
+        .op("quantized::embedding_bag_byte_unpack(Tensor weight) -> Tensor",
+            torch::RegisterOperators::options()
+                .kernel<QEmbeddingBagByteUnpack>(TensorTypeId::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_prepack(Tensor weight) -> Tensor",
+            torch::RegisterOperators::options()
+                .kernel<QEmbeddingBag4BitPrepack>(TensorTypeId::CPUTensorId))
+        .op("quantized::embedding_bag_4bit_unpack(Tensor weight) -> Tensor",
+            torch::RegisterOperators::options()
+                .kernel<QEmbeddingBag4BitUnpack>(TensorTypeId::CPUTensorId));
+
+} // namespace
+} // namespace native
+} // namespace at
@@ -63,6 +63,20 @@ using qcat_nhwc_fn = Tensor (*)(
     int64_t dim,
     double scale,
     int64_t zero_point);
+// Sum (or mean, if the bool is set) of every bag of a row-wise quantized
+// embedding table into a float output of [bags, embedding_dim]. Every row of
+// the uint8 table is its quantized values followed by its scale and bias, and
+// a value q dequantizes to scale * q + bias:
+//   8-bit: | embedding_dim values | float scale | float bias |
+//   4-bit: | embedding_dim / 2 bytes, low nibble first | Half scale | Half bias |
+// per_sample_weights is a float tensor or undefined.
+using qembedding_bag_fn = void (*)(
+    const Tensor& /*weight*/,
+    const Tensor& /*indices*/,
+    const Tensor& /*offsets*/,
+    const Tensor& /*per_sample_weights*/,
+    bool /*mean*/,
+    Tensor& /*output*/);
 
 // using qavg_pool2d_fn
 DECLARE_DISPATCH(qrelu_fn, qrelu_stub);
@@ -74,6 +88,8 @@ DECLARE_DISPATCH(qadaptive_avg_pool2d_fn, qadaptive_avg_pool2d_nhwc_stub);
 DECLARE_DISPATCH(qavg_pool2d_fn, qavg_pool2d_nhwc_stub);
 DECLARE_DISPATCH(qcat_nhwc_fn, qcat_nhwc_stub);
 DECLARE_DISPATCH(qcat_nhwc_fn, qcat_relu_nhwc_stub);
+DECLARE_DISPATCH(qembedding_bag_fn, qembedding_bag_byte_stub);
+DECLARE_DISPATCH(qembedding_bag_fn, qembedding_bag_4bit_stub);
 
 } // namespace native
 } // namespace at
@@ -0,0 +1,203 @@
+// Basic functions on sparse CSR tensors
+
+#include <ATen/ATen.h>
+#include <ATen/Layout.h>
+#include <ATen/Parallel.h>
+#include <ATen/SparseCsrTensorImpl.h>
+#include <ATen/NativeFunctions.h>
+#include <ATen/SparseTensorUtils.h>
+
+namespace at { namespace native {
+
+using namespace at::sparse;
+
+
+/******************************************************************************
+ * access methods
+ ******************************************************************************/
+
+int64_t _nnz_sparse_csr(const Tensor& self) {
+  return get_sparse_csr_impl(self)->nnz();
+}
+
+Tensor crow_indices_sparse_csr(const Tensor& self) {
+  return get_sparse_csr_impl(self)->crow_indices().alias();
+}
+
+Tensor col_indices_sparse_csr(const Tensor& self) {
+  return get_sparse_csr_impl(self)->col_indices().alias();
+}
+
+Tensor values_sparse_csr(const Tensor& self) {
+  return get_sparse_csr_impl(self)->values().alias();
+}
+
+/******************************************************************************
+ * creation methods
+ ******************************************************************************/
+
+/*** Helper methods ***/
+
+Tensor new_sparse_csr(const TensorOptions& options) {
+  AT_ASSERT(!options.is_variable());  // TODO: remove this when Variable and Tensor are merged
+  AT_ASSERT(options.layout() == kSparseCsr);
+  TORCH_CHECK(options.device().is_cpu(), "sparse CSR tensors are only supported on CPU, but got device ", options.device());
+  return detail::make_tensor<SparseCsrTensorImpl>(
+      TensorTypeSet(TensorTypeId::SparseCsrCPUTensorId), options.dtype());
+}
+
+/** Actual dispatched creation methods ***/
+
+Tensor new_with_tensors_sparse_csr(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    IntArrayRef size,
+    const TensorOptions& options) {
+  Tensor self = new_sparse_csr(options);
+  // NOTE: Like new_with_dims_and_tensor_sparse, shallow-copy the member
+  // tensors so that the CSR tensor does not hold on to their AutogradMeta.
+  auto crow_indices_shallow_copy = Tensor(crow_indices.unsafeGetTensorImpl()->shallow_copy_and_detach(
+    /*version_counter=*/crow_indices.unsafeGetTensorImpl()->version_counter(),
+    /*allow_tensor_metadata_change=*/true));
+  auto col_indices_shallow_copy = Tensor(col_indices.unsafeGetTensorImpl()->shallow_copy_and_detach(
+    /*version_counter=*/col_indices.unsafeGetTensorImpl()->version_counter(),
+    /*allow_tensor_metadata_change=*/true));
+  auto values_shallow_copy = Tensor(values.unsafeGetTensorImpl()->shallow_copy_and_detach(
+    /*version_counter=*/values.unsafeGetTensorImpl()->version_counter(),
+    /*allow_tensor_metadata_change=*/true));
+  get_sparse_csr_impl(self)->set_member_tensors_unsafe(
+      crow_indices_shallow_copy, col_indices_shallow_copy, values_shallow_copy, size);
+  return self;
+}
+
+/** Public creation API that dispatch to methods above **/
+
+Tensor sparse_csr_tensor(
+    const Tensor& crow_indices,
+    const Tensor& col_indices,
+    const Tensor& values,
+    IntArrayRef size,
+    const TensorOptions& options) {
+  // arg checking
+  TORCH_CHECK(!options.has_layout() || options.layout() == kSparseCsr, "expected sparse CSR layout, but got layout ", options.layout());
+  TORCH_CHECK(!options.has_device() || options.device().is_cpu(), "sparse CSR tensors are only supported on CPU, but got device ", options.device());
+  Tensor values_ = options.has_dtype() ? values.to(typeMetaToScalarType(options.dtype())) : values;
+  // the shape checks are repeated in SparseCsrTensorImpl::set_member_tensors_unsafe,
+  // but we need them here to read the row pointers safely.
+  TORCH_CHECK(size.size() == 2, "sparse CSR tensors must be 2-dimensional, but got size ", size);
+  TORCH_CHECK(crow_indices.dim() == 1 && col_indices.dim() == 1,
+      "crow_indices and col_indices must be 1-dimensional, but got ", crow_indices.dim(), " and ", col_indices.dim());
+  TORCH_CHECK(crow_indices.size(0) == size[0] + 1,
+      "crow_indices must have size(0) == size[0] + 1 (", size[0] + 1, "), but got ", crow_indices.size(0));
+
+  // Check that the row pointers are well formed and that all column indices
+  // are within the boundaries of `size`
+  int64_t nnz = col_indices.size(0);
+  int64_t first = crow_indices[0].item<int64_t>();
+  int64_t last = crow_indices[size[0]].item<int64_t>();
+  TORCH_CHECK(first == 0, "crow_indices must start at 0, but got ", first);
+  TORCH_CHECK(last == nnz, "crow_indices must end at nnz (", nnz, "), but got ", last);
+  if (size[0] > 0) {
+    int64_t min_row_nnz = crow_indices.narrow(0, 1, size[0]).sub(crow_indices.narrow(0, 0, size[0])).min().item<int64_t>();
+    TORCH_CHECK(min_row_nnz >= 0, "crow_indices must be non-decreasing");
+  }
+  if (nnz > 0) {
+    int64_t min_col = col_indices.min().item<int64_t>();
+    TORCH_CHECK(min_col >= 0, "found negative column index ", min_col);
+    int64_t max_col = col_indices.max().item<int64_t>();
+    TORCH_CHECK(max_col < size[1],
+        "size is inconsistent with col_indices: size[1] is ", size[1], " but found column index ", max_col);
+  }
+
+  return at::_sparse_csr_tensor_unsafe(crow_indices, col_indices, values_, size, values_.options().layout(kSparseCsr));
+}
+
+/******************************************************************************
+ * conversions
+ ******************************************************************************/
+
+Tensor dense_to_sparse_csr(const Tensor& self) {
+  TORCH_CHECK(self.dim() == 2, "to_sparse_csr: expected a 2-dimensional tensor, but got ", self.dim(), "D tensor");
+  return self.to_sparse().to_sparse_csr();  // redispatch!
+}
+
+Tensor sparse_to_sparse_csr(const SparseTensor& self_) {
+  TORCH_CHECK(self_.sparse_dim() == 2 && self_.dense_dim() == 0,
+      "to_sparse_csr: expected a 2-dimensional sparse tensor with scalar values, but got sparse_dim ",
+      self_.sparse_dim(), " and dense_dim ", self_.dense_dim());
+  // CSR needs the entries sorted by row and then by column
+  SparseTensor self = self_.coalesce();
+  int64_t nnz = self._nnz();
+  LongTensor indices = self._indices();
+
+  LongTensor row_indices = indices.select(0, 0).contiguous();
+  LongTensor crow_indices = coo_to_csr(row_indices.data_ptr<int64_t>(), self.size(0), nnz);
+  LongTensor col_indices = indices.select(0, 1).clone();
+  return at::_sparse_csr_tensor_unsafe(crow_indices, col_indices, self._values().clone(), self.sizes(),
+                                       self._values().options().layout(kSparseCsr));
+}
+
+SparseTensor sparse_csr_to_sparse(const Tensor& self) {
+  SparseCsrTensorImpl* self_impl = get_sparse_csr_impl(self);
+  int64_t nrows = self.size(0);
+  int64_t nnz = self_impl->nnz();
+  const int64_t* crow_ptr = self_impl->crow_indices().data_ptr<int64_t>();
+
+  // Expand the row pointers back into one row index per entry
+  LongTensor indices = at::empty({2, nnz}, kLong);
+  int64_t* row_ptr = indices.data_ptr<int64_t>();
+  at::parallel_for(0, nrows, 0, [&](int64_t start, int64_t end) {
+    for (int64_t row = start; row < end; row++) {
+      for (int64_t i = crow_ptr[row]; i < crow_ptr[row + 1]; i++) {
+        row_ptr[i] = row;
+      }
+    }
+  });
+  indices.select(0, 1).copy_(self_impl->col_indices());
+
+  // The column indices of a row are not required to be sorted or unique, so
+  // the result is not marked as coalesced.
+  return at::_sparse_coo_tensor_unsafe(indices, self_impl->values().clone(), self.sizes(),
+                                       self_impl->values().options().layout(kSparse));
+}
+
+Tensor sparse_csr_to_dense(const Tensor& self) {
+  TORCH_CHECK(self.scalar_type() != ScalarType::Half, "to_dense() not supported for float16 on CPU");
+  SparseCsrTensorImpl* self_impl = get_sparse_csr_impl(self);
+  Tensor dst = at::zeros(self.sizes(), self.options().layout(kStrided));
+  int64_t nrows = self.size(0);
+  int64_t ncols = self.size(1);
+  const int64_t* crow_ptr = self_impl->crow_indices().data_ptr<int64_t>();
+  const int64_t* col_ptr = self_impl->col_indices().data_ptr<int64_t>();
+  Tensor values = self_impl->values().contiguous();
+
+  AT_DISPATCH_ALL_TYPES(
+      values.scalar_type(), "sparse_csr_to_dense", [&] {
+        const scalar_t* values_ptr = values.data_ptr<scalar_t>();
+        scalar_t* dst_ptr = dst.data_ptr<scalar_t>();
+        // each task only writes to its own rows of dst
+        at::parallel_for(0, nrows, 0, [&](int64_t start, int64_t end) {
+          for (int64_t row = start; row < end; row++) {
+            for (int64_t i = crow_ptr[row]; i < crow_ptr[row + 1]; i++) {
+              // duplicate entries are summed, as for uncoalesced COO tensors
+              dst_ptr[row * ncols + col_ptr[i]] += values_ptr[i];
+            }
+          }
+        });
+      }
+  );
+  return dst;
+}
+
+/******************************************************************************
+ * shape methods
+ ******************************************************************************/
+
+Tensor sparse_csr_transpose(const Tensor& self) {
+  // the rows of the transpose are the columns of self, so they have to be
+  // re-sorted; go through COO, whose transpose only swaps the index rows
+  return self.to_sparse().t().to_sparse_csr();  // redispatch!
+}
+
+}} // namespace at::native
@@ -8,8 +8,14 @@
 #include <ATen/InitialTensorOptions.h>
 #include <ATen/SparseTensorUtils.h>
 
+#include <ATen/native/ParallelSort.h>
+
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
@@ -369,7 +375,19 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   int64_t dense_dim = self.dense_dim();
   int64_t nnz = self._nnz();
 
+  // The radix sort keys of the flattened indices are equal exactly when the
+  // indices are.
   LongTensor indices_scalar = flatten_indices(indices, self.sizes());
+  auto indicesScalarAccessor = indices_scalar.accessor<int64_t, 1>();
+  std::vector<uint64_t> sorted(nnz);
+  std::vector<int64_t> perm(nnz);
+  at::parallel_for(0, nnz, at::internal::GRAIN_SIZE, [&](int64_t start, int64_t end) {
+    for (int64_t j = start; j < end; j++) {
+      sorted[j] = RadixSortKey<int64_t>::encode(indicesScalarAccessor[j]);
+      perm[j] = j;
+    }
+  });
+  radix_sort_pairs(sorted.data(), perm.data(), nnz);
 
   SparseTensor dst = new_sparse(self.options());
   get_sparse_impl(dst)->resize_(sparse_dim, dense_dim, self.sizes());
@@ -378,44 +396,67 @@ SparseTensor coalesce_sparse_cpu(const SparseTensor& self) {
   Tensor newValues = at::empty(values.sizes(), values.options());
   alias_into_sparse(dst, newIndices, newValues);
 
-  LongTensor indicesBuffer;
-  LongTensor indicesPermutation;
-  std::tie(indicesBuffer, indicesPermutation) = indices_scalar.sort(0);
   // NB: The accessor accesses here rely on self._nnz() > 0 (tested earlier in this function)
   auto newIndicesAccessor = newIndices.accessor<int64_t, 2>();
   auto indicesAccessor = indices.accessor<int64_t, 2>();
-  auto indicesPermutationAccessor = indicesPermutation.accessor<int64_t, 1>();
-  auto indicesBufferAccessor = indicesBuffer.accessor<int64_t, 1>();
 
-  int64_t i = -1;
+  // Each chunk owns the runs of equal keys that start within it, so it can
+  // sum duplicates without synchronizing with its neighbours. A first pass
+  // counts the runs of every chunk to find where the chunk writes its output.
+  const int64_t num_chunks = parallel_sort_num_chunks(nnz, at::internal::GRAIN_SIZE);
+  const int64_t chunk_size = divup(nnz, num_chunks);
+  auto is_run_start = [&](int64_t j) {
+    return j == 0 || sorted[j] != sorted[j - 1];
+  };
+  std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+  at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+    for (int64_t c = chunk_begin; c < chunk_end; c++) {
+      int64_t runs = 0;
+      for (int64_t j = c * chunk_size; j < std::min(nnz, (c + 1) * chunk_size); j++) {
+        runs += is_run_start(j);
+      }
+      chunk_offsets[c + 1] = runs;
+    }
+  });
+  std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "coalesce", [&] {
-        int64_t prev = -1;
         int64_t blockSize = values.stride(0);
         scalar_t* values_ptr = values.data_ptr<scalar_t>();
         scalar_t* newValues_ptr = newValues.data_ptr<scalar_t>();
-        for (int64_t j = 0; j < nnz; j++) {
-          int64_t pos = indicesPermutationAccessor[j];
-          int64_t curr = indicesBufferAccessor[j];
-          if (curr == prev) {
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+        at::parallel_for(0, num_chunks, 1, [&](int64_t chunk_begin, int64_t chunk_end) {
+          for (int64_t c = chunk_begin; c < chunk_end; c++) {
+            int64_t j = c * chunk_size;
+            const int64_t end = std::min(nnz, (c + 1) * chunk_size);
+            while (j < end && !is_run_start(j)) {
+              j++;
             }
-          } else {
-            ++i;
-            for (int64_t d = 0; d < sparse_dim; d++) {
-              newIndicesAccessor[d][i] = indicesAccessor[d][pos];
+            if (j == end) {
+              continue;  // no run starts in this chunk
             }
-            if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
-              THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+            int64_t i = chunk_offsets[c] - 1;
+            // The last run of the chunk may continue into the next chunks.
+            for (; j < nnz && (j < end || !is_run_start(j)); j++) {
+              int64_t pos = perm[j];
+              if (is_run_start(j)) {
+                ++i;
+                for (int64_t d = 0; d < sparse_dim; d++) {
+                  newIndicesAccessor[d][i] = indicesAccessor[d][pos];
+                }
+                if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
+                  THBlas_copy<scalar_t>(blockSize, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+                }
+              } else if (values.numel() > 0) {  // if values is an empty tensor, there are no elements to copy
+                THBlas_axpy<scalar_t>(blockSize, 1, values_ptr + pos * blockSize, 1, newValues_ptr + i * blockSize, 1);
+              }
             }
           }
-          prev = curr;
-        }
+        });
     });
 
   dst._coalesced_(true);
-  get_sparse_impl(dst)->set_nnz_and_narrow(i + 1);
+  get_sparse_impl(dst)->set_nnz_and_narrow(chunk_offsets[num_chunks]);
 
   return dst;
 }
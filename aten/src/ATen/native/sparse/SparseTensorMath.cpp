@@ -2,6 +2,7 @@
 
 #include <ATen/ATen.h>
 #include <ATen/Parallel.h>
+#include <ATen/SparseCsrTensorImpl.h>
 #include <ATen/SparseTensorImpl.h>
 #include <ATen/ExpandUtils.h>
 #include <ATen/NativeFunctions.h>
@@ -11,36 +12,14 @@
 
 #include <TH/THBlasUtils.h>
 
+#include <algorithm>
+#include <numeric>
+#include <utility>
+#include <vector>
+
 namespace at { namespace native {
 
 using namespace at::sparse;
-// --------------------------------------------------------------------
-// Utility functions
-// --------------------------------------------------------------------
-
-namespace {
-  LongTensor _to_csr(const int64_t* indices, int64_t dim, int64_t nnz) {
-    LongTensor csr = native::zeros({dim + 1}, kLong);
-
-    // TODO: eliminate this conditional when zero-size dims supported correctly
-    if (nnz > 0) {
-      auto csr_accessor = csr.accessor<int64_t, 1>();
-      // Convert the sparse matrix to CSR format
-      at::parallel_for(0, nnz, 10000, [&](int64_t start, int64_t end) {
-        int64_t h, hp0, hp1;
-        for (auto i = start; i < end; i++) {
-          hp0 = indices[i];
-          hp1 = (i+1 == nnz) ?  dim : indices[i+1];
-          if (hp0 != hp1) for (h = hp0; h < hp1; h++) {
-            csr_accessor[h+1] = i+1;
-          }
-        }
-      });
-    }
-    return csr;
-  }
-
-}
 
 // --------------------------------------------------------------------
 // zero_(SparseTensor)
@@ -230,6 +209,120 @@ Tensor& sub_out_sparse(Tensor& r, const Tensor& self, const Tensor& other, Scala
 
 Tensor& add_out_dense_sparse_cpu(Tensor& r, const Tensor& dense, const SparseTensor& sparse_, Scalar value);
 
+namespace {
+  constexpr int64_t kAddSparseGrain = 32768;
+
+  // Returns the number of entries of the sorted, duplicate free keys `a` and
+  // `b` that precede the position `diagonal` of their merge. The split is
+  // moved to the start of the smallest key that follows it, so a key that is
+  // in both inputs always ends up on one side.
+  std::pair<int64_t, int64_t> merge_split(const int64_t* a, int64_t a_n, const int64_t* b, int64_t b_n, int64_t diagonal) {
+    int64_t lo = std::max<int64_t>(0, diagonal - b_n);
+    int64_t hi = std::min(diagonal, a_n);
+    while (lo < hi) {
+      int64_t mid = lo + (hi - lo) / 2;
+      if (a[mid] < b[diagonal - mid - 1]) {
+        lo = mid + 1;
+      } else {
+        hi = mid;
+      }
+    }
+    int64_t i = lo, j = diagonal - lo;
+    if (i == a_n && j == b_n) {
+      return {i, j};
+    }
+    int64_t key = i == a_n ? b[j] : (j == b_n ? a[i] : std::min(a[i], b[j]));
+    return {std::lower_bound(a, a + a_n, key) - a, std::lower_bound(b, b + b_n, key) - b};
+  }
+
+  // Merges the coalesced inputs of add_out_sparse_cpu in parallel. r_indices
+  // and r_values have room for t_nnz + s_nnz entries and the values are
+  // zeroed. The merge is cut into chunks along the flattened indices, and a
+  // first pass over the keys counts the output of every chunk, so chunks
+  // write their part of the result independently. Returns the nnz of r.
+  template <typename scalar_t>
+  int64_t add_out_sparse_coalesced_cpu_kernel(
+      LongTensor& r_indices, Tensor& r_values,
+      const LongTensor& t_indices, const Tensor& t_values,
+      const LongTensor& src_indices, const Tensor& s_values,
+      const LongTensor& t_keys_, const LongTensor& s_keys_,
+      scalar_t cast_value) {
+    const int64_t sparse_dim = r_indices.size(0);
+    const int64_t t_nnz = t_keys_.numel(), s_nnz = s_keys_.numel();
+    const int64_t* t_keys = t_keys_.data_ptr<int64_t>();
+    const int64_t* s_keys = s_keys_.data_ptr<int64_t>();
+    const int64_t blockSize = r_values.stride(0);
+
+    const int64_t num_chunks = std::max<int64_t>(1, std::min<int64_t>(at::get_num_threads(), (t_nnz + s_nnz) / kAddSparseGrain));
+    std::vector<std::pair<int64_t, int64_t>> splits(num_chunks + 1);
+    std::vector<int64_t> chunk_offsets(num_chunks + 1, 0);
+    at::parallel_for(0, num_chunks + 1, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        splits[c] = merge_split(t_keys, t_nnz, s_keys, s_nnz, divup((t_nnz + s_nnz) * c, num_chunks));
+      }
+    });
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        int64_t t_i = splits[c].first, s_i = splits[c].second, count = 0;
+        while (t_i < splits[c + 1].first || s_i < splits[c + 1].second) {
+          if (s_i == splits[c + 1].second || (t_i < splits[c + 1].first && t_keys[t_i] < s_keys[s_i])) {
+            t_i++;
+          } else if (t_i == splits[c + 1].first || s_keys[s_i] < t_keys[t_i]) {
+            s_i++;
+          } else {
+            t_i++;
+            s_i++;
+          }
+          count++;
+        }
+        chunk_offsets[c + 1] = count;
+      }
+    });
+    std::partial_sum(chunk_offsets.begin(), chunk_offsets.end(), chunk_offsets.begin());
+
+    auto t_indices_accessor = t_indices.accessor<int64_t, 2>();
+    auto r_indices_accessor = r_indices.accessor<int64_t, 2>();
+    auto src_indices_accessor = src_indices.accessor<int64_t, 2>();
+    scalar_t* t_values_ptr = t_values.data_ptr<scalar_t>();
+    scalar_t* s_values_ptr = s_values.data_ptr<scalar_t>();
+    scalar_t* r_values_ptr = r_values.data_ptr<scalar_t>();
+    at::parallel_for(0, num_chunks, 1, [&](int64_t begin, int64_t end) {
+      for (int64_t c = begin; c < end; c++) {
+        const int64_t t_end = splits[c + 1].first, s_end = splits[c + 1].second;
+        int64_t t_i = splits[c].first, s_i = splits[c].second, r_i = chunk_offsets[c];
+        while (t_i < t_end || s_i < s_end) {
+          bool take_t = t_i < t_end && (s_i == s_end || t_keys[t_i] <= s_keys[s_i]);
+          bool take_s = s_i < s_end && (t_i == t_end || s_keys[s_i] <= t_keys[t_i]);
+          if (take_t) {
+            for (int64_t d = 0; d < sparse_dim; d++) {
+              r_indices_accessor[d][r_i] = t_indices_accessor[d][t_i];
+            }
+            if (t_values.numel() > 0) {
+              THBlas_axpy<scalar_t>(blockSize, 1,
+                t_values_ptr + t_i * blockSize, 1,
+                r_values_ptr + r_i * blockSize, 1);
+            }
+            t_i++;
+          }
+          if (take_s) {
+            for (int64_t d = 0; d < sparse_dim; d++) {
+              r_indices_accessor[d][r_i] = src_indices_accessor[d][s_i];
+            }
+            if (s_values.numel() > 0) {
+              THBlas_axpy<scalar_t>(blockSize, cast_value,
+                s_values_ptr + s_i * blockSize, 1,
+                r_values_ptr + r_i * blockSize, 1);
+            }
+            s_i++;
+          }
+          r_i++;
+        }
+      }
+    });
+    return chunk_offsets[num_chunks];
+  }
+}
+
 SparseTensor& add_out_sparse_cpu(SparseTensor& r, const SparseTensor& t, const SparseTensor& src, Scalar value) {
   if (!t.is_sparse()) {
     return add_out_dense_sparse_cpu(r, t, src, value);
@@ -261,7 +354,26 @@ SparseTensor& add_out_sparse_cpu(SparseTensor& r, const SparseTensor& t, const S
   Tensor s_values = src._values();
   r.resize_as_(src);
 
-  if (s_values.is_contiguous() && t_values.is_contiguous()) {
+  if (s_values.is_contiguous() && t_values.is_contiguous() && t_coalesced && s_coalesced) {
+    LongTensor r_indices = at::empty({sparse_dim, max_nnz}, t_indices.options());
+    Tensor r_values = new_values_with_size_of(s_values, max_nnz).zero_();
+    // Coalesced indices are sorted by their flattened index.
+    LongTensor t_keys = flatten_indices(t_indices, src.sizes()).contiguous();
+    LongTensor s_keys = flatten_indices(src_indices, src.sizes()).contiguous();
+    get_sparse_impl(r)->set_indices_and_values_unsafe(r_indices, r_values);
+
+    int64_t r_nnz = 0;
+    AT_DISPATCH_ALL_TYPES(
+        t_values.scalar_type(), "cadd_sparse", [&] {
+          r_nnz = add_out_sparse_coalesced_cpu_kernel<scalar_t>(
+              r_indices, r_values, t_indices, t_values, src_indices, s_values,
+              t_keys, s_keys, value.to<scalar_t>());
+        }
+    );
+
+    get_sparse_impl(r)->set_nnz_and_narrow(r_nnz);
+    return r._coalesced_(true);
+  } else if (s_values.is_contiguous() && t_values.is_contiguous()) {
     LongTensor r_indices = at::empty({sparse_dim, max_nnz}, t_indices.options());
     Tensor r_values = new_values_with_size_of(s_values, max_nnz).zero_();
     get_sparse_impl(r)->set_indices_and_values_unsafe(r_indices, r_values);
@@ -533,10 +645,12 @@ SparseTensor& mul_out_sparse_cpu(SparseTensor& r, const Tensor& t_, const Tensor
 // D = beta * D1 + alpha * mm(S, D2)
 // --------------------------------------------------------------------
 
+// The rows of S are computed in parallel from its CSR form (crow_indices,
+// col_indices, values), so every thread writes to its own rows of D.  A
+// SparseCsr tensor passes its own member tensors; a COO tensor is coalesced
+// and its row indices compressed with coo_to_csr first.
 template <typename scalar_t>
-void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& indices, const Tensor& values, const Tensor& dense) {
-  int64_t i;
-
+void s_addmm_out_csr_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j, int64_t dim_k, Tensor& r, Scalar beta, const Tensor& t, Scalar alpha, const Tensor& crow_indices, const Tensor& col_indices, const Tensor& values, const Tensor& dense) {
   // r_ = alpha * sparse * dense
   scalar_t cast_alpha = alpha.to<scalar_t>();
   scalar_t cast_beta = beta.to<scalar_t>();
@@ -550,9 +664,12 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
     at::mul_out(r, t, scalar_to_tensor(beta));
   }
 
-  auto indices_accessor = indices.accessor<int64_t, 2>();
+  const int64_t* csr_ptr = crow_indices.data_ptr<int64_t>();
+  const int64_t* col_ptr = col_indices.data_ptr<int64_t>();
+  int64_t col_stride = col_indices.stride(0);
 
-  auto values_accessor = values.accessor<scalar_t, 1>();
+  const scalar_t* values_ptr = values.data_ptr<scalar_t>();
+  int64_t values_stride = values.stride(0);
   scalar_t* dense_ptr = dense.data_ptr<scalar_t>();
   scalar_t* r_ptr = r.data_ptr<scalar_t>();
 
@@ -560,23 +677,22 @@ void s_addmm_out_sparse_dense_worker(int64_t nnz, int64_t dim_i, int64_t dim_j,
   int64_t dense_stride1 = dense.stride(1);
   int64_t r_stride0 = r.stride(0);
   int64_t r_stride1 = r.stride(1);
-  for (i = 0; i < nnz; i++) {
-    scalar_t val = values_accessor[i];
-    int64_t row = indices_accessor[0][i];
-    int64_t col = indices_accessor[1][i];
-    if (col >= 0 && col < dim_j && row >= 0 && row < dim_i) {
-      THBlas_axpy<scalar_t>(dim_k,
-            cast_alpha * val,
-            dense_ptr + col * dense_stride0, dense_stride1,
-            r_ptr + row * r_stride0, r_stride1);
-    } else {
-      if (col < 0 || col >= dim_j) {
-        AT_ERROR("addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
-      } else {
-        AT_ERROR("addmm: index out of row bound: ", row, " not between 1 and ", dim_i);
+  // grain size in rows, aiming at ~GRAIN_SIZE multiply-adds per task
+  int64_t grain_size = std::max<int64_t>(1, at::internal::GRAIN_SIZE / std::max<int64_t>(1, dim_k * nnz / dim_i));
+  at::parallel_for(0, dim_i, grain_size, [&](int64_t start, int64_t end) {
+    for (int64_t row = start; row < end; row++) {
+      for (int64_t i = csr_ptr[row]; i < csr_ptr[row + 1]; i++) {
+        int64_t col = col_ptr[i * col_stride];
+        if (col < 0 || col >= dim_j) {
+          AT_ERROR("addmm: index out of column bound: ", col, " not between 1 and ", dim_j);
+        }
+        THBlas_axpy<scalar_t>(dim_k,
+              cast_alpha * values_ptr[i * values_stride],
+              dense_ptr + col * dense_stride0, dense_stride1,
+              r_ptr + row * r_stride0, r_stride1);
       }
     }
-  }
+  });
 };
 
 Tensor& s_addmm_out_sparse_dense_cpu(
@@ -618,12 +734,26 @@ Tensor& s_addmm_out_sparse_dense_cpu(
     return r;
   }
 
-  LongTensor indices = sparse_._indices();
-  Tensor values      = sparse_._values();
+  // The CSR view needs the indices to be sorted by row
+  SparseTensor sparse = sparse_.coalesce();
+  nnz = sparse._nnz();
+  LongTensor indices = sparse._indices();
+  Tensor values      = sparse._values();
+
+  // indices are sorted by row, so only the first and last rows can be out
+  // of bounds
+  auto indices_accessor = indices.accessor<int64_t, 2>();
+  int64_t first_row = indices_accessor[0][0];
+  int64_t last_row = indices_accessor[0][nnz - 1];
+  if (first_row < 0 || last_row >= dim_i) {
+    AT_ERROR("addmm: index out of row bound: ", first_row < 0 ? first_row : last_row, " not between 1 and ", dim_i);
+  }
+  LongTensor crow_indices = coo_to_csr(indices.data_ptr<int64_t>(), dim_i, nnz);
+  LongTensor col_indices = indices.select(0, 1);
 
   AT_DISPATCH_ALL_TYPES(
       values.scalar_type(), "addmm_sparse_dense", [&] {
-        s_addmm_out_sparse_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, indices, values, dense);
+        s_addmm_out_csr_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha, crow_indices, col_indices, values, dense);
       }
   );
 
@@ -680,6 +810,97 @@ Tensor& s_addmm_sparse_dense_cpu_(
 
 // NB: Purposely no broadcasting version of addmm inplace
 
+// --------------------------------------------------------------------
+// addmm(D1, S, D2, beta, alpha) -> D  [broadcasts], S in SparseCsr layout
+// --------------------------------------------------------------------
+
+Tensor& s_addmm_out_sparse_csr_dense_cpu(
+    Tensor& r,
+    const Tensor& t,
+    const Tensor& sparse,
+    const Tensor& dense,
+    Scalar beta,
+    Scalar alpha
+) {
+  // mat1 is the only argument that may be sparse CSR; the others only
+  // dispatched here alongside it
+  TORCH_CHECK(sparse.is_sparse_csr(), "addmm: expected 'mat1' to be a sparse CSR tensor, but got layout ", sparse.layout());
+  TORCH_CHECK(t.layout() == kStrided, "addmm: expected 'self' to be a strided tensor, but got layout ", t.layout());
+  TORCH_CHECK(dense.layout() == kStrided, "addmm: expected 'mat2' to be a strided tensor, but got layout ", dense.layout());
+  TORCH_CHECK(r.layout() == kStrided, "addmm: expected 'out' to be a strided tensor, but got layout ", r.layout());
+  TORCH_CHECK(dense.dim() == 2, "addmm: matrices expected, got ", dense.dim(), "D tensor");
+  TORCH_CHECK(dense.scalar_type() == sparse.scalar_type(),
+      "addmm: expected 'mat2' to have dtype ", sparse.scalar_type(), ", but got ", dense.scalar_type());
+
+  // ixj * jxk = ixk
+  int64_t dim_i = sparse.size(0);
+  int64_t dim_j = sparse.size(1);
+  int64_t dim_k = dense.size(1);
+
+  TORCH_CHECK(dense.size(0) == dim_j,
+      "addmm: Argument #3 (dense): Expected dim 0 size ", dim_j, ", got ", dense.size(0));
+  TORCH_CHECK(t.size(0) == dim_i,
+      "addmm: Argument #1 (t): Expected dim 0 size ", dim_i, ", got ", t.size(0));
+  TORCH_CHECK(t.size(1) == dim_k,
+      "addmm: Argument #1 (t): Expected dim 1 size ", dim_k, ", got ", t.size(1));
+
+  r.resize_({dim_i, dim_k});
+
+  SparseCsrTensorImpl* sparse_impl = get_sparse_csr_impl(sparse);
+  int64_t nnz = sparse_impl->nnz();
+
+  if (nnz == 0) {
+    at::mul_out(r, t, at::scalar_tensor(beta, r.options()));
+    return r;
+  }
+
+  AT_DISPATCH_ALL_TYPES(
+      sparse.scalar_type(), "addmm_sparse_csr_dense", [&] {
+        s_addmm_out_csr_dense_worker<scalar_t>(nnz, dim_i, dim_j, dim_k, r, beta, t, alpha,
+            sparse_impl->crow_indices(), sparse_impl->col_indices(), sparse_impl->values(), dense);
+      }
+  );
+
+  return r;
+}
+
+Tensor& addmm_out_sparse_csr_dense_cpu(
+    Tensor& result,
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    Scalar beta,
+    Scalar alpha
+) {
+  Tensor b_self;
+  std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm_out");
+  return s_addmm_out_sparse_csr_dense_cpu(result, b_self, mat1, mat2, beta, alpha);
+}
+
+Tensor addmm_sparse_csr_dense_cpu(
+    const Tensor& self,
+    const Tensor& mat1,
+    const Tensor& mat2,
+    Scalar beta,
+    Scalar alpha
+) {
+  Tensor b_self;
+  std::tie(b_self) = expand_size(self, {mat1.size(0), mat2.size(1)}, "addmm_out");
+  Tensor r = at::empty({0}, b_self.options());
+  s_addmm_out_sparse_csr_dense_cpu(r, b_self, mat1, mat2, beta, alpha);
+  return r;
+}
+
+Tensor& s_addmm_sparse_csr_dense_cpu_(
+    Tensor& t,
+    const Tensor& sparse,
+    const Tensor& dense,
+    Scalar beta,
+    Scalar alpha
+) {
+  return s_addmm_out_sparse_csr_dense_cpu(t, t, sparse, dense, beta, alpha);
+}
+
 Tensor _sparse_addmm(
   const Tensor& t,
   const SparseTensor& sparse,
@@ -713,6 +934,22 @@ SparseTensor& _sparse_mm_out(
   return at::addmm_out(result, t, sparse, dense, 0, 1);  // redispatch!
 }
 
+// --------------------------------------------------------------------
+// mv(SparseTensor, Tensor)
+// --------------------------------------------------------------------
+
+Tensor mv_sparse(const SparseTensor& self, const Tensor& vec)
+{
+  TORCH_CHECK(self.ndimension() == 2 && vec.ndimension() == 1,
+              "mv: two tensor dim should be 2 and 1, but got ",
+              "SparseTensor Dim: ", self.ndimension(), "Tensor Dim: ", vec.ndimension());
+  TORCH_CHECK(vec.size(-1) == self.size(-1),
+              "mv: expected self.size(-1) == vec.size(-1)");
+
+  Tensor result = at::_sparse_mm(self, vec.unsqueeze(1));  // redispatch!
+  return result.squeeze_(1);
+}
+
 // --------------------------------------------------------------------
 // hspmm(SparseTensor mat1, Tensor mat2)
 // --------------------------------------------------------------------
@@ -840,7 +1077,7 @@ SparseTensor& _sspaddmm_out_cpu(
   LongTensor indices = sparse._indices();
   Tensor values      = sparse._values();
 
-  LongTensor csr = _to_csr(indices.data_ptr<int64_t>(), dim_i, nnz);
+  LongTensor csr = coo_to_csr(indices.data_ptr<int64_t>(), dim_i, nnz);
 
   int64_t t_nnz = t._nnz();
   int64_t r_nnz = nnz * dim_k + t_nnz;
@@ -272,6 +272,9 @@ class CAFFE2_API Tensor {
   /// Returns if a `Tensor` is mkldnn tensor.
   bool is_mkldnn() const;
 
+  /// Returns if a `Tensor` has sparse CSR backend.
+  bool is_sparse_csr() const;
+
   /// Returns if a `Tensor` has quantized backend.
   bool is_quantized() const;
 
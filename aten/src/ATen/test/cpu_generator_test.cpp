@@ -196,6 +196,37 @@ TEST(CPUGenerator, TestPhiloxEngineIndex) {
   ASSERT_NE(engine1(), engine2());
 }
 
+TEST(CPUGenerator, TestPhiloxMode) {
+  // Test Description:
+  //   Tests that Philox mode fills match a serial walk of the Philox
+  //   stream, however they are split across threads, and that consecutive
+  //   fills continue the stream.
+  auto gen = at::detail::createCPUGenerator(123);
+  gen->set_philox_mode(true);
+  const int64_t numel = 100003;
+  auto first = at::empty({numel}).uniform_(0, 1, gen.get());
+  auto second = at::empty({numel}).uniform_(0, 1, gen.get());
+
+  at::Philox4_32_10 engine(123, 0, 0);
+  auto first_data = first.data_ptr<float>();
+  for (int64_t i = 0; i < numel; i++) {
+    ASSERT_EQ(first_data[i], (engine() & ((1 << 24) - 1)) * (1.0f / (1 << 24)));
+  }
+  // the second fill starts at the next 128 bit number
+  engine = at::Philox4_32_10(123, 0, (numel + 3) / 4);
+  ASSERT_EQ(second.data_ptr<float>()[0], (engine() & ((1 << 24) - 1)) * (1.0f / (1 << 24)));
+
+  // reseeding restarts the stream
+  gen->set_current_seed(123);
+  ASSERT_TRUE(at::empty({numel}).uniform_(0, 1, gen.get()).equal(first));
+
+  auto normal = at::empty({numel}, at::kDouble).normal_(0, 1, gen.get());
+  ASSERT_NEAR(normal.mean().item<double>(), 0, 0.05);
+  ASSERT_NEAR(normal.std().item<double>(), 1, 0.05);
+  auto bernoulli = at::empty({numel}, at::kByte).bernoulli_(0.3, gen.get());
+  ASSERT_NEAR(bernoulli.to(at::kFloat).mean().item<float>(), 0.3, 0.05);
+}
+
 /**
  * MT19937 CPU Engine Tests
  */
@@ -37,3 +37,14 @@ struct THGeneratorStateNew {
   float next_float_normal_sample;
   bool is_next_float_normal_sample_valid;
 };
+
+/**
+ * THGeneratorStatePhilox is a POD class extending THGeneratorStateNew
+ * with the state of the Philox mode of at::CPUGenerator. It is the format
+ * returned by torch.get_rng_state().
+ */
+struct THGeneratorStatePhilox {
+  THGeneratorStateNew new_pod;
+  uint64_t philox_offset;
+  bool philox_mode;
+};
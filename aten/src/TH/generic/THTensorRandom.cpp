@@ -10,6 +10,7 @@
 #include <algorithm>
 #include <type_traits>
 #include <ATen/Utils.h>
+#include <ATen/native/PhiloxFill.h>
 #include <TH/THGenerator.hpp>
 
 void THTensor_(random)(THTensor *self, at::Generator *_generator)
@@ -79,6 +80,14 @@ void THTensor_(geometric)(THTensor *self, double p, at::Generator *_generator)
 void THTensor_(uniform)(THTensor *self, double a, double b, at::Generator *_generator)
 {
   auto gen = at::get_generator_or_default<at::CPUGenerator>(_generator, at::detail::getDefaultCPUGenerator());
+  if (gen->philox_mode()) {
+    // See Note [Philox mode of CPUGenerator]
+    THArgCheck(a <= b, 2, "uniform_ expects to return a [from, to) range, but found from=%f > to=%f", a, b);
+    THTensor *contig = THTensor_(newContiguous)(self);
+    at::native::philox_uniform_fill(contig->data<scalar_t>(), THTensor_(nElement)(contig), gen, a, b);
+    THTensor_(freeCopyTo)(contig, self);
+    return;
+  }
   // See Note [Acquire lock when using random generators]
   std::lock_guard<std::mutex> lock(gen->mutex_);
 
@@ -94,6 +103,15 @@ void THTensor_(uniform)(THTensor *self, double a, double b, at::Generator *_gene
 void THTensor_(normal)(THTensor *self, double mean, double stddev, at::Generator *_generator)
 {
   const int64_t size = THTensor_(numel)(self);
+  auto philox_gen = at::get_generator_or_default<at::CPUGenerator>(_generator, at::detail::getDefaultCPUGenerator());
+  if (philox_gen->philox_mode()) {
+    // See Note [Philox mode of CPUGenerator]
+    THArgCheck(stddev > 0, 3, "normal_ expects std > 0.0, but found std=%f", stddev);
+    THTensor *contig = THTensor_(newContiguous)(self);
+    at::native::philox_normal_fill(contig->data<scalar_t>(), size, philox_gen, mean, stddev);
+    THTensor_(freeCopyTo)(contig, self);
+    return;
+  }
   if (size >= 16 && THTensor_(isContiguous)(self)) {
     THVector_(normal_fill)(THStorage_(data)(THTensor_getStoragePtr(self)) + self->storage_offset(), size, _generator, mean, stddev);
   } else {
@@ -293,39 +311,42 @@ void THTensor_(getRNGState)(at::Generator *_generator, THTensor *self)
 {
   // See Note [Acquire lock when using random generators]
   std::lock_guard<std::mutex> lock(_generator->mutex_);
-  static const size_t size = sizeof(THGeneratorStateNew);
+  static const size_t size = sizeof(THGeneratorStatePhilox);
   THTensor_(resize1d)(self, size);
   THArgCheck(THTensor_(nElement)(self) == size, 1, "RNG state is wrong size");
   THArgCheck(THTensor_(isContiguous)(self), 1, "RNG state needs to be contiguous");
-  static_assert(std::is_pod<THGeneratorStateNew>::value, "THGeneratorStateNew is not a PODType");
+  static_assert(std::is_pod<THGeneratorStatePhilox>::value, "THGeneratorStatePhilox is not a PODType");
 
   // cast byte tensor to POD type
-  THGeneratorStateNew* rng_state = (THGeneratorStateNew*)self->data<scalar_t>();
+  THGeneratorStatePhilox* rng_state = (THGeneratorStatePhilox*)self->data<scalar_t>();
 
   // accumulate generator data to be copied into byte tensor
-  auto accum_state = c10::guts::make_unique<THGeneratorStateNew>();
+  auto accum_state = c10::guts::make_unique<THGeneratorStatePhilox>();
   auto cast_generator = at::check_generator<at::CPUGenerator>(_generator);
   auto rng_data = cast_generator->engine().data();
-  accum_state->legacy_pod.the_initial_seed = rng_data.seed_;
-  accum_state->legacy_pod.left = rng_data.left_;
-  accum_state->legacy_pod.seeded = rng_data.seeded_;
-  accum_state->legacy_pod.next = rng_data.next_;
-  std::copy(rng_data.state_.begin(), rng_data.state_.end(), std::begin(accum_state->legacy_pod.state));
-  accum_state->legacy_pod.normal_x = 0.0; // we don't use it anymore and this is just a dummy
-  accum_state->legacy_pod.normal_rho = 0.0; // we don't use it anymore and this is just a dummy
-  accum_state->legacy_pod.normal_is_valid = false;
-  accum_state->legacy_pod.normal_y = 0.0;
-  accum_state->next_float_normal_sample = 0.0f;
-  accum_state->is_next_float_normal_sample_valid = false;
+  accum_state->new_pod.legacy_pod.the_initial_seed = rng_data.seed_;
+  accum_state->new_pod.legacy_pod.left = rng_data.left_;
+  accum_state->new_pod.legacy_pod.seeded = rng_data.seeded_;
+  accum_state->new_pod.legacy_pod.next = rng_data.next_;
+  std::copy(rng_data.state_.begin(), rng_data.state_.end(), std::begin(accum_state->new_pod.legacy_pod.state));
+  accum_state->new_pod.legacy_pod.normal_x = 0.0; // we don't use it anymore and this is just a dummy
+  accum_state->new_pod.legacy_pod.normal_rho = 0.0; // we don't use it anymore and this is just a dummy
+  accum_state->new_pod.legacy_pod.normal_is_valid = false;
+  accum_state->new_pod.legacy_pod.normal_y = 0.0;
+  accum_state->new_pod.next_float_normal_sample = 0.0f;
+  accum_state->new_pod.is_next_float_normal_sample_valid = false;
   if(cast_generator->next_double_normal_sample()) {
-    accum_state->legacy_pod.normal_is_valid = true;
-    accum_state->legacy_pod.normal_y = *(cast_generator->next_double_normal_sample());
+    accum_state->new_pod.legacy_pod.normal_is_valid = true;
+    accum_state->new_pod.legacy_pod.normal_y = *(cast_generator->next_double_normal_sample());
   }
   if(cast_generator->next_float_normal_sample()) {
-    accum_state->is_next_float_normal_sample_valid = true;
-    accum_state->next_float_normal_sample = *(cast_generator->next_float_normal_sample());
+    accum_state->new_pod.is_next_float_normal_sample_valid = true;
+    accum_state->new_pod.next_float_normal_sample = *(cast_generator->next_float_normal_sample());
   }
 
+  accum_state->philox_offset = cast_generator->philox_offset();
+  accum_state->philox_mode = cast_generator->philox_mode();
+
   memcpy(rng_state, accum_state.get(), size);
 }
 
@@ -337,14 +358,18 @@ void THTensor_(setRNGState)(at::Generator *_generator, THTensor *self)
   THArgCheck(THTensor_(isContiguous)(self), 1, "RNG state needs to be contiguous");
   static_assert(std::is_pod<THGeneratorState>::value, "THGeneratorState is not a PODType");
   static_assert(std::is_pod<THGeneratorStateNew>::value, "THGeneratorStateNew is not a PODType");
+  static_assert(std::is_pod<THGeneratorStatePhilox>::value, "THGeneratorStatePhilox is not a PODType");
 
   static const size_t size_legacy = sizeof(THGeneratorState);
-  static const size_t size_current = sizeof(THGeneratorStateNew);
-  static_assert(size_legacy != size_current, "Legacy THGeneratorState and THGeneratorStateNew can't be of the same size");
+  static const size_t size_new = sizeof(THGeneratorStateNew);
+  static const size_t size_current = sizeof(THGeneratorStatePhilox);
+  static_assert(size_legacy != size_new && size_new != size_current, "THGeneratorState, THGeneratorStateNew and THGeneratorStatePhilox can't be of the same size");
 
   at::mt19937 engine;
   auto float_normal_sample = c10::optional<float>();
   auto double_normal_sample = c10::optional<double>();
+  uint64_t philox_offset = 0;
+  bool philox_mode = false;
 
   // Construct the state of at::CPUGenerator based on input byte tensor size.
   THGeneratorState* legacy_pod;
@@ -364,8 +389,16 @@ void THTensor_(setRNGState)(at::Generator *_generator, THTensor *self)
       // we return the sin version of the normal sample when in caching mode
       double_normal_sample = c10::optional<double>(r * ::sin(theta));
     }
-  } else if (THTensor_(nElement)(self) == size_current) {
-    auto rng_state = (THGeneratorStateNew*)self->data<scalar_t>();
+  } else if (THTensor_(nElement)(self) == size_new || THTensor_(nElement)(self) == size_current) {
+    THGeneratorStateNew* rng_state;
+    if (THTensor_(nElement)(self) == size_current) {
+      auto philox_state = (THGeneratorStatePhilox*)self->data<scalar_t>();
+      rng_state = &philox_state->new_pod;
+      philox_offset = philox_state->philox_offset;
+      philox_mode = philox_state->philox_mode;
+    } else {
+      rng_state = (THGeneratorStateNew*)self->data<scalar_t>();
+    }
     legacy_pod = &rng_state->legacy_pod;
     // update next_float_normal_sample
     if (rng_state->is_next_float_normal_sample_valid) {
@@ -381,7 +414,8 @@ void THTensor_(setRNGState)(at::Generator *_generator, THTensor *self)
     }
   } else {
     AT_ERROR("Expected either a THGeneratorState of size ", size_legacy,
-             " or a THGeneratorStateNew of size ", size_current,
+             ", a THGeneratorStateNew of size ", size_new,
+             " or a THGeneratorStatePhilox of size ", size_current,
              " but found the input RNG state size to be ", THTensor_(nElement)(self));
   }
 
@@ -400,6 +434,8 @@ void THTensor_(setRNGState)(at::Generator *_generator, THTensor *self)
   cast_generator->set_engine(engine);
   cast_generator->set_next_float_normal_sample(float_normal_sample);
   cast_generator->set_next_double_normal_sample(double_normal_sample);
+  cast_generator->set_philox_offset(philox_offset);
+  cast_generator->set_philox_mode(philox_mode);
 }
 #endif
 #endif
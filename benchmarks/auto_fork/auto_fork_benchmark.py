@@ -0,0 +1,75 @@
+from __future__ import absolute_import, division, print_function, unicode_literals
+import argparse
+import time
+
+import torch
+
+""" Auto-fork benchmark script.
+Compares the forward latency of a scripted four-tower model with and without
+automatic inter-op parallelism (ScriptModule._c._set_auto_fork), which forks
+the independent towers onto the inter-op thread pool.
+Example run:
+python auto_fork_benchmark.py --num_layers 4 --hidden 512 --batch_size 64
+"""
+
+
+def make_tower(num_layers, hidden):
+    layers = []
+    for _ in range(num_layers):
+        layers += [torch.nn.Linear(hidden, hidden), torch.nn.ReLU()]
+    return torch.nn.Sequential(*layers)
+
+
+class FourTowers(torch.nn.Module):
+    def __init__(self, num_layers, hidden):
+        super(FourTowers, self).__init__()
+        self.tower1 = make_tower(num_layers, hidden)
+        self.tower2 = make_tower(num_layers, hidden)
+        self.tower3 = make_tower(num_layers, hidden)
+        self.tower4 = make_tower(num_layers, hidden)
+
+    def forward(self, x):
+        # The towers only join here, so all of them can run at the same time.
+        return torch.cat([self.tower1(x), self.tower2(x), self.tower3(x), self.tower4(x)], 1)
+
+
+def benchmark(module, x, num_warmup_iters, num_iters):
+    with torch.no_grad():
+        for _ in range(num_warmup_iters):
+            module(x)
+        start = time.time()
+        for _ in range(num_iters):
+            module(x)
+        end = time.time()
+    return (end - start) * 1e3 / num_iters
+
+
+def main():
+    parser = argparse.ArgumentParser()
+    parser.add_argument("--num_layers", type=int, default=4)
+    parser.add_argument("--hidden", type=int, default=512)
+    parser.add_argument("--batch_size", type=int, default=64)
+    parser.add_argument("--min_cost", type=int, default=16)
+    parser.add_argument("--num_warmup_iters", type=int, default=10)
+    parser.add_argument("--num_iters", type=int, default=100)
+    args = parser.parse_args()
+
+    # Each tower runs single threaded, so that the gain comes from running
+    # the towers at the same time.
+    torch.set_num_threads(1)
+    model = FourTowers(args.num_layers, args.hidden).eval()
+    scripted = torch.jit.script(model)
+    x = torch.rand(args.batch_size, args.hidden)
+
+    print("inter-op threads: {}".format(torch.get_num_interop_threads()))
+    sequential_ms = benchmark(scripted, x, args.num_warmup_iters, args.num_iters)
+    print("sequential, latency per iter (ms): {:.3f}".format(sequential_ms))
+
+    scripted._c._set_auto_fork(True, args.min_cost)
+    forked_ms = benchmark(scripted, x, args.num_warmup_iters, args.num_iters)
+    print("auto fork, latency per iter (ms): {:.3f}".format(forked_ms))
+    print("speedup: {:.2f}x".format(sequential_ms / forked_ms))
+
+
+if __name__ == "__main__":
+    main()
@@ -19,6 +19,10 @@ buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_ben
  --add_op --graph_mode --eager_mode (Runs both graph mode and eager mode)
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --graph_mode (Runs only graph mode)
+buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
+ --add_op --graph_mode --script_mode (Scripts the op loop, which then runs in the interpreter)
+To compare interpreter overhead between two builds, run from this directory:
+python framework_overhead_benchmark.py --op add_op --script_mode --num_warmup_iters 1000 --num_iters 100000
 To run C2 benchmark:
 buck run @mode/opt <path-to-framework_overhead_benchmark>:framework_overhead_benchmark --
  --add_op --benchmark_c2_net
@@ -57,8 +61,9 @@ def benchmark_simple_fn(args, config, module_config, module_type, result):
     else:
         f_name = module_config.pt_fn.__name__ + ":Num Operands=" + str(module_config.num_params)
         graph_mode_str = "Graph mode" + ":" + str(module_config.graph_mode)
-        result_key = ','.join((f_name, graph_mode_str))
-        module = WrapperModule(module_type, module_config, args.debug, args.save)
+        script_mode_str = "Script mode" + ":" + str(args.script_mode)
+        result_key = ','.join((f_name, graph_mode_str, script_mode_str))
+        module = WrapperModule(module_type, module_config, args.debug, args.save, args.script_mode)
         latency_per_iter_ms = benchmark_module(config, module, args.use_throughput_benchmark)
         result[result_key] = latency_per_iter_ms
 
@@ -70,6 +75,7 @@ def main():
     parser.add_argument("--debug", default=False, dest="debug", action="store_true")
     parser.add_argument("--save", default=False, dest="save", action="store_true")
     parser.add_argument("--eager_mode", default=False, dest="eager_mode", action="store_true")
+    parser.add_argument("--script_mode", default=False, dest="script_mode", action="store_true")
     parser.add_argument("--num_warmup_iters", type=int, default=100)
     parser.add_argument("--num_iters", type=int, default=1000)
     args = parser.parse_args()
@@ -19,10 +19,17 @@ class WrapperModule(object):
             - Whether debug mode is enabled.
         save:
             - In graph mode, whether graph is to be saved.
+        script:
+            - In graph mode, whether pt_fn is compiled with TorchScript before
+              tracing, so that its loops run in the interpreter instead of
+              being unrolled by the tracer.
     """
-    def __init__(self, wrapped_type, module_config, debug, save=False):
+    def __init__(self, wrapped_type, module_config, debug, save=False, script=False):
         pt_fn = module_config.pt_fn
-        self.module = wrapped_type(pt_fn)
+        if module_config.graph_mode and script:
+            self.module = wrapped_type(torch.jit.script(pt_fn))
+        else:
+            self.module = wrapped_type(pt_fn)
         self.tensor_inputs = []
         self.module_name = wrapped_type.__name__
         for _ in range(module_config.num_params):
@@ -25,7 +25,7 @@ namespace c10 {
  * or "SparseCUDA"; backend in torch.backends is something like "MKL" or
  * "CUDNN".
  */
-enum class Backend { CPU, CUDA, HIP, SparseCPU, SparseCUDA, SparseHIP, MSNPU, XLA, QuantizedCPU, ComplexCPU, ComplexCUDA, Undefined, MkldnnCPU, NumOptions };
+enum class Backend { CPU, CUDA, HIP, SparseCPU, SparseCUDA, SparseHIP, MSNPU, XLA, QuantizedCPU, ComplexCPU, ComplexCUDA, Undefined, MkldnnCPU, SparseCsrCPU, NumOptions };
 
 static inline Backend toSparse(Backend b) {
   switch (b) {
@@ -64,6 +64,8 @@ static inline Backend toDense(Backend b) {
       return Backend::CUDA;
     case Backend::SparseHIP:
       return Backend::HIP;
+    case Backend::SparseCsrCPU:
+      return Backend::CPU;
     case Backend::QuantizedCPU:
       return Backend::QuantizedCPU;
     case Backend::ComplexCPU:
@@ -94,6 +96,8 @@ static inline Backend tensorTypeIdToBackend(TensorTypeId t) {
     return Backend::SparseHIP;
   } else if (t == TensorTypeId::MkldnnCPUTensorId) {
     return Backend::MkldnnCPU;
+  } else if (t == TensorTypeId::SparseCsrCPUTensorId) {
+    return Backend::SparseCsrCPU;
   } else if (t == TensorTypeId::QuantizedCPUTensorId) {
     return Backend::QuantizedCPU;
   } else if (t == TensorTypeId::ComplexCPUTensorId) {
@@ -127,6 +131,8 @@ static inline TensorTypeId backendToTensorTypeId(Backend b) {
       return TensorTypeId::SparseHIPTensorId;
     case Backend::MkldnnCPU:
       return TensorTypeId::MkldnnCPUTensorId;
+    case Backend::SparseCsrCPU:
+      return TensorTypeId::SparseCsrCPUTensorId;
     case Backend::QuantizedCPU:
       return TensorTypeId::QuantizedCPUTensorId;
     case Backend::ComplexCPU:
@@ -159,6 +165,7 @@ static inline DeviceType backendToDeviceType(Backend b) {
     case Backend::SparseHIP:
       return DeviceType::HIP;
     case Backend::MkldnnCPU:
+    case Backend::SparseCsrCPU:
     case Backend::QuantizedCPU:
     case Backend::ComplexCPU:
       return DeviceType::CPU;
@@ -190,6 +197,8 @@ static inline Backend backendToCPU(Backend b) {
       return Backend::CPU;
     case Backend::MkldnnCPU:
       return Backend::MkldnnCPU;
+    case Backend::SparseCsrCPU:
+      return Backend::SparseCsrCPU;
     case Backend::QuantizedCPU:
       return Backend::QuantizedCPU;
     case Backend::ComplexCPU:
@@ -264,6 +273,8 @@ static inline const char* toString(Backend b) {
       return "SparseHIP";
     case Backend::MkldnnCPU:
       return "MkldnnCPU";
+    case Backend::SparseCsrCPU:
+      return "SparseCsrCPU";
     case Backend::QuantizedCPU:
       return "QuantizedCPU";
     case Backend::ComplexCPU:
@@ -0,0 +1,510 @@
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/util/llvmMathExtras.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <unordered_set>
+#include <vector>
+
+C10_DEFINE_int64(
+    caffe2_cpu_caching_allocator_max_cached_bytes,
+    1LL << 30,
+    "Maximum number of bytes the CPU caching allocator keeps in its free "
+    "lists; blocks freed beyond this high-water mark go back to the system");
+
+namespace c10 {
+namespace CPUCachingAllocator {
+
+//
+// Caching allocator for CPU memory.
+//
+// - Requests are rounded up to a size class.  Size classes are spaced four
+//   per power of two (64, 80, 96, 112, 128, 160, ...), which bounds the
+//   internal fragmentation to 25%.  Requests above kMaxCachedSize are not
+//   cached and go straight to alloc_cpu/free_cpu.
+// - Every block carries a small header in front of the returned pointer
+//   recording its size class, so a block can be returned to the right free
+//   list no matter which allocator is installed when it is freed.  The
+//   header is gAlignment bytes, so the returned pointer keeps the alignment
+//   of alloc_cpu.
+// - Freed blocks of up to 1 MiB go to a free list local to the
+//   freeing thread, and are reused from there by later allocations on the
+//   same thread without touching any shared state.  When a thread-local list
+//   is full, or for larger blocks, the block goes to a global per-class free
+//   list.  Thread-local lists are flushed to the global ones when their
+//   thread exits.
+// - When NUMA is enabled, the global free lists are split into one arena per
+//   NUMA node.  Blocks remember the node they were first placed on (by
+//   alloc_cpu) and are only ever reused by threads running on that node, so
+//   a cached block never needs to be moved again.  A thread-local list only
+//   keeps blocks of the node its thread is running on.
+// - The total number of cached bytes is bounded by a configurable
+//   high-water mark.  A block freed while the cache is full is released to
+//   the system immediately.
+//
+
+namespace {
+
+constexpr size_t kHeaderSize = gAlignment;       // block header, keeps data aligned
+constexpr unsigned kMinClassLog2 = 6;            // smallest size class is 64 bytes
+constexpr unsigned kMaxClassLog2 = 26;           // largest size class is 64 MiB
+constexpr unsigned kClassesPerDoubling = 4;
+constexpr size_t kMinBlockSize = size_t(1) << kMinClassLog2;
+constexpr size_t kMaxCachedSize = size_t(1) << kMaxClassLog2;
+constexpr int64_t kNumSizeClasses =
+    (kMaxClassLog2 - kMinClassLog2) * kClassesPerDoubling + 1;
+constexpr int64_t kUncached = -1;
+constexpr unsigned kMaxThreadCachedLog2 = 20;    // thread-local lists up to 1 MiB
+constexpr size_t kThreadCacheBlocks = 16;        // per size class and thread
+constexpr int kMaxNUMANodes = 64;                // matches the mask in NUMAMove
+
+struct BlockHeader {
+  size_t size;          // size class in bytes, or requested size if uncached
+  int32_t size_class;   // index of the size class, or kUncached
+  int32_t numa_node;    // arena the block belongs to
+};
+static_assert(sizeof(BlockHeader) <= kHeaderSize, "block header too large");
+
+int64_t sizeClassIndex(size_t nbytes) {
+  if (nbytes <= kMinBlockSize) {
+    return 0;
+  }
+  if (nbytes > kMaxCachedSize) {
+    return kUncached;
+  }
+  const unsigned log2 = llvm::Log2_64(nbytes);
+  const size_t base = size_t(1) << log2;
+  const size_t step = base / kClassesPerDoubling;
+  // A step count of kClassesPerDoubling rolls over to the first class of the
+  // next power of two, which is exactly the next index.
+  const size_t steps = (nbytes - base + step - 1) / step;
+  return (log2 - kMinClassLog2) * kClassesPerDoubling + steps;
+}
+
+size_t sizeClassSize(int64_t size_class) {
+  const unsigned log2 = kMinClassLog2 + size_class / kClassesPerDoubling;
+  const size_t base = size_t(1) << log2;
+  return base + (size_class % kClassesPerDoubling) * (base / kClassesPerDoubling);
+}
+
+constexpr int64_t kNumThreadCachedClasses =
+    (kMaxThreadCachedLog2 - kMinClassLog2) * kClassesPerDoubling + 1;
+
+inline BlockHeader* headerOf(void* block) {
+  return static_cast<BlockHeader*>(block);
+}
+
+inline void* dataOf(void* block) {
+  return static_cast<char*>(block) + kHeaderSize;
+}
+
+inline void* blockOf(void* data) {
+  return static_cast<char*>(data) - kHeaderSize;
+}
+
+// Arena for the NUMA node the calling thread currently runs on; arena 0 is
+// used when NUMA is disabled.
+int currentNUMANode() {
+  const int node = GetCurrentNUMANode();
+  return (node < 0 || node >= kMaxNUMANodes) ? 0 : node;
+}
+
+void updateMax(std::atomic<uint64_t>& max_value, uint64_t value) {
+  uint64_t prev = max_value.load(std::memory_order_relaxed);
+  while (prev < value &&
+         !max_value.compare_exchange_weak(
+             prev, value, std::memory_order_relaxed)) {
+  }
+}
+
+struct ThreadCache;
+
+// Global per-size-class free lists of one NUMA node.
+struct Arena {
+  std::array<std::mutex, kNumSizeClasses> mutexes;
+  std::array<std::vector<void*>, kNumSizeClasses> pools;
+};
+
+class CachingAllocatorImpl {
+ public:
+  CachingAllocatorImpl()
+      : max_cached_bytes_(static_cast<size_t>(
+            std::max<int64_t>(0, FLAGS_caffe2_cpu_caching_allocator_max_cached_bytes))),
+        allocated_(0),
+        max_allocated_(0),
+        cached_(0),
+        max_cached_(0) {
+    for (auto& arena : arenas_) {
+      arena.store(nullptr);
+    }
+  }
+
+  void* malloc(size_t nbytes);
+  void free(void* data);
+  void emptyCache();
+
+  void registerThreadCache(ThreadCache* cache) {
+    std::lock_guard<std::mutex> lock(thread_caches_mutex_);
+    thread_caches_.insert(cache);
+  }
+  void unregisterThreadCache(ThreadCache* cache);
+
+  // Returns a block to the global free list of its size class in the arena
+  // of its NUMA node.  The block must already be accounted for in the cached
+  // byte count.
+  void pushGlobal(void* block) {
+    const int64_t size_class = headerOf(block)->size_class;
+    Arena& arena = getArena(headerOf(block)->numa_node);
+    std::lock_guard<std::mutex> lock(arena.mutexes[size_class]);
+    arena.pools[size_class].push_back(block);
+  }
+
+  void setMaxCachedBytes(size_t nbytes) {
+    max_cached_bytes_.store(nbytes);
+    if (cached_.load() > nbytes) {
+      emptyCache();
+    }
+  }
+  size_t maxCachedBytes() const {
+    return max_cached_bytes_.load();
+  }
+
+  uint64_t currentAllocated() const { return allocated_.load(); }
+  uint64_t maxAllocated() const { return max_allocated_.load(); }
+  void resetMaxAllocated() { max_allocated_.store(allocated_.load()); }
+  uint64_t currentCached() const { return cached_.load(); }
+  uint64_t maxCached() const { return max_cached_.load(); }
+  void resetMaxCached() { max_cached_.store(cached_.load()); }
+
+  // Releases `block` to the system, dropping it from the cached byte count.
+  void releaseCached(void* block) {
+    cached_.fetch_sub(headerOf(block)->size);
+    free_cpu(block);
+  }
+
+ private:
+  Arena& getArena(int numa_node) {
+    Arena* arena = arenas_[numa_node].load(std::memory_order_acquire);
+    if (!arena) {
+      std::lock_guard<std::mutex> lock(arenas_mutex_);
+      arena = arenas_[numa_node].load(std::memory_order_relaxed);
+      if (!arena) {
+        arena = new Arena();
+        arenas_[numa_node].store(arena, std::memory_order_release);
+      }
+    }
+    return *arena;
+  }
+
+  void* popGlobal(int numa_node, int64_t size_class) {
+    Arena& arena = getArena(numa_node);
+    std::lock_guard<std::mutex> lock(arena.mutexes[size_class]);
+    auto& pool = arena.pools[size_class];
+    if (pool.empty()) {
+      return nullptr;
+    }
+    void* block = pool.back();
+    pool.pop_back();
+    return block;
+  }
+
+  // Tries to account `nbytes` more bytes as cached; fails if that would go
+  // over the high-water mark.
+  bool reserveCached(size_t nbytes) {
+    const uint64_t total = cached_.fetch_add(nbytes) + nbytes;
+    if (total > max_cached_bytes_.load(std::memory_order_relaxed)) {
+      cached_.fetch_sub(nbytes);
+      return false;
+    }
+    updateMax(max_cached_, total);
+    return true;
+  }
+
+  std::atomic<size_t> max_cached_bytes_;
+  std::atomic<uint64_t> allocated_;
+  std::atomic<uint64_t> max_allocated_;
+  std::atomic<uint64_t> cached_;
+  std::atomic<uint64_t> max_cached_;
+
+  // Created on first use, since NUMA may be enabled after static
+  // initialization.
+  std::mutex arenas_mutex_;
+  std::array<std::atomic<Arena*>, kMaxNUMANodes> arenas_;
+
+  std::mutex thread_caches_mutex_;
+  std::unordered_set<ThreadCache*> thread_caches_;
+};
+
+// Leaked on purpose: blocks may be freed from static destructors and
+// thread exit handlers that run after a static allocator would be gone.
+CachingAllocatorImpl& impl() {
+  static CachingAllocatorImpl* impl = new CachingAllocatorImpl();
+  return *impl;
+}
+
+// Per-thread free lists for the small size classes.  The mutex is only ever
+// contended by emptyCache(), which needs to drain the lists of other
+// threads.
+struct ThreadCache {
+  ThreadCache() : blocks(kNumThreadCachedClasses) {
+    impl().registerThreadCache(this);
+  }
+
+  ~ThreadCache() {
+    impl().unregisterThreadCache(this);
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& list : blocks) {
+      for (void* block : list) {
+        impl().pushGlobal(block);
+      }
+    }
+  }
+
+  void* pop(int64_t size_class, int numa_node) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rebind(numa_node);
+    auto& list = blocks[size_class];
+    if (list.empty()) {
+      return nullptr;
+    }
+    void* block = list.back();
+    list.pop_back();
+    return block;
+  }
+
+  bool push(int64_t size_class, int numa_node, void* block) {
+    std::lock_guard<std::mutex> lock(mutex);
+    rebind(numa_node);
+    auto& list = blocks[size_class];
+    if (list.size() >= kThreadCacheBlocks) {
+      return false;
+    }
+    list.push_back(block);
+    return true;
+  }
+
+  void release() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& list : blocks) {
+      for (void* block : list) {
+        impl().releaseCached(block);
+      }
+      list.clear();
+    }
+  }
+
+  // The thread may have been migrated to another node since the lists were
+  // filled; hand their blocks back to the arena they belong to rather than
+  // reuse them remotely.  Must be called with `mutex` held.
+  void rebind(int numa_node) {
+    if (numa_node == node) {
+      return;
+    }
+    for (auto& list : blocks) {
+      for (void* block : list) {
+        impl().pushGlobal(block);
+      }
+      list.clear();
+    }
+    node = numa_node;
+  }
+
+  std::mutex mutex;
+  std::vector<std::vector<void*>> blocks;
+  int node = 0;         // NUMA node of every block in `blocks`
+};
+
+void CachingAllocatorImpl::unregisterThreadCache(ThreadCache* cache) {
+  std::lock_guard<std::mutex> lock(thread_caches_mutex_);
+  thread_caches_.erase(cache);
+}
+
+// The thread cache is reached through a trivially destructible pointer so
+// that frees issued by other thread_local destructors after ours has run
+// simply fall through to the global free lists.
+thread_local ThreadCache* tls_cache = nullptr;
+thread_local bool tls_cache_destroyed = false;
+
+struct ThreadCacheOwner {
+  ~ThreadCacheOwner() {
+    delete tls_cache;
+    tls_cache = nullptr;
+    tls_cache_destroyed = true;
+  }
+};
+
+ThreadCache* getThreadCache() {
+  if (!tls_cache && !tls_cache_destroyed) {
+    static thread_local ThreadCacheOwner owner;
+    tls_cache = new ThreadCache();
+  }
+  return tls_cache;
+}
+
+void* CachingAllocatorImpl::malloc(size_t nbytes) {
+  if (nbytes == 0) {
+    return nullptr;
+  }
+  CAFFE_ENFORCE(
+      ((ptrdiff_t)nbytes) >= 0,
+      "CPUCachingAllocator seems to have been called with negative number: ",
+      nbytes);
+
+  const int64_t size_class = sizeClassIndex(nbytes);
+  const int numa_node = currentNUMANode();
+  if (size_class == kUncached) {
+    void* block = alloc_cpu(nbytes + kHeaderSize);
+    headerOf(block)->size = nbytes;
+    headerOf(block)->size_class = kUncached;
+    headerOf(block)->numa_node = numa_node;
+    updateMax(max_allocated_, allocated_.fetch_add(nbytes) + nbytes);
+    return dataOf(block);
+  }
+
+  const size_t size = sizeClassSize(size_class);
+  void* block = nullptr;
+  if (size_class < kNumThreadCachedClasses) {
+    if (ThreadCache* cache = getThreadCache()) {
+      block = cache->pop(size_class, numa_node);
+    }
+  }
+  if (!block) {
+    block = popGlobal(numa_node, size_class);
+  }
+
+  if (block) {
+    cached_.fetch_sub(size);
+    // Fresh blocks are filled by alloc_cpu; reused ones need it done here.
+    if (FLAGS_caffe2_cpu_allocator_do_zero_fill) {
+      memset(dataOf(block), 0, size);
+    } else if (FLAGS_caffe2_cpu_allocator_do_junk_fill) {
+      memset_junk(dataOf(block), size);
+    }
+  } else {
+    // alloc_cpu places the block on the node of the calling thread.
+    block = alloc_cpu(size + kHeaderSize);
+    headerOf(block)->size = size;
+    headerOf(block)->size_class = size_class;
+    headerOf(block)->numa_node = numa_node;
+  }
+  updateMax(max_allocated_, allocated_.fetch_add(size) + size);
+  return dataOf(block);
+}
+
+void CachingAllocatorImpl::free(void* data) {
+  if (!data) {
+    return;
+  }
+  void* block = blockOf(data);
+  const size_t size = headerOf(block)->size;
+  const int64_t size_class = headerOf(block)->size_class;
+  allocated_.fetch_sub(size);
+
+  if (size_class == kUncached || !reserveCached(size)) {
+    free_cpu(block);
+    return;
+  }
+  const int numa_node = headerOf(block)->numa_node;
+  if (size_class < kNumThreadCachedClasses && numa_node == currentNUMANode()) {
+    ThreadCache* cache = getThreadCache();
+    if (cache && cache->push(size_class, numa_node, block)) {
+      return;
+    }
+  }
+  pushGlobal(block);
+}
+
+void CachingAllocatorImpl::emptyCache() {
+  {
+    std::lock_guard<std::mutex> lock(thread_caches_mutex_);
+    for (ThreadCache* cache : thread_caches_) {
+      cache->release();
+    }
+  }
+  for (auto& arena_ptr : arenas_) {
+    Arena* arena = arena_ptr.load(std::memory_order_acquire);
+    if (!arena) {
+      continue;
+    }
+    for (int64_t size_class = 0; size_class < kNumSizeClasses; size_class++) {
+      std::vector<void*> pool;
+      {
+        std::lock_guard<std::mutex> lock(arena->mutexes[size_class]);
+        pool.swap(arena->pools[size_class]);
+      }
+      for (void* block : pool) {
+        releaseCached(block);
+      }
+    }
+  }
+}
+
+void Delete(void* data) {
+  impl().free(data);
+}
+
+struct CPUCachingAllocator final : public at::Allocator {
+  at::DataPtr allocate(size_t nbytes) const override {
+    void* data = impl().malloc(nbytes);
+    return {data, data, &Delete, at::Device(at::DeviceType::CPU)};
+  }
+  at::DeleterFnPtr raw_deleter() const override {
+    return &Delete;
+  }
+};
+
+CPUCachingAllocator g_caching_cpu_alloc;
+
+} // namespace
+
+Allocator* get() {
+  return &g_caching_cpu_alloc;
+}
+
+void emptyCache() {
+  impl().emptyCache();
+}
+
+void setMaxCachedBytes(size_t nbytes) {
+  impl().setMaxCachedBytes(nbytes);
+}
+
+size_t maxCachedBytes() {
+  return impl().maxCachedBytes();
+}
+
+uint64_t currentMemoryAllocated() {
+  return impl().currentAllocated();
+}
+
+uint64_t maxMemoryAllocated() {
+  return impl().maxAllocated();
+}
+
+void resetMaxMemoryAllocated() {
+  impl().resetMaxAllocated();
+}
+
+uint64_t currentMemoryCached() {
+  return impl().currentCached();
+}
+
+uint64_t maxMemoryCached() {
+  return impl().maxCached();
+}
+
+void resetMaxMemoryCached() {
+  impl().resetMaxCached();
+}
+
+size_t roundSize(size_t nbytes) {
+  const int64_t size_class = sizeClassIndex(nbytes);
+  return size_class == kUncached ? nbytes : sizeClassSize(size_class);
+}
+
+} // namespace CPUCachingAllocator
+} // namespace c10
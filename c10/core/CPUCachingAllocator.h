@@ -0,0 +1,48 @@
+#pragma once
+
+#include <c10/core/Allocator.h>
+#include <c10/util/Flags.h>
+
+C10_DECLARE_int64(caffe2_cpu_caching_allocator_max_cached_bytes);
+
+namespace c10 {
+
+// A caching allocator for CPU memory.  It is NOT installed by default; to
+// opt in, route the CPU allocator through it during initialization:
+//
+//   c10::SetCPUAllocator(c10::CPUCachingAllocator::get());
+//
+// and restore the default with SetCPUAllocator(GetDefaultCPUAllocator()).
+// Memory handed out by the caching allocator remembers that it came from
+// there, so it is fine for tensors allocated before the switch back to
+// outlive it.
+//
+// See CPUCachingAllocator.cpp for the details of the caching policy.
+namespace CPUCachingAllocator {
+
+C10_API Allocator* get();
+
+// Releases all cached (free) blocks back to the system.  Blocks that are
+// still in use are not affected.
+C10_API void emptyCache();
+
+// Upper bound on the number of bytes kept in the cache.  Blocks freed while
+// the cache is at its high-water mark are returned to the system instead.
+C10_API void setMaxCachedBytes(size_t nbytes);
+C10_API size_t maxCachedBytes();
+
+// Number of bytes currently handed out to callers, rounded up to size class.
+C10_API uint64_t currentMemoryAllocated();
+C10_API uint64_t maxMemoryAllocated();
+C10_API void     resetMaxMemoryAllocated();
+// Number of bytes currently held in free lists.
+C10_API uint64_t currentMemoryCached();
+C10_API uint64_t maxMemoryCached();
+C10_API void     resetMaxMemoryCached();
+
+// Size in bytes of the size class a request of `nbytes` is rounded up to, or
+// `nbytes` itself if the request is too large to be cached.
+C10_API size_t roundSize(size_t nbytes);
+
+} // namespace CPUCachingAllocator
+} // namespace c10
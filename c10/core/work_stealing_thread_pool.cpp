@@ -0,0 +1,204 @@
+#include <c10/core/work_stealing_thread_pool.h>
+
+namespace c10 {
+
+namespace {
+
+// Rounds of looking for work an idle worker makes before it parks
+constexpr int kSpinRounds = 64;
+
+// Pool and worker index of the current thread, if it is a pool worker
+thread_local WorkStealingThreadPool* current_pool_ = nullptr;
+thread_local std::size_t current_index_ = 0;
+
+} // namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool(
+    int pool_size,
+    int numa_node_id,
+    std::function<void()> init_thread)
+    : threads_(pool_size < 0 ? defaultNumThreads() : pool_size),
+      running_(true),
+      active_(0),
+      next_mailbox_(0),
+      pending_(0),
+      sleeping_(0),
+      numa_node_id_(numa_node_id) {
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    workers_.emplace_back(new Worker());
+  }
+  for (std::size_t i = 0; i < threads_.size(); ++i) {
+    threads_[i] = std::thread([this, i, init_thread](){
+      if (init_thread) {
+        init_thread();
+      }
+      this->main_loop(i);
+    });
+  }
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() {
+  {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    running_ = false;
+    park_condition_.notify_all();
+  }
+
+  for (auto& t : threads_) {
+    try {
+      t.join();
+    } catch (const std::exception&) {
+    }
+  }
+
+  // drop the tasks that never ran, all workers are gone by now
+  for (auto& worker : workers_) {
+    while (Task* task = worker->deque.pop()) {
+      delete task;
+    }
+    for (Task* task : worker->mailbox) {
+      delete task;
+    }
+  }
+}
+
+size_t WorkStealingThreadPool::size() const {
+  return threads_.size();
+}
+
+size_t WorkStealingThreadPool::numAvailable() const {
+  return threads_.size() - active_.load();
+}
+
+bool WorkStealingThreadPool::inThreadPool() const {
+  return current_pool_ == this;
+}
+
+void WorkStealingThreadPool::run(const std::function<void()>& func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  push(new Task(func, /* forked */ false));
+}
+
+void WorkStealingThreadPool::fork(const std::function<void()>& func) {
+  if (threads_.size() == 0) {
+    throw std::runtime_error("No threads to run a task");
+  }
+  push(new Task(func, /* forked */ true));
+}
+
+void WorkStealingThreadPool::push(Task* task) {
+  // Count the task before it becomes visible so that whoever takes it can
+  // never drive the counter negative.
+  pending_.fetch_add(1);
+  if (task->forked && current_pool_ == this) {
+    workers_[current_index_]->deque.push(task);
+  } else {
+    Worker& worker = *workers_[next_mailbox_++ % workers_.size()];
+    std::lock_guard<std::mutex> lock(worker.mailbox_mutex);
+    worker.mailbox.push_back(task);
+  }
+  // Pairs with park(): either the parking worker sees the pending task, or
+  // we see it sleeping and wake it up.
+  if (sleeping_.load() > 0) {
+    std::lock_guard<std::mutex> lock(park_mutex_);
+    park_condition_.notify_one();
+  }
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::popMailbox(
+    Worker& worker,
+    bool forked_only) {
+  std::lock_guard<std::mutex> lock(worker.mailbox_mutex);
+  auto& mailbox = worker.mailbox;
+  for (auto it = mailbox.begin(); it != mailbox.end(); ++it) {
+    if (!forked_only || (*it)->forked) {
+      Task* task = *it;
+      mailbox.erase(it);
+      return task;
+    }
+  }
+  return nullptr;
+}
+
+WorkStealingThreadPool::Task* WorkStealingThreadPool::findTask(
+    std::size_t index,
+    bool is_worker,
+    bool forked_only) {
+  if (pending_.load(std::memory_order_relaxed) <= 0) {
+    return nullptr;
+  }
+  Task* task = nullptr;
+  if (is_worker) {
+    Worker& self = *workers_[index];
+    task = self.deque.pop();
+    if (!task) {
+      task = popMailbox(self, forked_only);
+    }
+  }
+  const std::size_t num_workers = workers_.size();
+  for (std::size_t i = 1; !task && i <= num_workers; ++i) {
+    Worker& victim = *workers_[(index + i) % num_workers];
+    task = victim.deque.steal();
+    if (!task) {
+      task = popMailbox(victim, forked_only);
+    }
+  }
+  if (task) {
+    pending_.fetch_sub(1);
+  }
+  return task;
+}
+
+void WorkStealingThreadPool::runTask(Task* task) {
+  try {
+    task->func();
+  } catch (const std::exception&) {
+  }
+  delete task;
+}
+
+void WorkStealingThreadPool::park() {
+  sleeping_.fetch_add(1);
+  {
+    std::unique_lock<std::mutex> lock(park_mutex_);
+    while (running_ && pending_.load() <= 0) {
+      park_condition_.wait(lock);
+    }
+  }
+  sleeping_.fetch_sub(1);
+}
+
+void WorkStealingThreadPool::waitUntil(const std::function<bool()>& done) {
+  const bool is_worker = current_pool_ == this;
+  const std::size_t index = is_worker ? current_index_ : 0;
+  while (!done()) {
+    if (Task* task = findTask(index, is_worker, /* forked_only */ true)) {
+      runTask(task);
+    } else {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void WorkStealingThreadPool::main_loop(std::size_t index) {
+  current_pool_ = this;
+  current_index_ = index;
+  while (running_) {
+    Task* task = findTask(index, true, /* forked_only */ false);
+    for (int round = 0; !task && round < kSpinRounds && running_; ++round) {
+      std::this_thread::yield();
+      task = findTask(index, true, /* forked_only */ false);
+    }
+    if (task) {
+      ++active_;
+      runTask(task);
+      --active_;
+    } else if (running_) {
+      park();
+    }
+  }
+}
+
+} // namespace c10
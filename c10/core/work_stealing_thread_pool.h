@@ -0,0 +1,212 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <c10/core/thread_pool.h>
+
+namespace c10 {
+
+namespace detail {
+
+// Chase-Lev work-stealing deque ("Dynamic Circular Work-Stealing Deque",
+// Chase and Lev, SPAA 2005; memory orderings after "Correct and Efficient
+// Work-Stealing for Weak Memory Models", Le et al., PPoPP 2013).
+//
+// Only the owning thread may push() and pop(), at the bottom; any thread may
+// steal() from the top.  The buffer grows when full; retired buffers are
+// kept alive until the deque is destroyed since a concurrent thief may
+// still be reading from them.
+template <typename T>
+class WorkStealingDeque {
+ public:
+  explicit WorkStealingDeque(int64_t log_capacity = 8)
+      : top_(0), bottom_(0), array_(new Array(log_capacity)) {
+    retired_.emplace_back(array_.load(std::memory_order_relaxed));
+  }
+
+  WorkStealingDeque(const WorkStealingDeque&) = delete;
+  WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+  bool empty() const {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    return b <= t;
+  }
+
+  void push(T* item) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > a->capacity - 1) {
+      a = a->grow(b, t);
+      retired_.emplace_back(a);
+      array_.store(a, std::memory_order_release);
+    }
+    a->put(b, item);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  T* pop() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    if (t > b) {
+      // empty
+      bottom_.store(b + 1, std::memory_order_relaxed);
+      return nullptr;
+    }
+    T* item = a->get(b);
+    if (t == b) {
+      // last item, race against thieves
+      if (!top_.compare_exchange_strong(
+              t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+        item = nullptr;
+      }
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return item;
+  }
+
+  // Returns nullptr if the deque is empty or the race for the top item was
+  // lost to another thread.
+  T* steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    Array* a = array_.load(std::memory_order_acquire);
+    T* item = a->get(t);
+    if (!top_.compare_exchange_strong(
+            t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return item;
+  }
+
+ private:
+  struct Array {
+    explicit Array(int64_t log_capacity)
+        : capacity(int64_t(1) << log_capacity),
+          mask(capacity - 1),
+          log_capacity(log_capacity),
+          items(new std::atomic<T*>[capacity]) {}
+
+    T* get(int64_t i) const {
+      return items[i & mask].load(std::memory_order_relaxed);
+    }
+
+    void put(int64_t i, T* item) {
+      items[i & mask].store(item, std::memory_order_relaxed);
+    }
+
+    Array* grow(int64_t b, int64_t t) const {
+      Array* bigger = new Array(log_capacity + 1);
+      for (int64_t i = t; i < b; ++i) {
+        bigger->put(i, get(i));
+      }
+      return bigger;
+    }
+
+    const int64_t capacity;
+    const int64_t mask;
+    const int64_t log_capacity;
+    std::unique_ptr<std::atomic<T*>[]> items;
+  };
+
+  alignas(64) std::atomic<int64_t> top_;
+  alignas(64) std::atomic<int64_t> bottom_;
+  std::atomic<Array*> array_;
+  std::vector<std::unique_ptr<Array>> retired_;
+};
+
+} // namespace detail
+
+// Thread pool for fork-join parallelism.  Every worker owns a lock-free
+// work-stealing deque; tasks forked from a worker of the pool go to the
+// bottom of its own deque, all other tasks are distributed round-robin over
+// small per-worker mailboxes.  Idle workers steal from the other workers'
+// deques and mailboxes, spin for a while when there is nothing to steal, and
+// only then park on a condition variable.
+//
+// A thread waiting for a set of forked tasks to finish can help run them
+// with waitUntil() instead of blocking, which also makes it safe to fork
+// tasks from within tasks (nested parallelism) without starving the pool.
+class C10_API WorkStealingThreadPool : public c10::TaskThreadPoolBase {
+ public:
+  WorkStealingThreadPool() = delete;
+
+  explicit WorkStealingThreadPool(
+      int pool_size,
+      int numa_node_id = -1,
+      std::function<void()> init_thread = nullptr);
+
+  ~WorkStealingThreadPool();
+
+  size_t size() const override;
+
+  size_t numAvailable() const override;
+
+  bool inThreadPool() const override;
+
+  void run(const std::function<void()>& func) override;
+
+  // Like run(), but the task may also be run by a thread waiting in
+  // waitUntil(), so it must not block on anything that is not itself
+  // running on the pool.
+  void fork(const std::function<void()>& func);
+
+  // Runs forked tasks of this pool on the calling thread until `done`
+  // returns true.  May be called from inside the pool or from outside.
+  void waitUntil(const std::function<bool()>& done);
+
+ private:
+  struct Task {
+    Task(const std::function<void()>& func, bool forked)
+        : func(func), forked(forked) {}
+    const std::function<void()> func;
+    const bool forked;
+  };
+
+  struct Worker {
+    detail::WorkStealingDeque<Task> deque;
+    std::mutex mailbox_mutex;
+    std::deque<Task*> mailbox;
+  };
+
+  void main_loop(std::size_t index);
+  void push(Task* task);
+  Task* popMailbox(Worker& worker, bool forked_only);
+  // Looks for a task, starting with the worker `index` itself (if it is a
+  // worker of this pool) and then stealing from the others.  Deques only
+  // ever hold forked tasks.
+  Task* findTask(std::size_t index, bool is_worker, bool forked_only);
+  void runTask(Task* task);
+  void park();
+
+  std::vector<std::unique_ptr<Worker>> workers_;
+  std::vector<std::thread> threads_;
+  std::atomic<bool> running_;
+  std::atomic<size_t> active_;
+  std::atomic<size_t> next_mailbox_;
+
+  // number of queued tasks and parked workers, see park()
+  std::atomic<int64_t> pending_;
+  std::atomic<int64_t> sleeping_;
+  std::mutex park_mutex_;
+  std::condition_variable park_condition_;
+  int numa_node_id_;
+};
+
+} // namespace c10
@@ -0,0 +1,87 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/CPUAllocator.h>
+#include <c10/core/CPUCachingAllocator.h>
+
+#include <thread>
+
+using namespace c10;
+
+TEST(CPUCachingAllocator, RoundSize) {
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1), 64);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(64), 64);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(65), 80);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(113), 128);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1000), 1024);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1025), 1280);
+  ASSERT_EQ(CPUCachingAllocator::roundSize(1 << 26), 1 << 26);
+  ASSERT_EQ(CPUCachingAllocator::roundSize((1 << 26) + 1), (1 << 26) + 1);
+}
+
+TEST(CPUCachingAllocator, ReusesFreedBlocks) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  void* first = nullptr;
+  {
+    auto data = allocator->allocate(1000);
+    first = data.get();
+    ASSERT_EQ(reinterpret_cast<uintptr_t>(first) % gAlignment, 0);
+    ASSERT_EQ(CPUCachingAllocator::currentMemoryAllocated(), 1024);
+  }
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryAllocated(), 0);
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryCached(), 1024);
+  {
+    // Any request in the same size class is served from the cache.
+    auto data = allocator->allocate(1010);
+    ASSERT_EQ(data.get(), first);
+    ASSERT_EQ(CPUCachingAllocator::currentMemoryCached(), 0);
+  }
+  CPUCachingAllocator::emptyCache();
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryCached(), 0);
+}
+
+TEST(CPUCachingAllocator, RawInterface) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  void* ptr = allocator->raw_allocate(4096);
+  ASSERT_NE(ptr, nullptr);
+  allocator->raw_deallocate(ptr);
+  ASSERT_EQ(allocator->allocate(0).get(), nullptr);
+}
+
+TEST(CPUCachingAllocator, HighWaterMark) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  const size_t old_max = CPUCachingAllocator::maxCachedBytes();
+  CPUCachingAllocator::setMaxCachedBytes(4096);
+  {
+    auto a = allocator->allocate(4096);
+    auto b = allocator->allocate(4096);
+  }
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryCached(), 4096);
+  CPUCachingAllocator::setMaxCachedBytes(0);
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryCached(), 0);
+  CPUCachingAllocator::setMaxCachedBytes(old_max);
+}
+
+TEST(CPUCachingAllocator, CrossThreadFree) {
+  Allocator* allocator = CPUCachingAllocator::get();
+  CPUCachingAllocator::emptyCache();
+  auto data = allocator->allocate(256);
+  std::thread t([&]() { data.clear(); });
+  t.join();
+  // The block was cached by the other thread and handed over to the global
+  // free list when that thread exited.
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryCached(), 256);
+  CPUCachingAllocator::emptyCache();
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryCached(), 0);
+}
+
+TEST(CPUCachingAllocator, SetCPUAllocator) {
+  SetCPUAllocator(CPUCachingAllocator::get());
+  auto data = GetCPUAllocator()->allocate(128);
+  SetCPUAllocator(GetDefaultCPUAllocator());
+  // Blocks from the caching allocator outlive switching back.
+  data.clear();
+  CPUCachingAllocator::emptyCache();
+  ASSERT_EQ(CPUCachingAllocator::currentMemoryAllocated(), 0);
+}
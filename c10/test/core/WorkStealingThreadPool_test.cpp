@@ -0,0 +1,92 @@
+#include <gtest/gtest.h>
+
+#include <c10/core/work_stealing_thread_pool.h>
+
+#include <atomic>
+
+using namespace c10;
+
+TEST(WorkStealingDeque, OwnerIsLifoThiefIsFifo) {
+  detail::WorkStealingDeque<int> deque(/* log_capacity */ 1);
+  int items[8];
+  for (int i = 0; i < 8; ++i) {
+    items[i] = i;
+    // grows past the initial capacity of 2
+    deque.push(&items[i]);
+  }
+  ASSERT_EQ(*deque.steal(), 0);
+  ASSERT_EQ(*deque.pop(), 7);
+  ASSERT_EQ(*deque.steal(), 1);
+  for (int i = 6; i >= 2; --i) {
+    ASSERT_EQ(*deque.pop(), i);
+  }
+  ASSERT_TRUE(deque.empty());
+  ASSERT_EQ(deque.pop(), nullptr);
+  ASSERT_EQ(deque.steal(), nullptr);
+}
+
+TEST(WorkStealingThreadPool, RunsAllTasks) {
+  WorkStealingThreadPool pool(4);
+  ASSERT_EQ(pool.size(), 4);
+  ASSERT_FALSE(pool.inThreadPool());
+  std::atomic<int> count{0};
+  for (int i = 0; i < 1000; ++i) {
+    pool.fork([&count]() { ++count; });
+  }
+  pool.waitUntil([&count]() { return count.load() == 1000; });
+  ASSERT_EQ(count.load(), 1000);
+}
+
+TEST(WorkStealingThreadPool, NestedTasks) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> outer_done{0};
+  std::atomic<int> inner_count{0};
+  for (int i = 0; i < 8; ++i) {
+    pool.fork([&]() {
+      std::atomic<int> remaining{16};
+      for (int j = 0; j < 16; ++j) {
+        pool.fork([&]() {
+          ++inner_count;
+          --remaining;
+        });
+      }
+      // help instead of blocking the worker
+      pool.waitUntil([&remaining]() { return remaining.load() == 0; });
+      ++outer_done;
+    });
+  }
+  pool.waitUntil([&outer_done]() { return outer_done.load() == 8; });
+  ASSERT_EQ(inner_count.load(), 8 * 16);
+}
+
+TEST(WorkStealingThreadPool, WakesUpParkedWorkers) {
+  WorkStealingThreadPool pool(2);
+  std::atomic<int> count{0};
+  for (int round = 0; round < 3; ++round) {
+    // give the workers time to park between rounds
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    pool.run([&count]() { ++count; });
+    // not helping, a worker has to pick the task up
+    while (count.load() != round + 1) {
+      std::this_thread::yield();
+    }
+  }
+  ASSERT_EQ(count.load(), 3);
+}
+
+TEST(WorkStealingThreadPool, WaitersOnlyRunForkedTasks) {
+  WorkStealingThreadPool pool(1);
+  std::atomic<bool> release{false};
+  std::atomic<int> count{0};
+  // occupies the only worker until released; a waiter must never pick it
+  pool.run([&]() {
+    while (!release.load()) {
+      std::this_thread::yield();
+    }
+  });
+  for (int i = 0; i < 10; ++i) {
+    pool.fork([&count]() { ++count; });
+  }
+  pool.waitUntil([&count]() { return count.load() == 10; });
+  release = true;
+}
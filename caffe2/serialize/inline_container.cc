@@ -166,6 +166,7 @@ static std::string getPadding(size_t cursor, const std::string& filename, size_t
 }
 
 bool PyTorchStreamReader::hasRecord(const std::string& name) {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   std::stringstream ss;
   ss << archive_name_ << "/" << name;
   mz_zip_reader_locate_file(ar_.get(), ss.str().c_str(), nullptr, 0);
@@ -177,6 +178,27 @@ bool PyTorchStreamReader::hasRecord(const std::string& name) {
   return result;
 }
 
+std::vector<std::string> PyTorchStreamReader::getAllRecords() {
+  std::lock_guard<std::mutex> guard(reader_lock_);
+  mz_uint num_files = mz_zip_reader_get_num_files(ar_.get());
+  std::vector<std::string> out;
+  out.reserve(num_files);
+  std::string prefix = archive_name_ + "/";
+  for (mz_uint i = 0; i < num_files; ++i) {
+    size_t name_size = mz_zip_reader_get_filename(ar_.get(), i, nullptr, 0);
+    valid("getting filename");
+    // name_size includes the terminating null
+    std::string buf(name_size, '\0');
+    mz_zip_reader_get_filename(ar_.get(), i, &buf[0], name_size);
+    valid("getting filename");
+    buf.resize(name_size > 0 ? name_size - 1 : 0);
+    if (buf.compare(0, prefix.size(), prefix) == 0) {
+      out.push_back(buf.substr(prefix.size()));
+    }
+  }
+  return out;
+}
+
 size_t PyTorchStreamReader::getRecordID(const std::string& name) {
   std::stringstream ss;
   ss << archive_name_ << "/" << name;
@@ -188,37 +210,82 @@ size_t PyTorchStreamReader::getRecordID(const std::string& name) {
   return result;
 }
 
+static int64_t read_le_16(uint8_t* buf) {
+  return buf[0] + (buf[1] << 8);
+}
+
+// returns the offset of the data of the file described by stat. the local
+// header may have a different extra field than the central directory, so it
+// has to be read from the file.
+static size_t getDataOffset(
+    ReadAdapterInterface* in,
+    const mz_zip_archive_file_stat& stat) {
+  uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
+  in->read(
+      stat.m_local_header_ofs,
+      local_header,
+      MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
+      "reading file header");
+  size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
+  size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
+  return stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+}
+
 // return dataptr, size
 std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecord(const std::string& name) {
+  std::unique_lock<std::mutex> guard(reader_lock_);
   size_t key = getRecordID(name);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), key, &stat);
   valid("retrieving file meta-data");
   void * ptr = malloc(stat.m_uncomp_size);
-  mz_zip_reader_extract_to_mem(ar_.get(), key, ptr, stat.m_uncomp_size, 0);
-  valid("reading file");
-
   at::DataPtr retval(ptr, ptr, free, at::kCPU);
+  if (stat.m_method == 0 && stat.m_comp_size == stat.m_uncomp_size &&
+      in_->supportsConcurrentReads()) {
+    // stored records are read straight from the adapter, and only the
+    // lookup above is serialized, so several records can be read at once.
+    size_t offset = getDataOffset(in_.get(), stat);
+    guard.unlock();
+    in_->read(offset, ptr, stat.m_uncomp_size, "reading file");
+    if (mz_crc32(MZ_CRC32_INIT, static_cast<const mz_uint8*>(ptr), stat.m_uncomp_size) !=
+        stat.m_crc32) {
+      CAFFE_THROW("PytorchStreamReader failed reading file ", name, ": CRC-32 check failed");
+    }
+  } else {
+    mz_zip_reader_extract_to_mem(ar_.get(), key, ptr, stat.m_uncomp_size, 0);
+    valid("reading file");
+  }
   return std::make_tuple(std::move(retval), stat.m_uncomp_size);
 }
 
-static int64_t read_le_16(uint8_t* buf) {
-  return buf[0] + (buf[1] << 8);
-}
-
 size_t PyTorchStreamReader::getRecordOffset(const std::string& name) {
+  std::lock_guard<std::mutex> guard(reader_lock_);
   mz_zip_archive_file_stat stat;
   mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
   valid("retriving file meta-data");
-  uint8_t local_header[MZ_ZIP_LOCAL_DIR_HEADER_SIZE];
-  in_->read(
-      stat.m_local_header_ofs,
-      local_header,
-      MZ_ZIP_LOCAL_DIR_HEADER_SIZE,
-      "reading file header");
-  size_t filename_len = read_le_16(local_header + MZ_ZIP_LDH_FILENAME_LEN_OFS);
-  size_t extra_len = read_le_16(local_header + MZ_ZIP_LDH_EXTRA_LEN_OFS);
-  return stat.m_local_header_ofs + MZ_ZIP_LOCAL_DIR_HEADER_SIZE + filename_len + extra_len;
+  return getDataOffset(in_.get(), stat);
+}
+
+std::tuple<at::DataPtr, size_t> PyTorchStreamReader::getRecordNoCopy(const std::string& name) {
+  mz_zip_archive_file_stat stat;
+  size_t offset;
+  {
+    std::lock_guard<std::mutex> guard(reader_lock_);
+    mz_zip_reader_file_stat(ar_.get(), getRecordID(name), &stat);
+    valid("retrieving file meta-data");
+    offset = getDataOffset(in_.get(), stat);
+  }
+  // only records that are stored as-is can alias the archive. records from
+  // other zip writers may be unaligned, which is not safe to hand out as
+  // tensor data
+  if (stat.m_method == 0 && stat.m_comp_size == stat.m_uncomp_size &&
+      offset % kFieldAlignment == 0) {
+    at::DataPtr retval = in_->getDataPtr(offset, stat.m_uncomp_size);
+    if (retval) {
+      return std::make_tuple(std::move(retval), stat.m_uncomp_size);
+    }
+  }
+  return getRecord(name);
 }
 
 
@@ -6,6 +6,8 @@
 #include <istream>
 #include <ostream>
 #include <fstream>
+#include <mutex>
+#include <vector>
 
 #include <c10/core/Allocator.h>
 #include <c10/core/Backend.h>
@@ -51,6 +53,9 @@ typedef struct mz_zip_archive mz_zip_archive;
 // 2. It provides a getRecordOffset function which returns the offset into the
 //    raw file where file data lives. If the file was written with PyTorchStreamWriter
 //    it is guarenteed to be 64 byte aligned.
+// 3. It provides a getRecordNoCopy function which, when reading through an
+//    adapter that maps the file (e.g. MmapFileAdapter), returns stored records
+//    as pointers into the mapped file rather than copies.
 
 // PyTorchReader/Writer handle checking the version number on the archive format
 // and ensure that all files are written to a archive_name directory so they
@@ -95,6 +100,12 @@ constexpr uint64_t kMaxSupportedFileFormatVersion = 0x1L;
 // Writer-specific constants
 constexpr uint64_t kFieldAlignment = 64;
 
+// All public methods of the reader are thread-safe, so records can be fetched
+// concurrently. Only the zip directory lookups are serialized when the read
+// adapter supports concurrent reads (see
+// ReadAdapterInterface::supportsConcurrentReads) and the record is stored
+// uncompressed, as PyTorchStreamWriter writes them; other records are read
+// under the reader's lock.
 class CAFFE2_API PyTorchStreamReader final {
  public:
   explicit PyTorchStreamReader(const std::string& file_name);
@@ -103,8 +114,16 @@ class CAFFE2_API PyTorchStreamReader final {
 
   // return dataptr, size
   std::tuple<at::DataPtr, size_t> getRecord(const std::string& name);
+  // like getRecord, but if the record is stored uncompressed at an aligned
+  // offset and the read adapter supports it (see
+  // ReadAdapterInterface::getDataPtr), the returned dataptr aliases the
+  // adapter's data instead of holding a copy. falls back to getRecord
+  // otherwise.
+  std::tuple<at::DataPtr, size_t> getRecordNoCopy(const std::string& name);
   size_t getRecordOffset(const std::string& name);
   bool hasRecord(const std::string& name);
+  // names of all records, without the archive_name/ prefix
+  std::vector<std::string> getAllRecords();
 
   ~PyTorchStreamReader();
 
@@ -119,6 +138,8 @@ class CAFFE2_API PyTorchStreamReader final {
   std::unique_ptr<mz_zip_archive> ar_;
   std::string archive_name_;
   std::unique_ptr<ReadAdapterInterface> in_;
+  // guards ar_ and in_
+  std::mutex reader_lock_;
 };
 
 class CAFFE2_API PyTorchStreamWriter final {
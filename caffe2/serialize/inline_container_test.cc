@@ -4,7 +4,9 @@
 
 #include <gtest/gtest.h>
 
+#include "caffe2/core/common.h"
 #include "caffe2/serialize/inline_container.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 namespace caffe2 {
 namespace serialize {
@@ -60,6 +62,48 @@ TEST(PyTorchStreamWriterAndReader, SaveAndLoad) {
   ASSERT_EQ(memcmp(the_file.c_str() + off2, data2.data(), data2.size()), 0);
 }
 
+TEST(PyTorchStreamWriterAndReader, LoadMmapNoCopy) {
+  std::array<char, 127> data1;
+  for (int i = 0; i < data1.size(); ++i) {
+    data1[i] = data1.size() - i;
+  }
+  std::array<char, 64> data2;
+  for (int i = 0; i < data2.size(); ++i) {
+    data2[i] = i;
+  }
+  {
+    PyTorchStreamWriter writer("output_mmap.zip");
+    writer.writeRecord("key1", data1.data(), data1.size());
+    writer.writeRecord("key2", data2.data(), data2.size(), /*compress=*/true);
+    writer.writeEndOfFile();
+  }
+
+  at::DataPtr data_ptr;
+  size_t size;
+  const char* base = nullptr;
+  {
+    auto rai = caffe2::make_unique<MmapFileAdapter>("output_mmap.zip");
+    base = static_cast<const char*>(rai->getDataPtr(0, rai->size()).get());
+    PyTorchStreamReader reader(std::move(rai));
+
+    // stored records alias the mapped file
+    std::tie(data_ptr, size) = reader.getRecordNoCopy("key1");
+    ASSERT_EQ(size, data1.size());
+    ASSERT_EQ(
+        static_cast<const char*>(data_ptr.get()),
+        base + reader.getRecordOffset("key1"));
+
+    // compressed records are still extracted into a fresh buffer
+    at::DataPtr compressed_ptr;
+    std::tie(compressed_ptr, size) = reader.getRecordNoCopy("key2");
+    ASSERT_EQ(size, data2.size());
+    ASSERT_EQ(memcmp(compressed_ptr.get(), data2.data(), data2.size()), 0);
+  }
+  // the mapping outlives the reader and its adapter
+  ASSERT_EQ(memcmp(data_ptr.get(), data1.data(), data1.size()), 0);
+  std::remove("output_mmap.zip");
+}
+
 } // namespace
 } // namespace serialize
 } // namespace caffe2
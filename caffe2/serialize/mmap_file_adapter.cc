@@ -0,0 +1,156 @@
+#include "caffe2/serialize/mmap_file_adapter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <c10/util/Exception.h>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace caffe2 {
+namespace serialize {
+
+struct MmapFileAdapter::Mapping {
+  explicit Mapping(const std::string& file_name);
+  ~Mapping();
+
+  char* data = nullptr;
+  size_t size = 0;
+#ifdef _WIN32
+  HANDLE file = INVALID_HANDLE_VALUE;
+  HANDLE map = nullptr;
+#endif
+};
+
+#ifdef _WIN32
+
+MmapFileAdapter::Mapping::Mapping(const std::string& file_name) {
+  file = CreateFileA(
+      file_name.c_str(),
+      GENERIC_READ,
+      // allow the file to be replaced by renaming over it while mapped;
+      // writing to it in place still fails, which would corrupt the tensors
+      // that alias it.
+      FILE_SHARE_READ | FILE_SHARE_DELETE,
+      nullptr,
+      OPEN_EXISTING,
+      FILE_ATTRIBUTE_NORMAL,
+      nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  LARGE_INTEGER file_size;
+  if (!GetFileSizeEx(file, &file_size)) {
+    CloseHandle(file);
+    AT_ERROR("could not get the size of file ", file_name);
+  }
+  size = static_cast<size_t>(file_size.QuadPart);
+  if (size == 0) {
+    return;
+  }
+  map = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+  if (map == nullptr) {
+    CloseHandle(file);
+    AT_ERROR("could not create a file mapping for ", file_name);
+  }
+  data = static_cast<char*>(MapViewOfFile(map, FILE_MAP_COPY, 0, 0, 0));
+  if (data == nullptr) {
+    CloseHandle(map);
+    CloseHandle(file);
+    AT_ERROR("could not map file ", file_name);
+  }
+}
+
+MmapFileAdapter::Mapping::~Mapping() {
+  if (data != nullptr) {
+    UnmapViewOfFile(data);
+  }
+  if (map != nullptr) {
+    CloseHandle(map);
+  }
+  if (file != INVALID_HANDLE_VALUE) {
+    CloseHandle(file);
+  }
+}
+
+#else /* _WIN32 */
+
+MmapFileAdapter::Mapping::Mapping(const std::string& file_name) {
+  int fd = open(file_name.c_str(), O_RDONLY);
+  if (fd == -1) {
+    AT_ERROR("open file failed, file path: ", file_name);
+  }
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) == -1) {
+    ::close(fd);
+    AT_ERROR("could not get the size of file ", file_name, ": ", strerror(errno));
+  }
+  size = static_cast<size_t>(file_stat.st_size);
+  if (size == 0) {
+    ::close(fd);
+    return;
+  }
+  void* ptr =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+  // the mapping holds its own reference to the file
+  ::close(fd);
+  if (ptr == MAP_FAILED) {
+    AT_ERROR("could not map file ", file_name, ": ", strerror(errno));
+  }
+  data = static_cast<char*>(ptr);
+}
+
+MmapFileAdapter::Mapping::~Mapping() {
+  if (data != nullptr) {
+    munmap(data, size);
+  }
+}
+
+#endif /* _WIN32 */
+
+MmapFileAdapter::MmapFileAdapter(const std::string& file_name)
+    : mapping_(std::make_shared<Mapping>(file_name)) {}
+
+size_t MmapFileAdapter::size() const {
+  return mapping_->size;
+}
+
+size_t MmapFileAdapter::read(uint64_t pos, void* buf, size_t n, const char* what)
+    const {
+  if (pos >= mapping_->size) {
+    return 0;
+  }
+  n = std::min(n, static_cast<size_t>(mapping_->size - pos));
+  std::memcpy(buf, mapping_->data + pos, n);
+  return n;
+}
+
+bool MmapFileAdapter::supportsConcurrentReads() const {
+  return true;
+}
+
+at::DataPtr MmapFileAdapter::getDataPtr(uint64_t pos, size_t n) const {
+  AT_ASSERTM(
+      pos + n <= mapping_->size,
+      "record [", pos, ", ", pos + n, ") is out of the mapped range of size ",
+      mapping_->size);
+  auto owner = new std::shared_ptr<Mapping>(mapping_);
+  return at::DataPtr(
+      mapping_->data + pos,
+      owner,
+      [](void* ctx) { delete static_cast<std::shared_ptr<Mapping>*>(ctx); },
+      at::kCPU);
+}
+
+MmapFileAdapter::~MmapFileAdapter() {}
+
+} // namespace serialize
+} // namespace caffe2
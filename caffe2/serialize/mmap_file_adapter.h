@@ -0,0 +1,39 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "c10/macros/Macros.h"
+#include "caffe2/serialize/read_adapter_interface.h"
+
+namespace caffe2 {
+namespace serialize {
+
+// this is a reader that maps the whole file into memory. records can be
+// handed out as DataPtrs that alias the mapping (see getDataPtr), so tensor
+// data is never copied and the pages are shared between all processes that
+// load the same file. the mapping is private (copy-on-write): writing to an
+// aliased tensor copies the touched pages and never modifies the file.
+// the file must not be truncated or rewritten in place while anything still
+// aliases it, and since the mapping is writable, it is charged against the
+// commit limit for its full size.
+class CAFFE2_API MmapFileAdapter final : public ReadAdapterInterface {
+ public:
+  C10_DISABLE_COPY_AND_ASSIGN(MmapFileAdapter);
+  explicit MmapFileAdapter(const std::string& file_name);
+  size_t size() const override;
+  size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
+      const override;
+  at::DataPtr getDataPtr(uint64_t pos, size_t n) const override;
+  bool supportsConcurrentReads() const override;
+  ~MmapFileAdapter();
+
+ private:
+  struct Mapping;
+  // shared with every DataPtr returned by getDataPtr, so the file stays
+  // mapped until the adapter and all aliasing tensors are gone.
+  std::shared_ptr<Mapping> mapping_;
+};
+
+} // namespace serialize
+} // namespace caffe2
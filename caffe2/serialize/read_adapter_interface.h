@@ -3,6 +3,7 @@
 #include <cstddef>
 #include <cstdint>
 
+#include <c10/core/Allocator.h>
 #include "c10/macros/Macros.h"
 
 namespace caffe2 {
@@ -16,6 +17,14 @@ class CAFFE2_API ReadAdapterInterface {
   virtual size_t size() const = 0;
   virtual size_t read(uint64_t pos, void* buf, size_t n, const char* what = "")
       const = 0;
+  // returns a DataPtr that aliases n bytes at pos of the underlying data
+  // without copying them. the returned DataPtr keeps that data alive on its
+  // own. adapters that cannot do this return an empty DataPtr, which is the
+  // default. unlike read, this may be called from several threads at once.
+  virtual at::DataPtr getDataPtr(uint64_t pos, size_t n) const;
+  // whether read may be called from several threads at once. when it is,
+  // PyTorchStreamReader reads stored records without holding its lock.
+  virtual bool supportsConcurrentReads() const;
   virtual ~ReadAdapterInterface();
 };
 
@@ -1,10 +1,13 @@
 #include <gtest/gtest.h>
 
 #include <torch/autograd.h>
+#include <torch/csrc/autograd/engine.h>
 
 #include <torch/utils.h>
 #include <test/cpp/api/support.h>
 
+#include <mutex>
+
 using namespace torch::autograd;
 
 #define ASSERT_VARIABLE_EQ(a,b) ASSERT_TRUE(torch::allclose((a),(b)))
@@ -611,6 +614,82 @@ TEST(CustomAutogradTest, HookNone) {
   ASSERT_TRUE(was_called);
 }
 
+static Engine& multithreaded_engine() {
+  static Engine engine;
+  static std::once_flag flag;
+  std::call_once(flag, [] {
+    engine.set_num_cpu_threads(4);
+    engine.set_deterministic(true);
+  });
+  return engine;
+}
+
+TEST(CustomAutogradTest, MultithreadedEngine) {
+  auto& engine = multithreaded_engine();
+  ASSERT_EQ(engine.num_cpu_threads(), 4);
+  ASSERT_TRUE(engine.is_deterministic());
+
+  // A wide graph: many independent branches all flowing into x
+  auto x = torch::randn({64, 64}, torch::requires_grad());
+  std::vector<Variable> branches;
+  for (int i = 0; i < 32; ++i) {
+    branches.push_back((x * (i + 1)).tanh().sum());
+  }
+  auto out = torch::stack(branches).sum();
+
+  auto expected = torch::autograd::grad({out}, {x}, {}, /*retain_graph=*/true)[0];
+  variable_list grads;
+  for (int run = 0; run < 3; ++run) {
+    grads.push_back(engine.execute(
+        {out.gradient_edge()}, {torch::ones_like(out)}, /*keep_graph=*/true,
+        /*create_graph=*/false, {x.gradient_edge()})[0]);
+  }
+  ASSERT_VARIABLE_EQ(grads[0], expected);
+  // Summation order does not depend on thread timing
+  ASSERT_TRUE(grads[0].equal(grads[1]));
+  ASSERT_TRUE(grads[0].equal(grads[2]));
+
+  // Accumulation into .grad of a leaf shared by concurrent branches
+  engine.execute(
+      {out.gradient_edge()}, {torch::ones_like(out)}, /*keep_graph=*/false,
+      /*create_graph=*/false);
+  ASSERT_VARIABLE_EQ(x.grad(), expected);
+}
+
+TEST(CustomAutogradTest, MultithreadedEngineReentrant) {
+  struct MyFunction : public Function<MyFunction> {
+    static Variable forward(AutogradContext *ctx, Variable x) {
+      ctx->saved_data["x"] = x;
+      return x * 2;
+    }
+
+    static variable_list backward(AutogradContext *ctx, variable_list grad) {
+      auto x = ctx->saved_data["x"].toTensor();
+      {
+        at::AutoGradMode enable_grad(true);
+        auto y = x.detach().requires_grad_();
+        auto branch = (y * y).sum() + (y * 3).sum();
+        multithreaded_engine().execute(
+            {branch.gradient_edge()}, {torch::ones_like(branch)},
+            /*keep_graph=*/false, /*create_graph=*/false);
+      }
+      return {grad[0] * 2};
+    }
+  };
+
+  auto& engine = multithreaded_engine();
+  auto x = torch::randn({4, 4}, torch::requires_grad());
+  std::vector<Variable> branches;
+  for (int i = 0; i < 8; ++i) {
+    branches.push_back(MyFunction::apply(x).sum());
+  }
+  auto out = torch::stack(branches).sum();
+  engine.execute(
+      {out.gradient_edge()}, {torch::ones_like(out)}, /*keep_graph=*/false,
+      /*create_graph=*/false);
+  ASSERT_VARIABLE_EQ(x.grad(), torch::ones({4, 4}) * 16);
+}
+
 // TODO add these tests if needed
 // test_once_differentiable
 // test_sparse_backward
@@ -73,7 +73,8 @@ void assign_parameter(
 template <typename OptimizerClass, typename Options>
 void check_exact_values(
     Options options,
-    std::vector<std::vector<torch::Tensor>> expected_parameters) {
+    std::vector<std::vector<torch::Tensor>> expected_parameters,
+    bool flatten = false) {
   const size_t kIterations = 1001;
   const size_t kSampleEvery = 100;
 
@@ -100,6 +101,9 @@ void check_exact_values(
   assign_parameter(parameters, "2.bias", torch::tensor({-0.0711}));
 
   auto optimizer = OptimizerClass(parameters.values(), options);
+  if (flatten) {
+    optimizer.flatten_parameters();
+  }
   torch::Tensor input =
       torch::tensor({0.1, 0.2, 0.3, 0.4, 0.5, 0.6}).reshape({3, 2});
 
@@ -265,6 +269,116 @@ TEST(OptimTest, ProducesPyTorchValues_SGDWithWeightDecayAndNesterovMomentum) {
       expected_parameters::SGD_with_weight_decay_and_nesterov_momentum());
 }
 
+TEST(OptimTest, ProducesPyTorchValues_FlattenedAdamWithWeightDecayAndAMSGrad) {
+  check_exact_values<Adam>(
+      AdamOptions(1.0).weight_decay(1e-6).amsgrad(true),
+      expected_parameters::Adam_with_weight_decay_and_amsgrad(),
+      /*flatten=*/true);
+}
+
+TEST(OptimTest, ProducesPyTorchValues_FlattenedAdagradWithWeightDecayAndLRDecay) {
+  check_exact_values<Adagrad>(
+      AdagradOptions(1.0).weight_decay(1e-6).lr_decay(1e-3),
+      expected_parameters::Adagrad_with_weight_decay_and_lr_decay(),
+      /*flatten=*/true);
+}
+
+TEST(
+    OptimTest,
+    ProducesPyTorchValues_FlattenedRMSpropWithWeightDecayAndCenteredAndMomentum) {
+  check_exact_values<RMSprop>(
+      RMSpropOptions(0.1).weight_decay(1e-6).centered(true).momentum(0.9),
+      expected_parameters::
+          RMSprop_with_weight_decay_and_centered_and_momentum(),
+      /*flatten=*/true);
+}
+
+TEST(OptimTest, ProducesPyTorchValues_FlattenedSGDWithWeightDecayAndNesterovMomentum) {
+  check_exact_values<SGD>(
+      SGDOptions(0.1).weight_decay(1e-6).momentum(0.9).nesterov(true),
+      expected_parameters::SGD_with_weight_decay_and_nesterov_momentum(),
+      /*flatten=*/true);
+}
+
+TEST(OptimTest, FlattenParameters) {
+  torch::manual_seed(0);
+
+  Linear model(3, 4);
+  const auto original = model->weight.clone();
+  Adam optimizer(model->parameters(), 0.1);
+  optimizer.flatten_parameters();
+
+  // Parameters, gradients and state are each back to back in one buffer.
+  const auto& parameters = optimizer.parameters();
+  ASSERT_TRUE(model->weight.allclose(original));
+  ASSERT_TRUE(parameters[0].storage().is_alias_of(parameters[1].storage()));
+  ASSERT_EQ(parameters[1].storage_offset(), parameters[0].numel());
+  ASSERT_TRUE(
+      parameters[0].grad().storage().is_alias_of(parameters[1].grad().storage()));
+
+  model->forward(torch::ones({5, 3})).sum().backward();
+  optimizer.step();
+  ASSERT_FALSE(model->weight.allclose(original));
+  ASSERT_TRUE(optimizer.exp_average_buffers[0].storage().is_alias_of(
+      optimizer.exp_average_buffers[1].storage()));
+
+  // Gradients stay in their buffer across zero_grad() and backward().
+  optimizer.zero_grad();
+  ASSERT_EQ(parameters[0].grad().sum().item<float>(), 0);
+  model->forward(torch::ones({5, 3})).sum().backward();
+  ASSERT_TRUE(
+      parameters[0].grad().storage().is_alias_of(parameters[1].grad().storage()));
+  ASSERT_NE(parameters[1].grad().sum().item<float>(), 0);
+}
+
+TEST(OptimTest, TiedParametersAreUpdatedOnce) {
+  torch::manual_seed(0);
+
+  enum class Path { Fused, Flattened, Fallback };
+  for (auto path : {Path::Fused, Path::Flattened, Path::Fallback}) {
+    Linear model(3, 3);
+    auto weight = model->weight;
+    auto bias = model->bias;
+    auto expected_weight = weight.detach().clone().requires_grad_(true);
+    auto expected_bias = bias.detach().clone().requires_grad_(true);
+    // A parameter of another type makes `step()` update the parameters one
+    // by one instead of with the fused kernels.
+    auto other = torch::zeros({2}, torch::kDouble).requires_grad_(true);
+    auto expected_other = other.detach().clone().requires_grad_(true);
+
+    // The weight is listed twice, as it is when a module shares it.
+    std::vector<torch::Tensor> parameters{weight, bias, weight};
+    std::vector<torch::Tensor> expected_parameters{expected_weight,
+                                                   expected_bias};
+    if (path == Path::Fallback) {
+      parameters.push_back(other);
+      expected_parameters.push_back(expected_other);
+    }
+    SGD optimizer(parameters, SGDOptions(0.1).momentum(0.9));
+    SGD expected_optimizer(expected_parameters, SGDOptions(0.1).momentum(0.9));
+    if (path == Path::Flattened) {
+      optimizer.flatten_parameters();
+      ASSERT_TRUE(bias.storage().is_alias_of(weight.storage()));
+      ASSERT_EQ(bias.storage_offset(), weight.numel());
+      ASSERT_EQ(weight.storage().numel(), weight.numel() + bias.numel());
+    }
+
+    const auto input = torch::randn({5, 3});
+    for (size_t i = 0; i < 3; ++i) {
+      optimizer.zero_grad();
+      expected_optimizer.zero_grad();
+      (torch::addmm(bias, input, weight.t()).sum() + other.sum()).backward();
+      (torch::addmm(expected_bias, input, expected_weight.t()).sum() +
+       expected_other.sum())
+          .backward();
+      optimizer.step();
+      expected_optimizer.step();
+      ASSERT_TRUE(weight.allclose(expected_weight));
+      ASSERT_TRUE(bias.allclose(expected_bias));
+    }
+  }
+}
+
 TEST(OptimTest, ZeroGrad) {
   torch::manual_seed(0);
 
@@ -0,0 +1,218 @@
+#include "test/cpp/jit/test_base.h"
+
+#include "torch/csrc/jit/fuser/cpu/disk_cache.h"
+
+#ifndef _WIN32
+#include "torch/csrc/jit/fuser/cpu/temp_file.h"
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+#ifndef _WIN32
+
+using fuser::cpu::KernelDiskCache;
+using fuser::cpu::TempFile;
+
+namespace {
+
+std::string readAll(const std::string& path) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  std::stringstream ss;
+  ss << file.rdbuf();
+  return ss.str();
+}
+
+std::vector<std::string> listDir(const std::string& path) {
+  std::vector<std::string> names;
+  DIR* dir = opendir(path.c_str());
+  if (dir == nullptr) {
+    return names;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    if (name != "." && name != "..") {
+      names.push_back(name);
+    }
+  }
+  closedir(dir);
+  return names;
+}
+
+void removeAll(const std::string& path) {
+  struct stat st;
+  if (lstat(path.c_str(), &st) != 0) {
+    return;
+  }
+  if (S_ISDIR(st.st_mode)) {
+    for (const auto& name : listDir(path)) {
+      removeAll(path + "/" + name);
+    }
+    rmdir(path.c_str());
+  } else {
+    unlink(path.c_str());
+  }
+}
+
+// Sets an environment variable for the lifetime of the guard.
+struct EnvGuard {
+  EnvGuard(const char* name, const char* value) : name_(name) {
+    const char* prev = getenv(name);
+    had_value_ = prev != nullptr;
+    if (had_value_) {
+      prev_ = prev;
+    }
+    if (value) {
+      setenv(name, value, 1);
+    } else {
+      unsetenv(name);
+    }
+  }
+  ~EnvGuard() {
+    if (had_value_) {
+      setenv(name_, prev_.c_str(), 1);
+    } else {
+      unsetenv(name_);
+    }
+  }
+
+ private:
+  const char* name_;
+  bool had_value_;
+  std::string prev_;
+};
+
+} // namespace
+
+void testFuserDiskCache() {
+  char tmpl[] = "/tmp/test_fuser_disk_cache_XXXXXX";
+  ASSERT_NE(mkdtemp(tmpl), nullptr);
+  const std::string root = tmpl;
+
+  // the cache is off unless PYTORCH_FUSER_CACHE_DIR names a directory
+  {
+    EnvGuard dir_env("PYTORCH_FUSER_CACHE_DIR", nullptr);
+    ASSERT_TRUE(KernelDiskCache::fromEnvironment() == nullptr);
+  }
+  {
+    EnvGuard dir_env("PYTORCH_FUSER_CACHE_DIR", "");
+    ASSERT_TRUE(KernelDiskCache::fromEnvironment() == nullptr);
+  }
+  {
+    const std::string dir = root + "/env/cache";
+    EnvGuard dir_env("PYTORCH_FUSER_CACHE_DIR", dir.c_str());
+    auto cache = KernelDiskCache::fromEnvironment();
+    ASSERT_TRUE(cache != nullptr);
+    ASSERT_EQ(cache->dir(), dir);
+    struct stat st;
+    ASSERT_EQ(stat(dir.c_str(), &st), 0);
+    ASSERT_TRUE(S_ISDIR(st.st_mode));
+  }
+
+  // lookup and insert
+  {
+    const std::string dir = root + "/entries";
+    ASSERT_EQ(mkdir(dir.c_str(), 0755), 0);
+    KernelDiskCache cache(dir, 1 << 20);
+    ASSERT_FALSE(cache.lookup("k1").has_value());
+
+    std::string entry;
+    {
+      TempFile so_file(cache.tempTemplate(".so"), 3);
+      so_file.write("aaaa");
+      so_file.sync();
+      ASSERT_TRUE(cache.insert("k1", so_file.name()));
+      auto found = cache.lookup("k1");
+      ASSERT_TRUE(found.has_value());
+      entry = *found;
+      ASSERT_NE(entry, so_file.name());
+    }
+    // the entry is published as a link, so it outlives the compiled file
+    ASSERT_EQ(readAll(entry), "aaaa");
+    ASSERT_FALSE(cache.lookup("k2").has_value());
+
+    // a published entry is never replaced
+    {
+      TempFile so_file(cache.tempTemplate(".so"), 3);
+      so_file.write("bbbb");
+      so_file.sync();
+      ASSERT_TRUE(cache.insert("k1", so_file.name()));
+    }
+    ASSERT_EQ(readAll(*cache.lookup("k1")), "aaaa");
+
+    // no temporary files are left behind
+    for (const auto& name : listDir(dir)) {
+      ASSERT_NE(name.compare(0, 4, "tmp-"), 0);
+    }
+
+    // an entry whose stored key differs, as on a hash collision, is not
+    // returned and keeps its slot
+    const std::string key_file = entry.substr(0, entry.size() - 3) + ".key";
+    ASSERT_EQ(readAll(key_file), "k1");
+    unlink(key_file.c_str());
+    {
+      std::ofstream out(key_file, std::ios::out | std::ios::binary);
+      out << "other";
+    }
+    ASSERT_FALSE(cache.lookup("k1").has_value());
+    {
+      TempFile so_file(cache.tempTemplate(".so"), 3);
+      so_file.write("cccc");
+      so_file.sync();
+      ASSERT_FALSE(cache.insert("k1", so_file.name()));
+    }
+    ASSERT_EQ(readAll(key_file), "other");
+    ASSERT_EQ(readAll(entry), "aaaa");
+  }
+
+  // eviction of the least recently used entries beyond the size limit
+  {
+    const std::string dir = root + "/evict";
+    ASSERT_EQ(mkdir(dir.c_str(), 0755), 0);
+    KernelDiskCache cache(dir, 12);
+    std::string old_entry;
+    {
+      TempFile so_file(cache.tempTemplate(".so"), 3);
+      so_file.write("12345678");
+      so_file.sync();
+      ASSERT_TRUE(cache.insert("old", so_file.name()));
+      old_entry = *cache.lookup("old");
+    }
+    struct timeval times[2] = {{1000, 0}, {1000, 0}};
+    ASSERT_EQ(utimes(old_entry.c_str(), times), 0);
+    {
+      TempFile so_file(cache.tempTemplate(".so"), 3);
+      so_file.write("12345678");
+      so_file.sync();
+      ASSERT_TRUE(cache.insert("new", so_file.name()));
+    }
+    ASSERT_TRUE(cache.lookup("new").has_value());
+    ASSERT_FALSE(cache.lookup("old").has_value());
+    struct stat st;
+    ASSERT_NE(stat(old_entry.c_str(), &st), 0);
+  }
+
+  removeAll(root);
+}
+
+#else // _WIN32
+
+void testFuserDiskCache() {
+  ASSERT_TRUE(fuser::cpu::KernelDiskCache::fromEnvironment() == nullptr);
+}
+
+#endif // _WIN32
+
+} // namespace jit
+} // namespace torch
@@ -27,5 +27,53 @@ void testInterp() {
   ASSERT_TRUE(exactlyEqual(outputs[0], hx));
   ASSERT_TRUE(exactlyEqual(outputs[1], cx));
 }
+
+void testInterpSuperinstructions() {
+  auto graph = std::make_shared<Graph>();
+  script::parseIR(
+      R"IR(
+graph(%a : Tensor, %b : Tensor, %cond : bool):
+  %one : int = prim::Constant[value=1]()
+  %c : Tensor = aten::mul(%a, %b)
+  %d : Tensor = aten::add(%c, %a, %one)
+  %y : Tensor = aten::relu(%b)
+  %x : Tensor = aten::mul(%d, %y)
+  %e : Tensor = prim::If(%cond)
+    block0():
+      %f : Tensor = aten::relu(%x)
+      -> (%f)
+    block1():
+      %g : Tensor = aten::neg(%x)
+      -> (%g)
+  %h : Tensor = aten::add(%e, %x, %one)
+  return (%h))IR",
+      &*graph);
+  Code code(graph);
+  std::stringstream ss;
+  ss << code;
+  // The STORE of the outputs of the if is the target of the JMP of its then
+  // block, it must not be fused with the OP of its else block.
+  testing::FileCheck()
+      .check("LOADC_OP")
+      ->check("MOVE_OP")
+      ->check("OP_STORE")
+      ->check("JF")
+      ->check("JMP")
+      ->check("LOAD_OP")
+      ->check_next(" STORE ")
+      ->run(ss.str());
+
+  auto a = autograd::make_variable(at::randn({2, 3}), false);
+  auto b = autograd::make_variable(at::randn({2, 3}), false);
+  auto x = (a * b + a) * b.relu();
+  for (bool cond : {true, false}) {
+    InterpreterState interp(code);
+    Stack stack = {a, b, cond};
+    interp.run(stack);
+    ASSERT_EQ(stack.size(), 1);
+    auto expected = (cond ? x.relu() : x.neg()) + x;
+    ASSERT_TRUE(stack[0].toTensor().allclose(expected));
+  }
+}
 } // namespace jit
 } // namespace torch
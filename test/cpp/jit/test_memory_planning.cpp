@@ -0,0 +1,72 @@
+#include <test/cpp/jit/test_base.h>
+#include <test/cpp/jit/test_utils.h>
+
+#include <torch/csrc/jit/irparser.h>
+#include <torch/csrc/jit/memory_planned_executor.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+namespace torch {
+namespace jit {
+
+void testMemoryPlanning() {
+  auto graph = std::make_shared<Graph>();
+  const std::string input =
+      R"IR(
+graph(%a : Tensor, %b : Tensor):
+  %one : int = prim::Constant[value=1]()
+  %c : Tensor = aten::mul(%a, %b)
+  %d : Tensor = aten::add(%c, %a, %one)
+  %e : Tensor = aten::tanh(%d)
+  %f : Tensor = aten::mul(%e, %c)
+  %g : Tensor = aten::add(%f, %b, %one)
+  return (%g)
+)IR";
+  script::parseIR(input, graph.get());
+
+  // Live ranges by node position: c [1, 4], d [2, 3], e [3, 4], f [4, 5].
+  // At most three of them are live at once, and f can reuse d's memory.
+  std::vector<Value*> values;
+  for (Node* n : graph->nodes()) {
+    if (n->kind() != prim::Constant && n->output() != graph->outputs()[0]) {
+      values.push_back(n->output());
+    }
+  }
+  auto ranges = ComputeLiveRanges(graph, values);
+  ASSERT_EQ(ranges.at(values[0]).begin, 1);
+  ASSERT_EQ(ranges.at(values[0]).end, 4);
+  ASSERT_EQ(ranges.at(values[1]).end, 3);
+  std::unordered_map<const Value*, size_t> sizes;
+  for (Value* v : values) {
+    sizes[v] = 100;
+  }
+  auto plan = PackLiveRanges(ranges, sizes);
+  ASSERT_EQ(plan.arena_bytes, 3 * 128);
+  ASSERT_EQ(plan.offsets.at(values[3]), plan.offsets.at(values[1]));
+
+  MemoryPlannedExecutor executor(graph);
+  for (int i = 0; i < 3; i++) {
+    auto a = at::randn({4, 16});
+    auto b = at::randn({4, 16});
+    Stack stack{a, b};
+    executor.run(stack);
+    ASSERT_EQ(stack.size(), 1);
+    auto c = a * b;
+    ASSERT_TRUE(almostEqual(stack[0].toTensor(), (c + a).tanh() * c + b));
+    ASSERT_EQ(executor.numPlannedValues(), 4);
+    ASSERT_EQ(executor.arenaBytes(), 3 * 4 * 16 * sizeof(float));
+  }
+
+  // Larger inputs do not fit the plan, and are planned again.
+  auto a = at::randn({8, 16});
+  auto b = at::randn({8, 16});
+  for (int i = 0; i < 3; i++) {
+    Stack stack{a, b};
+    executor.run(stack);
+    auto c = a * b;
+    ASSERT_TRUE(almostEqual(stack[0].toTensor(), (c + a).tanh() * c + b));
+  }
+  ASSERT_EQ(executor.arenaBytes(), 3 * 8 * 16 * sizeof(float));
+}
+
+} // namespace jit
+} // namespace torch
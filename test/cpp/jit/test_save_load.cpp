@@ -1,6 +1,7 @@
 #include <test/cpp/jit/test_base.h>
 #include <test/cpp/jit/test_utils.h>
 
+#include <cstdio>
 #include <sstream>
 
 #include <torch/csrc/jit/export.h>
@@ -57,6 +58,38 @@ void testSaveExtraFilesHook() {
   }
 }
 
+void testLoadStorages() {
+  const std::string filename = "test_load_storages.pt";
+  std::vector<at::Tensor> params;
+  {
+    Module m("__torch__.m");
+    for (int i = 0; i < 16; ++i) {
+      params.push_back(torch::randn({i + 1, 64}));
+      m.register_parameter("p" + c10::to_string(i), params.back(), false);
+    }
+    m.save(filename);
+  }
+  for (int mode = 0; mode < 4; ++mode) {
+    bool prev_lazy = getLazyStorageLoading();
+    bool prev_mmap = getMmapLoading();
+    getLazyStorageLoading() = mode & 1;
+    getMmapLoading() = mode & 2;
+    Module loaded = jit::load(filename);
+    getLazyStorageLoading() = prev_lazy;
+    getMmapLoading() = prev_mmap;
+    for (size_t i = 0; i < params.size(); ++i) {
+      ASSERT_TRUE(
+          loaded.get_parameter("p" + c10::to_string(i)).equal(params[i]));
+    }
+    // loaded tensors are writable and do not write through to the file
+    torch::NoGradGuard no_grad;
+    loaded.get_parameter("p0").zero_();
+  }
+  Module reloaded = jit::load(filename);
+  ASSERT_TRUE(reloaded.get_parameter("p0").equal(params[0]));
+  std::remove(filename.c_str());
+}
+
 static const auto pretty_printed = R"JIT(
 op_version_set = 1000
 def foo(x: Tensor,
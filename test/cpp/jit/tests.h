@@ -63,8 +63,12 @@ namespace jit {
   _(DCE)                               \
   _(CustomFusionNestedBlocks)          \
   _(ImportTooNew)                      \
+  _(LoadStorages)                      \
   _(ClassDerive)                       \
-  _(Inliner)
+  _(Inliner)                           \
+  _(MemoryPlanning)                    \
+  _(InterpSuperinstructions)           \
+  _(FuserDiskCache)
 
 #define TH_FORALL_TESTS_CUDA(_) \
   _(ArgumentSpec)               \
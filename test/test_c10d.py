@@ -2854,6 +2854,56 @@ class ReducerTest(TestCase):
             output.backward()
             optimizer.step()
 
+    def _run_with_comm_hook(self, hook):
+        random.seed(0)
+        torch.manual_seed(0)
+        batch_size = 10
+        model = ReducerModule().float()
+        parameters = list(model.parameters())
+        reducer = dist.Reducer([parameters], [list(range(len(parameters)))], self.process_group)
+        if hook is not None:
+            reducer._register_comm_hook(hook)
+        loss = nn.CrossEntropyLoss()
+        input = torch.rand([batch_size, 2])
+        target = torch.LongTensor([random.randrange(4) for _ in range(batch_size)])
+        output = loss(model(input), target)
+        reducer.prepare_for_backward(output)
+        output.backward()
+        return torch.cat([p.grad.view(-1) for p in parameters])
+
+    def test_fp16_compress_hook(self):
+        expected = self._run_with_comm_hook(None)
+        grad = self._run_with_comm_hook(dist._FP16CompressHook(self.process_group))
+        self.assertEqual(expected, grad, prec=1e-3)
+
+    def test_topk_compress_hook(self):
+        expected = self._run_with_comm_hook(None)
+        grad = self._run_with_comm_hook(dist._TopKCompressHook(self.process_group, 0.25))
+        # Only the largest quarter of the gradients is sent, unchanged.
+        k = (grad.numel() + 3) // 4
+        self.assertLessEqual(grad.nonzero().size(0), k)
+        sent = grad != 0
+        self.assertEqual(expected[sent], grad[sent])
+        self.assertGreaterEqual(
+            expected[sent].abs().min(), expected[~sent].abs().max())
+
+    def test_powersgd_hook(self):
+        expected = self._run_with_comm_hook(None)
+        grad = self._run_with_comm_hook(dist._PowerSGDHook(self.process_group, 1))
+        self.assertEqual(expected.size(), grad.size())
+        self.assertTrue(torch.isfinite(grad).all())
+        # Buckets that would not shrink are allreduced uncompressed.
+        grad = self._run_with_comm_hook(dist._PowerSGDHook(self.process_group, 8))
+        self.assertEqual(expected, grad, prec=1e-4)
+
+    def test_register_comm_hook_twice(self):
+        model = ReducerModule()
+        parameters = list(model.parameters())
+        reducer = dist.Reducer([parameters], [list(range(len(parameters)))], self.process_group)
+        reducer._register_comm_hook(dist._FP16CompressHook(self.process_group))
+        with self.assertRaises(RuntimeError):
+            reducer._register_comm_hook(dist._FP16CompressHook(self.process_group))
+
 
 class ComputeBucketAssignmentTest(TestCase):
     def test_single_limit_single_dtype(self):
@@ -1440,6 +1440,71 @@ graph(%input, %weight):
             torch._C._jit_pass_fuse_linear(graph)
             FileCheck().run(input_str, graph)
 
+    def test_freeze_module(self):
+        class SubModule(torch.nn.Module):
+            def __init__(self):
+                super(SubModule, self).__init__()
+                self.conv = torch.nn.Conv2d(1, 4, 3)
+                self.bn = torch.nn.BatchNorm2d(4)
+
+            def forward(self, x):
+                return self.bn(self.conv(x))
+
+        class TestModule(torch.nn.Module):
+            def __init__(self):
+                super(TestModule, self).__init__()
+                self.sub = SubModule()
+                self.fc = torch.nn.Linear(16, 2)
+
+            def forward(self, x):
+                return self.fc(self.sub(x).flatten(1))
+
+        eager = TestModule()
+        eager.sub.bn.running_mean.uniform_()
+        eager.sub.bn.running_var.uniform_(1, 2)
+        eager.eval()
+        m = torch.jit.script(eager)
+        frozen = torch._C._jit_pass_freeze_module(m._c)
+        graph = frozen._get_method('forward').graph
+        FileCheck().check_not('prim::GetAttr').check_not('aten::batch_norm') \
+                   .check('aten::conv2d').check('aten::linear').run(graph)
+        self.assertFalse(frozen._has_module('sub'))
+
+        x = torch.rand(2, 1, 6, 6)
+        self.assertEqual(frozen._get_method('forward')(x), eager(x))
+        # The original module is left as is.
+        FileCheck().check('prim::GetAttr').run(m._c._get_method('forward').graph)
+        self.assertEqual(m(x), eager(x))
+
+        with self.assertRaisesRegex(RuntimeError, "eval mode"):
+            torch._C._jit_pass_freeze_module(torch.jit.script(TestModule())._c)
+
+    def test_freeze_module_written_attributes(self):
+        class M(torch.nn.Module):
+            def __init__(self):
+                super(M, self).__init__()
+                self.scale = 2
+                self.count = 0
+                self.register_buffer('total', torch.zeros(3))
+
+            def forward(self, x):
+                self.count += 1
+                self.total.add_(x)
+                return x * self.scale
+
+        m = torch.jit.script(M())
+        m.eval()
+        frozen = torch._C._jit_pass_freeze_module(m._c)
+        FileCheck().check_not('GetAttr[name="scale"]') \
+                   .check('GetAttr[name="count"]') \
+                   .check('GetAttr[name="total"]') \
+                   .run(frozen._get_method('forward').graph)
+        x = torch.ones(3)
+        self.assertEqual(frozen._get_method('forward')(x), x * 2)
+        frozen._get_method('forward')(x)
+        self.assertEqual(frozen._get_attribute('count'), 2)
+        self.assertEqual(frozen._get_attribute('total'), x * 2)
+
     @_tmp_donotuse_dont_inline_everything
     def test_fold_quantize(self):
         class M(torch.nn.Module):
@@ -10458,6 +10523,90 @@ a")
         self.assertEqual(torch.autograd.grad(slstm(*inputs).sum(), inputs),
                          torch.autograd.grad(lstm(*inputs).sum(), inputs))
 
+    def test_linear_batching(self):
+        graph = parse_ir("""
+graph(%x : Tensor, %img : Tensor, %w1 : Tensor, %w2 : Tensor, %w3 : Tensor,
+      %b1 : Tensor, %b3 : Tensor, %cw1 : Tensor, %cw2 : Tensor, %cb1 : Tensor):
+  %none : None = prim::Constant()
+  %zero : int = prim::Constant[value=0]()
+  %one : int = prim::Constant[value=1]()
+  %ones : int[] = prim::ListConstruct(%one, %one)
+  %zeros : int[] = prim::ListConstruct(%zero, %zero)
+  %y1 : Tensor = aten::linear(%x, %w1, %b1)
+  %w2_t : Tensor = aten::t(%w2)
+  %y2 : Tensor = aten::mm(%x, %w2_t)
+  %y3 : Tensor = aten::linear(%x, %w3, %b3)
+  %c1 : Tensor = aten::conv2d(%img, %cw1, %cb1, %ones, %zeros, %ones, %one)
+  %c2 : Tensor = aten::conv2d(%img, %cw2, %none, %ones, %zeros, %ones, %one)
+  return (%y1, %y2, %y3, %c1, %c2)""")
+        torch._C._jit_pass_batch_mm(graph)
+        FileCheck().check_count("prim::BatchLinear", 2, exactly=True) \
+            .run(str(graph))
+        FileCheck().check_not("aten::linear").check_not("aten::mm") \
+            .check_not("aten::conv2d").run(str(graph))
+
+        fn = self.createFunctionFromGraph(graph)
+        x = torch.randn(5, 4)
+        img = torch.randn(2, 3, 6, 6)
+        w1, w2, w3 = torch.randn(3, 4), torch.randn(6, 4), torch.randn(2, 4)
+        b1, b3 = torch.randn(3), torch.randn(2)
+        cw1, cw2 = torch.randn(4, 3, 1, 1), torch.randn(5, 3, 1, 1)
+        cb1 = torch.randn(4)
+        inputs = (x, img, w1, w2, w3, b1, b3, cw1, cw2, cb1)
+
+        def expected():
+            return (F.linear(x, w1, b1), x.mm(w2.t()), F.linear(x, w3, b3),
+                    F.conv2d(img, cw1, cb1), F.conv2d(img, cw2))
+
+        with torch.no_grad():
+            # The second run uses the cached concatenated weights.
+            for _ in range(2):
+                outputs = fn(*inputs)
+                self.assertEqual(outputs, expected())
+                for output in outputs:
+                    self.assertTrue(output.is_contiguous())
+            # Updating a weight in place invalidates the cache.
+            w1.add_(1)
+            cb1.add_(1)
+            self.assertEqual(fn(*inputs), expected())
+
+    @unittest.skipIf(not torch.fbgemm_is_cpu_supported(),
+                     'Quantized linear requires FBGEMM. FBGEMM is only optimized for CPUs'
+                     ' with instruction set support avx2 or newer.')
+    def test_quantized_linear_batching(self):
+        graph = parse_ir("""
+graph(%x : Tensor, %w1 : Tensor, %w2 : Tensor, %w3 : Tensor):
+  %scale : float = prim::Constant[value=0.1]()
+  %zero_point : int = prim::Constant[value=3]()
+  %y1 : Tensor = quantized::linear(%x, %w1, %scale, %zero_point)
+  %y2 : Tensor = quantized::linear(%x, %w2, %scale, %zero_point)
+  %y3 : Tensor = quantized::linear(%x, %w3, %scale, %zero_point)
+  return (%y1, %y2, %y3)""")
+        torch._C._jit_pass_batch_mm(graph)
+        FileCheck().check_count("prim::BatchLinear", 1, exactly=True) \
+            .check_not("quantized::linear").run(str(graph))
+
+        fn = self.createFunctionFromGraph(graph)
+        prepack = torch.ops.quantized.linear_prepack
+        qlinear = torch.ops.quantized.linear
+
+        def weight(out_features, scale=0.05):
+            return torch.quantize_per_tensor(torch.randn(out_features, 4), scale, 0, torch.qint8)
+
+        x = torch.quantize_per_tensor(torch.randn(5, 4), 0.05, 128, torch.quint8)
+        w1, w2 = prepack(weight(3), torch.randn(3)), prepack(weight(6))
+        for w3 in [prepack(weight(2), torch.randn(2)),
+                   # A different weight scale runs the ops one by one.
+                   prepack(weight(2, scale=0.02))]:
+            expected = [qlinear(x, w, 0.1, 3) for w in (w1, w2, w3)]
+            # The second run uses the cached packed weight.
+            for _ in range(2):
+                outputs = fn(x, w1, w2, w3)
+                for output, ref in zip(outputs, expected):
+                    self.assertEqual(output.int_repr(), ref.int_repr())
+                    self.assertEqual(output.q_scale(), ref.q_scale())
+                    self.assertEqual(output.q_zero_point(), ref.q_zero_point())
+
     def test_loop_unrolling(self):
         def fn(x):
             y = 0
@@ -17734,6 +17883,68 @@ class TestAsync(JitTestCase):
         f = io.BytesIO()
         torch.onnx.export(MyMod(), (torch.rand(3, 4),), f)
 
+    def test_auto_fork(self):
+        graph_str = """
+graph(%x : Tensor, %w1 : Tensor, %w2 : Tensor):
+  %a1 : Tensor = aten::mm(%x, %w1)
+  %a2 : Tensor = aten::relu(%a1)
+  %a3 : Tensor = aten::mm(%a2, %w1)
+  %b1 : Tensor = aten::mm(%x, %w2)
+  %b2 : Tensor = aten::relu(%b1)
+  %b3 : Tensor = aten::mm(%b2, %w2)
+  %one : int = prim::Constant[value=1]()
+  %r : Tensor = aten::add(%a3, %b3, %one)
+  return (%r)"""
+        inputs = [torch.rand(4, 4) for _ in range(3)]
+        expected = self.createFunctionFromGraph(parse_ir(graph_str))(*inputs)
+
+        # Each tower costs 3, which is too cheap to fork under a min_cost of 4.
+        graph = parse_ir(graph_str)
+        torch._C._jit_pass_auto_fork(graph, 4)
+        self.assertGraphContainsExactly(graph, 'prim::fork', 0)
+
+        # The first tower runs on the inter-op pool, the second one in the
+        # calling thread, and the sum waits for the first.
+        graph = parse_ir(graph_str)
+        torch._C._jit_pass_auto_fork(graph, 3)
+        self.assertGraphContainsExactly(graph, 'prim::fork', 1)
+        self.assertGraphContainsExactly(graph, 'aten::wait', 1)
+        self.assertGraphContainsExactly(graph, 'aten::mm', 2)
+        FileCheck().check("prim::fork").check("aten::wait").check("aten::add").run(str(graph))
+        self.assertEqual(self.createFunctionFromGraph(graph)(*inputs), expected)
+
+        # Nothing is forked when the towers write to their inputs.
+        graph = parse_ir(graph_str.replace("aten::relu(%a1)", "aten::relu_(%x)"))
+        torch._C._jit_pass_auto_fork(graph, 3)
+        self.assertGraphContainsExactly(graph, 'prim::fork', 0)
+
+    def test_auto_fork_module(self):
+        class Towers(torch.nn.Module):
+            def __init__(self):
+                super(Towers, self).__init__()
+                self.tower1 = torch.nn.Sequential(
+                    torch.nn.Linear(8, 8), torch.nn.ReLU(), torch.nn.Linear(8, 8))
+                self.tower2 = torch.nn.Sequential(
+                    torch.nn.Linear(8, 8), torch.nn.ReLU(), torch.nn.Linear(8, 8))
+
+            def forward(self, x):
+                return torch.cat([self.tower1(x), self.tower2(x)], 1)
+
+        eager = Towers()
+        m = torch.jit.script(eager)
+        m._c._set_auto_fork(True, 4)
+        x = torch.rand(4, 8)
+        with torch.no_grad():
+            for _ in range(2):
+                self.assertEqual(m(x), eager(x))
+            FileCheck().check("prim::fork").check("aten::wait").check("aten::cat") \
+                .run(str(torch.jit.last_executed_optimized_graph()))
+
+        m._c._set_auto_fork(False)
+        with torch.no_grad():
+            self.assertEqual(m(x), eager(x))
+            FileCheck().check_not("prim::fork").run(str(torch.jit.last_executed_optimized_graph()))
+
     def test_save_load_with_extra_files(self):
         class MyMod(torch.jit.ScriptModule):
             @torch.jit.script_method
@@ -46,6 +46,24 @@ class TestFuser(JitTestCase):
     def test_abs_cuda(self):
         self._test_fused_abs(device="cuda")
 
+    @unittest.skipIf(IS_SANDCASTLE, "NYI: fuser CPU support for Sandcastle")
+    @enable_cpu_fuser
+    def test_vectorized_cpu(self):
+        def func(x, y, z):
+            return torch.sigmoid(torch.relu(x * y + z.exp()) - 0.5 * x).neg()
+
+        # sizes that leave a scalar tail, and a size that is split into
+        # several parallel chunks
+        for dtype in [torch.float, torch.double]:
+            for size in [3, 17, 100003]:
+                inputs = [torch.randn(size, dtype=dtype) for _ in range(3)]
+                ge = self.checkScript(func, inputs)
+                self.assertAllFused(ge.graph_for(*inputs))
+
+            # non-contiguous inputs are not vectorized
+            inputs = [torch.randn(8, 7, dtype=dtype).t() for _ in range(3)]
+            self.checkScript(func, inputs)
+
     @unittest.skipIf(not RUN_CUDA, "requires CUDA")
     def test_zero_element_tensors(self):
         def decode(sin_t, cos_t):
@@ -2940,6 +2940,59 @@ class TestNN(NNTestCase):
             self._test_EmbeddingBag(False, 'sum', True, test_backward=test_backward, dtype=dtype)
             self._test_EmbeddingBag(False, 'mean', True, test_backward=test_backward, dtype=dtype)
 
+    def test_embedding_bag_uneven_bags_cpu(self):
+        # Enough bags and rows for the kernels to split them among threads,
+        # with empty bags, repeated indices and a strided table.
+        N, D = 50, 37
+        lengths = torch.randint(0, 30, (600,))
+        lengths[::7] = 0
+        offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)[:-1]])
+        input = torch.randint(N, (int(lengths.sum()),))
+
+        def reference(weight, mode, scale_grad_by_freq, per_sample_weights):
+            embeddings = F.embedding(input, weight, scale_grad_by_freq=scale_grad_by_freq)
+            if per_sample_weights is not None:
+                embeddings = embeddings * per_sample_weights.unsqueeze(1)
+            bags = []
+            for offset, length in zip(offsets.tolist(), lengths.tolist()):
+                bag = embeddings.narrow(0, offset, length)
+                if length == 0:
+                    bags.append(weight.new_zeros(D))
+                elif mode == 'sum':
+                    bags.append(bag.sum(0))
+                elif mode == 'mean':
+                    bags.append(bag.mean(0))
+                else:
+                    bags.append(bag.max(0)[0])
+            return torch.stack(bags)
+
+        for dtype, mode, scale_grad_by_freq, strided, weighted in product(
+                [torch.float, torch.double], ['sum', 'mean', 'max'], [False, True], [False, True], [False, True]):
+            if (mode == 'max' and scale_grad_by_freq) or (mode != 'sum' and weighted):
+                continue
+            weight = torch.randn(N, 2 * D if strided else D, dtype=dtype)
+            weight = weight[:, :D] if strided else weight
+            weight.requires_grad_()
+            weight_ref = weight.detach().clone().requires_grad_()
+            per_sample_weights = torch.rand(input.numel(), dtype=dtype) if weighted else None
+            grad_output = torch.randn(lengths.numel(), D, dtype=dtype)
+
+            output = F.embedding_bag(input, weight, offsets, mode=mode,
+                                     scale_grad_by_freq=scale_grad_by_freq,
+                                     per_sample_weights=per_sample_weights)
+            ref_output = reference(weight_ref, mode, scale_grad_by_freq, per_sample_weights)
+            self.assertEqual(output, ref_output, dtype2prec[dtype])
+            output.backward(grad_output)
+            ref_output.backward(grad_output)
+            self.assertEqual(weight.grad, weight_ref.grad, dtype2prec[dtype] * 2)
+
+        for mode in ['sum', 'mean', 'max']:
+            weight = torch.randn(N, D)
+            output = F.embedding_bag(input, weight.half(), offsets, mode=mode)
+            self.assertEqual(output.dtype, torch.half)
+            self.assertEqual(output.float(), F.embedding_bag(input, weight.half().float(), offsets, mode=mode),
+                             dtype2prec[torch.half])
+
     def _test_embedding_bag_empty_input(self, device):
         m = 4
         n = 3
@@ -8513,6 +8566,122 @@ class TestNN(NNTestCase):
     def test_conv_noncontig_weights_and_bias_cuda(self):
         self._test_conv_noncontig_weights_and_bias(self, torch.device('cuda'))
 
+    def test_conv_cpu_direct_and_winograd(self):
+        # Without gradients, CPU convolutions take the direct (1x1 and
+        # depthwise) and Winograd kernels; compare them with the default path.
+        configs = [
+            # in_channels, out_channels, kernel_size, stride, padding, groups
+            (24, 40, 1, 1, 0, 1),
+            (5, 7, 1, 1, 0, 1),
+            (16, 16, 3, 1, 1, 16),
+            (8, 16, 5, 2, 2, 8),
+            (16, 24, 3, 1, 1, 1),
+            (32, 16, 3, 1, 0, 1),
+        ]
+        with torch.backends.mkldnn.flags(enabled=False):
+            for dtype in [torch.float, torch.double]:
+                for cin, cout, k, s, p, g in configs:
+                    for bias in [True, False]:
+                        conv = nn.Conv2d(cin, cout, k, stride=s, padding=p, groups=g, bias=bias).to(dtype)
+                        x = torch.randn(2, cin, 13, 11, dtype=dtype)
+                        expected = conv(x)
+                        with torch.no_grad():
+                            actual = conv(x)
+                        prec = 1e-4 if dtype == torch.float else 1e-10
+                        self.assertEqual(actual, expected, prec=prec)
+
+        x = torch.randn(1, 16, 8, 8)
+        w = torch.randn(16, 16, 3, 3)
+        self.assertEqual(torch._conv2d_winograd(x, w, None, [1, 1]),
+                         F.conv2d(x, w, padding=1), prec=1e-4)
+        self.assertEqual(torch._conv2d_direct(x, w[:, :1], None, [1, 1], [1, 1], 16),
+                         F.conv2d(x, w[:, :1], padding=1, groups=16), prec=1e-4)
+
+    def test_channels_last_cpu_ops(self):
+        def check(fn, x):
+            x_cl = x.detach().contiguous(memory_format=torch.channels_last).requires_grad_()
+            x = x.detach().requires_grad_()
+            out, out_cl = fn(x), fn(x_cl)
+            self.assertTrue(out_cl.is_contiguous(memory_format=torch.channels_last))
+            self.assertEqual(out_cl, out, prec=1e-5)
+            grad = torch.randn_like(out)
+            out.backward(grad)
+            out_cl.backward(grad)
+            self.assertEqual(x_cl.grad, x.grad, prec=1e-5)
+
+        x = torch.randn(2, 19, 9, 11, dtype=torch.double)
+        check(lambda t: F.max_pool2d(t, 3, stride=2, padding=1), x)
+        check(lambda t: F.avg_pool2d(t, 3, stride=2, padding=1), x)
+        check(lambda t: F.avg_pool2d(t, 2, ceil_mode=True, count_include_pad=False), x)
+        check(lambda t: F.interpolate(t, scale_factor=2, mode='bilinear', align_corners=False), x)
+        w1, w3 = torch.randn(7, 19, 1, 1, dtype=torch.double), torch.randn(5, 19, 3, 3, dtype=torch.double)
+        w_rect, b_rect = torch.randn(5, 19, 3, 2, dtype=torch.double), torch.randn(5, dtype=torch.double)
+        w_group, b_group = torch.randn(6, 6, 3, 3, dtype=torch.double), torch.randn(6, dtype=torch.double)
+        check(lambda t: F.conv2d(t, w1), x)
+        check(lambda t: F.conv2d(t, w3, padding=1), x)
+        check(lambda t: F.conv2d(t, w_rect, b_rect, stride=(2, 1), padding=(1, 2), dilation=(1, 2)), x)
+        check(lambda t: F.conv2d(t[:, :18], w_group, b_group, padding=1, groups=3), x)
+        for training in [True, False]:
+            bn = nn.BatchNorm2d(19).double()
+            bn.weight.data.uniform_()
+            bn.bias.data.uniform_()
+            bn.train(training)
+            check(bn, x)
+
+    def test_channels_last_resnet_forward(self):
+        # Every layer of a ResNet forward keeps a channels last input in that
+        # format, so the model never converts back to NCHW.
+        class Block(nn.Module):
+            def __init__(self, planes):
+                super(Block, self).__init__()
+                self.conv1 = nn.Conv2d(planes, planes, 3, padding=1, bias=False)
+                self.bn1 = nn.BatchNorm2d(planes)
+                self.conv2 = nn.Conv2d(planes, planes, 3, padding=1, bias=False)
+                self.bn2 = nn.BatchNorm2d(planes)
+
+            def forward(self, x):
+                out = F.relu(self.bn1(self.conv1(x)))
+                return F.relu(self.bn2(self.conv2(out)) + x)
+
+        layers = [
+            nn.Conv2d(3, 16, 7, stride=2, padding=3, bias=False),
+            nn.BatchNorm2d(16),
+            nn.ReLU(),
+            nn.MaxPool2d(3, stride=2, padding=1),
+            Block(16),
+            nn.Conv2d(16, 32, 1, bias=False),
+            nn.BatchNorm2d(32),
+            Block(32),
+            nn.AvgPool2d(4),
+        ]
+        model = nn.Sequential(*layers).eval()
+        x = torch.randn(2, 3, 32, 32)
+        with torch.no_grad():
+            out, out_cl = x, x.contiguous(memory_format=torch.channels_last)
+            for layer in layers:
+                out, out_cl = layer(out), layer(out_cl)
+                self.assertTrue(out_cl.is_contiguous(memory_format=torch.channels_last))
+                self.assertEqual(out_cl, out, prec=1e-4)
+            self.assertEqual(model(x.contiguous(memory_format=torch.channels_last)), out, prec=1e-4)
+
+        # The convolutions run on the NHWC data, and never make an NCHW copy
+        # of their input.
+        calls = []
+        hooks = [m.register_forward_hook(lambda m, i, o: calls.append((m, i[0])))
+                 for m in model.modules() if isinstance(m, nn.Conv2d)]
+        with torch.no_grad():
+            model(x.contiguous(memory_format=torch.channels_last))
+        for hook in hooks:
+            hook.remove()
+        self.assertEqual(len(calls), 6)
+        for conv, conv_input in calls:
+            with torch.no_grad(), torch.autograd.profiler.profile() as prof:
+                conv(conv_input)
+            names = [event.name for event in prof.function_events]
+            self.assertIn('_conv2d_channels_last', names)
+            for name in ['contiguous', 'thnn_conv2d', 'mkldnn_convolution', '_convolution_nogroup']:
+                self.assertNotIn(name, names)
+
     def run_conv_double_back_test(self, kern, stride, padding, chan_in, chan_out, batch_size,
                                   inp_size, dilation, no_weight, groups=1, use_cuda=False,
                                   use_bias=True, dtype=torch.double):
@@ -843,6 +843,52 @@ class TestQuantizedOps(TestCase):
         self.assertEqual(qX.equal(qX), equal_ref(qX, qX))
         self.assertEqual(qX.equal(qX2), equal_ref(qX, qX2))
 
+    """Tests the row-wise quantized embedding table packing and lookup."""
+    @given(num_embeddings=st.integers(1, 100),
+           embedding_dim=st.sampled_from([2, 10, 16, 64, 130]),
+           bit_rate=st.sampled_from([8, 4]),
+           mode=st.sampled_from([0, 1]),
+           weighted=st.booleans())
+    def test_embedding_bag_rowwise(self, num_embeddings, embedding_dim, bit_rate, mode, weighted):
+        if bit_rate == 8:
+            prepack = torch.ops.quantized.embedding_bag_byte_prepack
+            unpack = torch.ops.quantized.embedding_bag_byte_unpack
+            embedding_bag = torch.ops.quantized.embedding_bag_byte
+            scale_bias_bytes = 8
+        else:
+            prepack = torch.ops.quantized.embedding_bag_4bit_prepack
+            unpack = torch.ops.quantized.embedding_bag_4bit_unpack
+            embedding_bag = torch.ops.quantized.embedding_bag_4bit
+            scale_bias_bytes = 4
+        weight = torch.randn(num_embeddings, embedding_dim)
+        packed = prepack(weight)
+        self.assertEqual(packed.dtype, torch.uint8)
+        self.assertEqual(packed.size(1), embedding_dim * bit_rate // 8 + scale_bias_bytes)
+
+        # Every value is within half a quantization step of its row, plus the
+        # rounding of the 4-bit scale and bias to half.
+        dequantized = unpack(packed)
+        row_range = weight.max(1, keepdim=True)[0] - weight.min(1, keepdim=True)[0]
+        step = row_range / (2 ** bit_rate - 1)
+        rounding = 1e-2 * weight.abs().max(1, keepdim=True)[0] + 1e-6
+        self.assertTrue(((dequantized - weight).abs() <= step / 2 + rounding).all())
+
+        lengths = torch.randint(0, 5, (20,))
+        offsets = torch.cat([torch.zeros(1, dtype=torch.long), lengths.cumsum(0)[:-1]])
+        indices = torch.randint(num_embeddings, (int(lengths.sum()),))
+        per_sample_weights = torch.rand(indices.numel()) if weighted and mode == 0 else None
+        output = embedding_bag(packed, indices, offsets, mode=mode,
+                               per_sample_weights=per_sample_weights)
+        ref = F.embedding_bag(indices, dequantized, offsets, mode=['sum', 'mean'][mode],
+                              per_sample_weights=per_sample_weights)
+        torch.testing.assert_allclose(output, ref)
+
+        # Offsets that start at 0 but then go negative, decrease or run past
+        # the indices are rejected by the kernel.
+        for bad_offsets in ([0, -1], [0, 3, 2], [0, indices.numel() + 1]):
+            with self.assertRaisesRegex(RuntimeError, "offsets must be non-negative"):
+                embedding_bag(packed, indices, torch.tensor(bad_offsets), mode=mode)
+
 
 @unittest.skipIf(
     not torch.fbgemm_is_cpu_supported(),
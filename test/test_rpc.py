@@ -214,6 +214,49 @@ class RpcTest(MultiProcessTestCase):
         )
         self.assertEqual(fut.wait(), torch.ones(n, n) * 2)
 
+    @_wrap_with_rpc
+    def test_add_tensor_args(self):
+        n = self.rank + 1
+        dst_rank = n % self.world_size
+        # large, non-contiguous, empty and integer tensors
+        x = torch.rand(512, 1024)
+        ret = dist.rpc(
+            "worker{}".format(dst_rank), torch.add, args=(x, x.t().t())
+        )
+        self.assertEqual(ret, x * 2)
+        ret = dist.rpc(
+            "worker{}".format(dst_rank), torch.add, args=(x.t(), x.t())
+        )
+        self.assertEqual(ret, x.t() * 2)
+        ret = dist.rpc(
+            "worker{}".format(dst_rank),
+            torch.add,
+            args=(torch.ones(0, n), torch.ones(0, n)),
+        )
+        self.assertEqual(ret.size(), torch.Size([0, n]))
+        ret = dist.rpc(
+            "worker{}".format(dst_rank),
+            torch.add,
+            args=(torch.arange(n), torch.arange(n)),
+        )
+        self.assertEqual(ret, torch.arange(n) * 2)
+
+    @_wrap_with_rpc
+    def test_shared_storage(self):
+        n = self.rank + 1
+        dst_rank = n % self.world_size
+        # the chunks are views of one storage, and arrive as such
+        x = torch.arange(6.0).view(3, 2)
+        ret = dist.rpc(
+            "worker{}".format(dst_rank), torch.split, args=(x.t(), 1, 0)
+        )
+        self.assertEqual(len(ret), 2)
+        self.assertEqual(ret[0], x.t()[0:1])
+        self.assertEqual(ret[1], x.t()[1:2])
+        self.assertEqual(ret[0].stride(), x.t().stride())
+        self.assertEqual(ret[1].storage_offset(), 1)
+        self.assertEqual(ret[0].storage().data_ptr(), ret[1].storage().data_ptr())
+
     @_wrap_with_rpc
     def test_nonzero(self):
         n = self.rank + 1
@@ -896,6 +896,23 @@ class TestSparse(TestCase):
         test_shape(10, 100, 0, 0)
         test_shape(10, 100, 0, 20)
 
+    def test_mv(self):
+        def test_shape(di, dj, nnz):
+            x, _, _ = self._gen_sparse(2, nnz, [di, dj])
+            y = torch.randn(dj, device=self.device, requires_grad=True)
+
+            res = torch.mv(x, y)
+            expected = torch.mv(self.safeToDense(x), y)
+            self.assertEqual(res, expected)
+
+            grad = torch.randn(di, device=self.device)
+            res.backward(grad)
+            self.assertEqual(y.grad, self.safeToDense(x).t().mv(grad))
+
+        test_shape(10, 100, 20)
+        test_shape(1000, 100, 5000)
+        test_shape(10, 100, 0)
+
     @cpu_only
     def test_saddmm(self):
         def test_shape(di, dj, dk, nnz):
@@ -1259,6 +1276,29 @@ class TestSparse(TestCase):
         expected = self.safeToDense(x) + self.safeToDense(x)
         self.assertEqual(self.safeToDense(y), expected)
 
+    def test_coalesce_add_large(self):
+        # enough entries that coalesce and add split their work into chunks,
+        # with many duplicates across chunk boundaries
+        def test_shape(nnz, shape_i, shape_v=None):
+            shape = shape_i + (shape_v or [])
+            x1, _, _ = self._gen_sparse(len(shape_i), nnz, shape)
+            x2, _, _ = self._gen_sparse(len(shape_i), nnz, shape)
+            x1_coalesced = x1.coalesce()
+            self.assertTrue(x1_coalesced.is_coalesced())
+            self.assertEqual(self.safeToDense(x1_coalesced), self.safeToDense(x1))
+            flat = x1_coalesced._indices()[0]
+            for d in range(1, len(shape_i)):
+                flat = flat * shape_i[d] + x1_coalesced._indices()[d]
+            self.assertTrue((flat[1:] > flat[:-1]).all())
+
+            y = x1.coalesce() + x2.coalesce()
+            self.assertTrue(y.is_coalesced())
+            self.assertEqual(self.safeToDense(y), self.safeToDense(x1) + self.safeToDense(x2))
+
+        test_shape(200000, [100, 100])
+        test_shape(200000, [4, 1000, 100])
+        test_shape(100000, [300, 200], [2])
+
     def _test_sparse_mask_shape(self, nnz_x1, nnz_x2, shape_i, shape_v=None):
         shape = shape_i + (shape_v or [])
         x1, _, _ = self._gen_sparse(len(shape_i), nnz_x1, shape)
@@ -2125,5 +2165,115 @@ class TestSparseOneOff(TestCase):
             x + sparse_y
 
 
+
+class TestSparseCsr(TestCase):
+    def _gen_sparse_csr(self, di, dj, nnz):
+        i = torch.stack([torch.randint(di, (nnz,)), torch.randint(dj, (nnz,))])
+        v = torch.randn(nnz, dtype=torch.double)
+        x = torch.sparse_coo_tensor(i, v, (di, dj)).coalesce()
+        return x.to_sparse_csr(), x.to_dense()
+
+    def test_construction(self):
+        crow_indices = torch.tensor([0, 2, 2, 3])
+        col_indices = torch.tensor([0, 3, 1])
+        values = torch.tensor([1., 2., 3.])
+        x = torch.sparse_csr_tensor(crow_indices, col_indices, values, (3, 4))
+        self.assertEqual(x.layout, torch.sparse_csr)
+        self.assertTrue(x.is_sparse_csr)
+        self.assertFalse(x.is_sparse)
+        self.assertEqual(x.shape, torch.Size([3, 4]))
+        self.assertEqual(x._nnz(), 3)
+        self.assertEqual(x.crow_indices(), crow_indices)
+        self.assertEqual(x.col_indices(), col_indices)
+        self.assertEqual(x.values(), values)
+        self.assertEqual(x.to_dense(), torch.tensor([[1., 0., 0., 2.],
+                                                     [0., 0., 0., 0.],
+                                                     [0., 3., 0., 0.]]))
+        self.assertIn('layout=torch.sparse_csr', str(x))
+
+        x = torch.sparse_csr_tensor(torch.zeros(3, dtype=torch.long), torch.empty(0, dtype=torch.long),
+                                    torch.empty(0), (2, 5))
+        self.assertEqual(x._nnz(), 0)
+        self.assertEqual(x.to_dense(), torch.zeros(2, 5))
+
+    def test_construction_invalid(self):
+        values = torch.tensor([1., 2., 3.])
+        with self.assertRaisesRegex(RuntimeError, "crow_indices must have size"):
+            torch.sparse_csr_tensor(torch.tensor([0, 3]), torch.tensor([0, 1, 2]), values, (2, 3))
+        with self.assertRaisesRegex(RuntimeError, "crow_indices must start at 0"):
+            torch.sparse_csr_tensor(torch.tensor([1, 2, 3]), torch.tensor([0, 1, 2]), values, (2, 3))
+        with self.assertRaisesRegex(RuntimeError, "crow_indices must end at nnz"):
+            torch.sparse_csr_tensor(torch.tensor([0, 1, 2]), torch.tensor([0, 1, 2]), values, (2, 3))
+        with self.assertRaisesRegex(RuntimeError, "crow_indices must be non-decreasing"):
+            torch.sparse_csr_tensor(torch.tensor([0, 2, 1, 3]), torch.tensor([0, 1, 2]), values, (3, 3))
+        with self.assertRaisesRegex(RuntimeError, "found column index 3"):
+            torch.sparse_csr_tensor(torch.tensor([0, 2, 3]), torch.tensor([0, 3, 2]), values, (2, 3))
+
+    def test_conversions(self):
+        for di, dj, nnz in [(10, 20, 30), (1, 7, 3), (8, 1, 5), (5, 5, 0)]:
+            x, dense = self._gen_sparse_csr(di, dj, nnz)
+            self.assertEqual(x.to_dense(), dense)
+            self.assertEqual(dense.to_sparse_csr().to_dense(), dense)
+            self.assertEqual(x.to_sparse().to_dense(), dense)
+            self.assertEqual(x.to_sparse().coalesce().to_sparse_csr().crow_indices(), x.crow_indices())
+            self.assertEqual(x.t().to_dense(), dense.t())
+            # crow_indices counts the entries of the rows before each row
+            counts = (dense != 0).long().sum(1)
+            self.assertEqual(x.crow_indices(), torch.cat([torch.zeros(1, dtype=torch.long), counts.cumsum(0)]))
+
+    def test_addmm(self):
+        for di, dj, dk, nnz in [(10, 20, 30, 50), (100, 50, 7, 1000), (10, 20, 30, 0)]:
+            x, dense = self._gen_sparse_csr(di, dj, nnz)
+            t = torch.randn(di, dk, dtype=torch.double)
+            y = torch.randn(dj, dk, dtype=torch.double)
+            alpha = random.random()
+            beta = random.random()
+
+            self.assertEqual(torch.addmm(t, x, y, beta=beta, alpha=alpha),
+                             torch.addmm(t, dense, y, beta=beta, alpha=alpha))
+            # self is broadcast to the size of the result
+            bias = torch.randn(dk, dtype=torch.double)
+            self.assertEqual(torch.addmm(bias, x, y), torch.addmm(bias, dense, y))
+            out = torch.empty(0, dtype=torch.double)
+            torch.addmm(t, x, y, beta=beta, alpha=alpha, out=out)
+            self.assertEqual(out, torch.addmm(t, dense, y, beta=beta, alpha=alpha))
+            expected = torch.addmm(t, dense, y, beta=beta, alpha=alpha)
+            t.addmm_(x, y, beta=beta, alpha=alpha)
+            self.assertEqual(t, expected)
+
+            self.assertEqual(torch.mm(x, y), torch.mm(dense, y))
+            # non-contiguous dense operand
+            y_t = torch.randn(dk, dj, dtype=torch.double).t()
+            self.assertEqual(torch.mm(x, y_t), torch.mm(dense, y_t))
+
+            v = torch.randn(dj, dtype=torch.double)
+            self.assertEqual(torch.mv(x, v), torch.mv(dense, v))
+
+    def test_mm_mv_backward(self):
+        x, dense = self._gen_sparse_csr(30, 20, 60)
+
+        y = torch.randn(20, 10, dtype=torch.double, requires_grad=True)
+        grad = torch.randn(30, 10, dtype=torch.double)
+        torch.mm(x, y).backward(grad)
+        self.assertEqual(y.grad, dense.t().mm(grad))
+
+        # column-major dense operand
+        y_t = torch.randn(10, 20, dtype=torch.double, requires_grad=True)
+        torch.mm(x, y_t.t()).backward(grad)
+        self.assertEqual(y_t.grad, dense.t().mm(grad).t())
+
+        v = torch.randn(20, dtype=torch.double, requires_grad=True)
+        grad = torch.randn(30, dtype=torch.double)
+        torch.mv(x, v).backward(grad)
+        self.assertEqual(v.grad, dense.t().mv(grad))
+
+        self.assertTrue(gradcheck(lambda y: torch.mm(x, y), (torch.randn(20, 3, dtype=torch.double, requires_grad=True),)))
+
+    def test_mm_sparse_csr_second_argument(self):
+        x, _ = self._gen_sparse_csr(5, 5, 10)
+        with self.assertRaisesRegex(RuntimeError, "expected 'mat1' to be a sparse CSR tensor"):
+            torch.mm(torch.randn(5, 5, dtype=torch.double), x)
+
+
 if __name__ == '__main__':
     run_tests()
@@ -1604,6 +1604,24 @@ class _TestTorchMixin(object):
             lambda n, d: logsumexp(n, d),
             use_integral=False)
 
+    def test_sum_strided_layouts(self):
+        # Reductions over non-adjacent dims, the middle dims of channels last
+        # tensors and into few outputs, which take the reordered, blocked and
+        # two-pass paths, against a double precision reference.
+        x = torch.randn(8, 3, 70, 90)
+        ref = x.double()
+        x_cl = x.contiguous(memory_format=torch.channels_last)
+        for dims in [(0, 2), (0, 3), (1, 3), (0, 2, 3), (1, 2), (2,), (1,), ()]:
+            expected = ref.sum(dims) if dims else ref.sum()
+            for t in [x, x_cl,
+                      x.transpose(0, 2).contiguous().transpose(0, 2),
+                      x.permute(2, 3, 0, 1).contiguous().permute(2, 3, 0, 1)]:
+                actual = t.sum(dims) if dims else t.sum()
+                self.assertEqual(actual.double(), expected, prec=1e-2)
+        self.assertEqual(x_cl.sum((0, 2, 3), keepdim=True).double(), ref.sum((0, 2, 3), keepdim=True), prec=1e-2)
+        y = (1 + x / 1000).contiguous(memory_format=torch.channels_last)
+        self.assertEqual(y.prod((0, 2, 3)).double(), y.double().prod((0, 2, 3)), prec=1e-2)
+
     def test_sum_out(self):
         x = torch.rand(100, 100)
         res1 = torch.sum(x, 1)
@@ -2761,6 +2779,46 @@ class _TestTorchMixin(object):
         self.assertIsOrdered('descending', x, res2val, res2ind,
                              'random with NaNs')
 
+    def test_sort_large(self):
+        # long enough to be sorted in parallel chunks
+        n = 200000
+        for dtype in (torch.uint8, torch.int8, torch.int16, torch.int32, torch.int64,
+                      torch.float, torch.double):
+            if dtype.is_floating_point:
+                x = torch.randn(n, dtype=dtype)
+                x[::1000] = float('NaN')
+                x[1::1000] = -0.0
+            else:
+                x = torch.randint(-100 if dtype != torch.uint8 else 0, 100, (n,), dtype=dtype)
+            for descending in (False, True):
+                values, indices = x.sort(descending=descending)
+                self.assertEqual(values, x[indices])
+                self.assertEqual(indices.sort()[0], torch.arange(n))
+                # NaNs are the largest elements
+                nan = values != values
+                num_nan = int(nan.sum())
+                if descending:
+                    self.assertTrue(nan[:num_nan].all())
+                    self.assertTrue((values[num_nan + 1:] <= values[num_nan:-1]).all())
+                else:
+                    self.assertTrue(nan[n - num_nan:].all())
+                    self.assertTrue((values[1:n - num_nan] >= values[:n - num_nan - 1]).all())
+                # the sort is stable
+                equal = values[1:] == values[:-1]
+                self.assertTrue((indices[1:][equal] > indices[:-1][equal]).all())
+
+            # sorting many slices, and a few long ones
+            y = x.view(100, -1)
+            self.assertEqual(y.sort(1)[0], torch.stack([row.sort()[0] for row in y]))
+            self.assertEqual(y.sort(0)[0], y.t().sort(1)[0].t())
+
+            if not dtype.is_floating_point:
+                self.assertEqual(x.unique(), x.sort()[0].unique_consecutive())
+                output, inverse, counts = x.unique(return_inverse=True, return_counts=True)
+                self.assertEqual(output[inverse], x)
+                self.assertEqual(counts.sum(), n)
+                self.assertEqual(x.topk(n // 2)[0], x.sort(descending=True)[0][:n // 2])
+
     def test_topk(self):
         def topKViaSort(t, k, dim, dir):
             sorted, indices = t.sort(dim, dir)
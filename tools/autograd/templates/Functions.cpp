@@ -505,7 +505,7 @@ Tensor clamp_backward(const Tensor & grad, const Tensor &self, const optional<Sc
 
 Tensor mm_mat1_backward(const Tensor & grad, const Tensor & mat2, const Tensor & mat1, const Scalar & alpha) {
   // if input was column-major, return grad as column-order for efficiency
-  if (mat1.is_sparse()) {
+  if (mat1.is_sparse() || mat1.is_sparse_csr()) {
     throw std::runtime_error("calculating the gradient of a sparse Tensor argument to mm is not supported.");
   }
   at::IntArrayRef sizes = mat1.sizes();
@@ -519,6 +519,11 @@ Tensor mm_mat1_backward(const Tensor & grad, const Tensor & mat2, const Tensor &
 
 Tensor mm_mat2_backward(const Tensor & grad, const Tensor & mat1, IntArrayRef sizes, IntArrayRef strides, const Scalar & alpha) {
   // if input was column-major, return grad as column-order for efficiency
+  if (mat1.is_sparse_csr()) {
+    // The transpose of a CSR matrix is again CSR, and the only product a
+    // CSR operand supports is mm(CSR, dense).
+    return maybe_multiply(mat1.t().mm(grad), alpha);
+  }
   if (strides[0] == 1 && strides[1] == sizes[0]) {
     if (mat1.is_sparse()) {
       // Since mm(dense, sparse) doesn't exist,
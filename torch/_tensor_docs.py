@@ -610,6 +610,17 @@ type as :attr:`self`.
     propagating to the cloned tensor will propagate to the original tensor.
 """)
 
+add_docstr_all('col_indices',
+               r"""
+col_indices() -> Tensor
+
+If :attr:`self` is a sparse CSR tensor (i.e., with ``torch.sparse_csr`` layout),
+this returns a view of the contained column indices tensor, holding the column
+of every stored value. Otherwise, this throws an error.
+
+See also :meth:`Tensor.crow_indices` and :meth:`Tensor.values`.
+""")
+
 add_docstr_all('contiguous',
                r"""
 contiguous() -> Tensor
@@ -682,6 +693,19 @@ cross(other, dim=-1) -> Tensor
 See :func:`torch.cross`
 """)
 
+add_docstr_all('crow_indices',
+               r"""
+crow_indices() -> Tensor
+
+If :attr:`self` is a sparse CSR tensor (i.e., with ``torch.sparse_csr`` layout),
+this returns a view of the contained compressed row indices tensor, of size
+``self.size(0) + 1``. The values of row ``i`` are stored at positions
+``crow_indices[i]`` to ``crow_indices[i + 1] - 1`` of :meth:`Tensor.col_indices`
+and :meth:`Tensor.values`. Otherwise, this throws an error.
+
+See also :meth:`Tensor.col_indices` and :meth:`Tensor.values`.
+""")
+
 add_docstr_all('cuda',
                r"""
 cuda(device=None, non_blocking=False) -> Tensor
@@ -1129,15 +1153,15 @@ add_docstr_all('values',
                r"""
 values() -> Tensor
 
-If :attr:`self` is a sparse COO tensor (i.e., with ``torch.sparse_coo`` layout),
-this returns a view of the contained values tensor. Otherwise, this throws an
-error.
+If :attr:`self` is a sparse COO tensor (i.e., with ``torch.sparse_coo`` layout)
+or a sparse CSR tensor (i.e., with ``torch.sparse_csr`` layout), this returns a
+view of the contained values tensor. Otherwise, this throws an error.
 
 See also :meth:`Tensor.indices`.
 
 .. note::
-  This method can only be called on a coalesced sparse tensor. See
-  :meth:`Tensor.coalesce` for details.
+  For a sparse COO tensor, this method can only be called on a coalesced
+  sparse tensor. See :meth:`Tensor.coalesce` for details.
 """)
 
 add_docstr_all('gt',
@@ -2796,6 +2820,22 @@ Example::
            size=(3, 3), nnz=1, layout=torch.sparse_coo)
 """)
 
+add_docstr_all('to_sparse_csr',
+               r"""
+to_sparse_csr() -> Tensor
+Returns a copy of the 2-D tensor in compressed sparse row (CSR) layout.
+:attr:`self` can be a strided CPU tensor or a sparse COO CPU tensor.
+
+Example::
+
+    >>> d = torch.tensor([[0, 0, 0], [9, 0, 10], [0, 0, 0]])
+    >>> d.to_sparse_csr()
+    tensor(crow_indices=tensor([0, 0, 2, 2]),
+           col_indices=tensor([0, 2]),
+           values=tensor([ 9, 10]),
+           size=(3, 3), nnz=2, layout=torch.sparse_csr)
+""")
+
 add_docstr_all('to_mkldnn',
                r"""
 to_mkldnn() -> Tensor
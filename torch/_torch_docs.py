@@ -4769,6 +4769,40 @@ Example::
 .. _torch.sparse: https://pytorch.org/docs/stable/sparse.html
 """.format(**factory_common_args))
 
+add_docstr(torch.sparse_csr_tensor,
+           r"""
+sparse_csr_tensor(crow_indices, col_indices, values, size, dtype=None, layout=None, device=None, pin_memory=False, requires_grad=False) -> Tensor
+
+Constructs a 2-D sparse tensor in CSR (compressed sparse row) format. The
+values of row ``i`` are ``values[crow_indices[i]:crow_indices[i + 1]]``, and
+their columns are ``col_indices[crow_indices[i]:crow_indices[i + 1]]``. Only
+CPU tensors are supported.
+
+Args:
+    crow_indices (Tensor): 1-D int64 tensor of size ``size[0] + 1``. It must
+        start at 0, end at the number of values and be non-decreasing.
+    col_indices (Tensor): 1-D int64 tensor with the column of every value.
+    values (Tensor): 1-D tensor with the stored values.
+    size (list, tuple, or :class:`torch.Size`): size of the sparse matrix.
+    dtype (:class:`torch.dtype`, optional): the desired data type of returned tensor.
+        Default: if None, infers data type from :attr:`values`.
+    layout (:class:`torch.layout`, optional): must be ``torch.sparse_csr`` if given.
+    {device}
+    {pin_memory}
+    {requires_grad}
+
+Example::
+
+    >>> crow_indices = torch.tensor([0, 2, 3])
+    >>> col_indices = torch.tensor([0, 2, 1])
+    >>> values = torch.tensor([1., 2., 3.])
+    >>> torch.sparse_csr_tensor(crow_indices, col_indices, values, (2, 3))
+    tensor(crow_indices=tensor([0, 2, 3]),
+           col_indices=tensor([0, 2, 1]),
+           values=tensor([1., 2., 3.]),
+           size=(2, 3), nnz=3, layout=torch.sparse_csr)
+""".format(**factory_common_args))
+
 add_docstr(torch.sqrt,
            r"""
 sqrt(input, out=None) -> Tensor
@@ -6991,6 +7025,42 @@ Example::
 """)
 
 
+add_docstr(torch._C.Generator.set_philox_mode,
+           r"""
+Generator.set_philox_mode(enabled) -> Generator
+
+Switches a CPU generator to (or back from) a counter-based Philox engine
+for :meth:`~Tensor.uniform_`, :meth:`~Tensor.normal_` and
+:meth:`~Tensor.bernoulli_` with a scalar probability (and thus dropout).
+
+In Philox mode these fills run in parallel, and their results only depend on
+the seed and on how many numbers the generator produced before, not on the
+number of threads. The numbers differ from the ones produced without Philox
+mode. Other random ops are not affected.
+
+Arguments:
+    enabled (bool): Whether to use the Philox engine.
+
+Returns:
+    Generator: An torch.Generator object.
+
+Example::
+
+    >>> g_cpu = torch.Generator()
+    >>> g_cpu.manual_seed(2147483647).set_philox_mode(True)
+    >>> torch.empty(3).uniform_(generator=g_cpu)
+""")
+
+
+add_docstr(torch._C.Generator.philox_mode,
+           r"""
+Generator.philox_mode() -> bool
+
+Returns whether a CPU generator uses the Philox engine. See
+:meth:`~Generator.set_philox_mode`.
+""")
+
+
 add_docstr(torch._C.Generator.device,
            r"""
 Generator.device -> device
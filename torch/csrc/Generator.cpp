@@ -151,6 +151,33 @@ static PyObject * THPGenerator_initialSeed(THPGenerator *self, PyObject *noargs)
   END_HANDLE_TH_ERRORS
 }
 
+static PyObject * THPGenerator_setPhiloxMode(THPGenerator *self, PyObject *enabled)
+{
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyBool_Check(enabled), "set_philox_mode expected a bool, "
+          "but got %s", THPUtils_typename(enabled));
+  TORCH_CHECK(self->cdata->device().type() == at::kCPU,
+              "Philox mode is only supported by CPU generators");
+  auto generator = at::check_generator<CPUGenerator>(self->cdata);
+  generator->set_philox_mode(enabled == Py_True);
+  Py_INCREF(self);
+  return (PyObject*)self;
+  END_HANDLE_TH_ERRORS
+}
+
+static PyObject * THPGenerator_philoxMode(THPGenerator *self, PyObject *noargs)
+{
+  HANDLE_TH_ERRORS
+  TORCH_CHECK(self->cdata->device().type() == at::kCPU,
+              "Philox mode is only supported by CPU generators");
+  auto generator = at::check_generator<CPUGenerator>(self->cdata);
+  if (generator->philox_mode()) {
+    Py_RETURN_TRUE;
+  }
+  Py_RETURN_FALSE;
+  END_HANDLE_TH_ERRORS
+}
+
 static PyObject * THPGenerator_get_device(THPGenerator *self, void *unused) {
   HANDLE_TH_ERRORS
   return THPDevice_New(self->cdata->device());
@@ -168,6 +195,8 @@ static PyMethodDef THPGenerator_methods[] = {
   {"manual_seed",     (PyCFunction)THPGenerator_manualSeed,     METH_O,       nullptr},
   {"seed",            (PyCFunction)THPGenerator_seed,           METH_NOARGS,  nullptr},
   {"initial_seed",    (PyCFunction)THPGenerator_initialSeed,    METH_NOARGS,  nullptr},
+  {"set_philox_mode", (PyCFunction)THPGenerator_setPhiloxMode,  METH_O,       nullptr},
+  {"philox_mode",     (PyCFunction)THPGenerator_philoxMode,     METH_NOARGS,  nullptr},
   {nullptr}
 };
 
@@ -53,6 +53,14 @@ class TORCH_API OptimizerBase {
   /// Returns the number of parameters referenced by the optimizer.
   size_t size() const noexcept;
 
+  /// Moves the parameters, their gradients and the optimizer state created
+  /// from then on into one contiguous buffer each. The parameters (which must
+  /// share their type and device) become views into their buffer, and on CPU
+  /// `step()` then updates all of them in a single pass over each buffer.
+  /// Every parameter has a (zero-initialized) gradient from then on. A
+  /// parameter that is listed more than once is only moved once.
+  void flatten_parameters();
+
   /// Serializes the optimizer state into the given `archive`.
   virtual void save(serialize::OutputArchive& archive) const;
 
@@ -79,8 +87,35 @@ class TORCH_API OptimizerBase {
   /// Additionally, zeros out the buffers when this is called on the index
   Tensor& buffer_at(std::vector<Tensor>& buffers, size_t index);
 
+  /// Returns the indices of the parameters, skipping repeated entries of tied
+  /// parameters, so that `step()` updates each of them once.
+  std::vector<size_t> unique_parameter_indices() const;
+
+  /// Collects the parameters that have a gradient, their indices and their
+  /// gradients for the fused CPU kernels of `step()`, skipping repeated
+  /// entries of tied parameters. Returns false if some of
+  /// these parameters are not dense, contiguous CPU tensors of one floating
+  /// point type, in which case `step()` updates the parameters one by one.
+  bool fused_parameters(
+      std::vector<size_t>& indices,
+      std::vector<Tensor>& parameters,
+      std::vector<Tensor>& gradients);
+
+  /// Replaces every list of tensors by a single tensor over the buffer they
+  /// lie in, if the tensors of each list are back to back in one buffer, as
+  /// they are after `flatten_parameters()`. Leaves the lists unchanged
+  /// otherwise.
+  static void coalesce(std::vector<std::vector<Tensor>*> lists);
+
+  /// Bumps the version counters of tensors a fused kernel updated in place.
+  static void bump_versions(const std::vector<Tensor>& tensors);
+
   /// The parameters this optimizer optimizes.
   std::vector<Tensor> parameters_;
+
+  /// Whether `flatten_parameters()` was called, so that `buffer_at` creates
+  /// new state in one contiguous buffer.
+  bool flat_{false};
 };
 
 /// Serializes an `OptimizerBase` into an `OutputArchive`.
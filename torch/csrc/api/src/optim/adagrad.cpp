@@ -5,7 +5,9 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/native/FusedOptimizers.h>
 
+#include <algorithm>
 #include <functional>
 
 namespace torch {
@@ -17,7 +19,31 @@ AdagradOptions::AdagradOptions(double learning_rate)
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/adagrad.py
 void Adagrad::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
+  std::vector<size_t> indices;
+  std::vector<Tensor> params, grads;
+  if (fused_parameters(indices, params, grads)) {
+    std::vector<Tensor> sums;
+    std::vector<double> learning_rates;
+    for (auto i : indices) {
+      sums.push_back(buffer_at(sum_buffers, i));
+      const auto step = ++buffer_at(step_buffers, i);
+      learning_rates.push_back(
+          options.learning_rate() / (1.0 + (step - 1.0) * options.lr_decay()));
+    }
+    bump_versions(params);
+    bump_versions(sums);
+    // Flattened state is updated in one piece if all steps agree.
+    if (!learning_rates.empty() &&
+        std::equal(learning_rates.begin() + 1, learning_rates.end(), learning_rates.begin())) {
+      coalesce({&params, &grads, &sums});
+      learning_rates.resize(params.size());
+    }
+    at::native::fused_adagrad_step_(
+        params, grads, sums, learning_rates, options.weight_decay());
+    return;
+  }
+
+  for (auto i : unique_parameter_indices()) {
     Tensor p = parameters_.at(i);
     if (!p.grad().defined()) {
       continue;
@@ -6,7 +6,9 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/native/FusedOptimizers.h>
 
+#include <algorithm>
 #include <cmath>
 #include <functional>
 
@@ -16,7 +18,49 @@ AdamOptions::AdamOptions(double learning_rate)
     : learning_rate_(learning_rate) {}
 
 void Adam::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
+  std::vector<size_t> indices;
+  std::vector<Tensor> params, grads;
+  if (fused_parameters(indices, params, grads)) {
+    std::vector<Tensor> exp_averages, exp_average_sqs, max_exp_average_sqs;
+    std::vector<double> step_sizes, bias_corrections2;
+    for (auto i : indices) {
+      exp_averages.push_back(buffer_at(exp_average_buffers, i));
+      exp_average_sqs.push_back(buffer_at(exp_average_sq_buffers, i));
+      if (options.amsgrad()) {
+        max_exp_average_sqs.push_back(buffer_at(max_exp_average_sq_buffers, i));
+      }
+      const auto step = ++buffer_at(step_buffers, i);
+      step_sizes.push_back(
+          options.learning_rate() / (1 - std::pow(options.beta1(), step)));
+      bias_corrections2.push_back(1 - std::pow(options.beta2(), step));
+    }
+    bump_versions(params);
+    bump_versions(exp_averages);
+    bump_versions(exp_average_sqs);
+    bump_versions(max_exp_average_sqs);
+    // Flattened state is updated in one piece if all steps agree.
+    if (!step_sizes.empty() &&
+        std::equal(step_sizes.begin() + 1, step_sizes.end(), step_sizes.begin())) {
+      coalesce({&params, &grads, &exp_averages, &exp_average_sqs, &max_exp_average_sqs});
+      step_sizes.resize(params.size());
+      bias_corrections2.resize(params.size());
+    }
+    at::native::fused_adam_step_(
+        params,
+        grads,
+        exp_averages,
+        exp_average_sqs,
+        max_exp_average_sqs,
+        step_sizes,
+        bias_corrections2,
+        options.beta1(),
+        options.beta2(),
+        options.weight_decay(),
+        options.eps());
+    return;
+  }
+
+  for (auto i : unique_parameter_indices()) {
     Tensor p = parameters_.at(i);
     if (!p.grad().defined()) {
       continue;
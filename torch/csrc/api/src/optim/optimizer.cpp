@@ -4,14 +4,51 @@
 #include <torch/ordered_dict.h>
 #include <torch/serialize/archive.h>
 #include <torch/types.h>
+#include <torch/utils.h>
 
 #include <string>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
 namespace torch {
 namespace optim {
 namespace detail {
+namespace {
+/// Returns a contiguous tensor of the given size at `storage_offset` into the
+/// storage of `tensor`. Unlike a view of `tensor`, it can be detached in
+/// place, as `zero_grad()` does with gradients.
+Tensor tensor_in_storage_of(
+    const Tensor& tensor,
+    int64_t storage_offset,
+    IntArrayRef size) {
+  NoGradGuard guard;
+  return torch::empty({0}, tensor.options())
+      .set_(tensor.storage(), storage_offset, size);
+}
+
+int64_t total_numel(const std::vector<Tensor>& tensors) {
+  int64_t numel = 0;
+  for (const auto& tensor : tensors) {
+    numel += tensor.numel();
+  }
+  return numel;
+}
+
+/// Returns `tensors` without the repeated occurrences of tensors that are
+/// listed more than once, such as tied parameters.
+std::vector<Tensor> unique_tensors(const std::vector<Tensor>& tensors) {
+  std::vector<Tensor> unique;
+  std::unordered_set<const c10::TensorImpl*> seen;
+  for (const auto& tensor : tensors) {
+    if (seen.insert(tensor.unsafeGetTensorImpl()).second) {
+      unique.push_back(tensor);
+    }
+  }
+  return unique;
+}
+} // namespace
+
 OptimizerBase::OptimizerBase(std::vector<Tensor> parameters)
     : parameters_(std::move(parameters)) {}
 
@@ -40,7 +77,131 @@ size_t OptimizerBase::size() const noexcept {
   return parameters_.size();
 }
 
+void OptimizerBase::flatten_parameters() {
+  if (parameters_.empty()) {
+    return;
+  }
+  const auto options = parameters_.front().options();
+  for (const auto& parameter : parameters_) {
+    TORCH_CHECK(
+        parameter.layout() == torch::kStrided &&
+            parameter.dtype() == options.dtype() &&
+            parameter.device() == options.device(),
+        "flatten_parameters() requires dense parameters of the same type and device");
+  }
+
+  // A tied parameter is moved once; its other entries share its TensorImpl
+  // and so see the move too.
+  NoGradGuard guard;
+  auto parameters = unique_tensors(parameters_);
+  const auto numel = total_numel(parameters);
+  auto flat_parameters = torch::empty({numel}, options);
+  auto flat_gradients = torch::zeros({numel}, options);
+  int64_t offset = 0;
+  for (auto& parameter : parameters) {
+    const auto size = parameter.sizes().vec();
+    flat_parameters.narrow(0, offset, parameter.numel()).view(size).copy_(parameter);
+    auto gradient = tensor_in_storage_of(flat_gradients, offset, size);
+    if (parameter.grad().defined()) {
+      gradient.copy_(parameter.grad());
+    }
+    parameter.set_(flat_parameters.storage(), offset, size);
+    parameter.grad() = gradient;
+    offset += parameter.numel();
+  }
+  flat_ = true;
+}
+
+std::vector<size_t> OptimizerBase::unique_parameter_indices() const {
+  std::vector<size_t> indices;
+  std::unordered_set<const c10::TensorImpl*> seen;
+  for (size_t i = 0; i < parameters_.size(); ++i) {
+    if (seen.insert(parameters_[i].unsafeGetTensorImpl()).second) {
+      indices.push_back(i);
+    }
+  }
+  return indices;
+}
+
+bool OptimizerBase::fused_parameters(
+    std::vector<size_t>& indices,
+    std::vector<Tensor>& parameters,
+    std::vector<Tensor>& gradients) {
+  for (auto i : unique_parameter_indices()) {
+    const auto& parameter = parameters_[i];
+    const auto& gradient = parameter.grad();
+    if (!gradient.defined()) {
+      continue;
+    }
+    const auto dtype = parameter.scalar_type();
+    if (!parameter.device().is_cpu() || !gradient.device().is_cpu() ||
+        parameter.layout() != torch::kStrided ||
+        gradient.layout() != torch::kStrided ||
+        !parameter.is_contiguous() || !gradient.is_contiguous() ||
+        (dtype != torch::kFloat && dtype != torch::kDouble) ||
+        gradient.scalar_type() != dtype ||
+        (!parameters.empty() && parameters.front().scalar_type() != dtype)) {
+      return false;
+    }
+    indices.push_back(i);
+    parameters.push_back(parameter);
+    gradients.push_back(gradient);
+  }
+  return true;
+}
+
+void OptimizerBase::coalesce(std::vector<std::vector<Tensor>*> lists) {
+  std::vector<Tensor> flat(lists.size());
+  for (size_t l = 0; l < lists.size(); ++l) {
+    const auto& list = *lists[l];
+    if (list.empty()) {
+      continue;
+    }
+    const auto& first = list.front();
+    int64_t numel = 0;
+    for (const auto& tensor : list) {
+      if (!tensor.is_contiguous() ||
+          !tensor.storage().is_alias_of(first.storage()) ||
+          tensor.storage_offset() != first.storage_offset() + numel) {
+        return;
+      }
+      numel += tensor.numel();
+    }
+    flat[l] = tensor_in_storage_of(first, first.storage_offset(), {numel});
+  }
+  for (size_t l = 0; l < lists.size(); ++l) {
+    if (flat[l].defined()) {
+      *lists[l] = {flat[l]};
+    }
+  }
+}
+
+void OptimizerBase::bump_versions(const std::vector<Tensor>& tensors) {
+  for (const auto& tensor : tensors) {
+    tensor.unsafeGetTensorImpl()->bump_version();
+  }
+}
+
 Tensor& OptimizerBase::buffer_at(std::vector<Tensor>& buffers, size_t index) {
+  if (flat_ && buffers.size() < parameters_.size()) {
+    // Lays the state of all parameters out in one buffer, keeping the values
+    // of the state that exists already.
+    NoGradGuard guard;
+    auto flat = torch::zeros({total_numel(parameters_)}, parameters_.front().options());
+    int64_t offset = 0;
+    for (size_t i = 0; i < parameters_.size(); ++i) {
+      auto buffer = tensor_in_storage_of(flat, offset, parameters_[i].sizes());
+      if (i < buffers.size()) {
+        if (buffers[i].defined()) {
+          buffer.copy_(buffers[i]);
+        }
+        buffers[i] = buffer;
+      } else {
+        buffers.push_back(buffer);
+      }
+      offset += parameters_[i].numel();
+    }
+  }
   if (buffers.size() <= index) {
     buffers.reserve(index);
     for (auto i = buffers.size(); i <= index; ++i) {
@@ -5,6 +5,7 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/native/FusedOptimizers.h>
 
 #include <functional>
 
@@ -17,7 +18,39 @@ RMSpropOptions::RMSpropOptions(double learning_rate)
 /// Adapted from
 /// https://github.com/pytorch/pytorch/blob/master/torch/optim/rmsprop.py
 void RMSprop::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
+  std::vector<size_t> indices;
+  std::vector<Tensor> params, grads;
+  if (fused_parameters(indices, params, grads)) {
+    std::vector<Tensor> square_averages, grad_averages, momentums;
+    for (auto i : indices) {
+      square_averages.push_back(buffer_at(square_average_buffers, i));
+      if (options.centered()) {
+        grad_averages.push_back(buffer_at(grad_average_buffers, i));
+      }
+      if (options.momentum() > 0) {
+        momentums.push_back(buffer_at(momentum_buffers, i));
+      }
+    }
+    bump_versions(params);
+    bump_versions(square_averages);
+    bump_versions(grad_averages);
+    bump_versions(momentums);
+    coalesce({&params, &grads, &square_averages, &grad_averages, &momentums});
+    at::native::fused_rmsprop_step_(
+        params,
+        grads,
+        square_averages,
+        grad_averages,
+        momentums,
+        options.learning_rate(),
+        options.alpha(),
+        options.eps(),
+        options.weight_decay(),
+        options.momentum());
+    return;
+  }
+
+  for (auto i : unique_parameter_indices()) {
     Tensor p = parameters_.at(i);
     if (!p.grad().defined()) {
       continue;
@@ -8,6 +8,7 @@
 #include <torch/utils.h>
 
 #include <ATen/ATen.h>
+#include <ATen/native/FusedOptimizers.h>
 
 #include <functional>
 
@@ -16,7 +17,33 @@ namespace optim {
 SGDOptions::SGDOptions(double learning_rate) : learning_rate_(learning_rate) {}
 
 void SGD::step() {
-  for (size_t i = 0; i < parameters_.size(); ++i) {
+  std::vector<size_t> indices;
+  std::vector<Tensor> params, grads;
+  if (fused_parameters(indices, params, grads)) {
+    std::vector<Tensor> momentums;
+    if (options.momentum() != 0) {
+      for (auto i : indices) {
+        momentums.push_back(buffer_at(momentum_buffers, i));
+      }
+    }
+    const auto dampening = iteration_ == 0 ? 0 : options.dampening();
+    bump_versions(params);
+    bump_versions(momentums);
+    coalesce({&params, &grads, &momentums});
+    at::native::fused_sgd_step_(
+        params,
+        grads,
+        momentums,
+        options.learning_rate(),
+        options.momentum(),
+        dampening,
+        options.weight_decay(),
+        options.nesterov());
+    iteration_ += 1;
+    return;
+  }
+
+  for (auto i : unique_parameter_indices()) {
     Tensor p = parameters_.at(i);
 
     if (!p.grad().defined()) {
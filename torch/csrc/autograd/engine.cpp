@@ -1,6 +1,7 @@
 #include <torch/csrc/autograd/engine.h>
 
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/autograd/functions/accumulate_grad.h>
 #include <torch/csrc/autograd/functions/basic_ops.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
@@ -28,6 +29,8 @@
 #include <set>
 #include <string>
 #include <thread>
+#include <algorithm>
+#include <array>
 #include <unordered_set>
 #include <typeinfo>
 #include <sstream>
@@ -56,6 +59,9 @@ static thread_local bool checkpoint_valid = true;
 // executed at the same time). Adding multiple threads per-device or removing
 // engine thread affinity to the device can break this invariant, and we depend
 // on it in a few places (e.g. AccumulateGrad function).
+//
+// See Note [Multithreaded CPU backwards] for how the invariant is kept when
+// several threads run CPU nodes.
 
 // Number of nested reentrant backwards calls currently on this thread
 static thread_local int current_depth = 0;
@@ -109,9 +115,38 @@ struct ReadyQueue {
 
   void push(NodeTask item);
   void pushShutdownTask();
-  NodeTask pop();
+  // Blocks until there is a task, or until `graph_task` (if given) has no
+  // outstanding tasks left, in which case a task without base_ is returned.
+  NodeTask pop(GraphTask* graph_task = nullptr);
+  // Wakes up all threads blocked in pop() so they re-check whether their
+  // graph task is done.
+  void wakeAll();
 };
 
+// Note [Multithreaded CPU backwards]
+// ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+// With Engine::set_num_cpu_threads(n > 1), n threads share the CPU
+// ReadyQueue, so independent CPU nodes of a graph run concurrently.  The
+// dependency counting and input buffers of a GraphTask are protected by its
+// mutex, so they stay correct no matter which thread finishes a node.
+//
+// Three things change compared to the single thread per device setup:
+//
+//  - A node of a single GraphTask is still only run once, but nodes shared by
+//    concurrently running graphs could now be entered concurrently.  The one
+//    place that relies on it, AccumulateGrad, is serialized per node with a
+//    striped lock.
+//
+//  - A reentrant backwards call made on a CPU thread may see its last task
+//    finish on another CPU thread, which would not wake up the owner blocked
+//    in pop().  The finishing thread wakes up all CPU threads instead, and
+//    pop() returns early for a thread whose graph task is done.
+//
+//  - The order in which gradients are accumulated into an InputBuffer
+//    depends on which producer finishes first.  If determinism is requested,
+//    contributions are deferred until the consumer is ready and then summed
+//    in a fixed order (see GraphTask::add_input).
+
 // Note [Reentrant backwards]
 // ~~~~~~~~~~~~~~~~~~~~~~~~~~
 // To understand the reentrant backwards problem, we have to notice two
@@ -191,6 +226,30 @@ struct GraphTask {
   std::unordered_map<Node*, InputBuffer> not_ready_;
   std::unordered_map<Node*, int> dependencies_;
 
+  // Gradients for nodes that are not ready yet, only used in deterministic
+  // mode.  See Note [Multithreaded CPU backwards]
+  struct DeferredInput {
+    DeferredInput(
+        size_t input_nr,
+        uint64_t producer_sequence_nr,
+        size_t producer_output_nr,
+        Variable grad,
+        const c10::optional<c10::Stream>& producer_stream)
+      : input_nr_(input_nr)
+      , producer_sequence_nr_(producer_sequence_nr)
+      , producer_output_nr_(producer_output_nr)
+      , grad_(std::move(grad))
+      , producer_stream_(producer_stream) {}
+    size_t input_nr_;
+    uint64_t producer_sequence_nr_;
+    size_t producer_output_nr_;
+    Variable grad_;
+    c10::optional<c10::Stream> producer_stream_;
+  };
+  std::unordered_map<Node*, std::vector<DeferredInput>> deferred_inputs_;
+  // It is safe to read deterministic_ without synchronization
+  const bool deterministic_;
+
   struct ExecInfo {
     struct Capture {
       Capture(int input_idx, int output_idx) : input_idx_(input_idx), output_idx_(output_idx) {}
@@ -219,6 +278,22 @@ struct GraphTask {
 
   void init_to_execute(Node& graph_root, const edge_list& outputs);
 
+  // Adds the gradient `grad` flowing from output `producer_output_nr` of
+  // `producer` into input `input_nr` of `fn` to its input buffer.  In
+  // deterministic mode the gradients are collected until `fn` is ready and
+  // only then summed, in decreasing order of producer sequence number.
+  // Requires mutex_ to be held.
+  void add_input(
+      Node* fn,
+      InputBuffer& buffer,
+      size_t input_nr,
+      Variable&& grad,
+      const Node& producer,
+      size_t producer_output_nr,
+      const c10::optional<c10::Stream>& producer_stream,
+      const c10::optional<c10::Stream>& consumer_stream,
+      bool is_ready);
+
   // The value of worker_device in the thread that created this task.
   // See Note [Reentrant backwards]
   // Safe to read owner_ and reentrant_depth_ without synchronizaton
@@ -230,15 +305,64 @@ struct GraphTask {
     return exec_info_.empty();
   }
 
-  GraphTask(bool keep_graph, bool grad_mode, int reentrant_depth)
+  GraphTask(bool keep_graph, bool grad_mode, int reentrant_depth, bool deterministic = false)
     : has_error_(false)
     , outstanding_tasks_(0)
     , keep_graph_(keep_graph)
     , grad_mode_(grad_mode)
+    , deterministic_(deterministic)
     , owner_(NO_DEVICE)
     , reentrant_depth_(reentrant_depth) {}
 };
 
+void GraphTask::add_input(
+    Node* fn,
+    InputBuffer& buffer,
+    size_t input_nr,
+    Variable&& grad,
+    const Node& producer,
+    size_t producer_output_nr,
+    const c10::optional<c10::Stream>& producer_stream,
+    const c10::optional<c10::Stream>& consumer_stream,
+    bool is_ready) {
+  if (!deterministic_) {
+    buffer.add(input_nr, std::move(grad), producer_stream, consumer_stream);
+    return;
+  }
+  auto it = deferred_inputs_.find(fn);
+  if (is_ready && it == deferred_inputs_.end()) {
+    // the only gradient for fn, nothing to order
+    buffer.add(input_nr, std::move(grad), producer_stream, consumer_stream);
+    return;
+  }
+  if (it == deferred_inputs_.end()) {
+    it = deferred_inputs_.emplace(fn, std::vector<DeferredInput>()).first;
+  }
+  auto& inputs = it->second;
+  inputs.emplace_back(
+      input_nr, producer.sequence_nr(), producer_output_nr, std::move(grad),
+      producer_stream);
+  if (!is_ready) {
+    return;
+  }
+  std::stable_sort(inputs.begin(), inputs.end(),
+      [](const DeferredInput& a, const DeferredInput& b) {
+        if (a.producer_sequence_nr_ != b.producer_sequence_nr_) {
+          return a.producer_sequence_nr_ > b.producer_sequence_nr_;
+        }
+        if (a.producer_output_nr_ != b.producer_output_nr_) {
+          return a.producer_output_nr_ < b.producer_output_nr_;
+        }
+        return a.input_nr_ < b.input_nr_;
+      });
+  for (auto& input : inputs) {
+    buffer.add(
+        input.input_nr_, std::move(input.grad_), input.producer_stream_,
+        consumer_stream);
+  }
+  deferred_inputs_.erase(it);
+}
+
 int NodeTask::getReentrantDepth() const {
   return base_->reentrant_depth_;
 }
@@ -261,17 +385,40 @@ auto ReadyQueue::pushShutdownTask() -> void {
   not_empty_.notify_one();
 }
 
-auto ReadyQueue::pop() -> NodeTask {
+auto ReadyQueue::pop(GraphTask* graph_task) -> NodeTask {
   // Lock mutex for accesses to heap_
   std::unique_lock<std::mutex> lock(mutex_);
-  not_empty_.wait(lock, [this]{ return !heap_.empty(); });
+  not_empty_.wait(lock, [this, graph_task]{
+    return !heap_.empty() ||
+        (graph_task && graph_task->outstanding_tasks_.load() == 0);
+  });
+  if (heap_.empty()) {
+    // graph_task is done, see Note [Multithreaded CPU backwards]
+    return NodeTask(nullptr, nullptr, InputBuffer(0));
+  }
   // NOLINTNEXTLINE(cppcoreguidelines-pro-type-const-cast)
   auto task = std::move(const_cast<NodeTask&>(heap_.top())); heap_.pop();
   return task;
 }
 
+auto ReadyQueue::wakeAll() -> void {
+  // Taking the lock orders this with the predicate check in pop()
+  std::lock_guard<std::mutex> lock(mutex_);
+  not_empty_.notify_all();
+}
+
+// Serializes AccumulateGrad nodes when several threads run CPU nodes, see
+// Note [Multithreaded CPU backwards]
+static std::mutex& accumulate_grad_mutex(const Node* fn) {
+  static std::array<std::mutex, 64> mutexes;
+  return mutexes[std::hash<const Node*>()(fn) % mutexes.size()];
+}
+
 // This limit is based on the default python recursion limit which is 1000
-Engine::Engine() : max_recursion_depth_(100) {}
+Engine::Engine()
+  : max_recursion_depth_(100)
+  , num_cpu_threads_(1)
+  , deterministic_(false) {}
 
 // Send shutdown tasks to all ReadyQueues if no backward tasks are running
 // Even though readyQueue should be empty, shutdown tasks have the highest
@@ -283,8 +430,12 @@ Engine::~Engine() {
     noBackward =  noBackward && queue->heap_.empty();
   }
   if (noBackward) {
-    for (auto& queue : ready_queues_) {
-     queue->pushShutdownTask();
+    for (size_t i = 0; i < ready_queues_.size(); ++i) {
+      // one shutdown task for every thread sharing the queue
+      int num_threads = i == 0 ? num_cpu_threads_ : 1;
+      for (int j = 0; j < num_threads; ++j) {
+        ready_queues_[i]->pushShutdownTask();
+      }
     }
   }
   // Othewise threads are leaked
@@ -351,14 +502,21 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
   auto queue = ready_queues_[worker_device + 1];
   // Why the test on graph_task->outstanding_tasks_?  See
   // Note [Reentrant backwards]
+  // Several threads share the CPU queue, see
+  // Note [Multithreaded CPU backwards]
+  const bool shared_queue = worker_device == -1 && num_cpu_threads_ > 1;
   while (!graph_task || graph_task->outstanding_tasks_ > 0) {
-    NodeTask task = queue->pop();
+    NodeTask task = queue->pop(graph_task);
     // This will only work if the worker is running a non backward task
     // TODO Needs to be fixed this to work in all cases
     if (task.isShutdownTask_) {
       C10_LOG_API_USAGE_ONCE("torch.autograd.thread_shutdown");
       break;
     }
+    if (!task.base_) {
+      // woken up because graph_task is done
+      continue;
+    }
     if (task.fn_ && !task.base_->has_error_.load()) {
       GradMode::set_enabled(task.base_->grad_mode_);
       try {
@@ -381,8 +539,11 @@ auto Engine::thread_main(GraphTask *graph_task) -> void {
     } else {
       // If it's a task initiated from this thread, decrease the counter, but
       // don't do anything - loop condition will do all checks for us next.
+      // With a shared queue the owner may be another thread blocked in pop().
       if (base_owner == worker_device) {
-        --task.base_->outstanding_tasks_;
+        if (--task.base_->outstanding_tasks_ == 0 && shared_queue) {
+          queue->wakeAll();
+        }
       // Otherwise send a dummy function task to the owning thread just to
       // ensure that it's not sleeping. If it has work, it might see that
       // graph_task->outstanding_tasks_ == 0 before it gets to the task, but
@@ -580,7 +741,13 @@ auto Engine::evaluate_function(NodeTask& task) -> void {
   const auto opt_parent_stream = (*task.fn_).stream(c10::DeviceType::CUDA);
   c10::OptionalStreamGuard parent_stream_guard{opt_parent_stream};
 
-  auto outputs = call_function(task);
+  variable_list outputs;
+  if (num_cpu_threads_ > 1 && dynamic_cast<AccumulateGrad*>(task.fn_.get())) {
+    std::lock_guard<std::mutex> lock(accumulate_grad_mutex(task.fn_.get()));
+    outputs = call_function(task);
+  } else {
+    outputs = call_function(task);
+  }
 
   auto& fn = *task.fn_;
   if (!task.base_->keep_graph_) {
@@ -645,10 +812,15 @@ auto Engine::evaluate_function(NodeTask& task) -> void {
 
       // Accumulates into buffer
       const auto opt_next_stream = next.function->stream(c10::DeviceType::CUDA);
-      input_buffer.add(next.input_nr,
-                       std::move(output),
-                       opt_parent_stream,
-                       opt_next_stream);
+      task.base_->add_input(next.function.get(),
+                            input_buffer,
+                            next.input_nr,
+                            std::move(output),
+                            fn,
+                            i,
+                            opt_parent_stream,
+                            opt_next_stream,
+                            is_ready);
 
       if (is_ready) {
         auto& queue = ready_queue(input_buffer.device());
@@ -662,10 +834,15 @@ auto Engine::evaluate_function(NodeTask& task) -> void {
 
       // Accumulates into buffer
       const auto opt_next_stream = next.function->stream(c10::DeviceType::CUDA);
-      input_buffer.add(next.input_nr,
-                       std::move(output),
-                       opt_parent_stream,
-                       opt_next_stream);
+      task.base_->add_input(next.function.get(),
+                            input_buffer,
+                            next.input_nr,
+                            std::move(output),
+                            fn,
+                            i,
+                            opt_parent_stream,
+                            opt_next_stream,
+                            is_ready);
       if (is_ready) {
         auto& queue = ready_queue(input_buffer.device());
         queue.push(NodeTask(task.base_, next.function, std::move(input_buffer)));
@@ -728,7 +905,9 @@ auto Engine::execute(const edge_list& roots,
   // Lock post_callbacks_lock_ before clearing final_callbacks_
   ClearCallbacks _cb_guard(final_callbacks_, post_callbacks_lock_);
 
-  GraphTask graph_task(keep_graph, create_graph, worker_device == NO_DEVICE ? 0 : total_depth+1);
+  GraphTask graph_task(keep_graph, create_graph,
+                       worker_device == NO_DEVICE ? 0 : total_depth+1,
+                       deterministic_.load());
   // Lock mutex while GraphTask is being set up
   std::unique_lock<std::mutex> lock(graph_task.mutex_);
 
@@ -833,6 +1012,26 @@ bool Engine::is_checkpoint_valid() {
   return checkpoint_valid;
 }
 
+void Engine::set_num_cpu_threads(int num_threads) {
+  TORCH_CHECK(num_threads > 0, "Expected positive number of threads");
+  TORCH_CHECK(ready_queues_.empty(),
+      "Error: cannot set the number of autograd CPU threads "
+      "after the first backward pass");
+  num_cpu_threads_ = num_threads;
+}
+
+int Engine::num_cpu_threads() const {
+  return num_cpu_threads_;
+}
+
+void Engine::set_deterministic(bool deterministic) {
+  deterministic_ = deterministic;
+}
+
+bool Engine::is_deterministic() const {
+  return deterministic_.load();
+}
+
 auto Engine::ready_queue(at::Device device) -> ReadyQueue& {
   // See Note [Allocating GPUs to autograd threads]
   if (device.type() == at::kCPU) {
@@ -872,6 +1071,12 @@ auto Engine::start_threads() -> void {
     std::thread t(&Engine::thread_init, this, i - 1);
     t.detach();
   }
+  // Additional threads sharing the CPU queue,
+  // see Note [Multithreaded CPU backwards]
+  for (int i = 1; i < num_cpu_threads_; ++i) {
+    std::thread t(&Engine::thread_init, this, -1);
+    t.detach();
+  }
 }
 
 void Engine::add_thread_pool_task(GraphTask *graph_task) {
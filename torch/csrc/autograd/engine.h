@@ -8,6 +8,7 @@
 #include <torch/csrc/autograd/input_buffer.h>
 #include <torch/csrc/autograd/anomaly_mode.h>
 
+#include <atomic>
 #include <deque>
 #include <exception>
 #include <functional>
@@ -53,6 +54,20 @@ struct TORCH_API Engine {
 
   bool is_checkpoint_valid();
 
+  // Number of worker threads running the CPU nodes of backward passes.  By
+  // default a single thread runs all of them; with more threads, independent
+  // ready nodes of a graph run concurrently.  Must be set before the first
+  // backward pass.
+  void set_num_cpu_threads(int num_threads);
+  int num_cpu_threads() const;
+
+  // When set, gradients flowing into the same input of a node are summed in
+  // an order that only depends on the graph (the sequence numbers of the
+  // producing nodes), not on which producer finished first.  This keeps
+  // backward passes bitwise reproducible when several threads run them.
+  void set_deterministic(bool deterministic);
+  bool is_deterministic() const;
+
 protected:
   void compute_dependencies(Node* root, GraphTask& task);
   void evaluate_function(NodeTask& task);
@@ -75,6 +90,9 @@ protected:
   std::mutex post_callbacks_lock_;
   // How many nested reentrant calls are allowed until a new thread is used
   int max_recursion_depth_;
+  // Number of threads sharing the CPU ReadyQueue, fixed once threads start
+  int num_cpu_threads_;
+  std::atomic<bool> deterministic_;
 
   struct ThreadPoolShared {
     // Data structures used by the threads for executing reentrant backwards
@@ -223,6 +223,34 @@ PyObject* THPEngine_is_checkpoint_valid(PyObject *self, PyObject *noargs) {
   END_HANDLE_TH_ERRORS
 }
 
+PyObject* THPEngine_set_num_cpu_threads(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(THPUtils_checkLong(arg), "set_num_cpu_threads expects an int, "
+          "but got %s", THPUtils_typename(arg));
+  engine.set_num_cpu_threads((int)THPUtils_unpackLong(arg));
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_set_deterministic(PyObject *self, PyObject *arg) {
+  HANDLE_TH_ERRORS
+  THPUtils_assert(PyBool_Check(arg), "set_deterministic expects a bool, "
+          "but got %s", THPUtils_typename(arg));
+  engine.set_deterministic(arg == Py_True);
+  Py_RETURN_NONE;
+  END_HANDLE_TH_ERRORS
+}
+
+PyObject* THPEngine_is_deterministic(PyObject *self, PyObject *noargs) {
+  HANDLE_TH_ERRORS
+  if (engine.is_deterministic()) {
+    Py_RETURN_TRUE;
+  } else {
+    Py_RETURN_FALSE;
+  }
+  END_HANDLE_TH_ERRORS
+}
+
 PyObject *THPEngine_new(PyTypeObject *type, PyObject *args, PyObject *kwargs)
 {
   return type->tp_alloc(type, 0);
@@ -232,6 +260,9 @@ static struct PyMethodDef THPEngine_methods[] = {
   {(char*)"run_backward", (PyCFunction)(void(*)(void))THPEngine_run_backward, METH_VARARGS | METH_KEYWORDS, nullptr},
   {(char*)"queue_callback", (PyCFunction)THPEngine_queue_callback, METH_O, nullptr},
   {(char*)"is_checkpoint_valid", (PyCFunction)THPEngine_is_checkpoint_valid, METH_NOARGS, nullptr},
+  {(char*)"set_num_cpu_threads", (PyCFunction)THPEngine_set_num_cpu_threads, METH_O, nullptr},
+  {(char*)"set_deterministic", (PyCFunction)THPEngine_set_deterministic, METH_O, nullptr},
+  {(char*)"is_deterministic", (PyCFunction)THPEngine_is_deterministic, METH_NOARGS, nullptr},
   {nullptr}
 };
 
@@ -0,0 +1,215 @@
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
+
+#include <cmath>
+#include <functional>
+#include <mutex>
+
+#include <ATen/CPUGenerator.h>
+#include <c10/util/Exception.h>
+
+namespace c10d {
+namespace {
+
+// Work that completes once all `pending` works have completed and `then` has
+// run. `then` runs on the first thread that waits for this work, which allows
+// hooks to chain several collectives while the first one still overlaps with
+// the backward pass.
+class ContinuationWork : public ProcessGroup::Work {
+ public:
+  ContinuationWork(
+      std::vector<std::shared_ptr<ProcessGroup::Work>> pending,
+      std::function<void()> then)
+      : pending_(std::move(pending)), then_(std::move(then)) {}
+
+  void wait() override {
+    std::call_once(once_, [this] {
+      try {
+        for (auto& work : pending_) {
+          work->wait();
+        }
+        then_();
+        finish();
+      } catch (...) {
+        finish(std::current_exception());
+      }
+    });
+    ProcessGroup::Work::wait();
+  }
+
+ private:
+  std::vector<std::shared_ptr<ProcessGroup::Work>> pending_;
+  std::function<void()> then_;
+  std::once_flag once_;
+};
+
+// Sums all replicas of a bucket into the first one, so that compression and
+// communication happen once per process.
+at::Tensor& sumReplicas(std::vector<at::Tensor>& tensors) {
+  for (size_t i = 1; i < tensors.size(); i++) {
+    tensors[0].add_(tensors[i].to(tensors[0].device()));
+  }
+  return tensors[0];
+}
+
+// Copies the reduced contents of the first replica to all other replicas.
+void copyToReplicas(std::vector<at::Tensor>& tensors) {
+  for (size_t i = 1; i < tensors.size(); i++) {
+    tensors[i].copy_(tensors[0], /* non_blocking */ true);
+  }
+}
+
+// Plain allreduce of the replica sum, for buckets that are not worth
+// compressing.
+std::shared_ptr<ProcessGroup::Work> allreduceUncompressed(
+    const std::shared_ptr<ProcessGroup>& process_group,
+    std::vector<at::Tensor>& tensors) {
+  std::vector<at::Tensor> sum = {sumReplicas(tensors)};
+  auto work = process_group->allreduce(sum);
+  return std::make_shared<ContinuationWork>(
+      std::vector<std::shared_ptr<ProcessGroup::Work>>{work},
+      [tensors]() mutable { copyToReplicas(tensors); });
+}
+
+// Orthonormalizes the columns of a matrix in place (Gram-Schmidt).
+void orthogonalize(at::Tensor& matrix, double eps = 1e-8) {
+  const auto cols = matrix.size(1);
+  for (int64_t i = 0; i < cols; i++) {
+    auto col = matrix.narrow(1, i, 1);
+    col.div_(col.norm() + eps);
+    if (i + 1 < cols) {
+      auto rest = matrix.narrow(1, i + 1, cols - i - 1);
+      rest.sub_((col * rest).sum(0, /* keepdim */ true) * col);
+    }
+  }
+}
+
+} // namespace
+
+std::shared_ptr<ProcessGroup::Work> FP16CompressHook::runHook(
+    size_t /* unused */,
+    std::vector<at::Tensor>& tensors) {
+  std::vector<at::Tensor> compressed = {sumReplicas(tensors).to(at::kHalf)};
+  auto work = process_group_->allreduce(compressed);
+  return std::make_shared<ContinuationWork>(
+      std::vector<std::shared_ptr<ProcessGroup::Work>>{work},
+      [tensors, compressed]() mutable {
+        tensors[0].copy_(compressed[0]);
+        copyToReplicas(tensors);
+      });
+}
+
+TopKCompressHook::TopKCompressHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    double ratio)
+    : process_group_(std::move(process_group)), ratio_(ratio) {
+  TORCH_CHECK(
+      ratio_ > 0 && ratio_ <= 1,
+      "Expected top-k ratio in (0, 1], got ",
+      ratio_);
+}
+
+std::shared_ptr<ProcessGroup::Work> TopKCompressHook::runHook(
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  auto& tensor = sumReplicas(tensors);
+  const int64_t numel = tensor.numel();
+  const int64_t k = static_cast<int64_t>(std::ceil(ratio_ * numel));
+  if (k == 0 || k == numel) {
+    return allreduceUncompressed(process_group_, tensors);
+  }
+
+  auto& residual = residuals_[bucket_index];
+  if (!residual.defined() || residual.numel() != numel) {
+    residual = at::zeros_like(tensor);
+  }
+  residual.add_(tensor);
+  // Every process sends exactly k elements, so the allgathered tensors have
+  // the same size everywhere.
+  std::vector<at::Tensor> indices = {std::get<1>(residual.abs().topk(
+      k, /* dim */ 0, /* largest */ true, /* sorted */ false))};
+  std::vector<at::Tensor> values = {residual.index_select(0, indices[0])};
+  residual.index_fill_(0, indices[0], 0);
+
+  const auto world_size = process_group_->getSize();
+  std::vector<std::vector<at::Tensor>> gathered_indices(1);
+  std::vector<std::vector<at::Tensor>> gathered_values(1);
+  for (int i = 0; i < world_size; i++) {
+    gathered_indices[0].push_back(at::empty_like(indices[0]));
+    gathered_values[0].push_back(at::empty_like(values[0]));
+  }
+  std::vector<std::shared_ptr<ProcessGroup::Work>> works = {
+      process_group_->allgather(gathered_indices, indices),
+      process_group_->allgather(gathered_values, values)};
+  return std::make_shared<ContinuationWork>(
+      std::move(works),
+      [tensors, gathered_indices, gathered_values]() mutable {
+        tensors[0].zero_();
+        for (size_t i = 0; i < gathered_indices[0].size(); i++) {
+          tensors[0].index_add_(
+              0, gathered_indices[0][i], gathered_values[0][i]);
+        }
+        copyToReplicas(tensors);
+      });
+}
+
+PowerSGDHook::PowerSGDHook(
+    std::shared_ptr<ProcessGroup> process_group,
+    int64_t rank,
+    uint64_t seed)
+    : process_group_(std::move(process_group)), rank_(rank), seed_(seed) {
+  TORCH_CHECK(rank_ > 0, "Expected a positive PowerSGD rank, got ", rank_);
+}
+
+std::shared_ptr<ProcessGroup::Work> PowerSGDHook::runHook(
+    size_t bucket_index,
+    std::vector<at::Tensor>& tensors) {
+  auto& tensor = sumReplicas(tensors);
+  const int64_t numel = tensor.numel();
+  // View the bucket as a near-square n x m matrix, padded with zeros.
+  const int64_t n = static_cast<int64_t>(std::ceil(std::sqrt(numel)));
+  const int64_t m = n > 0 ? (numel + n - 1) / n : 0;
+  const int64_t rank = std::min(rank_, std::min(n, m));
+  if ((n + m) * rank >= numel) {
+    return allreduceUncompressed(process_group_, tensors);
+  }
+
+  State* state = &states_[bucket_index];
+  if (!state->error.defined() || state->error.numel() != numel) {
+    state->error = at::zeros_like(tensor);
+    // Q must start out identical on all processes.
+    auto generator = at::detail::createCPUGenerator(seed_ + bucket_index);
+    state->q = at::randn(
+                   {m, rank},
+                   generator.get(),
+                   tensor.options().device(at::kCPU))
+                   .to(tensor.device());
+  }
+
+  // Error feedback: compress the gradients plus what previous steps missed.
+  // The error holds the uncompressed local matrix until the approximation is
+  // known.
+  tensor.add_(state->error);
+  state->error.copy_(tensor);
+  auto matrix = at::zeros({n * m}, tensor.options());
+  matrix.narrow(0, 0, numel).copy_(tensor);
+  matrix = matrix.view({n, m});
+
+  std::vector<at::Tensor> p = {at::matmul(matrix, state->q)};
+  auto work = process_group_->allreduce(p);
+  auto process_group = process_group_;
+  return std::make_shared<ContinuationWork>(
+      std::vector<std::shared_ptr<ProcessGroup::Work>>{work},
+      [process_group, state, tensors, matrix, p, numel]() mutable {
+        orthogonalize(p[0]);
+        std::vector<at::Tensor> q = {at::matmul(matrix.t(), p[0])};
+        process_group->allreduce(q)->wait();
+        state->q = q[0];
+        auto approx =
+            at::matmul(p[0], q[0].t()).view({-1}).narrow(0, 0, numel);
+        tensors[0].copy_(approx);
+        state->error.sub_(approx);
+        copyToReplicas(tensors);
+      });
+}
+
+} // namespace c10d
@@ -0,0 +1,102 @@
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include <ATen/ATen.h>
+#include <c10d/ProcessGroup.hpp>
+
+namespace c10d {
+
+// A communication hook replaces the allreduce that the Reducer runs for a
+// dense bucket, e.g. to compress the gradients before they are sent.
+//
+// It is given the flattened contents of every replica of the bucket
+// (`BucketReplica::contents`), which already hold the local gradients
+// divided by the world size. When the returned work completes, every tensor
+// must hold the (approximate) sum of that bucket across all processes, i.e.
+// the averaged gradients.
+//
+// Hooks may keep per-bucket state (e.g. for error feedback), keyed by the
+// bucket index. Buckets keep their index for the lifetime of a Reducer,
+// unless `initialize_buckets` is called again.
+class CommHookInterface {
+ public:
+  virtual ~CommHookInterface() {}
+
+  virtual std::shared_ptr<ProcessGroup::Work> runHook(
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) = 0;
+};
+
+// Casts the bucket to fp16, allreduces it and casts it back. This halves the
+// communicated bytes at the cost of fp16 precision for the averaged gradients.
+class FP16CompressHook : public CommHookInterface {
+ public:
+  explicit FP16CompressHook(std::shared_ptr<ProcessGroup> process_group)
+      : process_group_(std::move(process_group)) {}
+
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+};
+
+// Sends only the `ratio` fraction of bucket elements with the largest
+// magnitude, as (index, value) pairs that are allgathered and summed.
+// Elements that are not sent are accumulated locally and added to the bucket
+// in the next iteration (error feedback), so no gradient is lost.
+class TopKCompressHook : public CommHookInterface {
+ public:
+  TopKCompressHook(std::shared_ptr<ProcessGroup> process_group, double ratio);
+
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+ private:
+  std::shared_ptr<ProcessGroup> process_group_;
+  const double ratio_;
+  // Bucket index -> elements that were not sent yet.
+  std::unordered_map<size_t, at::Tensor> residuals_;
+};
+
+// PowerSGD (Vogels et al., 2019) low-rank compression with error feedback.
+//
+// The bucket is viewed as an n x m matrix M and approximated by P Q^T,
+// where P is n x rank and Q is m x rank. One power iteration is run per
+// step, warm-started from the previous step's Q:
+//
+//   P = M Q, allreduce P, orthogonalize P, Q = M^T P, allreduce Q.
+//
+// The second allreduce runs when the bucket's work is waited on. Buckets too
+// small to benefit are allreduced uncompressed. `seed` must be the same on
+// all processes, as it is used to initialize Q identically everywhere.
+class PowerSGDHook : public CommHookInterface {
+ public:
+  PowerSGDHook(
+      std::shared_ptr<ProcessGroup> process_group,
+      int64_t rank,
+      uint64_t seed = 0);
+
+  std::shared_ptr<ProcessGroup::Work> runHook(
+      size_t bucket_index,
+      std::vector<at::Tensor>& tensors) override;
+
+ private:
+  struct State {
+    // Difference between the local gradients and their approximation.
+    at::Tensor error;
+    at::Tensor q;
+  };
+
+  std::shared_ptr<ProcessGroup> process_group_;
+  const int64_t rank_;
+  const uint64_t seed_;
+  std::unordered_map<size_t, State> states_;
+};
+
+} // namespace c10d
@@ -21,6 +21,7 @@
 
 #include <torch/csrc/Exceptions.h>
 #include <torch/csrc/distributed/c10d/comm.h>
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
 #include <torch/csrc/distributed/c10d/ddp.h>
 #include <torch/csrc/distributed/c10d/reducer.h>
 #include <torch/csrc/utils/object_ptr.h>
@@ -82,7 +83,41 @@ PyObject* c10d_init(PyObject* _unused) {
           [](::c10d::Reducer& reducer, const torch::autograd::Variable& output)
               -> void { reducer.prepare_for_backward({output}); },
           py::call_guard<py::gil_scoped_release>())
-      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats);
+      .def("get_backward_stats", &::c10d::Reducer::get_backward_stats)
+      .def(
+          "_register_comm_hook",
+          &::c10d::Reducer::register_comm_hook,
+          py::arg("hook"),
+          py::call_guard<py::gil_scoped_release>());
+
+  shared_ptr_class_<::c10d::CommHookInterface>(module, "_CommHookInterface");
+
+  py::class_<
+      ::c10d::FP16CompressHook,
+      ::c10d::CommHookInterface,
+      std::shared_ptr<::c10d::FP16CompressHook>>(module, "_FP16CompressHook")
+      .def(
+          py::init<std::shared_ptr<::c10d::ProcessGroup>>(),
+          py::arg("process_group"));
+
+  py::class_<
+      ::c10d::TopKCompressHook,
+      ::c10d::CommHookInterface,
+      std::shared_ptr<::c10d::TopKCompressHook>>(module, "_TopKCompressHook")
+      .def(
+          py::init<std::shared_ptr<::c10d::ProcessGroup>, double>(),
+          py::arg("process_group"),
+          py::arg("ratio"));
+
+  py::class_<
+      ::c10d::PowerSGDHook,
+      ::c10d::CommHookInterface,
+      std::shared_ptr<::c10d::PowerSGDHook>>(module, "_PowerSGDHook")
+      .def(
+          py::init<std::shared_ptr<::c10d::ProcessGroup>, int64_t, uint64_t>(),
+          py::arg("process_group"),
+          py::arg("rank"),
+          py::arg("seed") = 0);
 
   py::enum_<::c10d::ReduceOp>(module, "ReduceOp", R"(
 An enum-like class of available reduce operations: ``SUM``, ``PRODUCT``,
@@ -365,10 +365,25 @@ void Reducer::mark_bucket_ready(size_t bucket_index) {
       //
       tensors.push_back(replica.contents);
     }
-    bucket.work = process_group_->allreduce(tensors);
+    if (comm_hook_ && !bucket.expect_sparse_gradient) {
+      bucket.work = comm_hook_->runHook(next_bucket_, tensors);
+    } else {
+      bucket.work = process_group_->allreduce(tensors);
+    }
   }
 }
 
+void Reducer::register_comm_hook(std::shared_ptr<CommHookInterface> hook) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  AT_ASSERTM(
+      !expect_autograd_hooks_ && !require_finalize_,
+      "register_comm_hook must be called before the first backward pass.");
+  AT_ASSERTM(
+      comm_hook_ == nullptr,
+      "register_comm_hook can only be called once.");
+  comm_hook_ = std::move(hook);
+}
+
 void Reducer::initialize_buckets(
     std::vector<std::vector<size_t>> bucket_indices) {
   std::lock_guard<std::mutex> lock(mutex_);
@@ -9,6 +9,7 @@
 
 #include <c10d/ProcessGroup.hpp>
 #include <torch/csrc/autograd/function.h>
+#include <torch/csrc/distributed/c10d/comm_hooks.h>
 #include <torch/csrc/autograd/variable.h>
 
 namespace c10d {
@@ -47,6 +48,11 @@ class Reducer {
     return backward_stats_;
   }
 
+  // Registers a hook that replaces the allreduce of every dense bucket
+  // (see CommHookInterface). Sparse buckets are always allreduced.
+  // This can only be called once, before the first backward pass.
+  void register_comm_hook(std::shared_ptr<CommHookInterface> hook);
+
  protected:
   // Forward declaration.
   struct Bucket;
@@ -61,6 +67,7 @@ class Reducer {
   std::vector<std::vector<torch::autograd::Variable>> replicas_;
   std::shared_ptr<c10d::ProcessGroup> process_group_;
   std::vector<std::vector<bool>> expect_sparse_gradients_;
+  std::shared_ptr<CommHookInterface> comm_hook_;
 
   std::vector<std::vector<std::shared_ptr<torch::autograd::Node>>>
       grad_accumulators_;
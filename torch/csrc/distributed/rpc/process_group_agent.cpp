@@ -3,52 +3,101 @@
 
 #include <Python.h>
 
+#include <unordered_map>
+
 namespace torch {
 namespace distributed {
 namespace rpc {
 
 namespace {
 
-// Write the message into the given ostream
-void serialize(const Message& message, std::ostream& os) {
-  // We cast const void* to void* here because we need to create a tensor using
-  // that memory space. If is fine as that tensor stays function-local, and will
-  // not be modified during its lifetime.
-  auto payload = const_cast<void*>( // NOLINT
-      static_cast<const void*>(message.payload().data()));
-  auto payload_size = message.payload().size();
-
-  // getting tensor table from the message
-  std::vector<torch::Tensor> tensors = message.tensors();
-  // append payload as a tensor
-  tensors.push_back(torch::from_blob(payload, payload_size, {torch::kChar}));
-  // append id as a tensor
-  tensors.push_back(torch::tensor({message.id()}, {torch::kInt64}));
-
-  torch::save(tensors, os);
-}
-
-Message deserialize(MessageType type, std::istream& is) {
-  std::vector<torch::Tensor> tensors;
-
-  torch::load(tensors, is);
-
-  TORCH_CHECK(tensors.size() >= 2, "Failed to deserialize a message.");
-  auto idTensor = std::move(tensors.back());
-  tensors.pop_back();
-  auto payloadTensor = std::move(tensors.back());
-  tensors.pop_back();
-
-  int64_t id = idTensor.storage().data<int64_t>()[0];
-
-  std::vector<char> payload(payloadTensor.numel());
+// A message sent to rank dst is a sequence of buffers, all sent with tag dst:
+//   1. preamble: int64 tensor {srcRank, type, id, payloadSize, numTensors,
+//      headerSize}.
+//   2. header: int64 tensor of headerSize elements, containing numStorages,
+//      then {scalarType, numel} for every storage, then {storageIndex,
+//      requiresGrad, storageOffset, dim, sizes..., strides...} for every
+//      message tensor. Only sent if the message has tensors.
+//   3. payload: char tensor aliasing Message::payload(). Only sent if the
+//      payload is not empty.
+//   4. one buffer per storage with numel() > 0, holding the storage's data.
+// Message payloads and tensor storages are sent as-is rather than serialized
+// into one blob, and the receiver allocates each of them at its final
+// destination, so neither side copies them. Like torch::save, every storage
+// is sent once and whole, so tensors that share a storage, such as a tensor
+// and a view of it, still share it on the receiver.
+constexpr int64_t kPreambleSize = 6;
+
+// Builds the buffers to send for the given message. The returned tensors
+// alias the message's payload and storages, so the message must outlive the
+// sends.
+std::vector<torch::Tensor> toBuffers(const Message& message, int srcRank) {
+  const auto& payload = message.payload();
+  // one CPU tensor over each storage, which aliases it if it is on the CPU
+  std::vector<torch::Tensor> storages;
+  std::unordered_map<const c10::StorageImpl*, int64_t> storageIndices;
+  std::vector<int64_t> tensorHeader;
+  for (const auto& tensor : message.tensors()) {
+    TORCH_CHECK(
+        tensor.layout() == torch::kStrided,
+        "ProcessGroupAgent only supports sending dense tensors.");
+    const auto& storage = tensor.storage();
+    auto it = storageIndices.find(storage.unsafeGetStorageImpl());
+    if (it == storageIndices.end()) {
+      it = storageIndices
+               .emplace(storage.unsafeGetStorageImpl(), storages.size())
+               .first;
+      storages.push_back(
+          torch::empty({0}, tensor.options()).set_(storage).cpu());
+    }
+    tensorHeader.push_back(it->second);
+    tensorHeader.push_back(tensor.requires_grad());
+    tensorHeader.push_back(tensor.storage_offset());
+    tensorHeader.push_back(tensor.dim());
+    tensorHeader.insert(
+        tensorHeader.end(), tensor.sizes().begin(), tensor.sizes().end());
+    tensorHeader.insert(
+        tensorHeader.end(), tensor.strides().begin(), tensor.strides().end());
+  }
 
-  if (payloadTensor.numel() > 0) {
-    std::memcpy(
-        payload.data(), payloadTensor.storage().data(), payloadTensor.numel());
+  std::vector<int64_t> header;
+  if (!storages.empty()) {
+    header.push_back(storages.size());
+    for (const auto& storage : storages) {
+      header.push_back(static_cast<int64_t>(storage.scalar_type()));
+      header.push_back(storage.numel());
+    }
+    header.insert(header.end(), tensorHeader.begin(), tensorHeader.end());
   }
 
-  return Message(std::move(payload), std::move(tensors), type, id);
+  std::vector<torch::Tensor> buffers;
+  buffers.reserve(storages.size() + 3);
+  buffers.push_back(torch::tensor(
+      {(int64_t)srcRank,
+       (int64_t)message.type(),
+       message.id(),
+       (int64_t)payload.size(),
+       (int64_t)message.tensors().size(),
+       (int64_t)header.size()},
+      {torch::kLong}));
+  if (!header.empty()) {
+    buffers.push_back(torch::tensor(header, {torch::kLong}));
+  }
+  if (!payload.empty()) {
+    // We cast const void* to void* here because we need to create a tensor
+    // using that memory space. It is fine as the tensor is only read by the
+    // send, during which the message stays alive.
+    buffers.push_back(torch::from_blob(
+        const_cast<void*>(static_cast<const void*>(payload.data())), // NOLINT
+        payload.size(),
+        {torch::kChar}));
+  }
+  for (auto& storage : storages) {
+    if (storage.numel() > 0) {
+      buffers.push_back(std::move(storage));
+    }
+  }
+  return buffers;
 }
 
 } // namespace
@@ -214,36 +263,22 @@ void ProcessGroupAgent::enqueueSend(SendWork work) {
   // NB: this can be changed to use a native move capture when moved to C++14
   threadPool_.run(std::bind(
       [&](const SendWork& work) {
-        std::stringstream ss;
-        serialize(work.message_, ss);
-        std::string serializedPayload = ss.str();
-
-        std::vector<torch::Tensor> preamble = {torch::tensor(
-            {(int64_t)pg_->getRank(),
-             (int64_t)serializedPayload.length(),
-             (int64_t)work.message_.type()},
-            {torch::kLong})};
+        std::vector<torch::Tensor> buffers =
+            toBuffers(work.message_, pg_->getRank());
 
         // ProcessGroup is not thread-safe when sending with the same tag, hence
-        // the lock
+        // the lock. It also keeps the buffers of one message contiguous on
+        // the channel.
         std::vector<std::shared_ptr<c10d::ProcessGroup::Work>> pendingSends;
+        pendingSends.reserve(buffers.size());
         const auto& dst = work.to_.id_;
-        if (work.message_.isShutdown()) {
-          pendingSends.reserve(1);
-          std::lock_guard<std::mutex> guard(sendMutexes_[dst]);
-          pendingSends.emplace_back(
-              pg_->send(preamble, dst, dst /* channelTag */));
-        } else {
-          std::vector<torch::Tensor> payload = {torch::from_blob(
-              (void*)serializedPayload.c_str(),
-              serializedPayload.length(),
-              {torch::kChar})};
-          pendingSends.reserve(2);
+        {
           std::lock_guard<std::mutex> guard(sendMutexes_[dst]);
-          pendingSends.emplace_back(
-              pg_->send(preamble, dst, dst /* channelTag */));
-          pendingSends.emplace_back(
-              pg_->send(payload, dst, dst /* channelTag */));
+          for (auto& buffer : buffers) {
+            std::vector<torch::Tensor> tensors = {buffer};
+            pendingSends.emplace_back(
+                pg_->send(tensors, dst, dst /* channelTag */));
+          }
         }
         for (auto& pendingSend : pendingSends) {
           pendingSend->wait();
@@ -255,11 +290,7 @@ void ProcessGroupAgent::enqueueSend(SendWork work) {
 void ProcessGroupAgent::enqueueRecv(RecvWork work) {
   threadPool_.run(std::bind(
       [&](RecvWork& work) {
-        torch::Tensor& payload = work.payload_;
-        std::stringstream ss(std::string(
-            (char*)payload.storage().data<signed char>(), payload.numel()));
-
-        Message message = deserialize(work.type_, ss);
+        Message& message = work.message_;
 
         if (message.requiresResponse()) {
           send(work.from_, cb_(std::move(message)));
@@ -282,14 +313,18 @@ void ProcessGroupAgent::enqueueRecv(RecvWork work) {
 
 void ProcessGroupAgent::listenLoop() {
   while (true) {
-    // rank, tensor size, message type
-    std::vector<torch::Tensor> preamble = {torch::empty({3}, {torch::kInt64})};
+    // rank, message type, id, payload size, number of tensors, header size
+    std::vector<torch::Tensor> preamble = {
+        torch::empty({kPreambleSize}, {torch::kInt64})};
     pg_->recvAnysource(preamble, pg_->getRank())->wait();
     int64_t* preamble_items = preamble.front().storage().data<int64_t>();
 
     auto srcRank = preamble_items[0];
-    auto size = preamble_items[1];
-    MessageType type = MessageType(preamble_items[2]);
+    MessageType type = MessageType(preamble_items[1]);
+    auto id = preamble_items[2];
+    auto payloadSize = preamble_items[3];
+    auto numTensors = preamble_items[4];
+    auto headerSize = preamble_items[5];
 
     if (type == MessageType::SHUTDOWN) {
       // FIXME: This LOG also prints warnings no InitGoogleLogging() was invoked
@@ -300,10 +335,90 @@ void ProcessGroupAgent::listenLoop() {
       return;
     }
 
-    std::vector<torch::Tensor> tensors = {torch::empty({size}, {torch::kChar})};
-    pg_->recv(tensors, srcRank, pg_->getRank())->wait();
+    // the remaining buffers of the message come from srcRank, see toBuffers
+    auto recv = [&](torch::Tensor tensor) {
+      std::vector<torch::Tensor> tensors = {std::move(tensor)};
+      pg_->recv(tensors, srcRank, pg_->getRank())->wait();
+    };
+
+    std::vector<int64_t> header(headerSize);
+    if (headerSize > 0) {
+      recv(torch::from_blob(header.data(), {headerSize}, {torch::kInt64}));
+    }
+
+    // receive the payload in place, so it can be moved into the Message
+    std::vector<char> payload(payloadSize);
+    if (payloadSize > 0) {
+      recv(torch::from_blob(payload.data(), {payloadSize}, {torch::kChar}));
+    }
+
+    // receive every storage in place, then rebuild the tensors as views of
+    // them
+    size_t pos = 0;
+    auto next = [&]() {
+      TORCH_CHECK(pos < header.size(), "Malformed RPC message header.");
+      return header[pos++];
+    };
+    std::vector<torch::Tensor> storages;
+    if (numTensors > 0) {
+      const auto numStorages = next();
+      storages.reserve(numStorages);
+      for (int64_t i = 0; i < numStorages; ++i) {
+        const auto scalarType = static_cast<torch::ScalarType>(next());
+        const auto numel = next();
+        storages.push_back(torch::empty({numel}, {scalarType}));
+      }
+      for (auto& storage : storages) {
+        if (storage.numel() > 0) {
+          recv(storage);
+        }
+      }
+    }
+
+    std::vector<torch::Tensor> tensors;
+    tensors.reserve(numTensors);
+    for (int64_t i = 0; i < numTensors; ++i) {
+      const auto storageIndex = next();
+      TORCH_CHECK(
+          storageIndex >= 0 && storageIndex < (int64_t)storages.size(),
+          "Malformed RPC message header.");
+      const auto& storage = storages[storageIndex];
+      const bool requiresGrad = next();
+      const auto storageOffset = next();
+      const auto dim = next();
+      TORCH_CHECK(
+          dim >= 0 && pos + 2 * dim <= header.size(),
+          "Malformed RPC message header.");
+      std::vector<int64_t> sizes(
+          header.begin() + pos, header.begin() + pos + dim);
+      pos += dim;
+      std::vector<int64_t> strides(
+          header.begin() + pos, header.begin() + pos + dim);
+      pos += dim;
+
+      // the tensor must lie within its storage
+      int64_t extent = 1;
+      for (int64_t d = 0; d < dim; ++d) {
+        if (sizes[d] == 0) {
+          extent = 0;
+          break;
+        }
+        extent += (sizes[d] - 1) * strides[d];
+      }
+      TORCH_CHECK(
+          storageOffset >= 0 && storageOffset + extent <= storage.numel(),
+          "Malformed RPC message header.");
+
+      torch::Tensor tensor = torch::empty({0}, storage.options())
+                                 .set_(storage.storage(), storageOffset,
+                                       sizes, strides);
+      tensor.set_requires_grad(requiresGrad);
+      tensors.push_back(std::move(tensor));
+    }
 
-    enqueueRecv(RecvWork(workerIds_[srcRank], type, std::move(tensors[0])));
+    enqueueRecv(RecvWork(
+        workerIds_[srcRank],
+        Message(std::move(payload), std::move(tensors), type, id)));
   }
 }
 
@@ -23,15 +23,14 @@ struct SendWork {
   Message message_;
 };
 
-// SendWork wraps a Message and RecvWork wraps a Tensor. The difference here is
-// to allow us to run serialization/deserialization in the worker threads.
+// RecvWork wraps a Message that has already been received, so that it can be
+// processed in the worker threads.
 struct RecvWork {
-  RecvWork(const WorkerId& from, MessageType type, torch::Tensor&& payload)
-      : from_(from), type_(type), payload_(payload) {}
+  RecvWork(const WorkerId& from, Message&& message)
+      : from_(from), message_(std::move(message)) {}
 
   const WorkerId& from_;
-  const MessageType type_;
-  torch::Tensor payload_;
+  Message message_;
 };
 
 class ProcessGroupAgent : public RpcAgent {
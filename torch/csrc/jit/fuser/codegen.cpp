@@ -286,6 +286,164 @@ static std::string encodeRHS(const Node* n) {
   }
 }
 
+// Writes "simple mappable" ops for the vectorized loop of CPU kernels, in
+// which every value is a Vec (an at::vec256::Vec256 of the kernel's scalar
+// type). Only ops whose vectorized form computes exactly what encodeRHS()
+// computes are listed, so the vectorized loop and the scalar tail agree.
+static c10::optional<std::string> encodeVecRHS(const Node* n) {
+  static std::unordered_map<NodeKind, const char*> vec_map_ops = {
+      // unary
+      {aten::abs, "${0}.abs()"},
+      {aten::sigmoid, "Vec(1) / (Vec(1) + ${0}.neg().exp())"},
+      {aten::relu, "Vec::blendv(${0}, Vec(0), ${0} < Vec(0))"},
+      {aten::threshold, "Vec::blendv(${0}, ${2}, ${0} <= ${1})"},
+      {aten::log, "${0}.log()"},
+      {aten::log10, "${0}.log10()"},
+      {aten::log1p, "${0}.log1p()"},
+      {aten::log2, "${0}.log2()"},
+      {aten::lgamma, "${0}.lgamma()"},
+      {aten::exp, "${0}.exp()"},
+      {aten::expm1, "${0}.expm1()"},
+      {aten::erf, "${0}.erf()"},
+      {aten::erfc, "${0}.erfc()"},
+      {aten::cos, "${0}.cos()"},
+      {aten::acos, "${0}.acos()"},
+      {aten::cosh, "${0}.cosh()"},
+      {aten::sin, "${0}.sin()"},
+      {aten::asin, "${0}.asin()"},
+      {aten::sinh, "${0}.sinh()"},
+      {aten::tan, "${0}.tan()"},
+      {aten::atan, "${0}.atan()"},
+      {aten::tanh, "${0}.tanh()"},
+      {aten::sqrt, "${0}.sqrt()"},
+      {aten::rsqrt, "${0}.rsqrt()"},
+      {aten::ceil, "${0}.ceil()"},
+      {aten::floor, "${0}.floor()"},
+      {aten::trunc, "${0}.trunc()"},
+      {aten::frac, "${0}.frac()"},
+      {aten::reciprocal, "${0}.reciprocal()"},
+      {aten::neg, "${0}.neg()"},
+      // binary
+      {aten::atan2, "${0}.atan2(${1})"},
+      {aten::addcmul, "${0} + ${3} * ${1} * ${2}"},
+      {aten::div, "${0} / ${1}"},
+      {aten::lerp, "${0} + ${2} * (${1} - ${0})"},
+      {aten::type_as, "${0}"},
+      {aten::mul, "${0} * ${1}"},
+      {aten::pow, "${0}.pow(${1})"},
+      // alpha
+      {aten::add, "${0} + ${2} * ${1}"},
+      {aten::sub, "${0} - ${2} * ${1}"},
+      // simple derivatives
+      {aten::_sigmoid_backward, "${0} * ${1} * (Vec(1) - ${1})"},
+      {aten::_tanh_backward, "${0} * (Vec(1) - ${1} * ${1})"},
+  };
+
+  const auto it = vec_map_ops.find(n->kind());
+  if (it == vec_map_ops.end()) {
+    return c10::nullopt;
+  }
+  TemplateEnv env;
+  size_t i = 0;
+  for (auto in : n->inputs()) {
+    env.s(std::to_string(i++), valueName(in));
+  }
+  return format(it->second, env);
+}
+
+static bool isVectorizableTensor(
+    const TensorDesc& desc,
+    const at::ScalarType scalar_type) {
+  // Contiguous tensors are collapsed to one dimension, so their offset is
+  // the linear index
+  return desc.scalar_type == scalar_type && desc.nDim() == 1 &&
+      desc.lastIsContiguous();
+}
+
+static bool isVectorizableScalar(const Value* v) {
+  const auto kind = v->type()->kind();
+  return kind == TypeKind::IntType || kind == TypeKind::FloatType;
+}
+
+// Writes the body of the vectorized loop of a CPU kernel, or returns false if
+// the kernel cannot be vectorized: all tensors must be contiguous float or
+// double tensors of the same type, and all ops must have a vectorized form.
+static bool emitVectorizedBody(
+    std::ostream& out,
+    const Graph& graph,
+    const std::vector<std::pair<const Value*, const c10::optional<TensorDesc>>>& inputs,
+    const std::vector<std::pair<const Value*, const TensorDesc>>& outputs,
+    at::ScalarType& scalar_type) {
+  if (outputs.empty()) {
+    return false;
+  }
+  scalar_type = outputs[0].second.scalar_type;
+  if (scalar_type != at::kFloat && scalar_type != at::kDouble) {
+    return false;
+  }
+
+  TemplateEnv env;
+  env.s("scalar_type", scalarTypeName(scalar_type));
+  size_t formal_count = 0;
+  for (const auto& input : inputs) {
+    env.s("node", valueName(input.first));
+    env.d("formal", formal_count++);
+    if (input.second.has_value()) {
+      if (!isVectorizableTensor(*input.second, scalar_type)) {
+        return false;
+      }
+      out << format("Vec ${node} = Vec::loadu(t${formal}.data + linearIndex);\n", env);
+    } else {
+      if (!isVectorizableScalar(input.first)) {
+        return false;
+      }
+      out << format("Vec ${node} = Vec(static_cast<${scalar_type}>(s${formal}));\n", env);
+    }
+  }
+
+  for (const auto& n : graph.nodes()) {
+    if (n->kind() == prim::FusedConcat)
+      continue;
+    if (n->kind() == prim::ConstantChunk)
+      continue;
+    if (n->mustBeNone())
+      continue;
+    env.s("node", valueName(n->output()));
+    if (n->kind() == prim::Constant) {
+      const auto val = toIValue(n->output()).value();
+      if (val.isDouble()) {
+        env.s("rhs", scalarValue(val.toDouble()));
+      } else if (val.isInt()) {
+        env.s("rhs", scalarValue(val.toInt()));
+      } else {
+        return false;
+      }
+      out << format("Vec ${node} = Vec(static_cast<${scalar_type}>(${rhs}));\n", env);
+      continue;
+    }
+    const auto type = n->output()->type()->cast<TensorType>();
+    if (!type || type->scalarType() != scalar_type) {
+      return false;
+    }
+    const auto rhs = encodeVecRHS(n);
+    if (!rhs) {
+      return false;
+    }
+    env.s("rhs", *rhs);
+    out << format("Vec ${node} = ${rhs};\n", env);
+  }
+
+  for (const auto& output : outputs) {
+    if (!isVectorizableTensor(output.second, scalar_type)) {
+      return false;
+    }
+    env.d("formal", formal_count++);
+    env.s("node", valueName(output.first));
+    out << format("${node}.store(t${formal}.data + linearIndex);\n", env);
+  }
+  return true;
+}
+
 static void emitIndexingFor(
     std::ostream& out,
     const std::string& tensor,
@@ -506,6 +664,22 @@ std::string generateKernel(
     env.s("RandInit", "");
   }
 
+  // Vectorizes the CPU kernel if possible
+  // Note: the scalar loop computes the elements the vectorized loop leaves
+  //  over, or all of them if the vectorized loop is not compiled.
+  env.s("VecHeader", "");
+  env.s("vectorizedLoop", "");
+  if (!use_cuda) {
+    std::stringstream vec_body;
+    at::ScalarType vec_scalar_type = at::ScalarType::Undefined;
+    if (emitVectorizedBody(vec_body, graph, inputs, outputs, vec_scalar_type)) {
+      env.s("vec_scalar_type", scalarTypeName(vec_scalar_type));
+      env.s("vecBody", vec_body.str());
+      env.s("VecHeader", cpu::vec256_support_literal);
+      env.s("vectorizedLoop", cpu::cpu_vectorized_loop_template.format(env));
+    }
+  }
+
   // Insantiates the CUDA or CPU-specific templates
   env.s("tensorOffsets", tensorOffsets.str());
   env.s("kernelBody", body.str());
@@ -0,0 +1,236 @@
+#include <torch/csrc/jit/fuser/cpu/disk_cache.h>
+
+#ifndef _WIN32
+#include <torch/csrc/jit/fuser/cpu/temp_file.h>
+
+#include <dirent.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+#include <vector>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cpu {
+
+#ifdef _WIN32
+
+KernelDiskCache* KernelDiskCache::get() {
+  return nullptr;
+}
+
+std::unique_ptr<KernelDiskCache> KernelDiskCache::fromEnvironment() {
+  return nullptr;
+}
+
+KernelDiskCache::KernelDiskCache(std::string dir, uint64_t max_bytes)
+    : dir_(std::move(dir)), max_bytes_(max_bytes) {}
+
+std::string KernelDiskCache::tempTemplate(const std::string& suffix) const {
+  return dir_ + "\\tmp-XXXXXX" + suffix;
+}
+
+c10::optional<std::string> KernelDiskCache::lookup(const std::string& key) {
+  return c10::nullopt;
+}
+
+bool KernelDiskCache::insert(
+    const std::string& key,
+    const std::string& so_file) {
+  return false;
+}
+
+void KernelDiskCache::evict() {}
+
+#else
+
+namespace {
+
+constexpr uint64_t kDefaultMaxBytes = 256 * 1024 * 1024;
+// Temporary files older than this were left behind by a process that died
+// while compiling.
+constexpr time_t kStaleTempSeconds = 24 * 60 * 60;
+static const std::string temp_prefix = "tmp-";
+
+// 128-bit FNV-1a, as two 64-bit hashes with different offset bases. Lookups
+// compare the full key, so the hash only has to spread entries out.
+std::string hashKey(const std::string& key) {
+  uint64_t h1 = 14695981039346656037ULL;
+  uint64_t h2 = 0x6c62272e07bb0142ULL;
+  for (unsigned char c : key) {
+    h1 = (h1 ^ c) * 1099511628211ULL;
+    h2 = (h2 ^ c) * 1099511628211ULL;
+  }
+  char buf[33];
+  snprintf(
+      buf,
+      sizeof(buf),
+      "%016llx%016llx",
+      static_cast<unsigned long long>(h1),
+      static_cast<unsigned long long>(h2));
+  return buf;
+}
+
+// mkdir -p
+bool makeDirs(const std::string& path) {
+  for (size_t pos = path.find('/', 1);; pos = path.find('/', pos + 1)) {
+    const std::string prefix = path.substr(0, pos);
+    if (mkdir(prefix.c_str(), 0755) != 0 && errno != EEXIST) {
+      return false;
+    }
+    if (pos == std::string::npos) {
+      break;
+    }
+  }
+  struct stat st;
+  return stat(path.c_str(), &st) == 0 && S_ISDIR(st.st_mode);
+}
+
+bool readFile(const std::string& path, std::string& contents) {
+  std::ifstream file(path, std::ios::in | std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  std::stringstream ss;
+  ss << file.rdbuf();
+  contents = ss.str();
+  return true;
+}
+
+bool endsWith(const std::string& str, const std::string& suffix) {
+  return str.size() >= suffix.size() &&
+      str.compare(str.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+KernelDiskCache* KernelDiskCache::get() {
+  // Leaked on purpose: kernels may be compiled during static destruction.
+  static KernelDiskCache* cache = fromEnvironment().release();
+  return cache;
+}
+
+std::unique_ptr<KernelDiskCache> KernelDiskCache::fromEnvironment() {
+  const char* dir = getenv("PYTORCH_FUSER_CACHE_DIR");
+  if (!dir || !*dir || !makeDirs(dir)) {
+    return nullptr;
+  }
+  const char* max_env = getenv("PYTORCH_FUSER_CACHE_MAX_BYTES");
+  const uint64_t max_bytes =
+      max_env ? std::strtoull(max_env, nullptr, 10) : kDefaultMaxBytes;
+  return std::unique_ptr<KernelDiskCache>(new KernelDiskCache(dir, max_bytes));
+}
+
+KernelDiskCache::KernelDiskCache(std::string dir, uint64_t max_bytes)
+    : dir_(std::move(dir)), max_bytes_(max_bytes) {}
+
+std::string KernelDiskCache::tempTemplate(const std::string& suffix) const {
+  return dir_ + "/" + temp_prefix + "XXXXXX" + suffix;
+}
+
+c10::optional<std::string> KernelDiskCache::lookup(const std::string& key) {
+  const std::string base = dir_ + "/" + hashKey(key);
+  std::string stored_key;
+  if (!readFile(base + ".key", stored_key) || stored_key != key) {
+    return c10::nullopt;
+  }
+  const std::string so_file = base + ".so";
+  // Refreshing the modification time makes eviction least recently used.
+  if (utimes(so_file.c_str(), nullptr) != 0) {
+    return c10::nullopt;
+  }
+  return so_file;
+}
+
+bool KernelDiskCache::insert(
+    const std::string& key,
+    const std::string& so_file) {
+  const std::string base = dir_ + "/" + hashKey(key);
+  // The key is published first, so a visible .so always has its key.
+  {
+    TempFile key_file(tempTemplate(".key"), 4);
+    key_file.write(key);
+    key_file.sync();
+    if (link(key_file.name().c_str(), (base + ".key").c_str()) != 0) {
+      // Another process published the same entry first, or the hash
+      // collides with another key that keeps its slot.
+      std::string stored_key;
+      if (errno != EEXIST || !readFile(base + ".key", stored_key) ||
+          stored_key != key) {
+        return false;
+      }
+    }
+  }
+  if (link(so_file.c_str(), (base + ".so").c_str()) != 0 && errno != EEXIST) {
+    return false;
+  }
+  evict();
+  return true;
+}
+
+void KernelDiskCache::evict() {
+  struct Entry {
+    std::string base;
+    time_t mtime;
+    uint64_t size;
+  };
+  std::vector<Entry> entries;
+  uint64_t total_bytes = 0;
+  const time_t now = time(nullptr);
+
+  DIR* dir = opendir(dir_.c_str());
+  if (dir == nullptr) {
+    return;
+  }
+  while (struct dirent* entry = readdir(dir)) {
+    const std::string name = entry->d_name;
+    const std::string path = dir_ + "/" + name;
+    struct stat st;
+    if (stat(path.c_str(), &st) != 0 || !S_ISREG(st.st_mode)) {
+      continue;
+    }
+    if (name.compare(0, temp_prefix.size(), temp_prefix) == 0) {
+      if (now - st.st_mtime > kStaleTempSeconds) {
+        unlink(path.c_str());
+      }
+    } else if (endsWith(name, ".so")) {
+      entries.push_back(
+          {path.substr(0, path.size() - 3), st.st_mtime, (uint64_t)st.st_size});
+      total_bytes += st.st_size;
+    }
+  }
+  closedir(dir);
+
+  if (total_bytes <= max_bytes_) {
+    return;
+  }
+  std::sort(entries.begin(), entries.end(), [](const Entry& a, const Entry& b) {
+    return a.mtime < b.mtime;
+  });
+  // Processes that have already loaded an evicted library keep using it.
+  for (const auto& entry : entries) {
+    if (total_bytes <= max_bytes_) {
+      break;
+    }
+    unlink((entry.base + ".so").c_str());
+    unlink((entry.base + ".key").c_str());
+    total_bytes -= entry.size;
+  }
+}
+
+#endif // _WIN32
+
+} // namespace cpu
+} // namespace fuser
+} // namespace jit
+} // namespace torch
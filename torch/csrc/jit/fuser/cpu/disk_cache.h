@@ -0,0 +1,73 @@
+#pragma once
+
+#include <c10/util/Optional.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/utils/disallow_copy.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+namespace torch {
+namespace jit {
+namespace fuser {
+namespace cpu {
+
+// A persistent cache of compiled CPU kernels, shared by all processes that
+// use the same cache directory.
+//
+// Entries are content-addressed: a key (the generated source plus everything
+// that affects how it is compiled) is hashed into a file name, and the cache
+// holds <hash>.so together with <hash>.key, which stores the full key so that
+// hash collisions are detected on lookup. Files are only ever published into
+// the directory with link(), which fails instead of replacing an existing
+// entry, so concurrent processes never observe partially written entries.
+//
+// The cache is configured through the environment:
+//   PYTORCH_FUSER_CACHE_DIR: cache directory, created if needed. The cache
+//     is off unless this is set to a non-empty path.
+//   PYTORCH_FUSER_CACHE_MAX_BYTES: upper bound on the size of the cached
+//     libraries, 256 MiB by default. The least recently used entries are
+//     evicted when it is exceeded.
+//
+// The cache is not available on Windows.
+struct TORCH_API KernelDiskCache {
+  TH_DISALLOW_COPY_AND_ASSIGN(KernelDiskCache);
+
+  // Returns the cache configured by the environment, or nullptr if it is
+  // disabled or its directory cannot be created.
+  static KernelDiskCache* get();
+
+  // Creates a cache as configured by the current environment, or returns
+  // nullptr if it is disabled. get() calls this once.
+  static std::unique_ptr<KernelDiskCache> fromEnvironment();
+
+  KernelDiskCache(std::string dir, uint64_t max_bytes);
+
+  const std::string& dir() const {
+    return dir_;
+  }
+
+  // A mkstemps template for temporary files in dir(), such as libraries
+  // that are compiled to be inserted.
+  std::string tempTemplate(const std::string& suffix) const;
+
+  // Returns the path of the library cached for `key`, if any.
+  c10::optional<std::string> lookup(const std::string& key);
+
+  // Publishes the library at `so_file`, which must live in dir(), as the
+  // entry for `key`. The file itself is left in place. Returns false if the
+  // entry could not be added.
+  bool insert(const std::string& key, const std::string& so_file);
+
+ private:
+  void evict();
+
+  const std::string dir_;
+  const uint64_t max_bytes_;
+};
+
+} // namespace cpu
+} // namespace fuser
+} // namespace jit
+} // namespace torch
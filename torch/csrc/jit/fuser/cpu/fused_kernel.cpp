@@ -1,15 +1,22 @@
 #include <torch/csrc/jit/fuser/cpu/fused_kernel.h>
+#include <ATen/Parallel.h>
+#include <ATen/native/DispatchStub.h>
 #include <c10/util/Exception.h>
 #include <c10/util/Optional.h>
 #include <torch/csrc/jit/code_template.h>
 #include <torch/csrc/jit/fuser/compiler.h>
+#include <torch/csrc/jit/fuser/cpu/disk_cache.h>
 #include <torch/csrc/jit/fuser/cpu/temp_file.h>
 #include <torch/csrc/utils/memory.h>
 
 #ifdef _MSC_VER
 #include <torch/csrc/jit/fuser/cpu/msvc_arch.h>
+#else
+#include <dlfcn.h>
+#include <sys/stat.h>
 #endif
 
+#include <array>
 #include <cstdlib>
 #include <iostream>
 #include <sstream>
@@ -166,6 +173,40 @@ intptr_t run(const std::string& cmd) {
 }
 #endif
 
+#ifndef _MSC_VER
+// Returns the directory of the ATen headers that were installed along with
+// this library, i.e. <prefix>/include for <prefix>/lib/libtorch.so, or the
+// directory in PYTORCH_FUSER_INCLUDE_DIR. Returns an empty string if the
+// headers cannot be found.
+static std::string getATenIncludeDir() {
+  std::string include_dir;
+  const char* include_env = getenv("PYTORCH_FUSER_INCLUDE_DIR");
+  if (include_env != nullptr) {
+    include_dir = include_env;
+  } else {
+    Dl_info info;
+    if (dladdr(reinterpret_cast<void*>(&getATenIncludeDir), &info) == 0 ||
+        info.dli_fname == nullptr) {
+      return "";
+    }
+    const std::string library = info.dli_fname;
+    const auto lib_dir_end = library.rfind('/');
+    const auto prefix_end = lib_dir_end == std::string::npos || lib_dir_end == 0
+        ? std::string::npos
+        : library.rfind('/', lib_dir_end - 1);
+    if (prefix_end == std::string::npos) {
+      return "";
+    }
+    include_dir = library.substr(0, prefix_end) + "/include";
+  }
+  struct stat st;
+  if (stat((include_dir + "/ATen/cpu/vec256/vec256_base.h").c_str(), &st) != 0) {
+    return "";
+  }
+  return include_dir;
+}
+#endif
+
 // A single compiler config is accessed through getConfig() (below)
 // Controls compilation options and may be updated based on the result
 // of compilation attempts.
@@ -183,18 +224,33 @@ struct CompilerConfig {
     if (!programExists(cxx)) {
       cxx = "";
     }
+
+#ifndef _MSC_VER
+    const std::string include_dir = getATenIncludeDir();
+    if (!include_dir.empty()) {
+      vec_flags = "-DFUSER_VEC256 -I\"" + include_dir + "\"";
+#if defined(__x86_64__) || defined(__i386__)
+      // the same check ATen uses to pick its AVX2 kernels, so
+      // ATEN_CPU_CAPABILITY applies to fused kernels too
+      if (at::native::get_cpu_capability() >= at::native::CPUCapability::AVX2) {
+        vec_flags += " -mavx2 -mfma";
+      }
+#endif
+    }
+#endif
   }
 
   ~CompilerConfig() = default;
 
   #ifdef _MSC_VER
     std::string cxx = "cl";
-    const std::string openmp_flags = "/openmp";
   #else
     std::string cxx = "g++";
-    const std::string openmp_flags = "-fopenmp";
   #endif
-  bool openmp = true;
+  // Flags that compile the vectorized loops of kernels, which use the ATen
+  // headers, including the target flags for AVX2 hosts. Empty if the
+  // headers cannot be found.
+  std::string vec_flags;
 };
 
 static CompilerConfig& getConfig() {
@@ -228,14 +284,14 @@ static const std::string arch_flags = getArchFlags();
 static const std::string compile_string =
     "cd /D \"" + temp_dir + "\" && "
     "${cxx} /nologo /MD /Ox " + arch_flags + " /LD /EHsc "
-    "${fopenmp} \"${cpp_file}\" /link /out:\"${so_file}\"";
+    "${vec_flags} \"${cpp_file}\" /link /out:\"${so_file}\"";
 #else
 static const std::string compile_string =
     "\"${cxx}\" -O3 -g "
 #ifndef __PPC64__
 //  "-march=native "
 #endif
-    "-std=c++11 -fPIC ${fopenmp} -shared \"${cpp_file}\" -o \"${so_file}\" -lm";
+    "-std=c++11 -fPIC ${vec_flags} -shared \"${cpp_file}\" -o \"${so_file}\" -lm";
 #endif
 static void runCompiler(
     const std::string& cpp_file,
@@ -243,7 +299,7 @@ static void runCompiler(
   auto& config = getConfig();
   TemplateEnv env;
   env.s("cxx", config.cxx);
-  env.s("fopenmp", config.openmp ? config.openmp_flags : "");
+  env.s("vec_flags", config.vec_flags);
   env.s("cpp_file", cpp_file);
   env.s("so_file", so_file);
   std::string result = format(compile_string, env);
@@ -252,10 +308,10 @@ static void runCompiler(
 #else
   int r = system(result.c_str());
 #endif
-  if (config.openmp && r != 0) {
+  if (!config.vec_flags.empty() && r != 0) {
     std::cerr
-        << "warning: pytorch jit fuser failed to compile with openmp, trying without it...\n";
-    config.openmp = false; // disable for future compiles
+        << "warning: pytorch jit fuser failed to compile with the ATen headers, trying without them...\n";
+    config.vec_flags = ""; // disable for future compiles
     return runCompiler(cpp_file, so_file);
   }
   TORCH_CHECK(r == 0, "Failed to compile a fused CPU kernel");
@@ -274,6 +330,95 @@ static void disas(const std::string& so_file) {
   AT_ASSERT(r == 0);
 }
 
+// Kernels that go through the disk cache are compiled under this symbol name
+// instead of their per-process kernel name, so that a fusion group generates
+// the same source in every process.
+static const std::string cached_kernel_name = "fused_cpu_kernel";
+
+static std::string replaceAll(
+    std::string str,
+    const std::string& from,
+    const std::string& to) {
+  for (size_t pos = str.find(from); pos != std::string::npos;
+       pos = str.find(from, pos + to.size())) {
+    str.replace(pos, from.size(), to);
+  }
+  return str;
+}
+
+static std::string compilerVersion() {
+  std::string version;
+#ifndef _MSC_VER
+  std::string cmd = "\"" + getConfig().cxx + "\" --version 2>&1";
+  FILE* pipe = popen(cmd.c_str(), "r");
+  if (pipe != nullptr) {
+    std::array<char, 128> buffer;
+    while (fgets(buffer.data(), buffer.size(), pipe) != nullptr) {
+      version += buffer.data();
+    }
+    pclose(pipe);
+  }
+#endif
+  return version;
+}
+
+// The disk cache key of a kernel: its source and everything that affects
+// how it is compiled.
+static std::string diskCacheKey(const std::string& code) {
+  static const std::string version = compilerVersion();
+  auto& config = getConfig();
+  std::stringstream key;
+  key << compile_string << "\n"
+      << config.cxx << "\n"
+      << version << "\n"
+      << config.vec_flags << "\n"
+      << code;
+  return key.str();
+}
+
+// Compiles code into a library created from so_tmpl and loads it. If a
+// cache is given, the library is also inserted into it.
+static std::unique_ptr<at::DynamicLibrary> compileAndLoad(
+    const std::string& code,
+    const std::string& so_tmpl,
+    const std::string& cpp_tmpl,
+    KernelDiskCache* cache = nullptr) {
+  TempFile so_file(so_tmpl, so_suffix_len);
+  TempFile cpp_file(cpp_tmpl, cpp_suffix_len);
+  cpp_file.write(code);
+  cpp_file.sync();
+#ifdef _MSC_VER
+  so_file.close();
+  cpp_file.close();
+#endif
+  runCompiler(cpp_file.name(), so_file.name());
+  if (debugFuser() >= 2)
+    disas(so_file.name());
+  if (cache) {
+    // the key is computed after compiling, as runCompiler may have dropped
+    // the vectorization flags
+    cache->insert(diskCacheKey(code), so_file.name());
+  }
+  return make_unique<at::DynamicLibrary>(so_file.name().c_str());
+}
+
+static std::unique_ptr<at::DynamicLibrary> loadWithDiskCache(
+    KernelDiskCache& cache,
+    const std::string& code) {
+  if (auto so_file = cache.lookup(diskCacheKey(code))) {
+    try {
+      return make_unique<at::DynamicLibrary>(so_file->c_str());
+    } catch (const c10::Error&) {
+      // the entry was evicted or is broken, compile the kernel again
+    }
+  }
+  return compileAndLoad(
+      code,
+      cache.tempTemplate(".so"),
+      cache.tempTemplate(".cpp"),
+      &cache);
+}
+
 FusedKernelCPU::FusedKernelCPU(
     std::string name,
     std::string code,
@@ -290,21 +435,17 @@ FusedKernelCPU::FusedKernelCPU(
           std::move(chunk_desc),
           std::move(concat_desc),
           has_random) {
-  TempFile so_file(so_template, so_suffix_len);
-  TempFile cpp_file(cpp_template, cpp_suffix_len);
-  cpp_file.write(code_);
-  cpp_file.sync();
-#ifdef _MSC_VER
-  so_file.close();
-  cpp_file.close();
-#endif
-  runCompiler(cpp_file.name(), so_file.name());
-  if (debugFuser() >= 2)
-    disas(so_file.name());
-  so_lib = make_unique<at::DynamicLibrary>(so_file.name().c_str());
+  std::string symbol = name_;
+  if (KernelDiskCache* cache = KernelDiskCache::get()) {
+    symbol = cached_kernel_name;
+    so_lib = loadWithDiskCache(
+        *cache, replaceAll(code_, name_, cached_kernel_name));
+  } else {
+    so_lib = compileAndLoad(code_, so_template, cpp_template);
+  }
 #pragma GCC diagnostic ignored "-Wpedantic"
-  kernel =
-      reinterpret_cast<void (*)(uint32_t, void**)>(so_lib->sym(name_.c_str()));
+  kernel = reinterpret_cast<void (*)(uint32_t, uint32_t, void**)>(
+      so_lib->sym(symbol.c_str()));
 #pragma GCC diagnostic pop
 }
 
@@ -327,6 +468,15 @@ static std::shared_ptr<FusedKernel> createFusionKernel(
       has_random);
 }
 
+void FusedKernelCPU::launch_raw(
+    const uint32_t numel,
+    std::vector<void*>& arguments) const {
+  at::parallel_for(
+      0, numel, at::internal::GRAIN_SIZE, [&](int64_t begin, int64_t end) {
+        kernel(begin, end, arguments.data());
+      });
+}
+
 RegisterFusionBackend reg(at::DeviceType::CPU, createFusionKernel);
 } // namespace cpu
 } // namespace fuser
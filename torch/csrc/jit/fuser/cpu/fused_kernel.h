@@ -29,14 +29,14 @@ struct TORCH_API FusedKernelCPU : public ::torch::jit::fuser::FusedKernel {
     return at::Backend::CPU;
   }
 
+  // Splits the elements into chunks that are computed in parallel
   void launch_raw(const uint32_t numel, std::vector<void*>& arguments)
-      const override {
-    kernel(numel, arguments.data());
-  }
+      const override;
 
  private:
   std::unique_ptr<at::DynamicLibrary> so_lib;
-  void (*kernel)(uint32_t, void**) = nullptr;
+  // Computes the elements [begin, end)
+  void (*kernel)(uint32_t, uint32_t, void**) = nullptr;
 };
 
 } // namespace cpu
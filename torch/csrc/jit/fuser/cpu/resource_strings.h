@@ -30,10 +30,34 @@ struct TensorInfo<T, 0> {
 };
 )");
 
+// The vectorized loop of a kernel is only compiled when the ATen headers are
+// available to the compiler, which defines FUSER_VEC256 in that case.
+// Kernels only include the generic Vec256 (the AVX specializations call
+// SLEEF, which they cannot link against); its fixed-width loops are turned
+// into AVX2 instructions by the compiler, which gets -mavx2 -mfma on hosts
+// that support them.
+static auto cpu_vectorized_loop_template = CodeTemplate(R"(
+#ifdef FUSER_VEC256
+using Vec = at::vec256::Vec256<${vec_scalar_type}>;
+const IndexTypeLoop vecSize = Vec::size();
+for (; linearIndex + vecSize <= ToIndexTypeLoop(end);
+     linearIndex += vecSize) {
+  ${vecBody}
+}
+#endif
+)");
+
+constexpr auto vec256_support_literal = R"(
+#ifdef FUSER_VEC256
+#include <ATen/cpu/vec256/vec256_base.h>
+#endif
+)";
+
 static auto cpu_compilation_unit_template = CodeTemplate(R"(
 #include <math.h>
 #include <cstddef>
 #include <cstdint>
+${VecHeader}
 
 double rsqrt(double x) {
   return 1.0/sqrt(x);
@@ -76,12 +100,12 @@ using int_same_size_t = typename int_of_size<sizeof(T)>::type;
 #define ToIndexTypeLoop(x) x
 #endif
 
-#define OMP_THRESHOLD 100000
-static void ${kernelName}_kernel(IndexType totalElements, ${formals}) {
-  #pragma omp parallel for if(totalElements > OMP_THRESHOLD)
-  for (IndexTypeLoop linearIndex = 0;
-        linearIndex < ToIndexTypeLoop(totalElements);
-        linearIndex += 1) {
+// Computes the elements [begin, end). The caller splits the elements into
+// chunks with at::parallel_for.
+static void ${kernelName}_kernel(IndexType begin, IndexType end, ${formals}) {
+  IndexTypeLoop linearIndex = ToIndexTypeLoop(begin);
+  ${vectorizedLoop}
+  for (; linearIndex < ToIndexTypeLoop(end); linearIndex += 1) {
       // Convert `linearIndex` into an offset of tensor:
       ${tensorOffsets}
       // calculate the results
@@ -96,8 +120,8 @@ static void ${kernelName}_kernel(IndexType totalElements, ${formals}) {
 #endif
 
 extern "C"
-JIT_API void ${kernelName}(IndexType totalElements, void ** args) {
-  ${kernelName}_kernel(totalElements ${,argument_loads});
+JIT_API void ${kernelName}(IndexType begin, IndexType end, void ** args) {
+  ${kernelName}_kernel(begin, end ${,argument_loads});
 }
 )");
 
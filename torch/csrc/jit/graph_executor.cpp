@@ -11,6 +11,7 @@
 #include <torch/csrc/jit/ir.h>
 #include <torch/csrc/jit/jit_log.h>
 #include <torch/csrc/jit/pass_manager.h>
+#include <torch/csrc/jit/passes/auto_fork.h>
 #include <torch/csrc/jit/passes/batch_mm.h>
 #include <torch/csrc/jit/passes/canonicalize_ops.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
@@ -498,6 +499,12 @@ struct GraphExecutorImpl : public GraphExecutorImplBase {
                                       : getOrCompileFallback();
   }
 
+  void setAutoFork(c10::optional<size_t> min_cost) override {
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    auto_fork_min_cost = min_cost;
+    plan_cache.clear();
+  }
+
   GraphExecutorState getDebugState() override {
     GraphExecutorState state;
     state.graph = graph.get();
@@ -600,6 +607,9 @@ struct GraphExecutorImpl : public GraphExecutorImplBase {
           autodiff_subgraph_inlining ? autodiffSubgraphInlineThreshold : 1);
     } else {
       runNondiffOptimization(opt_graph);
+      if (auto_fork_min_cost) {
+        AutoFork(opt_graph, *auto_fork_min_cost);
+      }
     }
     // Make sure there are no leftovers from any passes.
     EliminateDeadCode(opt_graph);
@@ -641,6 +651,10 @@ GraphExecutorState GraphExecutor::getDebugState() {
   return pImpl->getDebugState();
 }
 
+void GraphExecutor::setAutoFork(c10::optional<size_t> min_cost) {
+  pImpl->setAutoFork(min_cost);
+}
+
 void runRequiredPasses(const std::shared_ptr<Graph>& g) {
   specializeAutogradZero(*g);
   LowerGradOf(*g);
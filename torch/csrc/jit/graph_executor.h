@@ -46,6 +46,12 @@ struct TORCH_API GraphExecutor {
   std::shared_ptr<Graph> graph() const;
   GraphExecutorState getDebugState();
 
+  // Forks the independent parts of the plans compiled for inference (see
+  // passes/auto_fork.h) that cost at least `min_cost`; nullopt turns it off.
+  // Drops the plans compiled so far, so it must not be called while the
+  // executor runs. The profiling executor ignores it.
+  void setAutoFork(c10::optional<size_t> min_cost);
+
  private:
   std::shared_ptr<GraphExecutorImplBase> pImpl;
 };
@@ -66,6 +66,11 @@ struct GraphExecutorImplBase {
   virtual GraphExecutorState getDebugState() = 0;
   virtual ~GraphExecutorImplBase() = default;
 
+  virtual void setAutoFork(c10::optional<size_t> min_cost) {
+    std::lock_guard<std::mutex> lock(compile_mutex);
+    auto_fork_min_cost = min_cost;
+  }
+
  protected:
   friend struct GraphExecutor;
 
@@ -82,6 +87,9 @@ struct GraphExecutorImplBase {
   // GraphExecutors can be accessed from multiple threads, so this thread needs
   // to be held every time we access the fallback or plan_cache.
   std::mutex compile_mutex;
+
+  // Cost threshold of AutoFork, if it runs on the inference plans.
+  c10::optional<size_t> auto_fork_min_cost;
 };
 
 } // namespace jit
@@ -15,8 +15,10 @@
 #include "caffe2/serialize/file_adapter.h"
 #include "caffe2/serialize/inline_container.h"
 #include "caffe2/serialize/istream_adapter.h"
+#include "caffe2/serialize/mmap_file_adapter.h"
 
 #include <ATen/ATen.h>
+#include <ATen/Parallel.h>
 
 #include <fstream>
 #include <string>
@@ -28,11 +30,40 @@ namespace jit {
 
 using caffe2::serialize::FileAdapter;
 using caffe2::serialize::IStreamAdapter;
+using caffe2::serialize::MmapFileAdapter;
 using caffe2::serialize::PyTorchStreamReader;
 using caffe2::serialize::ReadAdapterInterface;
 
+bool& getLazyStorageLoading() {
+  static bool lazy_storage_loading = false;
+  return lazy_storage_loading;
+}
+
+bool& getMmapLoading() {
+  static bool mmap_loading = false;
+  return mmap_loading;
+}
+
 namespace {
 
+std::unique_ptr<ReadAdapterInterface> openFile(const std::string& filename) {
+  if (getMmapLoading()) {
+    return caffe2::make_unique<MmapFileAdapter>(filename);
+  }
+  return caffe2::make_unique<FileAdapter>(filename);
+}
+
+// reads one byte of every page in [data, data + size), so that the pages of
+// a record that aliases a mapped file are read in by the calling thread
+// rather than on first access.
+void touchPages(const void* data, size_t size) {
+  constexpr size_t kPageSize = 4096;
+  auto bytes = static_cast<const volatile char*>(data);
+  for (size_t i = 0; i < size; i += kPageSize) {
+    (void)bytes[i];
+  }
+}
+
 // this is a deserializer class which loads script modules from pt files. the
 // content of the file is written using PyTorchStreamWriter, for details please
 // check caffe2/serialize/inline_container.h. all the records except the last
@@ -53,6 +84,8 @@ class ScriptModuleDeserializer final {
 
  private:
   IValue readArchive(const std::string& archive_name);
+  std::unordered_map<std::string, at::DataPtr> prefetchRecords(
+      const std::string& archive_name);
   void importCallback(const std::string& qualifier);
 
   std::shared_ptr<script::CompilationUnit> compilation_unit_;
@@ -63,12 +96,42 @@ class ScriptModuleDeserializer final {
   std::string export_prefix_ = "code/";
 };
 
+// fetches every record of the archive's directory, i.e. all of its tensor
+// storages, in parallel on the intra-op thread pool.
+std::unordered_map<std::string, at::DataPtr> ScriptModuleDeserializer::
+    prefetchRecords(const std::string& archive_name) {
+  const std::string prefix = archive_name + "/";
+  std::vector<std::string> names;
+  for (const std::string& record : reader_->getAllRecords()) {
+    if (record.compare(0, prefix.size(), prefix) == 0) {
+      names.push_back(record.substr(prefix.size()));
+    }
+  }
+  std::vector<at::DataPtr> records(names.size());
+  at::parallel_for(
+      0, names.size(), /*grain_size=*/1, [&](int64_t begin, int64_t end) {
+        for (int64_t i = begin; i < end; ++i) {
+          at::DataPtr data;
+          size_t size;
+          std::tie(data, size) = reader_->getRecordNoCopy(prefix + names[i]);
+          touchPages(data.get(), size);
+          records[i] = std::move(data);
+        }
+      });
+  std::unordered_map<std::string, at::DataPtr> result;
+  for (size_t i = 0; i < names.size(); ++i) {
+    result.emplace(std::move(names[i]), std::move(records[i]));
+  }
+  return result;
+}
+
 IValue ScriptModuleDeserializer::readArchive(const std::string& archive_name) {
   std::stringstream picklename;
   picklename << archive_name << ".pkl";
   at::DataPtr pickle_ptr;
   size_t pickle_size;
-  std::tie(pickle_ptr, pickle_size) = reader_->getRecord(picklename.str());
+  std::tie(pickle_ptr, pickle_size) =
+      reader_->getRecordNoCopy(picklename.str());
 
   size_t bytes_read = 0;
   auto data = reinterpret_cast<const char*>(pickle_ptr.get());
@@ -88,10 +151,21 @@ IValue ScriptModuleDeserializer::readArchive(const std::string& archive_name) {
     return c10::StrongTypePtr(
         compilation_unit_, compilation_unit_->get_class(qn));
   };
+  std::unordered_map<std::string, at::DataPtr> prefetched;
+  if (!getLazyStorageLoading()) {
+    prefetched = prefetchRecords(archive_name);
+  }
   auto read_record = [&](const std::string& name) {
+    auto it = prefetched.find(name);
+    if (it != prefetched.end()) {
+      at::DataPtr data = std::move(it->second);
+      prefetched.erase(it);
+      return data;
+    }
     std::stringstream ss;
     ss << archive_name << "/" << name;
-    return std::get<0>(reader_->getRecord(ss.str()));
+    // tensor data aliases the file when it is mapped, see MmapFileAdapter
+    return std::get<0>(reader_->getRecordNoCopy(ss.str()));
   };
   Unpickler unpickler(
       reader, std::move(class_resolver), std::move(read_record), device_);
@@ -180,7 +254,7 @@ script::Module import_ir_module(
     const std::string& filename,
     c10::optional<at::Device> device,
     script::ExtraFilesMap& extra_files) {
-  auto reader = torch::make_unique<PyTorchStreamReader>(filename);
+  auto reader = torch::make_unique<PyTorchStreamReader>(openFile(filename));
   ScriptModuleDeserializer deserializer(std::move(cu), std::move(reader));
   return deserializer.deserialize(device, extra_files);
 }
@@ -209,8 +283,7 @@ script::Module load(
     const std::string& filename,
     c10::optional<at::Device> device,
     script::ExtraFilesMap& extra_files) {
-  std::unique_ptr<FileAdapter> rai = caffe2::make_unique<FileAdapter>(filename);
-  auto module = load(std::move(rai), device, extra_files);
+  auto module = load(openFile(filename), device, extra_files);
   return module;
 }
 
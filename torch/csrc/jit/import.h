@@ -16,6 +16,21 @@ namespace jit {
 
 static script::ExtraFilesMap default_extra_files;
 
+// By default, all tensor storages of a module are fetched in parallel on the
+// intra-op thread pool before the module is rebuilt. When lazy storage loading
+// is on, storages are fetched one by one as the unpickler reaches them, and
+// storages that alias a memory-mapped file (see `getMmapLoading`) are not
+// read at all: each page is only read from disk on first access.
+TORCH_API bool& getLazyStorageLoading();
+
+// When on, `load(filename)` and `import_ir_module(cu, filename)` map the file
+// with caffe2::serialize::MmapFileAdapter instead of reading it, and tensor
+// storages alias the mapping rather than holding a copy. Off by default: the
+// file must not be overwritten while any loaded tensor is alive (on Windows
+// it cannot be, as it stays open), and the private writable mapping is
+// charged against the commit limit for the whole file size.
+TORCH_API bool& getMmapLoading();
+
 TORCH_API script::Module import_ir_module(
     std::shared_ptr<script::CompilationUnit> cu,
     const std::string& filename,
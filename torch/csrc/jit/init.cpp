@@ -10,6 +10,8 @@
 #include <torch/csrc/jit/import.h>
 #include <torch/csrc/jit/irparser.h>
 #include <torch/csrc/jit/operator.h>
+#include <torch/csrc/jit/passes/auto_fork.h>
+#include <torch/csrc/jit/passes/batch_mm.h>
 #include <torch/csrc/jit/passes/canonicalize.h>
 #include <torch/csrc/jit/passes/canonicalize_ops.h>
 #include <torch/csrc/jit/passes/common_subexpression_elimination.h>
@@ -19,6 +21,7 @@
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/decompose_ops.h>
 #include <torch/csrc/jit/passes/erase_number_types.h>
+#include <torch/csrc/jit/passes/freeze_module.h>
 #include <torch/csrc/jit/passes/fuse_linear.h>
 #include <torch/csrc/jit/passes/graph_fuser.h>
 #include <torch/csrc/jit/passes/inline_fork_wait.h>
@@ -109,6 +112,13 @@ void initJITBindings(PyObject* module) {
       .def("_jit_pass_onnx_preprocess_caffe2", PreprocessCaffe2Ops)
       .def("_jit_pass_onnx", ToONNX)
       .def("_jit_pass_lower_all_tuples", LowerAllTuples)
+      .def(
+          "_jit_pass_auto_fork",
+          [](std::shared_ptr<Graph>& g, size_t min_cost) {
+            AutoFork(g, min_cost);
+          },
+          py::arg("graph"),
+          py::arg("min_cost") = 16)
       .def("_jit_pass_onnx_peephole", PeepholeOptimizeONNX)
       .def(
           "_jit_pass_onnx_cast_all_constant_to_floating",
@@ -180,6 +190,8 @@ void initJITBindings(PyObject* module) {
           [](std::shared_ptr<Graph>& g) { return QuantFusion(g); })
       .def("_jit_pass_fold_convbn", &FoldConvBatchNorm2d)
       .def("_jit_pass_fuse_linear", &FuseLinear)
+      .def("_jit_pass_freeze_module", &freeze_module)
+      .def("_jit_pass_fold_frozen_convbn", &FoldFrozenConvBatchNorm2d)
       .def("_jit_pass_fold_quantize",
            [](script::Module& module, const std::string& method_name) {
              FoldQuantizeCallIntoBuffer(module, method_name);
@@ -290,6 +302,7 @@ void initJITBindings(PyObject* module) {
       .def("_jit_pass_fixup_onnx_loops", FixupONNXLoops)
       .def("_jit_pass_canonicalize_ops", CanonicalizeOps)
       .def("_jit_pass_decompose_ops", DecomposeOps)
+      .def("_jit_pass_batch_mm", BatchMM)
       .def("_jit_pass_specialize_autogradzero", specializeAutogradZero)
       .def("_jit_override_can_fuse_on_cpu", &overrideCanFuseOnCPU)
       .def(
@@ -312,6 +325,18 @@ void initJITBindings(PyObject* module) {
       .def(
           "_jit_set_profiling_mode",
           [](bool profiling_flag) { getProfilingMode() = profiling_flag; })
+      .def(
+          "_jit_set_lazy_storage_loading",
+          [](bool enabled) { getLazyStorageLoading() = enabled; })
+      .def(
+          "_jit_get_lazy_storage_loading",
+          []() { return getLazyStorageLoading(); })
+      .def(
+          "_jit_set_mmap_loading",
+          [](bool enabled) { getMmapLoading() = enabled; })
+      .def(
+          "_jit_get_mmap_loading",
+          []() { return getMmapLoading(); })
       .def(
           "_jit_set_inline_everything_mode",
           [](bool enabled) { script::getInlineEverythingMode() = enabled; })
@@ -35,7 +35,11 @@ namespace jit {
   _(TAIL_CALL, "F") /* replace current frame with function F */             \
   _(INTERFACE_CALL, "CI") /* call method X on the first argument (of N) */  \
   _(GET_ATTR, "S") /* get attribute from slot X in an Object */             \
-  _(SET_ATTR, "S") /* set attribute to slot X in an Object */
+  _(SET_ATTR, "S") /* set attribute to slot X in an Object */             \
+  _(LOAD_OP, "OR") /* LOAD register N, then invoke operator X */            \
+  _(MOVE_OP, "OR") /* MOVE register N, then invoke operator X */            \
+  _(LOADC_OP, "OC") /* LOADC constant N, then invoke operator X */          \
+  _(OP_STORE, "OR") /* invoke operator X, then STORE register N */
 
 enum OpCode : uint8_t {
 #define DEFINE_OP(op, _) op,
@@ -4,6 +4,7 @@
 #include <ATen/core/ivalue.h>
 #include <c10/core/thread_pool.h>
 #include <c10/util/Exception.h>
+#include <c10/util/SmallVector.h>
 #include <torch/csrc/autograd/edge.h>
 #include <torch/csrc/autograd/grad_mode.h>
 #include <torch/csrc/autograd/variable.h>
@@ -19,6 +20,7 @@
 
 #include <exception>
 #include <iostream>
+#include <limits>
 #include <memory>
 #include <mutex>
 #include <ostream>
@@ -29,6 +31,18 @@
 #include <utility>
 #include <vector>
 
+// With computed goto (a GNU extension), each instruction ends with its own
+// indirect jump to the next one, which branch predictors handle better than
+// the single jump of a switch. Build with -DJIT_USE_COMPUTED_GOTO=0 to
+// compare against the switch.
+#ifndef JIT_USE_COMPUTED_GOTO
+#if defined(__GNUC__) || defined(__clang__)
+#define JIT_USE_COMPUTED_GOTO 1
+#else
+#define JIT_USE_COMPUTED_GOTO 0
+#endif
+#endif
+
 namespace torch {
 namespace jit {
 
@@ -387,7 +401,7 @@ struct CodeImpl {
     instructions_source_.emplace_back(current_node_);
 
     // check that we didn't accidentally emit nodes out of topological order
-    if (op == OP) {
+    if (invokesOperator(op)) {
       if (last_inserted_op_ != nullptr && current_node_ != last_inserted_op_ &&
           current_node_->owningBlock() == last_inserted_op_->owningBlock()) {
         TORCH_INTERNAL_ASSERT(
@@ -465,10 +479,42 @@ struct CodeImpl {
     }
   }
 
+  static bool invokesOperator(OpCode op) {
+    return op == OP || op == LOAD_OP || op == MOVE_OP || op == LOADC_OP ||
+        op == OP_STORE;
+  }
+
+  // Superinstructions: the last LOAD, MOVE or LOADC of the inputs of an
+  // operator is folded into its OP, and so is the STORE of its single output,
+  // which saves a dispatch each. Only instructions emitted for the same node
+  // are fused: the second one could otherwise be the target of a jump, like
+  // the STORE of the outputs of an if that follows the OP of its else block.
+  // The register or constant goes in N, so large indices are not fused.
+  bool canFuseWithLast(OpCode op) {
+    return !instructions_.empty() && instructions_.back().op == op &&
+        instructions_source_.back() == current_node_ &&
+        instructions_.back().X <= std::numeric_limits<uint16_t>::max();
+  }
+
+  void fuseWithLast(OpCode fused, int64_t X) {
+    int32_t N = instructions_.back().X;
+    truncateInstructions(instructions_.size() - 1);
+    insertInstruction(fused, X, N);
+  }
+
   void emitOperator(Node* node) {
     emitLoadInputs(node->inputs());
-    insertInstruction(OP, operator_table_.size());
+    int64_t op_index = operator_table_.size();
     operator_table_.emplace_back(getOperation(node));
+    if (canFuseWithLast(LOAD)) {
+      fuseWithLast(LOAD_OP, op_index);
+    } else if (canFuseWithLast(MOVE)) {
+      fuseWithLast(MOVE_OP, op_index);
+    } else if (canFuseWithLast(LOADC)) {
+      fuseWithLast(LOADC_OP, op_index);
+    } else {
+      insertInstruction(OP, op_index);
+    }
   }
 
   void emitWait(Node* node) {
@@ -487,7 +533,12 @@ struct CodeImpl {
     if (N == 0)
       return;
     int regs = allocRegs(node->outputs());
-    if (N == 1) {
+    if (N == 1 && regs <= std::numeric_limits<uint16_t>::max() &&
+        !instructions_.empty() && instructions_.back().op == OP &&
+        instructions_source_.back() == current_node_) {
+      instructions_.back().op = OP_STORE;
+      instructions_.back().N = regs;
+    } else if (N == 1) {
       insertInstruction(STORE, regs);
     } else {
       insertInstruction(STOREN, regs, node->outputs().size());
@@ -700,7 +751,7 @@ struct CodeImpl {
 
   void dump(std::ostream& out, size_t i) const {
     out << i << " " << instructions_[i];
-    if (instructions_[i].op == OP || instructions_[i].op == CALL) {
+    if (invokesOperator(instructions_[i].op) || instructions_[i].op == CALL) {
       out << " # " << *instructions_source_[i];
     } else {
       out << "\n";
@@ -737,7 +788,10 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
   // in the case where it is true, then the interpreter and this array get
   // copied if this every becomes a bottleneck then we _should_ consider
   // minimizing the total number or register
-  std::vector<IValue> registers;
+  //
+  // The registers and frames of small graphs live in the state itself, which
+  // saves allocations on each run.
+  c10::SmallVector<IValue, 32> registers;
 
   // A Frame captures function's state
   // (e.g. `pc` and `base_pointer`)
@@ -775,7 +829,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
           types(frame.function->type_table_.data()) {}
   };
 
-  std::vector<Frame> frames;
+  c10::SmallVector<Frame, 4> frames;
 
   c10::intrusive_ptr<InterpreterStateImpl> intrusive_from_this() {
     c10::raw::intrusive_ptr::incref(this);
@@ -827,60 +881,97 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
         // std::cout << "RUNNING ";
         // frames.back().function->dump(std::cout, af.pc);
         Instruction inst = af.instructions[af.pc];
+#if JIT_USE_COMPUTED_GOTO
+        static void* dispatch_table[] = {
+#define DISPATCH_LABEL(op, _) &&label_##op,
+            FORALL_OPCODES(DISPATCH_LABEL)
+#undef DISPATCH_LABEL
+        };
+#define INST(op) label_##op
+#define DISPATCH()           \
+  inst = af.instructions[af.pc]; \
+  goto* dispatch_table[inst.op]
+        goto* dispatch_table[inst.op];
+#else
+#define INST(op) case op
+#define DISPATCH() continue
         switch (inst.op) {
-          case OP:
+#endif
+          INST(OP):
+            af.operators[inst.X](stack);
+            ++af.pc;
+            DISPATCH();
+          INST(LOAD_OP):
+            stack.emplace_back(reg(inst.N));
+            af.operators[inst.X](stack);
+            ++af.pc;
+            DISPATCH();
+          INST(MOVE_OP):
+            stack.emplace_back(std::move(reg(inst.N)));
+            af.operators[inst.X](stack);
+            ++af.pc;
+            DISPATCH();
+          INST(LOADC_OP):
+            stack.emplace_back(af.constants[inst.N]);
+            af.operators[inst.X](stack);
+            ++af.pc;
+            DISPATCH();
+          INST(OP_STORE):
             af.operators[inst.X](stack);
+            reg(inst.N) = pop(stack);
             ++af.pc;
-            break;
-          case LOAD:
+            DISPATCH();
+          INST(LOAD):
             stack.emplace_back(reg(inst.X));
             ++af.pc;
-            break;
-          case MOVE:
+            DISPATCH();
+          INST(MOVE):
             stack.emplace_back(std::move(reg(inst.X)));
             ++af.pc;
-            break;
-          case STORE:
+            DISPATCH();
+          INST(STORE):
             reg(inst.X) = pop(stack);
             ++af.pc;
-            break;
-          case STOREN:
+            DISPATCH();
+          INST(STOREN):
             for (size_t i = inst.N; i > 0; --i) {
               reg(inst.X + i - 1) = pop(stack);
             }
             ++af.pc;
-            break;
-          case DROP:
+            DISPATCH();
+          INST(DROP):
             pop(stack);
             ++af.pc;
-            break;
-          case DROPR:
+            DISPATCH();
+          INST(DROPR):
             reg(inst.X) = IValue();
             ++af.pc;
-            break;
-          case LOADC:
+            DISPATCH();
+          INST(LOADC):
             stack.emplace_back(af.constants[inst.X]);
             ++af.pc;
-            break;
-          case GET_ATTR: {
+            DISPATCH();
+          INST(GET_ATTR): {
             auto userObj = pop(stack).toObject();
             auto value = userObj->getSlot(inst.X);
             push(stack, std::move(value));
             ++af.pc;
-          } break;
-          case SET_ATTR: {
+            DISPATCH();
+          }
+          INST(SET_ATTR): {
             auto v = pop(stack);
             auto userObj = pop(stack).toObject();
             userObj->setSlot(inst.X, std::move(v));
             ++af.pc;
-          } break;
-          case JF:
+            DISPATCH();
+          }
+          INST(JF):
             af.pc += (pop(stack).toBool()) ? 1 : inst.X;
-            break;
-          case JMP:
+            DISPATCH();
+          INST(JMP):
             af.pc += inst.X;
-            break;
-          case LOOP: {
+            DISPATCH();
+          INST(LOOP): {
             // stack: iteration_count, max_iter, cond, loop_carried_deps...
             auto frame = stack.end() - (inst.N + 1);
             int64_t trip_count = frame[0].toInt();
@@ -898,15 +989,17 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               drop(stack, 3); // iteration_count, max_iter, cond
               af.pc += inst.X;
             }
-          } break;
-          case CALL: {
+            DISPATCH();
+          }
+          INST(CALL): {
             const Code& code =
                 af.functions[inst.X]->get_executor().getPlanFor(stack).code;
             frames.back().pc = af.pc + 1;
             enterFrame(code, stack.size() - code.num_inputs());
             af = ActiveFrame(frames.back());
-          } break;
-          case INTERFACE_CALL: {
+            DISPATCH();
+          }
+          INST(INTERFACE_CALL): {
             // note the hash table lookup to find the function
             // this can be more optimized if necessary, caching parts
             // of the hashing computation or storing the offset when
@@ -919,12 +1012,13 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             frames.back().pc = af.pc + 1;
             enterFrame(code, stack.size() - inst.N);
             af = ActiveFrame(frames.back());
-          } break;
-          case RET:
+            DISPATCH();
+          }
+          INST(RET):
             if (frames.size() > 1) {
               leaveFrame();
               af = ActiveFrame(frames.back());
-              break;
+              DISPATCH();
             }
             if (future_) {
               auto num_outputs = frames.back().function->n_outputs;
@@ -936,7 +1030,7 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
               }
             }
             return false;
-          case WAIT: {
+          INST(WAIT): {
             auto future = stack.back().toFuture();
             if (!future->completed()) {
               getOrCreateFuture();
@@ -983,14 +1077,16 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             stack.pop_back();
             stack.emplace_back(future->value());
             ++af.pc;
-          } break;
-          case GUARD: {
+            DISPATCH();
+          }
+          INST(GUARD): {
             auto actual = TensorType::create(stack.back().toTensor());
             const TypePtr& expected = af.types[inst.X];
             push(stack, *expected == *actual);
             ++af.pc;
-          } break;
-          case TAIL_CALL: {
+            DISPATCH();
+          }
+          INST(TAIL_CALL): {
             af.functions[inst.X]->ensure_defined();
             const Code& code =
                 af.functions[inst.X]->get_executor().getPlanFor(stack).code;
@@ -1006,8 +1102,13 @@ struct InterpreterStateImpl : c10::intrusive_ptr_target {
             leaveFrame();
             enterFrame(code, base_pointer);
             af = ActiveFrame(frames.back());
-          } break;
+            DISPATCH();
+          }
+#if !JIT_USE_COMPUTED_GOTO
         }
+#endif
+#undef INST
+#undef DISPATCH
       }
     } catch (std::exception& e) {
       frames.back().pc = af.pc;
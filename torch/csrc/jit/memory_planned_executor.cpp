@@ -0,0 +1,222 @@
+#include <torch/csrc/jit/memory_planned_executor.h>
+
+#include <ATen/core/grad_mode.h>
+#include <c10/core/CPUAllocator.h>
+#include <torch/csrc/autograd/generated/variable_factories.h>
+#include <torch/csrc/jit/passes/alias_analysis.h>
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <algorithm>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// The out variant of a functional op takes the same arguments plus a
+// trailing `Tensor(a!) out`, e.g.
+//   aten::add.Tensor(Tensor self, Tensor other, *, Scalar alpha=1) -> Tensor
+//   aten::add.out(Tensor self, Tensor other, *, Scalar alpha=1, Tensor(a!) out) -> Tensor(a!)
+Operation findOutVariant(Node* n) {
+  const FunctionSchema* schema = n->maybeSchema();
+  if (!schema || schema->is_mutable() || schema->is_vararg() ||
+      n->outputs().size() != 1 ||
+      !n->output()->type()->isSubtypeOf(TensorType::get())) {
+    return nullptr;
+  }
+  const auto& args = schema->arguments();
+  for (const auto& op : getAllOperatorsFor(n->kind())) {
+    const FunctionSchema& out_schema = op->schema();
+    const auto& out_args = out_schema.arguments();
+    if (out_args.size() != args.size() + 1 || out_args.back().name() != "out" ||
+        !out_schema.is_mutable()) {
+      continue;
+    }
+    const bool same_args = std::equal(
+        args.begin(), args.end(), out_args.begin(),
+        [](const Argument& a, const Argument& b) {
+          return a.name() == b.name() && *a.type() == *b.type();
+        });
+    if (same_args) {
+      return op->getOperation(n);
+    }
+  }
+  return nullptr;
+}
+
+} // namespace
+
+MemoryPlannedExecutor::MemoryPlannedExecutor(std::shared_ptr<Graph> graph)
+    : graph_(std::move(graph)) {
+  std::unordered_map<const Value*, size_t> registers;
+  auto reg = [&](const Value* v) {
+    auto it = registers.find(v);
+    if (it != registers.end()) {
+      return it->second;
+    }
+    const size_t r = registers.size();
+    registers[v] = r;
+    return r;
+  };
+  for (Value* v : graph_->inputs()) {
+    input_registers_.push_back(reg(v));
+  }
+
+  AliasDb alias_db(graph_);
+  std::unordered_map<const Value*, size_t> last_use;
+  for (Node* n : graph_->nodes()) {
+    TORCH_CHECK(n->blocks().empty(),
+        "MemoryPlannedExecutor: graphs with control flow are not supported, found ",
+        n->kind().toQualString());
+    Step step;
+    step.node = n;
+    step.op = getOperation(n);
+    for (Value* v : n->inputs()) {
+      step.inputs.push_back(reg(v));
+      last_use[v] = steps_.size();
+    }
+    for (Value* v : n->outputs()) {
+      step.outputs.push_back(reg(v));
+    }
+    // Values that escape through the outputs must get memory of their own.
+    Operation out_op = findOutVariant(n);
+    if (out_op && alias_db.mayContainAlias({n->output()}, graph_->outputs())) {
+      out_op = nullptr;
+    }
+    out_ops_.push_back(std::move(out_op));
+    steps_.push_back(std::move(step));
+  }
+  for (Value* v : graph_->outputs()) {
+    output_registers_.push_back(reg(v));
+  }
+
+  // Release every other value after its last use, or right away if it is
+  // never used.
+  std::unordered_set<const Value*> outputs(
+      graph_->outputs().begin(), graph_->outputs().end());
+  for (const auto& e : last_use) {
+    if (!outputs.count(e.first)) {
+      steps_[e.second].frees.push_back(registers.at(e.first));
+    }
+  }
+  for (auto& step : steps_) {
+    for (Value* v : step.node->outputs()) {
+      if (!last_use.count(v) && !outputs.count(v)) {
+        step.frees.push_back(registers.at(v));
+      }
+    }
+  }
+  registers_.resize(registers.size());
+}
+
+void MemoryPlannedExecutor::run(Stack& stack) {
+  const size_t num_inputs = input_registers_.size();
+  TORCH_CHECK(stack.size() >= num_inputs,
+      "MemoryPlannedExecutor: expected ", num_inputs, " inputs but got ", stack.size());
+  for (size_t i = 0; i < num_inputs; i++) {
+    registers_[input_registers_[i]] = std::move(stack[stack.size() - num_inputs + i]);
+  }
+  drop(stack, num_inputs);
+
+  // Unplanned runs record the outputs of the steps with an out variant, to
+  // plan their memory afterwards.
+  std::vector<c10::optional<Profile>> profiles;
+  if (!planned_) {
+    profiles.resize(steps_.size());
+  }
+  bool fits = true;
+  for (size_t i = 0; i < steps_.size(); i++) {
+    Step& step = steps_[i];
+    stack_.clear();
+    for (size_t r : step.inputs) {
+      stack_.push_back(registers_[r]);
+    }
+    if (planned_ && step.slot) {
+      const at::Tensor& out = slots_[*step.slot];
+      void* slot_data = out.storage().data();
+      stack_.push_back(out);
+      out_ops_[i](stack_);
+      // A larger output than at planning time moved the slot out of the
+      // arena.
+      fits = fits && out.storage().data() == slot_data;
+    } else {
+      step.op(stack_);
+    }
+    for (size_t o = 0; o < step.outputs.size(); o++) {
+      registers_[step.outputs[o]] = std::move(stack_[o]);
+    }
+    if (!planned_ && out_ops_[i]) {
+      const c10::IValue& output = registers_[step.outputs[0]];
+      if (output.isTensor()) {
+        const at::Tensor& t = output.toTensor();
+        if (t.defined() && t.device().is_cpu() && t.layout() == at::kStrided &&
+            t.is_contiguous() && !t.requires_grad() && t.numel() > 0) {
+          profiles[i] = Profile{t.numel(), t.scalar_type()};
+        }
+      }
+    }
+    for (size_t r : step.frees) {
+      registers_[r] = c10::IValue();
+    }
+  }
+
+  for (size_t r : output_registers_) {
+    stack.push_back(registers_[r]);
+  }
+  for (size_t r : output_registers_) {
+    registers_[r] = c10::IValue();
+  }
+  for (size_t r : input_registers_) {
+    registers_[r] = c10::IValue();
+  }
+
+  if (!planned_) {
+    plan(profiles);
+  } else if (!fits) {
+    planned_ = false;
+  }
+}
+
+void MemoryPlannedExecutor::plan(const std::vector<c10::optional<Profile>>& profiles) {
+  std::vector<Value*> values;
+  std::unordered_map<const Value*, size_t> sizes;
+  for (size_t i = 0; i < steps_.size(); i++) {
+    if (profiles[i]) {
+      Value* v = steps_[i].node->output();
+      values.push_back(v);
+      sizes[v] = profiles[i]->numel * c10::elementSize(profiles[i]->dtype);
+    }
+  }
+  const MemoryPlan memory_plan = PackLiveRanges(ComputeLiveRanges(graph_, values), sizes);
+
+  slots_.clear();
+  at::Allocator* allocator = c10::GetCPUAllocator();
+  arena_ = allocator->allocate(memory_plan.arena_bytes);
+  arena_bytes_ = memory_plan.arena_bytes;
+  num_planned_ = values.size();
+  at::NoGradGuard no_grad;
+  for (size_t i = 0; i < steps_.size(); i++) {
+    steps_[i].slot = c10::nullopt;
+    if (!profiles[i]) {
+      continue;
+    }
+    // The slot's storage does not own its memory, but stays resizable so
+    // that larger outputs can still be written, out of the arena.
+    const Profile& profile = *profiles[i];
+    char* data = static_cast<char*>(arena_.get()) +
+        memory_plan.offsets.at(steps_[i].node->output());
+    c10::Storage storage(
+        c10::scalarTypeToTypeMeta(profile.dtype),
+        profile.numel,
+        at::DataPtr(data, at::Device(at::kCPU)),
+        allocator,
+        /*resizable=*/true);
+    steps_[i].slot = slots_.size();
+    slots_.push_back(torch::empty({0}, at::TensorOptions().dtype(profile.dtype)).set_(storage));
+  }
+  planned_ = true;
+}
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <ATen/core/stack.h>
+#include <c10/core/Allocator.h>
+#include <torch/csrc/WindowsTorchApiMacro.h>
+#include <torch/csrc/jit/ir.h>
+#include <torch/csrc/jit/operator.h>
+
+#include <memory>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// Runs a straight-line inference graph (no prim::If, prim::Loop or calls;
+// inline and freeze the graph first) with statically planned memory.
+//
+// The first run executes every node normally and records the size of every
+// Tensor intermediate produced by an op that has an out variant (e.g.
+// aten::add -> aten::add.out) and that does not escape through the graph
+// outputs. Those intermediates are then packed by live range into one arena
+// (see passes/memory_planning.h), and later runs call the out variants with
+// tensors over their slots of the arena, so that they do not allocate.
+// Intermediates are released after their last use, planned or not.
+//
+// If a later run produces a planned value larger than its slot (the input
+// shapes changed), the op resizes its output out of the arena as usual and
+// the next run records the sizes and plans again.
+//
+// An executor is not thread safe; use one per thread.
+struct TORCH_API MemoryPlannedExecutor {
+  explicit MemoryPlannedExecutor(std::shared_ptr<Graph> graph);
+
+  // Pops the graph inputs from `stack` and pushes the graph outputs.
+  void run(Stack& stack);
+
+  // Bytes of the arena of the current plan, 0 before the first run.
+  size_t arenaBytes() const {
+    return arena_bytes_;
+  }
+
+  // Number of intermediates placed in the arena by the current plan.
+  size_t numPlannedValues() const {
+    return num_planned_;
+  }
+
+ private:
+  struct Step {
+    Node* node;
+    Operation op;
+    std::vector<size_t> inputs;
+    std::vector<size_t> outputs;
+    // Registers that die after this step.
+    std::vector<size_t> frees;
+    // Index into slots_ of the planned output.
+    c10::optional<size_t> slot;
+  };
+
+  // What the first run recorded about a planned value.
+  struct Profile {
+    int64_t numel;
+    at::ScalarType dtype;
+  };
+
+  void plan(const std::vector<c10::optional<Profile>>& profiles);
+
+  std::shared_ptr<Graph> graph_;
+  std::vector<Step> steps_;
+  std::vector<size_t> input_registers_;
+  std::vector<size_t> output_registers_;
+  std::vector<c10::IValue> registers_;
+  Stack stack_;
+
+  // Out variants of the steps, indexed like steps_; empty for the steps
+  // that have none or whose output escapes.
+  std::vector<Operation> out_ops_;
+  bool planned_ = false;
+  at::DataPtr arena_;
+  size_t arena_bytes_ = 0;
+  size_t num_planned_ = 0;
+  // Tensors over the arena that the out variants write into.
+  std::vector<at::Tensor> slots_;
+};
+
+} // namespace jit
+} // namespace torch
@@ -325,6 +325,7 @@ void AliasDb::analyzeImpl(Node* node) {
     case prim::FusedConcat:
     case prim::MMTreeReduce:
     case prim::MMBatchSide:
+    case prim::BatchLinear:
     case prim::BroadcastSizes:
     case prim::ChunkSizes:
     case prim::Function:
@@ -1228,6 +1229,7 @@ bool aliasAnalysisHasSpecialCaseFor(Symbol symbol) {
       prim::GradOf,
       prim::MMTreeReduce,
       prim::MMBatchSide,
+      prim::BatchLinear,
       prim::BroadcastSizes,
       prim::ChunkSizes,
       prim::Function,
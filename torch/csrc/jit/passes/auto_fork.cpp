@@ -0,0 +1,381 @@
+#include <torch/csrc/jit/passes/auto_fork.h>
+
+#include <torch/csrc/jit/passes/alias_analysis.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+
+#include <algorithm>
+#include <set>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+// Calls `fn` on `n` and on every node nested in its blocks.
+void forEachNode(Node* n, const std::function<void(Node*)>& fn) {
+  fn(n);
+  for (Block* b : n->blocks()) {
+    for (Node* inner : b->nodes()) {
+      forEachNode(inner, fn);
+    }
+  }
+}
+
+// The values of the block of `n` that `n` or the nodes in its blocks use.
+std::vector<Value*> outerInputs(Node* n) {
+  Block* outer = n->owningBlock();
+  std::vector<Value*> inputs;
+  std::function<void(Node*)> visit = [&](Node* m) {
+    for (Value* v : m->inputs()) {
+      if (v->node()->owningBlock() == outer) {
+        inputs.push_back(v);
+      }
+    }
+    for (Block* b : m->blocks()) {
+      for (Node* inner : b->nodes()) {
+        visit(inner);
+      }
+      visit(b->return_node());
+    }
+  };
+  visit(n);
+  return inputs;
+}
+
+// The node of `block` that is, or contains, `n`.
+Node* ancestorIn(Node* n, Block* block) {
+  while (n->owningBlock() != block) {
+    n = n->owningBlock()->owningNode();
+  }
+  return n;
+}
+
+// Roughly the number of kernels that `n` runs.
+size_t nodeCost(Node* n) {
+  size_t cost = 0;
+  forEachNode(n, [&](Node* m) {
+    if (m->kind().is_aten()) {
+      cost++;
+    }
+    if (m->hasAttribute(attr::Subgraph)) {
+      for (Node* inner : m->g(attr::Subgraph)->nodes()) {
+        cost += nodeCost(inner);
+      }
+    }
+  });
+  return cost;
+}
+
+struct Chain {
+  // Top-level nodes, in graph order.
+  std::vector<Node*> nodes;
+  // The chains this one depends on, directly or not.
+  std::unordered_set<size_t> ancestors;
+  size_t cost = 0;
+};
+
+class AutoForker {
+ public:
+  AutoForker(std::shared_ptr<Graph> graph, size_t min_cost)
+      : graph_(std::move(graph)), min_cost_(min_cost), alias_db_(graph_) {}
+
+  void run() {
+    buildChains();
+    mergeSmallChains();
+    std::vector<size_t> selected = selectChains();
+    for (size_t c : selected) {
+      forkChain(chains_[c]);
+    }
+    if (!selected.empty()) {
+      EliminateDeadCode(graph_);
+    }
+  }
+
+ private:
+  // Constants and the cheap prim ops that only depend on constants and graph
+  // inputs (like the GetAttr of parameters or lists of constant sizes) do not
+  // tie chains together: forked chains get their own copy of them.
+  bool isConstantLike(Node* n) {
+    if (n->kind() == prim::Constant) {
+      return true;
+    }
+    if (!n->kind().is_prim() || !n->blocks().empty() || n->outputs().empty() ||
+        n->hasSideEffects() || nodeCost(n) != 0 || alias_db_.hasWriters(n)) {
+      return false;
+    }
+    for (Value* v : n->inputs()) {
+      if (v->node() != graph_->param_node() && !constant_like_.count(v->node())) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void buildChains() {
+    for (Node* n : graph_->nodes()) {
+      if (isConstantLike(n)) {
+        constant_like_.insert(n);
+        continue;
+      }
+      std::set<size_t> producers;
+      for (Value* v : outerInputs(n)) {
+        auto it = chain_of_.find(v->node());
+        if (it != chain_of_.end()) {
+          producers.insert(it->second);
+        }
+      }
+      size_t c;
+      if (producers.size() == 1) {
+        c = *producers.begin();
+      } else {
+        c = chains_.size();
+        chains_.emplace_back();
+        for (size_t p : producers) {
+          chains_[c].ancestors.insert(p);
+          chains_[c].ancestors.insert(
+              chains_[p].ancestors.begin(), chains_[p].ancestors.end());
+        }
+      }
+      chains_[c].nodes.push_back(n);
+      chains_[c].cost += nodeCost(n);
+      chain_of_[n] = c;
+    }
+  }
+
+  // Chains too small to be forked, like the transpose of a weight or a size
+  // computation, are merged into the chain that uses their results, if there
+  // is only one. That chain already depends on everything they depend on,
+  // and it is the only one that depends on them.
+  void mergeSmallChains() {
+    for (size_t c = 0; c < chains_.size(); c++) {
+      Chain& small = chains_[c];
+      if (small.nodes.empty() || small.cost >= min_cost_) {
+        continue;
+      }
+      c10::optional<size_t> consumer;
+      bool single_consumer = true;
+      for (Node* n : small.nodes) {
+        for (Value* output : n->outputs()) {
+          for (const Use& use : output->uses()) {
+            auto it = chain_of_.find(ancestorIn(use.user, graph_->block()));
+            if (it == chain_of_.end()) {
+              // Used by the graph outputs.
+              single_consumer = false;
+            } else if (it->second != c) {
+              single_consumer = single_consumer &&
+                  (!consumer || *consumer == it->second);
+              consumer = it->second;
+            }
+          }
+        }
+      }
+      if (!consumer || !single_consumer) {
+        continue;
+      }
+      Chain& target = chains_[*consumer];
+      for (Node* n : small.nodes) {
+        chain_of_[n] = *consumer;
+      }
+      target.nodes.insert(
+          target.nodes.end(), small.nodes.begin(), small.nodes.end());
+      std::sort(
+          target.nodes.begin(), target.nodes.end(), [](Node* a, Node* b) {
+            return a->isBefore(b);
+          });
+      target.cost += small.cost;
+      for (Chain& chain : chains_) {
+        chain.ancestors.erase(c);
+      }
+      small.nodes.clear();
+      small.cost = 0;
+    }
+  }
+
+  // The first top-level node (or the return node) that uses a result of
+  // `chain`.
+  Node* firstOuterUse(const Chain& chain) {
+    std::unordered_set<Node*> members(chain.nodes.begin(), chain.nodes.end());
+    Node* first = graph_->return_node();
+    for (Node* n : chain.nodes) {
+      for (Value* output : n->outputs()) {
+        for (const Use& use : output->uses()) {
+          Node* user = ancestorIn(use.user, graph_->block());
+          if (!members.count(user) && user->isBefore(first)) {
+            first = user;
+          }
+        }
+      }
+    }
+    return first;
+  }
+
+  bool canFork(const Chain& chain) {
+    std::unordered_set<Node*> members(chain.nodes.begin(), chain.nodes.end());
+    ValueSet reads;
+    ValueSet touched;
+    for (Node* n : chain.nodes) {
+      for (Value* v : outerInputs(n)) {
+        if (!members.count(v->node())) {
+          reads.insert(v);
+          touched.insert(v);
+        }
+      }
+      touched.insert(n->outputs().begin(), n->outputs().end());
+    }
+    bool ok = true;
+    for (Node* n : chain.nodes) {
+      forEachNode(n, [&](Node* m) {
+        // Exceptions are raised again by aten::wait.
+        if ((m->hasSideEffects() && m->kind() != prim::RaiseException) ||
+            m->isNondeterministic() || alias_db_.writesToWildcard(m) ||
+            alias_db_.writesToAlias(m, reads)) {
+          ok = false;
+        }
+      });
+    }
+    // Nothing may write to what the chain reads or produces while it runs.
+    for (Node* n : graph_->nodes()) {
+      if (ok && !members.count(n)) {
+        forEachNode(n, [&](Node* m) {
+          if (alias_db_.writesToAlias(m, touched)) {
+            ok = false;
+          }
+        });
+      }
+    }
+    return ok;
+  }
+
+  // A chain is forked when another one that does not depend on it starts
+  // before its results are used, so that both run at the same time.
+  std::vector<size_t> selectChains() {
+    std::vector<size_t> candidates;
+    for (size_t c = 0; c < chains_.size(); c++) {
+      if (!chains_[c].nodes.empty() && chains_[c].cost >= min_cost_ &&
+          canFork(chains_[c])) {
+        candidates.push_back(c);
+      }
+    }
+    std::vector<size_t> selected;
+    for (size_t c : candidates) {
+      Node* first_use = firstOuterUse(chains_[c]);
+      for (size_t other : candidates) {
+        if (other > c && !chains_[other].ancestors.count(c) &&
+            chains_[other].nodes.front()->isBefore(first_use)) {
+          selected.push_back(c);
+          break;
+        }
+      }
+    }
+    return selected;
+  }
+
+  void forkChain(const Chain& chain) {
+    std::unordered_set<Node*> members(chain.nodes.begin(), chain.nodes.end());
+    std::vector<Value*> results;
+    for (Node* n : chain.nodes) {
+      for (Value* output : n->outputs()) {
+        const bool used_outside = std::any_of(
+            output->uses().begin(), output->uses().end(), [&](const Use& use) {
+              return !members.count(ancestorIn(use.user, graph_->block()));
+            });
+        if (used_outside) {
+          results.push_back(output);
+        }
+      }
+    }
+    if (results.empty()) {
+      return;
+    }
+    Node* first_use = firstOuterUse(chain);
+
+    // The fork goes after the values it takes, which may come after the
+    // first node of a chain that other chains were merged into.
+    Node* insert_point = chain.nodes.front();
+    for (Node* n : chain.nodes) {
+      for (Value* v : outerInputs(n)) {
+        Node* producer = v->node();
+        if (!members.count(producer) && !constant_like_.count(producer) &&
+            producer != graph_->param_node() &&
+            !producer->isBefore(insert_point)) {
+          insert_point = producer->next();
+        }
+      }
+    }
+
+    auto subgraph = std::make_shared<Graph>();
+    Node* fork_node = graph_->create(prim::fork, 1)->insertBefore(insert_point);
+    std::unordered_map<Value*, Value*> env;
+    std::function<Value*(Value*)> value_map = [&](Value* v) -> Value* {
+      auto it = env.find(v);
+      if (it != env.end()) {
+        return it->second;
+      }
+      Node* producer = v->node();
+      if (constant_like_.count(producer)) {
+        Node* clone =
+            subgraph->insertNode(subgraph->createClone(producer, value_map));
+        for (size_t i = 0; i < producer->outputs().size(); i++) {
+          env[producer->output(i)] = clone->output(i);
+        }
+        return env.at(v);
+      }
+      fork_node->addInput(v);
+      Value* input = subgraph->addInput()->copyMetadata(v);
+      env[v] = input;
+      return input;
+    };
+    for (Node* n : chain.nodes) {
+      Node* clone = subgraph->insertNode(subgraph->createClone(n, value_map));
+      for (size_t i = 0; i < n->outputs().size(); i++) {
+        env[n->output(i)] = clone->output(i);
+      }
+    }
+
+    // The forked function returns a single value.
+    Value* output = env.at(results.at(0));
+    if (results.size() > 1) {
+      std::vector<Value*> outputs;
+      for (Value* result : results) {
+        outputs.push_back(env.at(result));
+      }
+      output = subgraph->insertNode(subgraph->createTuple(outputs))->output();
+    }
+    subgraph->registerOutput(output);
+    fork_node->g_(attr::Subgraph, subgraph);
+    fork_node->output()->setType(FutureType::create(output->type()));
+
+    Node* wait = graph_->create(aten::wait, {fork_node->output()}, 1)
+                     ->insertBefore(first_use);
+    wait->output()->setType(output->type());
+    std::vector<Value*> waited = {wait->output()};
+    if (results.size() > 1) {
+      Node* unpack = graph_->createTupleUnpack(wait->output())->insertAfter(wait);
+      waited = unpack->outputs().vec();
+    }
+    for (size_t i = 0; i < results.size(); i++) {
+      waited[i]->copyMetadata(results[i]);
+      results[i]->replaceAllUsesWith(waited[i]);
+    }
+    for (auto it = chain.nodes.rbegin(); it != chain.nodes.rend(); ++it) {
+      (*it)->destroy();
+    }
+  }
+
+  std::shared_ptr<Graph> graph_;
+  size_t min_cost_;
+  AliasDb alias_db_;
+  std::vector<Chain> chains_;
+  std::unordered_map<Node*, size_t> chain_of_;
+  std::unordered_set<Node*> constant_like_;
+};
+
+} // namespace
+
+void AutoFork(std::shared_ptr<Graph>& graph, size_t min_cost) {
+  AutoForker(graph, min_cost).run();
+}
+
+} // namespace jit
+} // namespace torch
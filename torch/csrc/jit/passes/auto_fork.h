@@ -0,0 +1,29 @@
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+namespace torch {
+namespace jit {
+
+// Runs independent parts of a graph in parallel on the inter-op thread pool,
+// like the towers of a multi-tower model.
+//
+// The top-level nodes are grouped into chains: a node joins the chain of its
+// inputs when they all come from one chain, and starts a new one otherwise.
+// A chain that costs at least `min_cost` (roughly, its number of aten ops)
+// is moved into the subgraph of a prim::fork, with an aten::wait before the
+// first use of its results, when a later chain of that cost that does not
+// depend on it starts before that use. The last of such independent chains
+// keeps running in the calling thread.
+//
+// Chains with side effects (other than raising exceptions) or
+// nondeterministic ops are never forked, and neither are chains that write
+// to values they did not create or that read values the rest of the graph
+// writes to, according to AliasDb.
+//
+// Meant for inference: the graph executor only runs it on plans that do not
+// require gradients, see GraphExecutor::setAutoFork.
+TORCH_API void AutoFork(std::shared_ptr<Graph>& graph, size_t min_cost = 16);
+
+} // namespace jit
+} // namespace torch
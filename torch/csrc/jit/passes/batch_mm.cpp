@@ -5,12 +5,16 @@
 #include <c10/util/Exception.h>
 #include <torch/csrc/jit/constants.h>
 #include <torch/csrc/jit/custom_operator.h>
+#include <torch/csrc/jit/node_hashing.h>
+#include <torch/csrc/jit/operator.h>
 #include <torch/csrc/jit/passes/alias_analysis.h>
 #include <torch/csrc/jit/passes/dead_code_elimination.h>
 #include <torch/csrc/jit/passes/peephole.h>
 
 #include <ATen/ATen.h>
+#include <ATen/core/grad_mode.h>
 #include <algorithm>
+#include <mutex>
 #include <unordered_map>
 
 namespace torch {
@@ -459,6 +463,582 @@ void BatchMMSide(Block* block, AliasDb& alias_db) {
   }
 }
 
+// Horizontal fusion of independent linear layers and convolutions that read
+// the same input, like the query, key and value projections of attention or
+// the first layers of the towers of a multi-tower model:
+//
+//   q = linear(x, Wq, bq)                    W = cat([Wq, Wk, Wv])
+//   k = linear(x, Wk, bk)       ==>          b = cat([bq, bk, bv])
+//   v = linear(x, Wv, bv)                    q, k, v = split(linear(x, W, b))
+//
+// runs one large GEMM instead of several small ones. The pass handles
+// aten::linear, aten::mm and aten::matmul by a transposed weight (which is
+// how linear layers without bias are scripted, and what DecomposeOps turns
+// addmm into), aten::addmm, aten::conv2d with groups == 1, whose weights
+// are concatenated along the output channels, and quantized::linear, whose
+// prepacked weights are unpacked, concatenated and packed again when they
+// share their quantization parameters.
+//
+// The nodes are replaced by a prim::BatchLinear, which checks at run time that
+// the shapes of the weights allow batching and runs the original ops
+// otherwise. Unless they require grad, the concatenated weights and biases
+// are cached in the operation, and only computed again when a weight or bias
+// is replaced or modified in place: inference pays for the concatenation once,
+// and for a copy of the weights.
+//
+// The outputs are split back along the output features, and made contiguous
+// like the outputs of the original ops.
+
+namespace {
+
+// Tunable parameter. Set to something larger if it turns out to be better.
+static constexpr size_t min_linear_batch_size = 2;
+
+enum class LinearKind { Linear, Addmm, Conv2d, QuantizedLinear };
+
+// The inputs of prim::BatchLinear are the input, the parameters of the op
+// (beta and alpha for addmm; stride, padding, dilation and groups for
+// conv2d; the output scale and zero point for quantized::linear), then the
+// weights and the biases of each batched op. quantized::linear has its bias
+// packed with its weight, so its biases are all None.
+size_t numSharedInputs(LinearKind kind) {
+  switch (kind) {
+    case LinearKind::Linear:
+      return 1;
+    case LinearKind::Addmm:
+      return 3;
+    case LinearKind::Conv2d:
+      return 5;
+    case LinearKind::QuantizedLinear:
+      return 3;
+  }
+  return 0;
+}
+
+// The dimension of the weights, and of the outputs, along which the ops are
+// batched.
+int64_t outputDim(LinearKind kind, bool transposed) {
+  return kind == LinearKind::Addmm && !transposed ? 1 : 0;
+}
+
+struct LinearBatchCache {
+  std::mutex mutex;
+  // The weights and biases the cached tensors were computed from, and their
+  // versions at that time.
+  std::vector<at::Tensor> sources;
+  std::vector<uint32_t> versions;
+  at::Tensor weight;
+  at::Tensor bias;
+  // The output features of each op, for packed weights whose sizes are only
+  // known once they are unpacked.
+  std::vector<int64_t> sizes;
+};
+
+bool requiresGrad(const at::Tensor& t) {
+  return t.defined() && t.requires_grad();
+}
+
+uint32_t tensorVersion(const at::Tensor& t) {
+  return t.defined()
+      ? t.unsafeGetTensorImpl()->version_counter().current_version()
+      : 0;
+}
+
+bool canBatchLinear(
+    LinearKind kind,
+    bool transposed,
+    at::TensorList weights,
+    at::TensorList biases,
+    int64_t groups) {
+  const at::Tensor& first = weights[0];
+  int64_t dim = outputDim(kind, transposed);
+  int64_t expected_dim = kind == LinearKind::Conv2d ? 4 : 2;
+  if (kind == LinearKind::Conv2d && groups != 1) {
+    return false;
+  }
+  for (size_t i = 0; i < weights.size(); ++i) {
+    const at::Tensor& w = weights[i];
+    if (!w.defined() || w.dim() != expected_dim ||
+        w.scalar_type() != first.scalar_type() ||
+        w.device() != first.device() || w.is_sparse()) {
+      return false;
+    }
+    for (int64_t d = 0; d < expected_dim; ++d) {
+      if (d != dim && w.size(d) != first.size(d)) {
+        return false;
+      }
+    }
+    const at::Tensor& b = biases[i];
+    if (!b.defined()) {
+      // addmm has no optional bias.
+      if (kind == LinearKind::Addmm) {
+        return false;
+      }
+      continue;
+    }
+    if (b.dim() != 1 || b.size(0) != w.size(dim) ||
+        b.scalar_type() != first.scalar_type() ||
+        b.device() != first.device()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+std::pair<at::Tensor, at::Tensor> concatWeights(
+    LinearKind kind,
+    bool transposed,
+    at::TensorList weights,
+    at::TensorList biases) {
+  int64_t dim = outputDim(kind, transposed);
+  at::Tensor weight = at::cat(weights, dim);
+  if (kind == LinearKind::Addmm && transposed) {
+    weight = weight.t();
+  }
+  at::Tensor bias;
+  bool has_bias = std::any_of(
+      biases.begin(), biases.end(), [](const at::Tensor& b) {
+        return b.defined();
+      });
+  if (has_bias) {
+    std::vector<at::Tensor> parts;
+    for (size_t i = 0; i < weights.size(); ++i) {
+      parts.push_back(
+          biases[i].defined() ? biases[i]
+                              : at::zeros({weights[i].size(dim)},
+                                          weights[i].options()));
+    }
+    bias = at::cat(parts);
+  }
+  return std::make_pair(weight, bias);
+}
+
+// Whether the cached tensors were computed from `sources`, and these did not
+// change since. Must be called with the cache's mutex held.
+bool cacheIsCurrent(
+    const LinearBatchCache& cache,
+    const std::vector<at::Tensor>& sources) {
+  if (cache.sources.size() != sources.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < sources.size(); ++i) {
+    if (!cache.sources[i].is_same(sources[i]) ||
+        cache.versions[i] != tensorVersion(sources[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Returns the concatenated weight and bias, from the cache when the weights
+// and biases did not change since they were last concatenated.
+std::pair<at::Tensor, at::Tensor> cachedWeights(
+    LinearBatchCache& cache,
+    LinearKind kind,
+    bool transposed,
+    at::TensorList weights,
+    at::TensorList biases) {
+  std::vector<at::Tensor> sources(weights.begin(), weights.end());
+  sources.insert(sources.end(), biases.begin(), biases.end());
+  std::lock_guard<std::mutex> guard(cache.mutex);
+  if (!cacheIsCurrent(cache, sources)) {
+    std::tie(cache.weight, cache.bias) =
+        concatWeights(kind, transposed, weights, biases);
+    cache.sources = std::move(sources);
+    cache.versions = fmap(cache.sources, tensorVersion);
+  }
+  return std::make_pair(cache.weight, cache.bias);
+}
+
+// The operation of the registered operator `name`, which has one overload.
+Operation operationFor(const char* name) {
+  const auto& ops = getAllOperatorsFor(Symbol::fromQualString(name));
+  TORCH_INTERNAL_ASSERT(ops.size() == 1, "expected one overload of ", name);
+  return ops.front()->getOperation();
+}
+
+// Unpacks the prepacked weights of quantized::linear ops and packs them into
+// the weight of a single op, whose output features are those of the ops in
+// order. Returns an undefined tensor if the weights can't be concatenated:
+// they must all be per tensor quantized with the same scale and zero point,
+// and have the same number of input features.
+at::Tensor packQuantizedWeights(
+    at::TensorList packed_weights,
+    std::vector<int64_t>& sizes) {
+  static const Operation unpack = operationFor("quantized::linear_unpack");
+  static const Operation prepack = operationFor("quantized::linear_prepack");
+  std::vector<at::Tensor> weights, biases;
+  for (const at::Tensor& packed_weight : packed_weights) {
+    Stack stack = {packed_weight};
+    unpack(stack);
+    IValue bias = pop(stack);
+    weights.push_back(pop(stack).toTensor());
+    biases.push_back(bias.isNone() ? at::Tensor() : bias.toTensor());
+  }
+  const at::Tensor& first = weights[0];
+  for (const at::Tensor& w : weights) {
+    if (w.qscheme() != at::kPerTensorAffine ||
+        w.scalar_type() != first.scalar_type() ||
+        w.q_scale() != first.q_scale() ||
+        w.q_zero_point() != first.q_zero_point() || w.dim() != 2 ||
+        w.size(1) != first.size(1)) {
+      return at::Tensor();
+    }
+  }
+  at::Tensor weight = at::_per_tensor_affine_qtensor(
+      at::cat(fmap(weights, [](const at::Tensor& w) { return w.int_repr(); })),
+      first.q_scale(),
+      first.q_zero_point());
+  IValue bias;
+  if (std::any_of(biases.begin(), biases.end(), [](const at::Tensor& b) {
+        return b.defined();
+      })) {
+    std::vector<at::Tensor> parts;
+    for (size_t i = 0; i < weights.size(); ++i) {
+      parts.push_back(
+          biases[i].defined() ? biases[i]
+                              : at::zeros({weights[i].size(0)}, at::kFloat));
+    }
+    bias = at::cat(parts);
+  }
+  Stack stack = {weight, bias};
+  prepack(stack);
+  sizes = fmap(weights, [](const at::Tensor& w) { return w.size(0); });
+  return pop(stack).toTensor();
+}
+
+// Runs a batch of quantized::linear ops. Their outputs are quantized with the
+// same scale and zero point, so the output of the batched op splits into
+// them.
+void runQuantizedBatchLinear(
+    LinearBatchCache& cache,
+    const at::Tensor& input,
+    at::TensorList packed_weights,
+    double output_scale,
+    int64_t output_zero_point,
+    Stack& stack) {
+  static const Operation linear = operationFor("quantized::linear");
+  const auto run = [&](const at::Tensor& packed_weight) {
+    Stack linear_stack = {
+        input, packed_weight, output_scale, output_zero_point};
+    linear(linear_stack);
+    return pop(linear_stack).toTensor();
+  };
+
+  std::vector<at::Tensor> sources(packed_weights.begin(), packed_weights.end());
+  at::Tensor packed_weight;
+  std::vector<int64_t> sizes;
+  {
+    std::lock_guard<std::mutex> guard(cache.mutex);
+    if (!cacheIsCurrent(cache, sources)) {
+      cache.weight = packQuantizedWeights(packed_weights, cache.sizes);
+      cache.sources = std::move(sources);
+      cache.versions = fmap(cache.sources, tensorVersion);
+    }
+    packed_weight = cache.weight;
+    sizes = cache.sizes;
+  }
+  if (!packed_weight.defined()) {
+    for (const at::Tensor& w : packed_weights) {
+      stack.emplace_back(run(w));
+    }
+    return;
+  }
+  at::Tensor output = run(packed_weight);
+  // Split the integer representation, so that every output is a contiguous
+  // quantized tensor of its own.
+  for (const at::Tensor& out : output.int_repr().split_with_sizes(sizes, -1)) {
+    stack.emplace_back(at::_per_tensor_affine_qtensor(
+        out, output.q_scale(), output.q_zero_point()));
+  }
+}
+
+RegisterOperators batch_linear_reg({Operator(
+    prim::BatchLinear,
+    [](const Node* node) -> Operation {
+      auto kind =
+          static_cast<LinearKind>(node->i(Symbol::attr("linear_kind")));
+      bool transposed = node->i(Symbol::attr("transposed"));
+      size_t num_ops = node->outputs().size();
+      size_t num_inputs = node->inputs().size();
+      auto cache = std::make_shared<LinearBatchCache>();
+      return [kind, transposed, num_ops, num_inputs, cache](Stack& stack) {
+        auto inputs = last(stack, num_inputs);
+        size_t shared = numSharedInputs(kind);
+        at::Tensor input = inputs[0].toTensor();
+        std::vector<at::Tensor> weights, biases;
+        for (size_t i = 0; i < num_ops; ++i) {
+          weights.push_back(inputs[shared + i].toTensor());
+          const IValue& bias = inputs[shared + num_ops + i];
+          biases.push_back(bias.isNone() ? at::Tensor() : bias.toTensor());
+        }
+        at::Scalar beta, alpha;
+        std::vector<int64_t> stride, padding, dilation;
+        int64_t groups = 1;
+        double output_scale = 0;
+        int64_t output_zero_point = 0;
+        if (kind == LinearKind::Addmm) {
+          beta = inputs[1].toScalar();
+          alpha = inputs[2].toScalar();
+        } else if (kind == LinearKind::Conv2d) {
+          stride = inputs[1].toIntListRef().vec();
+          padding = inputs[2].toIntListRef().vec();
+          dilation = inputs[3].toIntListRef().vec();
+          groups = inputs[4].toInt();
+        } else if (kind == LinearKind::QuantizedLinear) {
+          output_scale = inputs[1].toDouble();
+          output_zero_point = inputs[2].toInt();
+        }
+        drop(stack, num_inputs);
+
+        if (kind == LinearKind::QuantizedLinear) {
+          runQuantizedBatchLinear(
+              *cache, input, weights, output_scale, output_zero_point, stack);
+          return 0;
+        }
+
+        const auto run = [&](const at::Tensor& weight, const at::Tensor& bias) {
+          switch (kind) {
+            case LinearKind::Linear:
+              return at::linear(input, weight, bias);
+            case LinearKind::Addmm:
+              return at::addmm(bias, input, weight, beta, alpha);
+            case LinearKind::Conv2d:
+              return at::conv2d(
+                  input, weight, bias, stride, padding, dilation, groups);
+            case LinearKind::QuantizedLinear:
+              break;
+          }
+          AT_ERROR("unknown LinearKind");
+        };
+
+        if (!canBatchLinear(kind, transposed, weights, biases, groups)) {
+          for (size_t i = 0; i < num_ops; ++i) {
+            stack.emplace_back(
+                run(transposed ? weights[i].t() : weights[i], biases[i]));
+          }
+          return 0;
+        }
+        // The concatenation is recorded by autograd when the weights require
+        // grad, and then can't be cached.
+        bool requires_grad = at::GradMode::is_enabled() &&
+            (std::any_of(weights.begin(), weights.end(), requiresGrad) ||
+             std::any_of(biases.begin(), biases.end(), requiresGrad));
+        at::Tensor weight, bias;
+        std::tie(weight, bias) = requires_grad
+            ? concatWeights(kind, transposed, weights, biases)
+            : cachedWeights(*cache, kind, transposed, weights, biases);
+        int64_t dim = outputDim(kind, transposed);
+        std::vector<int64_t> sizes =
+            fmap(weights, [dim](const at::Tensor& w) { return w.size(dim); });
+        at::Tensor output = run(weight, bias);
+        // The features are the last dimension of the output of linear and
+        // addmm, and the channels the second one of conv2d.
+        int64_t split_dim = kind == LinearKind::Conv2d ? 1 : -1;
+        for (at::Tensor& out : output.split_with_sizes(sizes, split_dim)) {
+          stack.emplace_back(out.contiguous());
+        }
+        return 0;
+      };
+    },
+    aliasAnalysisIsSpecialCase())});
+
+struct LinearUse {
+  Node* node;
+  LinearKind kind;
+  bool transposed;
+  Value* input;
+  std::vector<Value*> params;
+  Value* weight;
+  // nullptr when the op has no bias input.
+  Value* bias;
+};
+
+// The weight of a linear layer, when `v` is its transpose.
+Value* transposedWeight(Value* v) {
+  Node* n = v->node();
+  if (n->matches("aten::t(Tensor self) -> Tensor")) {
+    return n->input();
+  }
+  return nullptr;
+}
+
+c10::optional<LinearUse> matchLinear(Node* node) {
+  if (node->matches(
+          "aten::linear(Tensor input, Tensor weight, Tensor? bias) -> Tensor")) {
+    return LinearUse{node,
+                     LinearKind::Linear,
+                     false,
+                     node->input(0),
+                     {},
+                     node->input(1),
+                     node->input(2)};
+  }
+  if (node->matches("aten::mm(Tensor self, Tensor mat2) -> Tensor") ||
+      node->matches("aten::matmul(Tensor self, Tensor other) -> Tensor")) {
+    // x @ w.t() == linear(x, w)
+    if (Value* weight = transposedWeight(node->input(1))) {
+      return LinearUse{node,
+                       LinearKind::Linear,
+                       false,
+                       node->input(0),
+                       {},
+                       weight,
+                       nullptr};
+    }
+    return c10::nullopt;
+  }
+  if (node->matches(
+          "aten::addmm(Tensor self, Tensor mat1, Tensor mat2, *, Scalar beta, Scalar alpha) -> Tensor")) {
+    Value* weight = transposedWeight(node->input(2));
+    return LinearUse{node,
+                     LinearKind::Addmm,
+                     weight != nullptr,
+                     node->input(1),
+                     {node->input(3), node->input(4)},
+                     weight ? weight : node->input(2),
+                     node->input(0)};
+  }
+  if (node->kind() == Symbol::fromQualString("quantized::linear")) {
+    // The bias is packed with the weight.
+    return LinearUse{node,
+                     LinearKind::QuantizedLinear,
+                     false,
+                     node->input(0),
+                     {node->input(2), node->input(3)},
+                     node->input(1),
+                     nullptr};
+  }
+  if (node->matches(
+          "aten::conv2d(Tensor input, Tensor weight, Tensor? bias, int[] stride, int[] padding, int[] dilation, int groups) -> Tensor")) {
+    auto groups = toIValue(node->input(6));
+    if (!groups || groups->toInt() != 1) {
+      return c10::nullopt;
+    }
+    return LinearUse{node,
+                     LinearKind::Conv2d,
+                     false,
+                     node->input(0),
+                     {node->input(3),
+                      node->input(4),
+                      node->input(5),
+                      node->input(6)},
+                     node->input(1),
+                     node->input(2)};
+  }
+  return c10::nullopt;
+}
+
+bool sameValue(Value* a, Value* b) {
+  return a == b ||
+      (a->node()->kind() == prim::Constant && EqualNode()(a->node(), b->node()));
+}
+
+bool canBatchTogether(const LinearUse& a, const LinearUse& b) {
+  if (a.kind != b.kind || a.transposed != b.transposed ||
+      a.input != b.input || a.weight == b.weight) {
+    return false;
+  }
+  for (size_t i = 0; i < a.params.size(); ++i) {
+    if (!sameValue(a.params[i], b.params[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Moves the ops of `uses` next to each other and replaces them by a
+// prim::BatchLinear. Ops that can't be moved are left alone. Returns whether
+// the graph changed.
+bool batchLinearUses(std::vector<LinearUse>& uses, AliasDb& alias_db) {
+  std::vector<LinearUse> batched = {uses.back()};
+  for (int64_t i = static_cast<int64_t>(uses.size()) - 2; i >= 0; --i) {
+    if (alias_db.moveBeforeTopologicallyValid(
+            uses[i].node, batched.front().node)) {
+      batched.insert(batched.begin(), uses[i]);
+    }
+  }
+  if (batched.size() < min_linear_batch_size) {
+    // The moves that succeeded kept the graph valid, but nothing was batched.
+    return false;
+  }
+
+  const LinearUse& first = batched.front();
+  Graph* graph = first.node->owningGraph();
+  WithInsertPoint insert_guard{first.node};
+  Node* batch = graph->create(
+      prim::BatchLinear, /*inputs=*/{}, /*num_outputs=*/batched.size());
+  batch->i_(Symbol::attr("linear_kind"), static_cast<int>(first.kind));
+  batch->i_(Symbol::attr("transposed"), first.transposed);
+  batch->addInput(first.input);
+  for (Value* param : first.params) {
+    batch->addInput(param);
+  }
+  for (const LinearUse& use : batched) {
+    batch->addInput(use.weight);
+  }
+  for (const LinearUse& use : batched) {
+    batch->addInput(use.bias ? use.bias : graph->insertConstant(IValue()));
+  }
+  graph->insertNode(batch);
+  for (size_t i = 0; i < batched.size(); ++i) {
+    batch->outputs().at(i)->setType(batched[i].node->output()->type());
+    batched[i].node->output()->replaceAllUsesWith(batch->outputs().at(i));
+    batched[i].node->destroy();
+  }
+  return true;
+}
+
+// Batches the first group of linear ops found in `block`, and returns whether
+// it found one. The AliasDb is stale afterwards.
+bool batchLinearInBlock(Block* block, AliasDb& alias_db) {
+  std::vector<LinearUse> uses;
+  for (Node* node : block->nodes()) {
+    if (auto use = matchLinear(node)) {
+      uses.push_back(*use);
+    }
+    for (Block* subblock : node->blocks()) {
+      if (batchLinearInBlock(subblock, alias_db)) {
+        return true;
+      }
+    }
+  }
+
+  std::vector<bool> grouped(uses.size(), false);
+  for (size_t i = 0; i < uses.size(); ++i) {
+    if (grouped[i]) {
+      continue;
+    }
+    std::vector<LinearUse> group = {uses[i]};
+    for (size_t j = i + 1; j < uses.size(); ++j) {
+      if (!grouped[j] && canBatchTogether(uses[i], uses[j]) &&
+          std::all_of(group.begin(), group.end(), [&](const LinearUse& u) {
+            return u.weight != uses[j].weight &&
+                alias_db.couldMoveBeforeTopologically(uses[j].node, u.node);
+          })) {
+        group.push_back(uses[j]);
+        grouped[j] = true;
+      }
+    }
+    if (group.size() >= min_linear_batch_size &&
+        batchLinearUses(group, alias_db)) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void BatchLinear(std::shared_ptr<Graph>& graph) {
+  while (true) {
+    AliasDb alias_db(graph);
+    if (!batchLinearInBlock(graph->block(), alias_db)) {
+      break;
+    }
+  }
+}
+
+} // namespace
+
 bool hasMutableOperators(Block* block) {
   for (auto n : block->nodes()) {
     if (n->kind().is_aten() && n->schema().is_mutable())
@@ -476,8 +1056,13 @@ void BatchMM(std::shared_ptr<Graph>& graph) {
     // TODO(suo): make BatchMM mutability-safe
     return;
   }
-  AliasDb alias_db(graph);
   BatchMMTreeReduce(graph->block());
+  // The matmuls reduced by BatchMMTreeReduce are still there.
+  EliminateDeadCode(graph);
+  // Before BatchMMSide, which would batch the matmuls of linear layers
+  // without caching their weights.
+  BatchLinear(graph);
+  AliasDb alias_db(graph);
   BatchMMSide(graph->block(), alias_db);
   EliminateDeadCode(graph);
   // It's possible that transpose rearrangements have created sequences of
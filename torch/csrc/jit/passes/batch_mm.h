@@ -5,6 +5,9 @@
 namespace torch {
 namespace jit {
 
+// Rewrites trees of matmuls, matmuls that share an operand, and independent
+// linear layers or convolutions that read the same input into batched ops.
+// Does nothing on graphs with mutable operators.
 TORCH_API void BatchMM(std::shared_ptr<Graph>& graph);
 
 }
@@ -0,0 +1,250 @@
+#include <torch/csrc/jit/passes/freeze_module.h>
+
+#include <ATen/core/grad_mode.h>
+#include <torch/csrc/jit/constants.h>
+#include <torch/csrc/jit/passes/alias_analysis.h>
+#include <torch/csrc/jit/passes/constant_pooling.h>
+#include <torch/csrc/jit/passes/constant_propagation.h>
+#include <torch/csrc/jit/passes/dead_code_elimination.h>
+#include <torch/csrc/jit/passes/fuse_linear.h>
+#include <torch/csrc/jit/passes/inliner.h>
+#include <torch/csrc/utils/memory.h>
+
+#include <set>
+#include <unordered_set>
+
+namespace torch {
+namespace jit {
+
+namespace {
+
+using ObjectPtr = c10::intrusive_ptr<c10::ivalue::Object>;
+
+// Attributes of these types can only change through prim::SetAttr.
+bool isImmutable(const IValue& v) {
+  return v.isInt() || v.isDouble() || v.isBool() || v.isString() ||
+      v.isNone() || v.isDevice();
+}
+
+// Attributes of these types can also be written in place, which is only
+// known from alias analysis.
+bool isMutable(const IValue& v) {
+  return (v.isTensor() && v.toTensor().defined()) || v.isIntList() ||
+      v.isDoubleList() || v.isBoolList();
+}
+
+struct ModuleAttributes {
+  // The module objects that values of the graph hold.
+  std::unordered_map<Value*, ObjectPtr> objects;
+  // Attributes written by prim::SetAttr, and the names of the attributes
+  // written on objects that could not be resolved.
+  std::set<std::pair<c10::ivalue::Object*, std::string>> written;
+  std::unordered_set<std::string> written_anywhere;
+};
+
+void resolveAttributes(Block* block, ModuleAttributes& attributes) {
+  for (Node* n : block->nodes()) {
+    if (n->kind() == prim::GetAttr) {
+      auto it = attributes.objects.find(n->input());
+      if (it != attributes.objects.end()) {
+        IValue value = it->second->getAttr(n->s(attr::name));
+        if (value.isObject()) {
+          attributes.objects[n->output()] = value.toObject();
+        }
+      }
+    } else if (n->kind() == prim::SetAttr) {
+      auto it = attributes.objects.find(n->inputs().at(0));
+      if (it != attributes.objects.end()) {
+        attributes.written.emplace(it->second.get(), n->s(attr::name));
+      } else {
+        attributes.written_anywhere.insert(n->s(attr::name));
+      }
+    }
+    for (Block* b : n->blocks()) {
+      resolveAttributes(b, attributes);
+    }
+  }
+}
+
+void foldAttributes(
+    Block* block,
+    const ModuleAttributes& attributes,
+    AliasDb* alias_db) {
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* n = *it++;
+    for (Block* b : n->blocks()) {
+      foldAttributes(b, attributes, alias_db);
+    }
+    if (n->kind() != prim::GetAttr) {
+      continue;
+    }
+    auto object = attributes.objects.find(n->input());
+    if (object == attributes.objects.end()) {
+      continue;
+    }
+    const std::string& name = n->s(attr::name);
+    if (attributes.written.count(std::make_pair(object->second.get(), name)) ||
+        attributes.written_anywhere.count(name)) {
+      continue;
+    }
+    IValue value = object->second->getAttr(name);
+    if (!isImmutable(value)) {
+      if (!alias_db || !isMutable(value) || alias_db->hasOutputWriters(n)) {
+        continue;
+      }
+      // Parameters require grad, constants must not.
+      if (value.isTensor()) {
+        value = value.toTensor().detach();
+      }
+    }
+    WithInsertPoint guard(n);
+    auto constant = tryInsertConstant(*block->owningGraph(), value);
+    if (!constant) {
+      continue;
+    }
+    n->output()->replaceAllUsesWith(*constant);
+    n->destroy();
+  }
+}
+
+// Replaces the prim::GetAttr reading attributes of `self` (the first input
+// of `graph`) or of its submodules with constants. Only immutable attributes
+// are folded unless `fold_mutable` is set.
+void foldModuleAttributes(
+    const std::shared_ptr<Graph>& graph,
+    const ObjectPtr& self,
+    bool fold_mutable) {
+  ModuleAttributes attributes;
+  attributes.objects[graph->inputs().at(0)] = self;
+  resolveAttributes(graph->block(), attributes);
+  std::unique_ptr<AliasDb> alias_db;
+  if (fold_mutable) {
+    alias_db = torch::make_unique<AliasDb>(graph);
+  }
+  foldAttributes(graph->block(), attributes, alias_db.get());
+}
+
+c10::optional<at::Tensor> toConstantTensor(Value* v) {
+  auto value = toIValue(v);
+  if (!value || !value->isTensor()) {
+    return c10::nullopt;
+  }
+  return value->toTensor();
+}
+
+void foldConvBatchNorm(Block* block) {
+  Graph* graph = block->owningGraph();
+  for (auto it = block->nodes().begin(); it != block->nodes().end();) {
+    Node* bn = *it++;
+    for (Block* b : bn->blocks()) {
+      foldConvBatchNorm(b);
+    }
+    // aten::batch_norm(input, weight, bias, running_mean, running_var,
+    //                  training, momentum, eps, cudnn_enabled)
+    // aten::conv2d(input, weight, bias, stride, padding, dilation, groups)
+    if (bn->kind() != aten::batch_norm) {
+      continue;
+    }
+    Node* conv = bn->input(0)->node();
+    if (conv->kind() != aten::conv2d || conv->output()->uses().size() != 1) {
+      continue;
+    }
+    auto conv_w = toConstantTensor(conv->input(1));
+    auto conv_b = toIValue(conv->input(2));
+    auto bn_w = toIValue(bn->input(1));
+    auto bn_b = toIValue(bn->input(2));
+    auto bn_rm = toConstantTensor(bn->input(3));
+    auto bn_rv = toConstantTensor(bn->input(4));
+    auto training = toIValue(bn->input(5));
+    auto eps = toIValue(bn->input(7));
+    if (!conv_w || !conv_b || !bn_w || !bn_b || !bn_rm || !bn_rv ||
+        !training || !eps || training->toBool()) {
+      continue;
+    }
+
+    // y = (conv(x, w) + b - mean) / sqrt(var + eps) * gamma + beta
+    //   = conv(x, w * scale) + (b - mean) * scale + beta
+    // with scale = gamma / sqrt(var + eps), per output channel.
+    at::NoGradGuard no_grad;
+    at::Tensor scale = bn_rv->add(eps->toDouble()).rsqrt();
+    if (bn_w->isTensor()) {
+      scale = scale * bn_w->toTensor();
+    }
+    at::Tensor bias =
+        conv_b->isTensor() ? conv_b->toTensor() : at::zeros_like(*bn_rm);
+    bias = (bias - *bn_rm) * scale;
+    if (bn_b->isTensor()) {
+      bias = bias + bn_b->toTensor();
+    }
+    std::vector<int64_t> shape(conv_w->dim(), 1);
+    shape[0] = -1;
+    at::Tensor weight = *conv_w * scale.reshape(shape);
+
+    WithInsertPoint guard(conv);
+    conv->replaceInput(1, graph->insertConstant(weight));
+    conv->replaceInput(2, graph->insertConstant(bias));
+    bn->output()->replaceAllUsesWith(conv->output());
+    bn->destroy();
+  }
+}
+
+} // namespace
+
+void FoldFrozenConvBatchNorm2d(std::shared_ptr<Graph>& graph) {
+  foldConvBatchNorm(graph->block());
+}
+
+script::Module freeze_module(const script::Module& module) {
+  script::Module frozen = module.clone();
+  TORCH_CHECK(
+      !frozen.is_training(),
+      "freeze_module: the module must be in eval mode, call eval() before freezing it");
+  auto graph = frozen.get_method("forward").graph();
+  Inline(*graph, /*recurse=*/true);
+  // The linear patterns start with aten::t(weight), which would be folded
+  // away once the weights are constants.
+  ConstantPooling(graph);
+  FuseLinear(graph);
+
+  // Immutable attributes go first: constant propagation then removes the
+  // branches that only run in training mode, along with the in-place updates
+  // of buffers they make, before the tensors are checked for writers.
+  foldModuleAttributes(graph, frozen.module_object(), /*fold_mutable=*/false);
+  ConstantPropagation(graph);
+  EliminateDeadCode(graph);
+  foldModuleAttributes(graph, frozen.module_object(), /*fold_mutable=*/true);
+  // Also folds the quantization and prepacking of the weights, now
+  // constants.
+  ConstantPropagation(graph);
+  FoldFrozenConvBatchNorm2d(graph);
+  ConstantPooling(graph);
+  EliminateDeadCode(graph);
+
+  if (!graph->inputs().at(0)->uses().empty()) {
+    return frozen;
+  }
+
+  // Nothing reads the module anymore: give forward a fresh module type,
+  // without submodules or attributes.
+  script::Module stripped(
+      frozen.name(), frozen.class_compilation_unit(), /*shouldMangle=*/true);
+  auto type_remap = [&](TypePtr type) -> TypePtr {
+    if (type == frozen.type()) {
+      return stripped.type();
+    }
+    return type;
+  };
+  auto stripped_graph = graph->copy();
+  stripped_graph->remapTypes(type_remap);
+  Function* forward = stripped.class_compilation_unit()->create_function(
+      c10::QualifiedName(stripped.name(), "forward"), stripped_graph);
+  stripped.type()->addMethod(forward);
+  forward->setSchema(frozen.get_method("forward")
+                         .function()
+                         .getSchema()
+                         .cloneWithRemappedTypes(type_remap));
+  return stripped;
+}
+
+} // namespace jit
+} // namespace torch
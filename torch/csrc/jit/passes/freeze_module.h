@@ -0,0 +1,36 @@
+/** \brief Freezing of script modules for inference
+ */
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+#include <torch/csrc/jit/script/module.h>
+
+namespace torch {
+namespace jit {
+
+/** \brief Returns a frozen copy of `module`, which must be in eval mode.
+ *
+ * The forward method of the copy is inlined, and the parameters and
+ * attributes it reads are turned into graph constants, unless they are
+ * written by the method (through prim::SetAttr or in-place ops). The graph
+ * is then simplified by constant propagation, which also folds the prepacking
+ * of constant quantized weights, by folding aten::batch_norm into the
+ * preceding aten::conv2d and by fusing linear patterns into aten::linear.
+ *
+ * When no attribute is left in the graph, the copy drops the module
+ * hierarchy and only has the forward method. Otherwise it keeps the
+ * submodules and attributes of `module` along with the frozen forward.
+ *
+ * `module` itself is not modified; the constants share the memory of its
+ * parameters.
+ */
+TORCH_API script::Module freeze_module(const script::Module& module);
+
+/** \brief Folds aten::batch_norm in eval mode into the aten::conv2d that
+ * produces its input, when the weights and statistics of both are graph
+ * constants.
+ */
+TORCH_API void FoldFrozenConvBatchNorm2d(std::shared_ptr<Graph>& graph);
+
+} // namespace jit
+} // namespace torch
@@ -0,0 +1,128 @@
+#include <torch/csrc/jit/passes/memory_planning.h>
+
+#include <torch/csrc/jit/passes/alias_analysis.h>
+#include <torch/csrc/jit/passes/liveness.h>
+
+#include <algorithm>
+
+namespace torch {
+namespace jit {
+
+std::unordered_map<const Value*, LiveRange> ComputeLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<Value*>& values) {
+  AliasDb alias_db(graph);
+  auto liveness_sets = BuildLivenessSets(graph);
+
+  // Every value is live from the node that produces it (graph inputs from
+  // before the first node) to the last node whose liveness set holds it.
+  std::unordered_map<Node*, size_t> positions;
+  std::vector<Value*> all_values(graph->inputs().begin(), graph->inputs().end());
+  std::unordered_map<const Value*, LiveRange> value_ranges;
+  for (Value* v : graph->inputs()) {
+    value_ranges[v] = LiveRange{0, 0};
+  }
+  size_t pos = 0;
+  for (Node* n : graph->nodes()) {
+    positions[n] = pos;
+    for (Value* v : n->outputs()) {
+      all_values.push_back(v);
+      value_ranges[v] = LiveRange{pos, pos};
+    }
+    pos++;
+  }
+  for (Node* n : graph->nodes()) {
+    const size_t n_pos = positions.at(n);
+    auto it = liveness_sets.find(n);
+    if (it == liveness_sets.end()) {
+      continue;
+    }
+    for (Value* v : it->second) {
+      auto range = value_ranges.find(v);
+      if (range != value_ranges.end()) {
+        range->second.end = std::max(range->second.end, n_pos);
+      }
+    }
+  }
+  // Graph outputs are live until the end.
+  for (Value* v : graph->outputs()) {
+    value_ranges[v].end = pos;
+  }
+
+  // The memory of a value stays in use for as long as any view of it, or
+  // any container holding it, is live.
+  std::unordered_map<const Value*, LiveRange> ranges;
+  for (Value* v : values) {
+    TORCH_INTERNAL_ASSERT(
+        v->node()->owningBlock() == graph->block(),
+        "ComputeLiveRanges: ", v->debugName(), " is not produced in the top-level block");
+    LiveRange range = value_ranges.at(v);
+    for (Value* other : all_values) {
+      if (other != v && alias_db.mayContainAlias(v, other)) {
+        range.end = std::max(range.end, value_ranges.at(other).end);
+      }
+    }
+    ranges[v] = range;
+  }
+  return ranges;
+}
+
+MemoryPlan PackLiveRanges(
+    const std::unordered_map<const Value*, LiveRange>& ranges,
+    const std::unordered_map<const Value*, size_t>& sizes,
+    size_t alignment) {
+  auto align = [&](size_t n) {
+    return (n + alignment - 1) / alignment * alignment;
+  };
+  std::vector<const Value*> order;
+  for (const auto& e : sizes) {
+    order.push_back(e.first);
+  }
+  // Largest first; ties are broken by position so that plans are
+  // deterministic.
+  std::sort(order.begin(), order.end(), [&](const Value* a, const Value* b) {
+    const size_t size_a = sizes.at(a);
+    const size_t size_b = sizes.at(b);
+    if (size_a != size_b) {
+      return size_a > size_b;
+    }
+    return ranges.at(a).begin < ranges.at(b).begin ||
+        (ranges.at(a).begin == ranges.at(b).begin && a->unique() < b->unique());
+  });
+
+  struct Placed {
+    const Value* value;
+    size_t offset;
+    size_t size;
+  };
+  std::vector<Placed> placed;
+  MemoryPlan plan;
+  for (const Value* v : order) {
+    const LiveRange& range = ranges.at(v);
+    const size_t size = align(sizes.at(v));
+    std::vector<Placed> conflicts;
+    for (const Placed& p : placed) {
+      const LiveRange& other = ranges.at(p.value);
+      if (range.begin <= other.end && other.begin <= range.end) {
+        conflicts.push_back(p);
+      }
+    }
+    std::sort(conflicts.begin(), conflicts.end(), [](const Placed& a, const Placed& b) {
+      return a.offset < b.offset;
+    });
+    size_t offset = 0;
+    for (const Placed& p : conflicts) {
+      if (offset + size <= p.offset) {
+        break;
+      }
+      offset = std::max(offset, p.offset + p.size);
+    }
+    placed.push_back(Placed{v, offset, size});
+    plan.offsets[v] = offset;
+    plan.arena_bytes = std::max(plan.arena_bytes, offset + size);
+  }
+  return plan;
+}
+
+} // namespace jit
+} // namespace torch
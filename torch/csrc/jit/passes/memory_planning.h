@@ -0,0 +1,43 @@
+#pragma once
+
+#include <torch/csrc/jit/ir.h>
+
+#include <unordered_map>
+#include <vector>
+
+namespace torch {
+namespace jit {
+
+// Static memory planning for straight-line graphs: values that are never
+// live at the same time may share memory, so every planned value gets one
+// offset in a single arena that is allocated once.
+
+// The positions, in graph order, of the node that produces a value and of
+// the last node that uses it or any value that may alias it.
+struct LiveRange {
+  size_t begin;
+  size_t end;
+};
+
+struct MemoryPlan {
+  std::unordered_map<const Value*, size_t> offsets;
+  size_t arena_bytes = 0;
+};
+
+// Computes the live ranges of `values`, which must be produced by nodes of
+// the top-level block of `graph`, from BuildLivenessSets and AliasDb.
+TORCH_API std::unordered_map<const Value*, LiveRange> ComputeLiveRanges(
+    const std::shared_ptr<Graph>& graph,
+    const std::vector<Value*>& values);
+
+// Packs values of `sizes` bytes with overlapping live ranges into disjoint,
+// `alignment`-aligned ranges of an arena. Values are placed from the largest
+// to the smallest, each at the lowest offset that fits next to the values
+// already placed whose live ranges overlap its own.
+TORCH_API MemoryPlan PackLiveRanges(
+    const std::unordered_map<const Value*, LiveRange>& ranges,
+    const std::unordered_map<const Value*, size_t>& sizes,
+    size_t alignment = 64);
+
+} // namespace jit
+} // namespace torch
@@ -608,6 +608,16 @@ void initJitScriptBindings(PyObject* module) {
           [](Module& self, const std::string& name) {
             return bool(self.find_method(name));
           })
+      .def(
+          "_set_auto_fork",
+          [](Module& self, bool enabled, size_t min_cost) {
+            for (Method method : self.get_methods()) {
+              method.get_executor().setAutoFork(
+                  enabled ? c10::optional<size_t>(min_cost) : c10::nullopt);
+            }
+          },
+          py::arg("enabled"),
+          py::arg("min_cost") = 16)
       .def(
           "_method_names",
           [](Module& self) {